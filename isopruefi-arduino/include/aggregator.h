@@ -0,0 +1,35 @@
+#pragma once
+
+#include "platform.h"
+
+/**
+ * @defgroup Aggregator Per-Interval Sample Aggregation
+ * @brief Folds the samples of one reporting interval into min/max/mean/count.
+ *
+ * With a sample period below one minute the firmware takes several readings
+ * per reporting interval but still sends one message per minute. Samples are
+ * added to a SampleAggregate in ADT7410 counts (1/128 °C); the aggregate has
+ * a fixed size however many samples it covers, and nothing is buffered.
+ *
+ * An aggregate of several samples is published as `"value":[mean]` with
+ * `"meta":{"mn":min, "mx":max, "n":count}`, plus `"l"` for the last sample
+ * when AggregateSetReportLast() is on. A single sample has no meta keys, so
+ * the default one-sample-per-minute configuration publishes exactly what it
+ * always did.
+ */
+
+/// Samples of one reporting interval, in ADT7410 counts
+struct SampleAggregate {
+  int32_t  sum;    ///< Sum of all samples
+  int16_t  min;
+  int16_t  max;
+  int16_t  last;   ///< Most recent sample
+  uint16_t count;  ///< Samples added since the last reset
+};
+
+void AggregateReset(SampleAggregate& aggregate);
+void AggregateAdd(SampleAggregate& aggregate, int16_t raw);
+int16_t AggregateMean(const SampleAggregate& aggregate);
+
+void AggregateSetReportLast(bool reportLast);
+bool AggregateReportsLast();
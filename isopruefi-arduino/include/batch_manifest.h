@@ -0,0 +1,48 @@
+#pragma once
+
+#include "platform.h"
+#include "outage_log.h"
+
+// =============================================================================
+// BATCH MANIFEST LAYOUT
+// =============================================================================
+
+/// Index of the legacy CSV batches that still wait for recovery
+#define BATCH_MANIFEST_PATH OUTAGE_LOG_DIR "/BATCHES.IDX"
+/// Room for "<year>/<MMDDhhmm>.csv" plus terminator
+static const size_t BATCH_PATH_BYTES = 24;
+/// On-card size of one manifest entry
+static const uint32_t BATCH_ENTRY_BYTES = 40;
+/// Upper bound of batches the manifest indexes
+static const uint16_t BATCH_MANIFEST_MAX_ENTRIES = 2048;
+
+/// Delivery state of a batch, stored per manifest entry
+enum BatchState : uint8_t {
+  BATCH_PENDING = 0,  ///< Not yet published
+  BATCH_SENT = 1,     ///< Published and deleted from the card
+  BATCH_SKIPPED = 2   ///< Empty or older than the recovery window, kept on the card
+};
+
+/**
+ * @brief Manifest entry describing one CSV batch file.
+ *
+ * Holds everything recovery needs to decide about a batch without opening
+ * it: the path, the first and last timestamp, the record count and the
+ * delivery state.
+ */
+struct BatchEntry {
+  char path[BATCH_PATH_BYTES];  ///< Path relative to the card root
+  uint32_t firstTimestamp;      ///< Unix timestamp of the first record
+  uint32_t lastTimestamp;       ///< Unix timestamp of the last record
+  uint16_t records;             ///< Number of parseable records
+  uint8_t state;                ///< BatchState
+};
+
+bool BatchManifestBegin();
+void BatchManifestEnd();
+
+uint16_t BatchManifestCount();
+uint16_t BatchManifestFirstPending();
+bool BatchManifestRead(uint16_t index, BatchEntry& entry);
+bool BatchManifestSetState(uint16_t index, uint8_t state);
+bool BatchManifestMarkSent(const char* path);
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// BURST SAMPLING DEFAULTS
+// =============================================================================
+
+/// Samples the change detector compares the newest one with
+static const uint8_t CHANGE_WINDOW_SAMPLES = 4;
+/// Rate of change that starts a burst: 64 counts (0.5 °C) per minute
+static const int16_t BURST_DEFAULT_RATE_THRESHOLD = 64;
+/// Sample period while a burst is at full rate
+static const uint8_t BURST_DEFAULT_PERIOD_SECONDS = 5;
+/// Full rate lasts this long after the last detected change
+static const uint16_t BURST_DEFAULT_HOLD_SECONDS = 60;
+/// Samples taken at each slower period before the next step of the decay
+static const uint8_t BURST_DECAY_SAMPLES = 4;
+/// Largest number of samples in one burst message; keeps it within the echo buffer
+static const uint8_t BURST_MAX_SAMPLES = 8;
+
+/**
+ * @defgroup BurstSampler Adaptive Burst Sampling
+ * @brief Samples faster while the temperature changes quickly.
+ *
+ * Every sample goes through a change detector that compares it with the
+ * previous CHANGE_WINDOW_SAMPLES samples. If the rate of change to any of
+ * them exceeds rateThreshold counts per minute (a door opened, the HVAC
+ * failed), a burst starts: the sample period drops to periodSeconds and
+ * stays there until holdSeconds have passed without another detected change.
+ * It then decays, BURST_DECAY_SAMPLES samples per step, through the next
+ * divisors of a minute at least twice as long (5 → 10 → 20 s ...) until it
+ * reaches the base period and the burst ends.
+ *
+ * The samples of a burst are collected into BurstMessage blocks of evenly
+ * spaced samples, at most BURST_MAX_SAMPLES each, which are published as one
+ * multi-value message. Everything is integer arithmetic on RTC seconds and
+ * ADT7410 counts, so the same trace always gives the same bursts.
+ */
+
+/// Tuning of the change detector and the burst rate
+struct BurstConfig {
+  int16_t rateThreshold;    ///< Counts per minute that start a burst
+  uint8_t periodSeconds;    ///< Sample period at full burst rate
+  uint16_t holdSeconds;     ///< Full rate lasts this long after the last change
+};
+
+/// Evenly spaced samples of a burst, published as one message
+struct BurstMessage {
+  uint32_t timestamp;               ///< RTC time of the first sample
+  uint8_t periodSeconds;            ///< Spacing of the samples
+  uint8_t count;                    ///< Samples in raw
+  int16_t raw[BURST_MAX_SAMPLES];   ///< Samples in ADT7410 counts
+};
+
+class BurstSampler {
+  public:
+    BurstSampler();
+
+    void Configure(bool enabled, const BurstConfig& config);
+    bool Enabled() const { return _enabled; }
+    void Reset();
+
+    void Add(uint32_t timestamp, int16_t raw, uint8_t basePeriodSeconds);
+    uint8_t PeriodSeconds(uint8_t basePeriodSeconds) const;
+    bool Active() const { return _active; }
+    bool TakeMessage(BurstMessage& message);
+
+    uint32_t Bursts() const { return _bursts; }
+
+  private:
+    bool DetectChange(uint32_t timestamp, int16_t raw);
+    void Append(uint32_t timestamp, int16_t raw);
+    void Flush();
+
+    bool _enabled;
+    BurstConfig _config;
+
+    int16_t _windowRaw[CHANGE_WINDOW_SAMPLES];
+    uint32_t _windowTime[CHANGE_WINDOW_SAMPLES];
+    uint8_t _windowCount;
+    uint8_t _windowHead;
+
+    bool _active;
+    uint8_t _period;
+    uint32_t _holdUntil;
+    uint8_t _decaySamples;
+    uint32_t _bursts;
+
+    BurstMessage _building;
+    BurstMessage _ready;
+    bool _haveReady;
+};
@@ -1,7 +1,30 @@
 #pragma once
 
+#include "reconnect_policy.h"
+#include "deadband.h"
+#include "burst_sampler.h"
+
 void CoreSetup();
 void CoreLoop();
+void CoreShutdown();
+void CoreSampleTask(unsigned long nowMs);
+void CorePublishTask(unsigned long nowMs);
+void CoreConnectionTask(unsigned long nowMs);
+void CoreRecoveryTask(unsigned long nowMs);
+void CoreHousekeepingTask(unsigned long nowMs);
+void CoreLogTask(unsigned long nowMs);
 bool IsWifiConnected();
 bool IsMqttConnected();
+uint8_t CorePublishPhaseSeconds();
+void CoreSetSamplePeriod(uint8_t seconds);
+const ReconnectPolicy& CoreReconnectPolicy();
+void CoreSetDeadband(bool enabled, int16_t thresholdRaw, uint32_t heartbeatSeconds);
+const DeadbandFilter& CoreDeadband();
+void CoreSetBurstSampling(bool enabled);
+const BurstSampler& CoreBurstSampler();
+void CoreSetOversampling(uint8_t conversions);
+void CoreSetRtcSqwPin(int pin);
+bool CoreSetLowPower(bool enabled);
+bool CoreSetInterruptSampling(bool enabled);
+void CoreOnSqwEdge();
 void FatDateTime(uint16_t* date, uint16_t* time);
\ No newline at end of file
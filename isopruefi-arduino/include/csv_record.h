@@ -0,0 +1,35 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// CSV RECORD FORMAT
+// =============================================================================
+
+/// Fixed-point scale of parsed temperatures (milli-degrees Celsius)
+static const int32_t CSV_TEMP_SCALE = 1000;
+
+/**
+ * @brief One parsed "timestamp,temperature,sequence" line of a CSV batch.
+ */
+struct CsvRecord {
+  uint32_t timestamp;    ///< Unix timestamp of the measurement
+  int32_t milliCelsius;  ///< Temperature in 1/1000 °C, rounded half away from zero
+  int32_t sequence;      ///< Sequence number of the measurement
+};
+
+/// Result of ParseCsvRecord(); every value except CSV_OK names the failing field
+enum CsvParseResult {
+  CSV_OK = 0,
+  CSV_ERR_EMPTY,        ///< Blank line
+  CSV_ERR_TIMESTAMP,    ///< Missing, non-numeric or out-of-range timestamp
+  CSV_ERR_TEMPERATURE,  ///< Missing, non-numeric or out-of-range temperature
+  CSV_ERR_SEQUENCE,     ///< Missing, non-numeric or out-of-range sequence
+  CSV_ERR_TRAILING      ///< Unexpected characters after the sequence
+};
+
+CsvParseResult ParseCsvRecord(const char* line, size_t length, CsvRecord& record);
+
+inline float CsvMilliCelsiusToFloat(int32_t milliCelsius) {
+  return (float)milliCelsius / CSV_TEMP_SCALE;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "platform.h"
+#include "outage_log.h"
+
+// =============================================================================
+// DEADBAND DEFAULTS
+// =============================================================================
+
+/// Change that is always reported: 13 counts, about 0.1 °C
+static const int16_t DEADBAND_DEFAULT_THRESHOLD_RAW = 13;
+/// Longest time without a report while the temperature stays in the band
+static const uint32_t DEADBAND_DEFAULT_HEARTBEAT_SECONDS = 900;
+
+/**
+ * @defgroup Deadband Report-by-Exception Filter
+ * @brief Drops readings that say nothing new, keeps a heartbeat.
+ *
+ * When enabled, a reading (or interval aggregate) is reported only if any
+ * of its samples lies more than the threshold away from the last reported
+ * value, or if the heartbeat interval has passed since the last report. The
+ * first reading after a reset is always reported.
+ *
+ * The filter sits in front of both the live publish and the staging ring,
+ * so readings taken during an outage are thinned the same way and backlogs
+ * shrink along with the live traffic. Sequence numbers count reports, not
+ * intervals: a timestamp gap with consecutive sequence numbers is a skipped
+ * interval, a sequence gap is lost data.
+ */
+class DeadbandFilter {
+  public:
+    DeadbandFilter();
+
+    void Configure(bool enabled, int16_t thresholdRaw, uint32_t heartbeatSeconds);
+    bool Enabled() const { return _enabled; }
+    void Reset();
+
+    bool Offer(const OutageRecord& record);
+
+    uint32_t Reported() const { return _reported; }
+    uint32_t Skipped() const { return _skipped; }
+
+  private:
+    bool _enabled;
+    int16_t _thresholdRaw;
+    uint32_t _heartbeatSeconds;
+    bool _haveLast;
+    int16_t _lastRaw;
+    uint32_t _lastTimestamp;
+    uint32_t _reported;
+    uint32_t _skipped;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// FIXED-POINT FORMATTING
+// =============================================================================
+
+/// Room for the longest formatted number ("-2147483648" or a fixed-point value)
+static const size_t FIXED_POINT_BUFFER_SIZE = 24;
+
+/**
+ * @defgroup FixedPoint Integer-Only Number Formatting
+ * @brief Decimal output of fixed-point temperatures without soft-float or printf.
+ *
+ * Temperatures stay in ADT7410 counts (1/128 °C) from the sensor register to
+ * the payload. The SAMD21 has no FPU, so every float step costs soft-float
+ * code and "%f" pulls printf-float into flash. These formatters print the
+ * exact decimal value with integer arithmetic only; the live JSON documents
+ * and the recovery stream both use them.
+ */
+
+size_t FormatUnsigned(char* buffer, uint32_t value);
+size_t FormatSigned(char* buffer, int32_t value);
+size_t FormatFixedPoint(char* buffer, int32_t value, uint16_t scale);
+size_t FormatRawTemp(char* buffer, int16_t raw);
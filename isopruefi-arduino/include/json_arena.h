@@ -0,0 +1,67 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// JSON ARENA CONFIGURATION
+// =============================================================================
+
+#ifdef UNIT_TEST
+/// 64-bit hosts use 16-byte slots in pools of 128 (ArduinoJson 7 defaults)
+static const size_t JSON_ARENA_SIZE = 3072;
+#else
+/// One pool of 64 eight-byte slots plus the formatted temperatures of a burst
+static const size_t JSON_ARENA_SIZE = 1024;
+#endif
+
+/**
+ * @defgroup JsonArena Static ArduinoJson Allocator
+ * @brief Keeps the live JSON documents off the heap.
+ *
+ * ArduinoJson 7 has no fixed-capacity document any more: StaticJsonDocument
+ * is an alias that allocates its memory pools and copied strings with
+ * malloc(). On a 32 KB SAMD21 that runs for months every such allocation
+ * is a fragmentation risk, so the live documents are given this allocator
+ * instead:
+ *
+ * ```cpp
+ * JsonDocument doc(&arena);
+ * ```
+ *
+ * The arena hands out blocks from a fixed buffer, bump-pointer style. A
+ * freed block is reclaimed right away if it is the last one, and the whole
+ * buffer once every block is free, which is the case after each document
+ * has been serialized and destroyed. When the buffer is exhausted the
+ * allocation fails and ArduinoJson marks the document as overflowed; the
+ * heap is never used as a fallback.
+ */
+class JsonArena : public ArduinoJson::Allocator {
+  public:
+    JsonArena();
+
+    void* allocate(size_t size) override;
+    void deallocate(void* pointer) override;
+    void* reallocate(void* pointer, size_t newSize) override;
+
+    size_t Used() const { return _used; }
+    size_t HighWater() const { return _highWater; }
+    uint16_t Blocks() const { return _blocks; }
+    uint32_t Failures() const { return _failures; }
+
+  private:
+    size_t BlockSize(const void* pointer) const;
+    bool IsLast(const void* pointer) const;
+
+    /// Blocks start on this boundary; each is preceded by its size
+    static const size_t ALIGNMENT = sizeof(void*) > sizeof(size_t) ? sizeof(void*) : sizeof(size_t);
+
+    union {
+      uint8_t _buffer[JSON_ARENA_SIZE];
+      size_t _align;
+    };
+    size_t _used;
+    size_t _lastBlock;
+    size_t _highWater;
+    uint16_t _blocks;
+    uint32_t _failures;
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "platform.h"
+#include "outage_log.h"
+
+// =============================================================================
+// LIVE BATCH LIMITS
+// =============================================================================
+
+/// Largest number of readings one live message can carry
+static const uint8_t LIVE_BATCH_MAX_RECORDS = 16;
+/// Readings per live message unless LiveBatchConfigure() says otherwise; 1 sends each on its own
+static const uint8_t LIVE_BATCH_DEFAULT_SIZE = 1;
+/// Longest time a reading waits for its batch to fill up
+static const unsigned long LIVE_BATCH_DEFAULT_MAX_LATENCY_MS = 120000;
+
+/**
+ * @defgroup LiveBatch Micro-Batched Live Publishing
+ * @brief Collects live readings so that K of them travel in one message.
+ *
+ * With a batch size above one, live readings are not published one by one
+ * but queued here. The queue is published as one message once it holds the
+ * configured number of readings, or once its oldest reading has waited the
+ * maximum latency, whichever comes first. That cuts the per-message
+ * overhead, the ack round trips and the broker fan-out by the batch size.
+ *
+ * One batch is in flight at a time; readings queue up behind it. The batch
+ * in flight keeps its records until the ack arrives. If it never does, all
+ * of them are spilled to the staging ring in one go (see LiveBatchSpill()),
+ * so a batch is either acknowledged or stored as a whole, never in parts.
+ */
+
+void LiveBatchReset();
+void LiveBatchConfigure(uint8_t size, unsigned long maxLatencyMs);
+uint8_t LiveBatchSize();
+
+bool LiveBatchAdd(const OutageRecord& record, unsigned long nowMs);
+size_t LiveBatchQueuedCount();
+bool LiveBatchDue(unsigned long nowMs);
+
+size_t LiveBatchStart();
+size_t LiveBatchInFlightCount();
+size_t LiveBatchPeekInFlight(OutageRecord* records, size_t maxRecords, size_t skip = 0);
+void LiveBatchSettle();
+size_t LiveBatchSpill(unsigned long nowMs);
+size_t LiveBatchSpillQueued(unsigned long nowMs);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// ON-CARD ENCODING HELPERS
+// =============================================================================
+// Shared by the binary files in the outage log directory (segments, cursor,
+// batch manifest). All multi-byte fields are little-endian.
+
+inline void PutU16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+inline void PutU32(uint8_t* p, uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+inline uint16_t GetU16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+inline uint32_t GetU32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint32_t Crc32(uint32_t seed, const uint8_t* data, size_t len);
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// LOG LEVELS
+// =============================================================================
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+/// Most verbose level compiled in; override with -DLOG_LEVEL=LOG_LEVEL_DEBUG
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// =============================================================================
+// LOG BUFFER LIMITS
+// =============================================================================
+
+/// Bytes of formatted text the ring holds until the sink takes them
+static const size_t LOG_BUFFER_BYTES = 512;
+/// Longest message including its level tag and newline; longer ones are cut
+static const size_t LOG_LINE_MAX = 96;
+
+/**
+ * @defgroup Logger Buffered Logging
+ * @brief Leveled log messages that never wait for the serial port.
+ *
+ * At 9600 baud every character costs a millisecond, and Serial.print()
+ * waits once the UART buffer is full. LOG_ERROR(), LOG_WARN(), LOG_INFO()
+ * and LOG_DEBUG() take a printf format instead: LogWrite() formats the
+ * message into a fixed-size ring and returns, and LogDrain() hands the text
+ * to the sink only as far as the sink takes it without waiting. The loop
+ * drains the ring as a task of its own (see CoreLoop()).
+ *
+ * Levels above LOG_LEVEL are compiled out: their macros expand to nothing,
+ * so neither the format string nor the arguments cost flash or cycles. The
+ * format strings of the rest are string literals, which stay in flash on
+ * the SAMD21; only the formatted text passes through RAM.
+ *
+ * A message that does not fit into the ring is dropped and counted; the
+ * next drain that empties the ring adds a note with the number dropped.
+ * Not for interrupt handlers: LogWrite() is not reentrant.
+ */
+
+/// Takes up to len bytes without waiting, returns how many it took
+typedef size_t (*LogSink)(const char* data, size_t len);
+
+/// Counters of the log ring
+struct LogStats {
+  uint32_t written;   ///< Messages put into the ring
+  uint32_t dropped;   ///< Messages that did not fit
+};
+
+void LogBegin(LogSink sink);
+void LogWrite(uint8_t level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+size_t LogDrain();
+void LogFlush();
+size_t LogPendingBytes();
+LogStats LogGetStats();
+void LogReset();
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LogWrite(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) LogWrite(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) LogWrite(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LogWrite(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
@@ -14,8 +14,18 @@ struct MockDateTime {
   int minute() const { return _minute; }
   int second() const { return _second; }
 
+  /// 1753778400 at 26.07.2025 14:55:00, other times relative to it
   uint32_t unixtime() const {
-    return 1753778400; // 26.07.2025 14:55:00 
+    return 1753778400 + (DaysFromCivil(_year, _month, _day) - DaysFromCivil(2025, 7, 26)) * 86400 +
+           (_hour - 14) * 3600 + (_minute - 55) * 60 + _second;
+  }
+
+  static int32_t DaysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    const int era = y / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    return era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy;
   }
 };
 
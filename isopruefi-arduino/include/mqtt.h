@@ -1,14 +1,27 @@
 #pragma once
 
 #include "platform.h"
+#include "mqtt_transport.h"
+#include "aggregator.h"
+#include "burst_sampler.h"
 
 extern MqttClient mqttClient;
 
 bool SendTempToMqtt(MqttClient& mqttClient, const char* topicPrefix, const char* sensorType,
                 const char* sensorId, float celsius, const DateTime& now, int sequence);
+bool SendAggregateToMqtt(MqttClient& mqttClient, const char* topicPrefix, const char* sensorType,
+                         const char* sensorId, const SampleAggregate& aggregate, const DateTime& now,
+                         int sequence);
+bool SendBurstToMqtt(MqttClient& mqttClient, const char* topicPrefix, const char* sensorType,
+                     const char* sensorId, const BurstMessage& burst);
 
 bool SendPendingDataToMqtt(MqttClient& mqttClient, const char* topicPrefix, const char* sensorType,
                      const char* sensorId, const DateTime& now);
+void ResetRecovery();
+void SetMqttAckMode(MqttAckMode mode);
+void SetRecoveryMessageLimit(size_t maxBytes);
+void SetLiveBatching(uint8_t readings, unsigned long maxLatencyMs);
+void ServicePublishWindow(MqttClient& mqttClient, const DateTime& now);
                      
 void CreateFullTopic(char* buffer, size_t bufferSize, const char* topicPrefix, const char* sensorType,
                      const char* sensorId, const char* suffix = "");
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// MQTT TRANSPORT
+// =============================================================================
+
+/**
+ * @defgroup MqttTransport Packet-ID Transport Layer
+ * @brief Exposes QoS 1 PUBACK completion by packet identifier.
+ *
+ * ArduinoMqttClient assigns packet identifiers and swallows PUBACKs without
+ * reporting them. The transport sits between the MQTT client and the network
+ * socket and scans the MQTT framing in both directions:
+ *
+ * - outbound: the packet identifier of every QoS 1 PUBLISH, read back with
+ *   MqttTransportLastPublishId() right after endMessage()
+ * - inbound: every PUBACK, reported to the handler set with
+ *   MqttTransportSetPubackHandler()
+ *
+ * Bytes are only observed, never changed, so the client library keeps doing
+ * all of the protocol work.
+ */
+
+/// How published messages are confirmed
+enum MqttAckMode : uint8_t {
+  MQTT_ACK_PUBACK = 0,  ///< Broker PUBACK, matched by packet identifier
+  MQTT_ACK_ECHO = 1     ///< Subscribe to the own topic and match the echoed payload
+};
+
+/// Incremental parser state for one direction of an MQTT byte stream
+struct MqttPacketScanner {
+  uint8_t  phase;             ///< Fixed header, remaining length or body
+  uint8_t  header;            ///< First byte of the current packet
+  uint32_t remaining;         ///< Body bytes still to come
+  uint32_t lengthMultiplier;  ///< Position inside the remaining length varint
+  uint32_t bodyIndex;         ///< Body bytes seen so far
+  uint16_t topicLength;       ///< PUBLISH topic length
+  uint16_t packetId;          ///< Packet identifier, 0 if the packet has none
+};
+
+/// Called with the packet type (upper header nibble) and identifier of each complete packet
+typedef void (*MqttPacketHandler)(uint8_t packetType, uint8_t header, uint16_t packetId);
+
+static const uint8_t MQTT_PACKET_PUBLISH = 3;
+static const uint8_t MQTT_PACKET_PUBACK = 4;
+
+void MqttScannerReset(MqttPacketScanner& scanner);
+void MqttScannerFeed(MqttPacketScanner& scanner, const uint8_t* data, size_t length, MqttPacketHandler handler);
+
+void MqttTransportReset();
+void MqttTransportObserveOutbound(const uint8_t* data, size_t length);
+void MqttTransportObserveInbound(const uint8_t* data, size_t length);
+uint16_t MqttTransportLastPublishId();
+void MqttTransportSetPubackHandler(void (*handler)(uint16_t packetId));
+
+#ifndef UNIT_TEST
+/**
+ * @brief Client decorator that feeds all socket traffic of the MQTT client to the transport.
+ *
+ * Construct it around the network client and hand it to MqttClient instead
+ * of the network client itself.
+ */
+class MqttTransportClient : public Client {
+  public:
+    explicit MqttTransportClient(Client& inner) : _inner(inner) {}
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override { return _inner.available(); }
+    int read() override;
+    int read(uint8_t* buffer, size_t size) override;
+    int peek() override { return _inner.peek(); }
+    void flush() override { _inner.flush(); }
+    void stop() override { _inner.stop(); }
+    uint8_t connected() override { return _inner.connected(); }
+    operator bool() override { return (bool)_inner; }
+
+  private:
+    Client& _inner;
+};
+#endif
@@ -1,9 +1,62 @@
 #pragma once
 
 #include "platform.h"
+#include "reconnect_policy.h"
+
+// =============================================================================
+// CONNECTION MANAGER TIMING
+// =============================================================================
+
+/// Time the access point gets to associate before the attempt is abandoned
+static const unsigned long WIFI_ASSOCIATE_TIMEOUT_MS = 15000;
+/// Upper bound of the one blocking call per attempt: the broker's TCP connect and CONNACK
+static const unsigned long MQTT_CONNECT_TIMEOUT_MS = 5000;
+/// Pause after a failed attempt or a lost link when no ReconnectPolicy is given
+static const unsigned long CONNECTION_RETRY_DELAY_MS = 2000;
+
+/**
+ * @defgroup ConnectionManager Non-Blocking Connection Manager
+ * @brief Brings up WiFi and the MQTT session in small steps from a periodic tick.
+ *
+ * ```
+ *   IDLE ──► ASSOCIATING ──► CONNECTING_BROKER ──► CONNECTED
+ *    ▲            │                 │                  │
+ *    │            ▼                 ▼                  │ link lost
+ *    └──────── BACKOFF ◄────────────┴──────────────────┘
+ * ```
+ *
+ * ConnectionTick() never waits for the access point: association is started
+ * once and its status polled on later ticks. The broker connect is the only
+ * call that blocks, bounded by MQTT_CONNECT_TIMEOUT_MS, and it is tried once
+ * per attempt. Between failed attempts the manager waits in BACKOFF while the
+ * rest of the firmware keeps its schedule; the wait comes from the
+ * ReconnectPolicy given to ConnectionBegin(), so a fleet does not retry in
+ * lock-step. Every state change is reported to the handler set with
+ * ConnectionSetStateHandler().
+ */
+
+enum ConnectionState : uint8_t {
+  CONNECTION_IDLE = 0,               ///< Nothing in progress; the next tick starts an attempt
+  CONNECTION_ASSOCIATING = 1,        ///< Waiting for the access point
+  CONNECTION_CONNECTING_BROKER = 2,  ///< WiFi is up, the MQTT session is opened next
+  CONNECTION_CONNECTED = 3,          ///< WiFi and MQTT session are up
+  CONNECTION_BACKOFF = 4             ///< Waiting before the next attempt
+};
+
+/// Called on every state change with the previous and the new state
+typedef void (*ConnectionStateHandler)(ConnectionState from, ConnectionState to);
+
+void ConnectionBegin(MqttClient& mqttClient, ReconnectPolicy* policy = nullptr);
+void ConnectionTick(unsigned long nowMs);
+void ConnectionAddSleepTime(unsigned long sleptMs);
+ConnectionState ConnectionGetState();
+unsigned long ConnectionRetryDelayMs();
+void ConnectionSetStateHandler(ConnectionStateHandler handler);
+const char* ConnectionStateName(ConnectionState state);
 
 bool ConnectToWiFi(unsigned long timeoutMs = 10000);
-bool ConnectToMQTT(MqttClient& mqttClient, unsigned long timeoutMs = 10000);
+bool ConnectToMQTT(MqttClient& mqttClient, unsigned long timeoutMs = 10000,
+                   ReconnectPolicy* policy = nullptr);
 
 inline bool IsConnectedToServer(MqttClient& mqttClient) {
   return WiFi.status() == WL_CONNECTED && mqttClient.connected();
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// OUTAGE LOG LAYOUT
+// =============================================================================
+
+/// Directory on the SD card that holds the segment files
+#define OUTAGE_LOG_DIR "LOG"
+/// Number of segment files the log rotates through
+static const uint8_t OUTAGE_LOG_SEGMENT_COUNT = 8;
+/// Preallocated size of a single segment file in bytes
+static const uint32_t OUTAGE_LOG_SEGMENT_BYTES = 32768;
+/// On-card size of one record (the segment header occupies one record slot)
+static const uint32_t OUTAGE_LOG_RECORD_BYTES = 32;
+/// Number of records a single segment can hold
+static const uint32_t OUTAGE_LOG_RECORDS_PER_SEGMENT = OUTAGE_LOG_SEGMENT_BYTES / OUTAGE_LOG_RECORD_BYTES - 1;
+/// Card sector size; appends are buffered in RAM and written one sector at a time
+static const uint32_t OUTAGE_LOG_SECTOR_BYTES = 512;
+/// Record slots per card sector
+static const uint32_t OUTAGE_LOG_RECORDS_PER_SECTOR = OUTAGE_LOG_SECTOR_BYTES / OUTAGE_LOG_RECORD_BYTES;
+
+/**
+ * @brief A single sensor reading as stored in the outage log.
+ *
+ * A record is one reading or the aggregate of a reporting interval (see
+ * aggregator.h); count 0 or 1 marks a single reading, whose min/max/last
+ * are not used. Records are written as 32 little-endian bytes: timestamp,
+ * sequence, raw temperature (the mean of an aggregate), flags, min, max,
+ * count, last, eight reserved zero bytes and a CRC32 that is seeded with
+ * the segment generation, so stale data left in a reused segment never
+ * validates.
+ */
+struct OutageRecord {
+  uint32_t timestamp;  ///< Unix timestamp of the measurement
+  uint32_t sequence;   ///< Sequence number of the measurement
+  int16_t  rawTemp;    ///< Temperature in ADT7410 counts (1/128 °C), the mean of an aggregate
+  uint16_t flags;      ///< Reserved, written as 0
+  int16_t  rawMin;     ///< Lowest sample of an aggregate
+  int16_t  rawMax;     ///< Highest sample of an aggregate
+  uint16_t count;      ///< Samples in the aggregate; 0 or 1 for a single reading
+  int16_t  rawLast;    ///< Last sample of an aggregate
+};
+
+bool OutageLogBegin();
+void OutageLogEnd();
+bool OutageLogFlush();
+void OutageLogTick(unsigned long nowMs, unsigned long maxAgeMs);
+uint32_t OutageLogBufferedBytes();
+
+bool OutageLogAppend(const OutageRecord& record);
+size_t OutageLogPeek(OutageRecord* records, size_t maxRecords, size_t skip = 0);
+void OutageLogConsume(size_t count);
+
+uint32_t OutageLogPendingCount();
+uint32_t OutageLogDroppedCount();
@@ -16,9 +16,11 @@
  * **Additionally mocked in platform.h:**
  *   - DateTime (RTClib)
  *   - RTC_DS3231 (RTClib)
- *   - SdFat and File (SD card)
- *   - Adafruit_ADT7410 (temperature sensor)
+ *   - SdFat and File (SD card, with shared file contents and binary I/O)
+ *   - Adafruit_ADT7410 (temperature sensor, with a model of its registers)
+ *   - Adafruit_I2CDevice (BusIO; reaches the ADT7410 register model)
  *   - WiFiClient, WiFi (network)
+ *   - LowPower (ArduinoLowPower standby)
  *   - MqttClient (MQTT)
  *   - Constants for file operations, SD card, and FAT time/date macros
  *   - All global objects (rtc, sd, tempsensor, wifiClient, mqttClient)
@@ -40,6 +42,9 @@
   #include <cstring>
   #include <cstdarg>
   #include <map>
+  #include <memory>
+  #include <vector>
+  #include <algorithm>
   #include <ArduinoJson.h>
   
   // Mock DateTime class for RTClib
@@ -47,6 +52,22 @@
     public:
       DateTime(int y, int m, int d, int h, int min, int s) 
         : _year(y), _month(m), _day(d), _hour(h), _minute(min), _second(s) {}
+      /// Seconds since 1970-01-01, like RTClib
+      explicit DateTime(uint32_t t) {
+        _second = t % 60; t /= 60;
+        _minute = t % 60; t /= 60;
+        _hour = t % 24;
+        // Civil date from days since the epoch (proleptic Gregorian calendar)
+        int32_t z = (int32_t)(t / 24) + 719468;
+        int32_t era = z / 146097;
+        int32_t doe = z - era * 146097;
+        int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        int32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        int32_t mp = (5 * doy + 2) / 153;
+        _day = doy - (153 * mp + 2) / 5 + 1;
+        _month = mp < 10 ? mp + 3 : mp - 9;
+        _year = yoe + era * 400 + (_month <= 2 ? 1 : 0);
+      }
       DateTime(const char* date, const char* time) 
         : _year(2025), _month(7), _day(26), _hour(14), _minute(55), _second(0) {} // Mock parsing
       DateTime(const __FlashStringHelper* date, const __FlashStringHelper* time) 
@@ -58,8 +79,14 @@
       int minute() const { return _minute; }
       int second() const { return _second; }
       uint32_t unixtime() const { 
-        // Simple mock timestamp calculation
-        return 1640995200 + (_year - 2022) * 31536000 + _month * 2628000 + _day * 86400 + _hour * 3600 + _minute * 60 + _second;
+        // Days since the epoch of the civil date (inverse of the constructor above)
+        int32_t y = _month <= 2 ? _year - 1 : _year;
+        int32_t era = y / 400;
+        int32_t yoe = y - era * 400;
+        int32_t doy = (153 * (_month > 2 ? _month - 3 : _month + 9) + 2) / 5 + _day - 1;
+        int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        uint32_t days = (uint32_t)(era * 146097 + doe - 719468);
+        return days * 86400 + _hour * 3600 + _minute * 60 + _second;
       }
       String timestamp(int format = 0) const {
         return String("2025-07-26T14:55:00");
@@ -72,28 +99,84 @@
       int _year, _month, _day, _hour, _minute, _second;
   };
   
+  // Stack probe: the mocks note the deepest stack address the firmware reaches through them,
+  // so tests can measure the stack high-water mark of a call
+  extern uintptr_t mockStackLowWater;
+  inline void MockStackProbe() {
+    volatile char marker = 0;
+    uintptr_t here = reinterpret_cast<uintptr_t>(&marker);
+    if (here < mockStackLowWater) mockStackLowWater = here;
+  }
+  inline void MockStackReset() { mockStackLowWater = UINTPTR_MAX; }
+
+  // Card access counters, so tests can assert how often the firmware hits the card
+  struct MockSdStats {
+    uint32_t writes;      // File::write() calls that reached the card
+    uint32_t bytesWritten;
+    uint32_t syncs;
+    uint32_t existsCalls;
+  };
+
   // Mock File class for SdFat
+  // File contents are shared with MockSdFat, so data written through one handle
+  // is visible to handles opened later (like on a real card).
   class MockFile {
     public:
-      MockFile() : _isOpen(false), _data(""), _position(0) {}
-      MockFile(bool isOpen) : _isOpen(isOpen), _data(""), _position(0) {}
+      MockFile() : _isOpen(false), _data(new std::string()), _position(0), _stats(nullptr) {}
+      MockFile(bool isOpen) : _isOpen(isOpen), _data(new std::string()), _position(0), _stats(nullptr) {}
+      MockFile(bool isOpen, std::shared_ptr<std::string> data, size_t position, MockSdStats* stats = nullptr)
+        : _isOpen(isOpen), _data(data), _position(position), _stats(stats) {}
+      // Directory handle: children are (name, isDirectory) pairs in listing order
+      MockFile(const std::vector<std::pair<std::string, bool>>& children)
+        : _isOpen(true), _data(new std::string()), _position(0), _stats(nullptr),
+          _isDir(true), _children(children) {}
       
       // Use std::string internally, convert ArduinoFake String when needed
-      bool print(const char* str) { if(_isOpen) _data += str; return _isOpen; }
+      bool print(const char* str) { write(str, strlen(str)); return _isOpen; }
       bool print(const String& str) {
-          if(_isOpen) _data += str.c_str();  // Convert ArduinoFake String to const char*
+          write(str.c_str(), str.length());  // Convert ArduinoFake String to const char*
           return _isOpen;
       }
+      size_t write(const void* buffer, size_t size) {
+        if (!_isOpen) return 0;
+        if (_stats) { _stats->writes++; _stats->bytesWritten += static_cast<uint32_t>(size); }
+        if (_position > _data->size()) _data->resize(_position, '\0');
+        size_t overlap = std::min(size, _data->size() - _position);
+        _data->replace(_position, overlap, static_cast<const char*>(buffer), size);
+        _position += size;
+        return size;
+      }
+      int read(void* buffer, size_t size) {
+        MockStackProbe();
+        if (!_isOpen) return -1;
+        if (_position >= _data->size()) return 0;
+        size_t n = std::min(size, _data->size() - _position);
+        memcpy(buffer, _data->data() + _position, n);
+        _position += n;
+        return static_cast<int>(n);
+      }
+      bool seekSet(uint32_t position) { if (!_isOpen) return false; _position = position; return true; }
+      uint32_t curPosition() const { return static_cast<uint32_t>(_position); }
+      uint32_t fileSize() const { return static_cast<uint32_t>(_data->size()); }
+      // Like SdFat: only valid on an empty file, the file then reports the full length
+      bool preAllocate(uint32_t length) {
+        if (!_isOpen || !_data->empty() || length == 0) return false;
+        _data->assign(length, '\0');
+        return true;
+      }
+      bool sync() { if (_stats && _isOpen) _stats->syncs++; return _isOpen; }
+      bool isOpen() const { return _isOpen; }
       void close() { _isOpen = false; }
-      bool available() { return _isOpen && _position < _data.length(); }
+      bool available() { return _isOpen && _position < _data->length(); }
       size_t fgets(char* buffer, size_t size) {
-        if (!_isOpen || _position >= _data.length()) return 0;
+        MockStackProbe();
+        if (!_isOpen || _position >= _data->length()) return 0;
         size_t i = 0;
-        while (i < size - 1 && _position < _data.length() && _data[_position] != '\n') {
-          buffer[i++] = _data[_position++];
+        while (i < size - 1 && _position < _data->length() && (*_data)[_position] != '\n') {
+          buffer[i++] = (*_data)[_position++];
         }
-        if (_position < _data.length() && _data[_position] == '\n') {
-          buffer[i++] = _data[_position++];
+        if (_position < _data->length() && (*_data)[_position] == '\n') {
+          buffer[i++] = (*_data)[_position++];
         }
         buffer[i] = '\0';
         return i;
@@ -101,50 +184,62 @@
       operator bool() const { return _isOpen; }
       
       // Additional methods needed by the code
-      MockFile openNextFile() { return MockFile(false); } // Mock iterator
-      bool isDirectory() { return false; }
+      MockFile openNextFile() {
+        if (!_isOpen || _nextChild >= _children.size()) return MockFile(false);
+        MockFile entry(true);
+        entry._name = _children[_nextChild].first;
+        entry._isDir = _children[_nextChild].second;
+        _nextChild++;
+        return entry;
+      }
+      bool isDirectory() { return _isDir; }
       void getName(char* buffer, size_t size) {
-        strncpy(buffer, "test.csv", size);
+        strncpy(buffer, _name.c_str(), size);
         buffer[size-1] = '\0';
       }
       
-      void setTestData(const std::string& data) { _data = data; _position = 0; }
-      std::string getWrittenData() const { return _data; }
+      void setTestData(const std::string& data) { *_data = data; _position = 0; }
+      std::string getWrittenData() const { return *_data; }
       
     private:
       bool _isOpen;
-      std::string _data;
+      std::shared_ptr<std::string> _data;
       size_t _position;
+      MockSdStats* _stats;
+      std::string _name;
+      bool _isDir = false;
+      std::vector<std::pair<std::string, bool>> _children;
+      size_t _nextChild = 0;
   };
   
   // Mock SdFat class
   class MockSdFat {
     public:
-      bool exists(const char* path) { return _existingFiles.find(std::string(path)) != _existingFiles.end(); }
-      bool mkdir(const char* path) { _existingFiles.insert(std::string(path)); return true; }
+      bool exists(const char* path) { _stats.existsCalls++; return _existingFiles.find(std::string(path)) != _existingFiles.end(); }
+      bool mkdir(const char* path) {
+        _existingFiles.insert(std::string(path));
+        _directories.insert(std::string(path));
+        return true;
+      }
       MockFile open(const char* path, int mode) { 
         std::string pathStr(path);
-        if (mode == 1) { // FILE_WRITE
+        if (mode == 1) { // FILE_WRITE: create if missing, position at end
           _existingFiles.insert(pathStr);
-          return MockFile(true);
+          std::shared_ptr<std::string>& data = _fileContents[pathStr];
+          if (!data) data.reset(new std::string());
+          return MockFile(true, data, data->size(), &_stats);
         }
         // FILE_READ
-        bool exists = _existingFiles.find(pathStr) != _existingFiles.end();
-        MockFile file(exists);
-        if (exists && _fileContents.find(pathStr) != _fileContents.end()) {
-          file.setTestData(_fileContents[pathStr]);
-        }
-        return file;
+        return open(path);
       }
       MockFile open(const char* path) { 
         // Default to read mode
         std::string pathStr(path);
-        bool exists = _existingFiles.find(pathStr) != _existingFiles.end();
-        MockFile file(exists);
-        if (exists && _fileContents.find(pathStr) != _fileContents.end()) {
-          file.setTestData(_fileContents[pathStr]);
-        }
-        return file;
+        if (pathStr == "/" || isDirectory(pathStr)) return MockFile(listDirectory(pathStr));
+        if (_existingFiles.find(pathStr) == _existingFiles.end()) return MockFile(false);
+        std::shared_ptr<std::string>& data = _fileContents[pathStr];
+        if (!data) data.reset(new std::string());
+        return MockFile(true, data, 0, &_stats);
       }
       bool remove(const char* path) { 
         std::string pathStr(path);
@@ -161,16 +256,47 @@
       void addTestFile(const std::string& path) { _existingFiles.insert(path); }
       void addTestFile(const std::string& path, const std::string& content) { 
         _existingFiles.insert(path); 
-        _fileContents[path] = content;
+        _fileContents[path].reset(new std::string(content));
+      }
+      std::string getTestFileContent(const std::string& path) {
+        auto it = _fileContents.find(path);
+        return (it != _fileContents.end() && it->second) ? *it->second : std::string();
       }
       void clearTestFiles() { 
         _existingFiles.clear(); 
         _fileContents.clear();
+        _directories.clear();
+        resetStats();
       }
+      const MockSdStats& getStats() const { return _stats; }
+      void resetStats() { _stats = MockSdStats(); }
       
     private:
+      // A path is a directory if it was created with mkdir() or contains files
+      bool isDirectory(const std::string& path) const {
+        if (_directories.count(path)) return true;
+        std::string prefix = path + "/";
+        auto it = _existingFiles.lower_bound(prefix);
+        return it != _existingFiles.end() && it->compare(0, prefix.size(), prefix) == 0;
+      }
+      std::vector<std::pair<std::string, bool>> listDirectory(const std::string& path) const {
+        std::string prefix = path == "/" ? std::string() : path + "/";
+        std::set<std::string> names;
+        for (const std::string& file : _existingFiles) {
+          if (file.compare(0, prefix.size(), prefix) != 0 || file.size() == prefix.size()) continue;
+          names.insert(file.substr(prefix.size(), file.find('/', prefix.size()) - prefix.size()));
+        }
+        std::vector<std::pair<std::string, bool>> children;
+        for (const std::string& name : names) {
+          children.push_back(std::make_pair(name, isDirectory(prefix + name)));
+        }
+        return children;
+      }
+
+      MockSdStats _stats = MockSdStats();
+      std::set<std::string> _directories;
       std::set<std::string> _existingFiles;
-      std::map<std::string, std::string> _fileContents;
+      std::map<std::string, std::shared_ptr<std::string>> _fileContents;
   };
   
   // Global mock objects
@@ -198,16 +324,35 @@
   
   class MockWiFiClass {
     public:
-      int begin(const char* ssid, const char* pass) { _status = 3; return 3; } // WL_CONNECTED = 3
+      int begin(const char* ssid, const char* pass) { _beginCalls++; _status = _beginStatus; return _status; }
       uint8_t status() { return _status; }
       void disconnect() { _status = 6; } // WL_DISCONNECTED = 6
+      void setTimeout(unsigned long timeoutMs) {}
+      void lowPowerMode() { _lowPower = true; }
+      void noLowPowerMode() { _lowPower = false; }
+
+      // Test hooks: the status begin() leaves behind (WL_CONNECTED unless told otherwise)
+      // and a status change from outside, e.g. the access point coming into range
+      void setBeginStatus(uint8_t status) { _beginStatus = status; }
+      void setStatus(uint8_t status) { _status = status; }
+      int getBeginCalls() const { return _beginCalls; }
+      bool isLowPowerMode() const { return _lowPower; }
+      void resetTestState() { _status = 6; _beginStatus = 3; _beginCalls = 0; _lowPower = false; }
       
     private:
       uint8_t _status = 6; // Start disconnected
+      uint8_t _beginStatus = 3; // WL_CONNECTED = 3
+      int _beginCalls = 0;
+      bool _lowPower = false;
   };  
 
     using WiFiClient = MockWiFiClient;
   
+  // Transport hooks (mqtt_transport.h): the mock feeds them the bytes a real socket would carry
+  void MqttTransportReset();
+  void MqttTransportObserveOutbound(const uint8_t* data, size_t length);
+  void MqttTransportObserveInbound(const uint8_t* data, size_t length);
+
   // Mock MQTT Client
   class MockMqttClient {
     public:
@@ -215,78 +360,355 @@
       
       void setId(const char* id) { _clientId = id; }
       void setUsernamePassword(const char* user, const char* pass) { _username = user; _password = pass; }
-      int connect(const char* broker, int port = 1883) { _connected = true; return 1; }
+      int connect(const char* broker, int port = 1883) {
+        _connectCalls++;
+        if (_refuseConnect) return 0;
+        MqttTransportReset();
+        _connected = true;
+        return 1;
+      }
+      void setConnectionTimeout(unsigned long timeoutMs) {}
+      // Test hooks: a broker that refuses connections, and how often connect() was tried
+      void setRefuseConnect(bool refuse) { _refuseConnect = refuse; }
+      int getConnectCalls() const { return _connectCalls; }
+      void resetConnectCalls() { _connectCalls = 0; }
       bool connected() { return _connected; }
       void stop() { _connected = false; }
-      void poll() {}
+      void poll() { deliverEchoes(); }
       
       int beginMessage(const char* MQTT_TOPIC, bool retain = false, int qos = 0) { 
         _currentTopic = MQTT_TOPIC; 
         _messageBuffer = "";
+        _currentQos = qos;
+        _declaredSize = -1;
         return 1; 
       }
-      size_t print(const char* data) { _messageBuffer += data; return strlen(data); }
+      /// Streaming variant: the payload length is sent up front and must match what is printed
+      int beginMessage(const char* MQTT_TOPIC, unsigned long size, bool retain, int qos) {
+        beginMessage(MQTT_TOPIC, retain, qos);
+        _declaredSize = static_cast<long>(size);
+        return 1;
+      }
+      size_t print(const char* data) { MockStackProbe(); _messageBuffer += data; return strlen(data); }
       size_t print(const String& data) { _messageBuffer += data.c_str(); return data.length(); }
-      int endMessage() { return 1; }
+      int endMessage() {
+        if (_declaredSize >= 0 && static_cast<size_t>(_declaredSize) != _messageBuffer.size()) return 0;
+        // Like a broker: messages on a subscribed topic come back on a later poll()
+        _publishCount++;
+        unsigned long dueMs = _ackDelayMs > 0 ? millis() + _ackDelayMs : 0;
+        if (_echoEnabled && _subscribedTopics.count(_currentTopic)) {
+          _pendingEchoes.push_back(PendingEcho{_currentTopic, _messageBuffer, dueMs});
+        }
+        if (_currentQos > 0) {
+          uint16_t packetId = writePublishPacket();
+          if (_pubackEnabled) _pendingAcks.push_back(PendingAck{packetId, dueMs});
+        }
+        return 1;
+      }
       
-      String messageTopic() { return String(_currentTopic.c_str()); }
+      String messageTopic() { return String(_rxTopic.c_str()); }
       bool messageRetain() { return false; }
-      int available() { return 0; }
-      int read() { return -1; }
+      int available() { return static_cast<int>(_rxBuffer.size() - _rxPosition); }
+      int read() { return _rxPosition < _rxBuffer.size() ? (unsigned char)_rxBuffer[_rxPosition++] : -1; }
       
       void setMessageCallback(void (*callback)(int)) { _callback = callback; }
       void onMessage(void (*callback)(int)) { _callback = callback; }
-      void subscribe(const char* MQTT_TOPIC) { _subscribedTopic = MQTT_TOPIC; }
-      void unsubscribe(const char* MQTT_TOPIC) {}
+      void subscribe(const char* MQTT_TOPIC) { _subscribedTopics.insert(MQTT_TOPIC); }
+      void unsubscribe(const char* MQTT_TOPIC) { _subscribedTopics.erase(MQTT_TOPIC); }
       
       // Test helpers
       std::string getLastMessage() { return _messageBuffer; }
+      std::string getLastTopic() { return _currentTopic; }
+      int getPublishCount() { return _publishCount; }
+      bool isSubscribed(const std::string& MQTT_TOPIC) { return _subscribedTopics.count(MQTT_TOPIC) > 0; }
+      void resetPublishCount() { _publishCount = 0; }
       void simulateMessage(const std::string& MQTT_TOPIC, const std::string& message) {
-        _currentTopic = MQTT_TOPIC;
-        _messageBuffer = message;
+        _rxTopic = MQTT_TOPIC;
+        _rxBuffer = message;
+        _rxPosition = 0;
         if (_callback) _callback(message.length());
       }
+      void setEchoEnabled(bool enabled) {
+        _echoEnabled = enabled;
+        _ackDelayMs = 0;
+        _pendingEchoes.clear();
+        _subscribedTopics.clear();
+      }
+      /// Broker answers QoS 1 publishes with a PUBACK on a later poll()
+      void setPubackEnabled(bool enabled) {
+        _pubackEnabled = enabled;
+        _ackDelayMs = 0;
+        _pendingAcks.clear();
+      }
+      /// Holds each echo and PUBACK back until millis() has advanced by delayMs (a slow link)
+      void setAckDelay(unsigned long delayMs) { _ackDelayMs = delayMs; }
       
     private:
+      struct PendingEcho {
+        std::string topic, message;
+        unsigned long dueMs;
+      };
+      struct PendingAck {
+        uint16_t packetId;
+        unsigned long dueMs;
+      };
+
+      /// Encodes the PUBLISH like the client library and passes it through the transport
+      uint16_t writePublishPacket() {
+        if (++_nextPacketId == 0) _nextPacketId = 1;
+        size_t remaining = 2 + _currentTopic.size() + 2 + _messageBuffer.size();
+        std::vector<uint8_t> packet;
+        packet.push_back(0x30 | (uint8_t)(_currentQos << 1));
+        do {
+          uint8_t digit = remaining % 128;
+          remaining /= 128;
+          packet.push_back(remaining > 0 ? (digit | 0x80) : digit);
+        } while (remaining > 0);
+        packet.push_back((uint8_t)(_currentTopic.size() >> 8));
+        packet.push_back((uint8_t)_currentTopic.size());
+        packet.insert(packet.end(), _currentTopic.begin(), _currentTopic.end());
+        packet.push_back((uint8_t)(_nextPacketId >> 8));
+        packet.push_back((uint8_t)_nextPacketId);
+        packet.insert(packet.end(), _messageBuffer.begin(), _messageBuffer.end());
+        MqttTransportObserveOutbound(packet.data(), packet.size());
+        return _nextPacketId;
+      }
+
+      void deliverEchoes() {
+        if (_pendingEchoes.empty() && _pendingAcks.empty()) return;
+        unsigned long nowMs = _ackDelayMs > 0 ? millis() : 0;
+
+        std::vector<PendingAck> lateAcks;
+        for (const auto& ack : _pendingAcks) {
+          if (ack.dueMs > nowMs) { lateAcks.push_back(ack); continue; }
+          uint8_t puback[] = {0x40, 0x02, (uint8_t)(ack.packetId >> 8), (uint8_t)ack.packetId};
+          MqttTransportObserveInbound(puback, sizeof(puback));
+        }
+        _pendingAcks.swap(lateAcks);
+
+        std::vector<PendingEcho> due;
+        std::vector<PendingEcho> later;
+        for (const auto& echo : _pendingEchoes) {
+          if (echo.dueMs <= nowMs) due.push_back(echo); else later.push_back(echo);
+        }
+        _pendingEchoes.swap(later);
+        for (const auto& echo : due) simulateMessage(echo.topic, echo.message);
+      }
+
       bool _connected;
       std::string _clientId, _username, _password;
-      std::string _currentTopic, _subscribedTopic, _messageBuffer;
+      std::string _currentTopic, _messageBuffer;
+      std::set<std::string> _subscribedTopics;
+      std::string _rxTopic, _rxBuffer;
+      size_t _rxPosition = 0;
+      bool _echoEnabled = false;
+      bool _pubackEnabled = false;
+      bool _refuseConnect = false;
+      int _connectCalls = 0;
+      unsigned long _ackDelayMs = 0;
+      int _currentQos = 0;
+      long _declaredSize = -1;
+      int _publishCount = 0;
+      uint16_t _nextPacketId = 0;
+      std::vector<PendingEcho> _pendingEchoes;
+      std::vector<PendingAck> _pendingAcks;
       void (*_callback)(int) = nullptr;
   };
   
   // WiFi status constants
+  #define WL_IDLE_STATUS 0
   #define WL_CONNECTED 3
+  #define WL_CONNECT_FAILED 4
   #define WL_DISCONNECTED 6
   
   // Global WiFi object
   extern MockWiFiClass WiFi;
   
+  // DS3231 modes of RTClib
+  enum Ds3231SqwPinMode { DS3231_OFF = 0x1C, DS3231_SquareWave1Hz = 0x00 };
+  enum Ds3231Alarm1Mode { DS3231_A1_PerSecond = 0x0F, DS3231_A1_Second = 0x0E, DS3231_A1_Minute = 0x0C,
+                          DS3231_A1_Hour = 0x08, DS3231_A1_Date = 0x00, DS3231_A1_Day = 0x10 };
+
   // Mock hardware objects
   class MockRTC {
     public:
-      DateTime now() { return DateTime(2025, 7, 26, 14, 55, 0); }
+      DateTime now() { _nowCalls++; return _now; }
       bool begin() { return true; }
       bool lostPower() { return false; }
       void adjust(const DateTime& dt) {}
+      void writeSqwPinMode(Ds3231SqwPinMode mode) { _sqwMode = mode; }
+      bool setAlarm1(const DateTime& dt, Ds3231Alarm1Mode mode) { _alarm1 = dt.unixtime(); _alarmFired = false; return true; }
+      void disableAlarm(uint8_t alarm) {}
+      void clearAlarm(uint8_t alarm) { if (alarm == 1) _alarmFired = false; }
+      bool alarmFired(uint8_t alarm) { return alarm == 1 && _alarmFired; }
+
+      // Test hooks: the time now() returns, and how often it was read over I2C.
+      // Alarm 1 goes off once the time reaches it.
+      void setNow(const DateTime& now) {
+        _now = now;
+        if (_alarm1 != 0 && now.unixtime() >= _alarm1) _alarmFired = true;
+      }
+      uint32_t getNowCalls() const { return _nowCalls; }
+      uint32_t getAlarm1() const { return _alarm1; }
+      Ds3231SqwPinMode getSqwPinMode() const { return _sqwMode; }
+      void resetTestState() {
+        _now = DateTime(2025, 7, 26, 14, 55, 0);
+        _nowCalls = 0;
+        _alarm1 = 0;
+        _alarmFired = false;
+        _sqwMode = DS3231_SquareWave1Hz;
+      }
+
+    private:
+      DateTime _now = DateTime(2025, 7, 26, 14, 55, 0);
+      uint32_t _nowCalls = 0;
+      uint32_t _alarm1 = 0;
+      bool _alarmFired = false;
+      Ds3231SqwPinMode _sqwMode = DS3231_SquareWave1Hz;
+  };
+
+  extern MockRTC rtc;
+
+  // Mock ArduinoLowPower; the wake-up interrupt is the DS3231 alarm
+  class MockLowPower {
+    public:
+      void attachInterruptWakeup(uint32_t pin, void (*callback)(), uint32_t mode) { _wakeCallback = callback; }
+      void deepSleep() {
+        _sleepCalls++;
+        if (_sleepHandler) _sleepHandler();
+        if (_wakeCallback && rtc.alarmFired(1)) _wakeCallback();
+      }
+
+      // Test hooks: what standby does to the simulated world (advance the RTC to
+      // the alarm, leave millis() where it was), and how often it was entered
+      void setSleepHandler(void (*handler)()) { _sleepHandler = handler; }
+      uint32_t getSleepCalls() const { return _sleepCalls; }
+      void resetTestState() { _sleepHandler = nullptr; _wakeCallback = nullptr; _sleepCalls = 0; }
+
+    private:
+      void (*_sleepHandler)() = nullptr;
+      void (*_wakeCallback)() = nullptr;
+      uint32_t _sleepCalls = 0;
   };
   
+  #define ADT7410_I2CADDR_DEFAULT 0x48
+
+  class MockTempSensor;
+  /// The ADT7410 that answers at ADT7410_I2CADDR_DEFAULT on the mock bus: the one
+  /// begin() was called on last, the global tempsensor otherwise
+  extern MockTempSensor* mockI2cTempSensor;
+  extern MockTempSensor tempsensor;
+
   class MockTempSensor {
     public:
-      float readTempC() { return 25.5; }
-      bool begin() { return true; }
-      int delayCalled() { return 250; }
-      void setResolution(int resolution) {} 
-      bool setResolutionCalled() { return true; }
+      ~MockTempSensor() { if (mockI2cTempSensor == this) mockI2cTempSensor = &tempsensor; }
+      float readTempC() { return _tempC; }
+      bool begin() { mockI2cTempSensor = this; return true; }
+
+      // Register model behind the I2C transfers of sensor.cpp (see MockI2CDevice).
+      // The first byte written sets the register pointer, a second one is written
+      // to that register; reads go on from the pointer. Writing one-shot mode (0x20)
+      // to the config register (0x03) starts a conversion, and the /RDY bit of the
+      // status register (0x02) stays set for the conversion time. The temperature
+      // (0x00 MSB, 0x01 LSB) is in 1/128 °C.
+      bool i2cWrite(const uint8_t* data, size_t len) {
+        if (_readFails) return false;
+        if (len >= 1) _pointer = data[0];
+        if (len >= 2 && _pointer == 0x03) {
+          _config = data[1];
+          if ((_config & 0x60) == 0x20) {
+            _converting = true;
+            _conversionStartMs = _conversionMs > 0 ? millis() : 0;
+            _conversions++;
+          }
+        }
+        return true;
+      }
+      bool i2cRead(uint8_t* data, size_t len) {
+        if (_readFails) return false;
+        for (size_t i = 0; i < len; i++) data[i] = readRegister(_pointer++);
+        return true;
+      }
+
+      // Test hooks: the temperature readTempC() returns, a sensor that does not answer,
+      // the conversion time (0: ready at once), and the bus traffic the driver caused
+      void setTempC(float tempC) { _tempC = tempC; }
+      void setReadFails(bool fails) { _readFails = fails; }
+      void setConversionMs(unsigned long ms) { _conversionMs = ms; }
+      uint8_t getConfig() const { return _config; }
+      uint32_t getConversions() const { return _conversions; }
+      uint32_t getStatusReads() const { return _statusReads; }
+      uint32_t getEarlyReads() const { return _earlyReads; }
+      void resetTestState() {
+        _tempC = 25.5f;
+        _readFails = false;
+        _conversionMs = 0;
+        _config = 0;
+        _pointer = 0;
+        _tempRaw = 0;
+        _converting = false;
+        _conversions = 0;
+        _statusReads = 0;
+        _earlyReads = 0;
+      }
+
+    private:
+      bool conversionDone() { return _conversionMs == 0 || millis() - _conversionStartMs >= _conversionMs; }
+      uint8_t readRegister(uint8_t reg) {
+        if (reg == 0x00) {
+          if (_converting && !conversionDone()) _earlyReads++;
+          float scaled = _tempC * 128;
+          _tempRaw = (uint16_t)(int16_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+          return (uint8_t)(_tempRaw >> 8);
+        }
+        if (reg == 0x01) return (uint8_t)_tempRaw;
+        if (reg == 0x02) {
+          _statusReads++;
+          return _converting && !conversionDone() ? 0x80 : 0x00;
+        }
+        return reg == 0x03 ? _config : 0;
+      }
+
+      float _tempC = 25.5f;
+      bool _readFails = false;
+      unsigned long _conversionMs = 0;
+      unsigned long _conversionStartMs = 0;
+      uint8_t _config = 0;
+      uint8_t _pointer = 0;
+      uint16_t _tempRaw = 0;   // latched with the MSB read, as the ADT7410 does
+      bool _converting = false;
+      uint32_t _conversions = 0;
+      uint32_t _statusReads = 0;
+      uint32_t _earlyReads = 0;
   };
   
+  // Adafruit BusIO device; transfers to ADT7410_I2CADDR_DEFAULT reach mockI2cTempSensor
+  class MockI2CDevice {
+    public:
+      explicit MockI2CDevice(uint8_t addr) : _addr(addr) {}
+      bool begin(bool addr_detect = true) { return !addr_detect || detected(); }
+      bool detected() { return _addr == ADT7410_I2CADDR_DEFAULT; }
+      uint8_t address() const { return _addr; }
+      bool write(const uint8_t* buffer, size_t len, bool stop = true) {
+        return detected() && mockI2cTempSensor->i2cWrite(buffer, len);
+      }
+      bool write_then_read(const uint8_t* write_buffer, size_t write_len, uint8_t* read_buffer,
+                           size_t read_len, bool stop = false) {
+        return write(write_buffer, write_len, stop) && mockI2cTempSensor->i2cRead(read_buffer, read_len);
+      }
+
+    private:
+      uint8_t _addr;
+  };
+
   // Type aliases for Arduino library classes - remove Client conflict
   using RTC_DS3231 = MockRTC;
   using Adafruit_ADT7410 = MockTempSensor;
+  using Adafruit_I2CDevice = MockI2CDevice;
   using MqttClient = MockMqttClient;
   using File = MockFile;
   
-  extern MockRTC rtc;
-  extern MockTempSensor tempsensor;
+  extern MockLowPower LowPower;
   extern MockWiFiClient wifiClient;
   extern MockMqttClient mqttClient;
   
@@ -319,8 +741,10 @@
   #include <SdFat.h>
   #include <RTClib.h>
   #include <Adafruit_ADT7410.h>
+  #include <Adafruit_I2CDevice.h>
   #include <ArduinoJson.h>
   #include <ArduinoMqttClient.h>
+  #include <ArduinoLowPower.h>
 
   // Global hardware objects (declaration)
   extern RTC_DS3231 rtc;
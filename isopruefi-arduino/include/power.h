@@ -0,0 +1,57 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// LOW-POWER TIMING
+// =============================================================================
+
+/// Longest time the MCU stays awake after a wake-up before it goes back to sleep
+static const unsigned long POWER_AWAKE_WINDOW_MS = 3000;
+/// Shortest sleep worth taking; also keeps the alarm second from passing before standby
+static const uint32_t POWER_MIN_SLEEP_SECONDS = 2;
+
+/**
+ * @defgroup Power Low-Power Sleep on RTC Alarm
+ * @brief Puts the MCU into standby until a DS3231 alarm wakes it.
+ *
+ * PowerSleepUntil() programs alarm 1 of the DS3231 for the given RTC
+ * second, switches the WiFi module to its power-save mode and enters
+ * standby. The alarm pulls the INT/SQW pin low at the start of that second,
+ * which wakes the MCU; the wake-up then re-anchors the time service to that
+ * second, since millis() stands still in standby. The MQTT session is kept:
+ * the module stays associated and the next publish goes out on it.
+ *
+ * Everything after a wake-up has POWER_AWAKE_WINDOW_MS. The caller sleeps as
+ * soon as its work is done; PowerWindowExpired() tells it when to sleep
+ * anyway, which is counted as a window overrun.
+ *
+ * The INT/SQW pin cannot carry the 1 Hz square wave at the same time, so
+ * PowerBegin() switches it to alarm output. The alarm wake-ups take over the
+ * role of the SQW edges in the time service.
+ *
+ * The hardware is reached through the RTClib, WiFi and ArduinoLowPower
+ * interfaces; the native build mocks them, so tests measure the duty cycle
+ * of a simulated run (see PowerGetStats()).
+ */
+
+/// Counters of the sleep/wake cycle
+struct PowerStats {
+  uint32_t sleeps;               ///< Times the MCU entered standby
+  uint32_t windowOverruns;       ///< Sleeps forced by the end of the awake window
+  unsigned long awakeMs;         ///< Time awake before each sleep, summed
+  unsigned long sleptMs;         ///< Time in standby, by the RTC
+  unsigned long longestAwakeMs;  ///< Longest time awake before a sleep
+  unsigned long lastSleptMs;     ///< Time in standby of the last sleep
+};
+
+bool PowerBegin(int wakePin);
+void PowerSetEnabled(bool enabled, unsigned long nowMs);
+bool PowerEnabled();
+void PowerReset();
+
+bool PowerWindowExpired(unsigned long nowMs);
+bool PowerSleepUntil(uint32_t wakeUnix, unsigned long nowMs, bool forced);
+
+const PowerStats& PowerGetStats();
+uint16_t PowerDutyCyclePermille();
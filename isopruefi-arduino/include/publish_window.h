@@ -0,0 +1,74 @@
+#pragma once
+
+#include "platform.h"
+#include "outage_log.h"
+#include "recovery_stream.h"
+
+// =============================================================================
+// PUBLISH WINDOW LIMITS
+// =============================================================================
+
+/// Largest number of recovery messages that may wait for their ack at once
+static const uint8_t PUBLISH_WINDOW_MAX_SIZE = 8;
+/// Recovery messages in flight unless PublishWindowSetSize() says otherwise
+static const uint8_t PUBLISH_WINDOW_DEFAULT_SIZE = 4;
+/// Slots kept free for live readings, so a full recovery window never delays them
+static const uint8_t PUBLISH_WINDOW_LIVE_RESERVE = 2;
+static const uint8_t PUBLISH_WINDOW_CAPACITY = PUBLISH_WINDOW_MAX_SIZE + PUBLISH_WINDOW_LIVE_RESERVE;
+
+/// What an in-flight message carries, and therefore what happens on ack or timeout
+enum PublishKind : uint8_t {
+  PUBLISH_LIVE = 0,          ///< Live reading; staged for recovery on timeout
+  PUBLISH_RECOVERY_LOG = 1,  ///< Outage log records; consumed in log order on ack
+  PUBLISH_RECOVERY_CSV = 2,  ///< Records of legacy CSV batches; fully covered batches are deleted on ack
+  PUBLISH_RECOVERY_RAM = 3,  ///< Staging ring readings; consumed in ring order on ack
+  PUBLISH_BURST = 4,         ///< Burst samples; dropped on timeout, the interval aggregate has them
+  PUBLISH_LIVE_BATCH = 5     ///< Batch of live readings on the recovery topic; spilled as a whole on timeout
+};
+
+enum PublishEntryState : uint8_t {
+  PUBLISH_FREE = 0,
+  PUBLISH_IN_FLIGHT = 1,
+  PUBLISH_ACKED = 2
+};
+
+/**
+ * @brief One published QoS 1 message that has not been settled yet.
+ *
+ * An ack is matched on the MQTT packet identifier (PUBACK mode) or on the
+ * key (echo mode): the sequence number of a live reading, the timestamp of
+ * a burst, or the first timestamp of a message on the recovery topic
+ * (recovery or live batch).
+ */
+struct PublishEntry {
+  uint8_t kind;                 ///< PublishKind
+  uint8_t state;                ///< PublishEntryState
+  uint8_t attempts;             ///< Number of times the message was published
+  uint32_t key;                 ///< Echo match key
+  uint16_t packetId;            ///< PUBACK match key, 0 in echo mode
+  uint32_t order;               ///< Publish order, settles outage log records in log order
+  unsigned long sentAtMs;       ///< millis() of the last publish
+  OutageRecord record;          ///< Live reading (PUBLISH_LIVE)
+  uint16_t records;             ///< Records covered by the message (recovery kinds, live batch)
+  RecoveryPosition start;       ///< First batch and offset of the message (PUBLISH_RECOVERY_CSV)
+  RecoveryPosition end;         ///< Where the next message starts; batches before it are covered
+};
+
+void PublishWindowReset();
+void PublishWindowSetSize(uint8_t size);
+uint8_t PublishWindowSize();
+
+PublishEntry* PublishWindowAdd(PublishKind kind, uint32_t key, unsigned long nowMs);
+void PublishWindowRelease(PublishEntry* entry);
+void PublishWindowReleaseRecovery();
+
+bool PublishWindowAck(bool recovery, uint32_t key);
+bool PublishWindowAckPacket(uint16_t packetId);
+PublishEntry* PublishWindowOldest(PublishKind kind);
+PublishEntry* PublishWindowNextSettled(PublishKind kind);
+PublishEntry* PublishWindowNextExpired(PublishKind kind, unsigned long nowMs, unsigned long timeoutMs);
+
+uint8_t PublishWindowCount(PublishKind kind);
+uint8_t PublishWindowRecoveryCount();
+bool PublishWindowHasRoom(PublishKind kind);
+uint32_t PublishWindowRecordsBefore(const PublishEntry* entry, PublishKind kind = PUBLISH_RECOVERY_LOG);
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// RECONNECT POLICY DEFAULTS
+// =============================================================================
+
+/// Upper bound of the first retry after a working link was lost
+static const unsigned long RECONNECT_FIRST_RETRY_MS = 500;
+/// Upper bound of the second retry; it doubles with every further failure
+static const unsigned long RECONNECT_BASE_DELAY_MS = 2000;
+/// Largest wait between two attempts
+static const unsigned long RECONNECT_MAX_DELAY_MS = 120000;
+
+/**
+ * @defgroup ReconnectPolicy Reconnect Backoff Policy
+ * @brief Spreads the reconnect attempts of a fleet over time.
+ *
+ * After a broker restart every sensor loses its session at the same moment.
+ * With a fixed retry interval they all come back in lock-step and hit the
+ * broker and the receiver at once, again and again. The policy therefore
+ * waits a random time between 0 and a ceiling ("full jitter"): the ceiling
+ * is firstRetryMs for the first retry, so a short glitch heals quickly, then
+ * baseDelayMs, doubling with every further failure up to maxDelayMs.
+ *
+ * The random sequence is seeded from a device identifier (the MQTT client
+ * ID), so devices draw different waits while each device stays reproducible.
+ * Nothing is read from analog pins or the clock.
+ */
+
+/// Ceilings of the backoff sequence
+struct ReconnectPolicyConfig {
+  unsigned long firstRetryMs;  ///< Ceiling of the first retry after a success
+  unsigned long baseDelayMs;   ///< Ceiling of the second retry
+  unsigned long maxDelayMs;    ///< Cap of the doubling ceiling
+};
+
+class ReconnectPolicy {
+  public:
+    ReconnectPolicy();
+
+    void Configure(const ReconnectPolicyConfig& config);
+    void Seed(const char* deviceId);
+
+    unsigned long NextDelayMs();
+    void RecordSuccess();
+
+    uint32_t ConsecutiveFailures() const { return _consecutiveFailures; }
+    uint32_t TotalFailures() const { return _totalFailures; }
+    uint32_t Successes() const { return _successes; }
+    unsigned long LastDelayMs() const { return _lastDelayMs; }
+    unsigned long CeilingMs() const;
+
+  private:
+    uint32_t NextRandom();
+
+    ReconnectPolicyConfig _config;
+    uint32_t _state;
+    uint32_t _consecutiveFailures;
+    uint32_t _totalFailures;
+    uint32_t _successes;
+    unsigned long _lastDelayMs;
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "platform.h"
+#include "outage_log.h"
+#include "staging_ring.h"
+#include "csv_record.h"
+#include "batch_manifest.h"
+#include "aggregator.h"
+#include "fixed_point.h"
+
+// =============================================================================
+// RECOVERY MESSAGE LIMITS
+// =============================================================================
+
+/// Recovery payload limit unless SetRecoveryMessageLimit() says otherwise
+static const size_t RECOVERY_DEFAULT_MESSAGE_BYTES = 2048;
+/// Smallest payload limit; still fits the fixed part and a few records
+static const size_t RECOVERY_MIN_MESSAGE_BYTES = 128;
+/// Largest payload limit; payloads are streamed, so this only bounds what the broker receives
+static const size_t RECOVERY_MAX_MESSAGE_BYTES = 16384;
+/// Outage log records a source decodes per card read
+static const size_t RECOVERY_SOURCE_CHUNK_RECORDS = 8;
+/// Longest line of a legacy CSV batch
+static const size_t RECOVERY_CSV_LINE_BYTES = 64;
+
+/**
+ * @defgroup RecoveryStream Streaming Recovery Encoder
+ * @brief Writes recovery payloads straight from the card into the MQTT client.
+ *
+ * A recovery message has the same structure the backend always received:
+ *
+ * ```json
+ * {"timestamp":1737024000,"sequence":null,"value":[null],
+ *  "meta":{"t":[1737024000,...],"v":[25.5,...],"s":[42,...]}}
+ * ```
+ *
+ * A message that carries at least one interval aggregate (see aggregator.h)
+ * adds its statistics after "s": "mn", "mx" and "n" (plus "l" for the last
+ * sample when AggregateReportsLast()); "v" holds the means. Single readings
+ * in such a message appear with their value as min and max and a count of 1.
+ *
+ * Instead of building a JsonDocument and a payload buffer, the encoder walks
+ * a RecoveryRecordSource twice: RecoveryMeasure() works out how many records
+ * fit into a message and its exact length, so the client can be told the
+ * length up front and stream the payload to the socket; RecoveryStreamMessage()
+ * then prints the "t", "v" and "s" arrays, rewinding the source for each one.
+ * Only one record and a small print buffer are ever held in RAM.
+ */
+
+/**
+ * @brief One reading on its way into a recovery message.
+ *
+ * The temperature keeps the fixed-point unit of its source, so it is printed
+ * exactly instead of going through a float.
+ */
+struct RecoveryRecord {
+  uint32_t timestamp;  ///< Unix timestamp of the measurement
+  int32_t  sequence;   ///< Sequence number of the measurement
+  int32_t  value;      ///< Temperature in 1/scale °C, the mean of an aggregate
+  uint16_t scale;      ///< 128 for ADT7410 counts, 1000 for CSV milli-degrees
+  int32_t  min;        ///< Lowest sample, value for a single reading
+  int32_t  max;        ///< Highest sample, value for a single reading
+  int32_t  last;       ///< Last sample, value for a single reading
+  uint16_t count;      ///< Samples behind the record, 1 for a single reading
+};
+
+/**
+ * @brief A place in the backlog where a recovery message starts or ends.
+ */
+struct RecoveryPosition {
+  uint16_t batch;   ///< Manifest index for sources spanning several batches, otherwise 0
+  uint32_t offset;  ///< Record index (outage log) or byte offset (CSV batch) inside it
+};
+
+/**
+ * @brief Sequential reader of the records that make up recovery messages.
+ */
+class RecoveryRecordSource {
+  public:
+    virtual ~RecoveryRecordSource() {}
+    /// Starts over at the first record of the message
+    virtual bool Rewind() = 0;
+    /// Reads the next record, false at the end of the source
+    virtual bool Next(RecoveryRecord& record) = 0;
+    /// Start of the record last returned by Next(), or the end of the source once Next() failed
+    virtual RecoveryPosition Position() const = 0;
+};
+
+/// Copies stored records without consuming them, like OutageLogPeek() and StagingRingPeek()
+typedef size_t (*OutageRecordPeek)(OutageRecord* records, size_t maxRecords, size_t skip);
+
+/**
+ * @brief Reads outage log records starting at a log offset.
+ *
+ * Reads the staging ring instead when given StagingRingPeek(); both store
+ * the same records in the same order.
+ */
+class OutageLogRecordSource : public RecoveryRecordSource {
+  public:
+    OutageLogRecordSource(size_t skip, size_t maxRecords, OutageRecordPeek peek = OutageLogPeek);
+    bool Rewind() override;
+    bool Next(RecoveryRecord& record) override;
+    RecoveryPosition Position() const override;
+
+  private:
+    OutageRecordPeek _peek;
+    size_t _skip;
+    size_t _maxRecords;
+    size_t _position;  ///< Records returned since the last Rewind()
+    bool _ended;
+    size_t _chunkStart;
+    size_t _chunkCount;
+    OutageRecord _chunk[RECOVERY_SOURCE_CHUNK_RECORDS];
+};
+
+/**
+ * @brief Reads the records of a legacy CSV batch starting at a byte offset.
+ *
+ * Malformed lines are skipped and counted once, however often the source is
+ * rewound.
+ */
+class CsvBatchRecordSource : public RecoveryRecordSource {
+  public:
+    CsvBatchRecordSource();
+    CsvBatchRecordSource(const char* path, uint32_t offset, size_t maxRecords);
+    ~CsvBatchRecordSource();
+    bool Open(const char* path, uint32_t offset, size_t maxRecords);
+    void Close();
+    bool IsOpen() const { return _open; }
+    bool Rewind() override;
+    bool Next(RecoveryRecord& record) override;
+    RecoveryPosition Position() const override;
+    /// Malformed, non-empty lines seen so far
+    uint16_t RejectedLines() const { return _rejected; }
+
+  private:
+    File _file;
+    bool _open;
+    uint32_t _offset;
+    size_t _maxRecords;
+    size_t _returned;
+    uint32_t _position;
+    uint32_t _scanned;  ///< Furthest byte already checked for malformed lines
+    uint16_t _rejected;
+};
+
+/**
+ * @brief Reads the records of consecutive pending CSV batches as one stream.
+ *
+ * Starts at a manifest index and byte offset and moves on to the next pending
+ * batch whenever a file is exhausted, so one message can carry several small
+ * batches. Batches that are sent or skipped are passed over; the source ends
+ * at a batch whose first record is older than oldestTimestamp or whose file
+ * cannot be opened, which recovery then handles on its own.
+ */
+class CsvManifestRecordSource : public RecoveryRecordSource {
+  public:
+    CsvManifestRecordSource(RecoveryPosition start, uint32_t oldestTimestamp, size_t maxRecords);
+    bool Rewind() override;
+    bool Next(RecoveryRecord& record) override;
+    RecoveryPosition Position() const override { return _position; }
+
+  private:
+    bool OpenCurrentBatch();
+
+    RecoveryPosition _start;
+    uint32_t _oldestTimestamp;
+    size_t _maxRecords;
+    size_t _returned;
+    uint16_t _batch;
+    RecoveryPosition _position;
+    CsvBatchRecordSource _reader;
+};
+
+/// Result of RecoveryMeasure()
+struct RecoveryMessageInfo {
+  size_t   records;         ///< Records that fit into the message
+  size_t   bytes;           ///< Exact payload length
+  uint32_t firstTimestamp;  ///< Timestamp of the first record, the echo match key
+  RecoveryPosition end;     ///< Where the next message starts
+  bool     complete;        ///< The message reaches the end of the source
+  bool     aggregated;      ///< The message carries the statistics columns
+};
+
+bool RecoveryMeasure(RecoveryRecordSource& source, uint32_t timestamp, size_t maxBytes, RecoveryMessageInfo& info);
+bool RecoveryStreamMessage(MqttClient& client, RecoveryRecordSource& source, uint32_t timestamp,
+                           const RecoveryMessageInfo& info);
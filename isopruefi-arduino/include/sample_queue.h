@@ -0,0 +1,60 @@
+#pragma once
+
+#include "platform.h"
+#include <atomic>
+
+// =============================================================================
+// SAMPLE QUEUE LIMITS
+// =============================================================================
+
+/// Samples the queue holds: 16 s of one-per-second burst sampling; a power of two
+static const uint32_t SAMPLE_QUEUE_CAPACITY = 16;
+
+/// SampleRecord::flags
+static const uint8_t SAMPLE_FLAG_FAILED = 0x01;   ///< The sensor did not answer, raw is not valid
+static const uint8_t SAMPLE_FLAG_REPORT = 0x02;   ///< Taken at this device's reporting point of the minute
+
+/// One sample as the sampling interrupt hands it to the loop
+struct SampleRecord {
+  uint32_t time;   ///< RTC second of the grid point the conversion started at
+  int16_t raw;     ///< Temperature in ADT7410 counts (1/128 °C)
+  uint8_t flags;   ///< SAMPLE_FLAG_* bits
+};
+
+/**
+ * @defgroup SampleQueue Lock-Free Sample Queue
+ * @brief Hands sample records from an interrupt to the main loop.
+ *
+ * A fixed-size single-producer/single-consumer ring: exactly one context
+ * pushes (the sampling interrupt, see sampler.h) and exactly one pops (the
+ * sample task). Each side writes only its own index, so no lock is taken
+ * and interrupts are never disabled. The indices run free and are reduced
+ * modulo the capacity on access; as the capacity is a power of two, the
+ * difference of the two stays right across their wrap.
+ *
+ * The producer stores a record before it publishes the new head with
+ * release order; the consumer reads the head with acquire order before it
+ * copies the record, and the tail the same way round. Only loads and
+ * stores of aligned 32-bit words are used, which the Cortex-M0+ does
+ * atomically without exclusive-access instructions it lacks.
+ *
+ * A push into a full queue drops the new record and counts it: the
+ * interrupt cannot wait for the loop.
+ */
+class SampleQueue {
+  public:
+    SampleQueue();
+
+    bool Push(const SampleRecord& record);
+    bool Pop(SampleRecord& record);
+    void Reset();
+
+    uint32_t Count() const;
+    uint32_t Dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+  private:
+    SampleRecord _records[SAMPLE_QUEUE_CAPACITY];
+    std::atomic<uint32_t> _head;      ///< Pushes so far; written by the producer only
+    std::atomic<uint32_t> _tail;      ///< Pops so far; written by the consumer only
+    std::atomic<uint32_t> _dropped;   ///< Pushes into a full queue; written by the producer only
+};
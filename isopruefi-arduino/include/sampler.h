@@ -0,0 +1,41 @@
+#pragma once
+
+#include "platform.h"
+#include "sample_queue.h"
+
+/**
+ * @defgroup Sampler Interrupt-Driven Sampling
+ * @brief Takes the samples of the grid in the DS3231 SQW interrupt.
+ *
+ * In the loop, a blocking broker connect or a long SD write delays the
+ * sample task and with it the sample. Here the 1 Hz SQW edge drives the
+ * sampling instead: SamplerOnSecond(), called from that interrupt, counts
+ * the RTC seconds itself and, at every point of the sample grid, starts a
+ * one-shot conversion of the ADT7410. The edge one second later reads the
+ * result, which has long been ready, and pushes it as a SampleRecord into
+ * the sample queue (see sample_queue.h). Each edge costs at most one short
+ * I2C write and one two-byte read, and no interrupts are disabled.
+ *
+ * The loop takes the records with SamplerTake() whenever it gets to it;
+ * their timestamps are those of the grid points, however late that is.
+ * The queue holds SAMPLE_QUEUE_CAPACITY records, far more than the longest
+ * blocking call of the loop lasts even at a one-second period.
+ *
+ * The grid is the same as in the loop: every period seconds from this
+ * device's phase of the minute, and always at the phase. The loop sets the
+ * period (it changes with burst sampling) with SamplerSetPeriod().
+ *
+ * The interrupt owns the I2C bus while the sampler runs, so the loop must
+ * not read the RTC or the sensor meanwhile. Oversampling does not apply:
+ * one conversion per second is all the edges leave room for.
+ */
+
+void SamplerBegin(uint32_t unixtime, uint8_t phaseSeconds, uint8_t periodSeconds);
+void SamplerStop();
+bool SamplerRunning();
+void SamplerSetPeriod(uint8_t seconds);
+void SamplerOnSecond();
+
+bool SamplerTake(SampleRecord& record);
+const SampleQueue& SamplerQueue();
+void SamplerReset();
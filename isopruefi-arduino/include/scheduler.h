@@ -0,0 +1,73 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// SCHEDULER LIMITS
+// =============================================================================
+
+/// Largest number of tasks one scheduler runs
+static const uint8_t SCHEDULER_MAX_TASKS = 8;
+/// Returned by Scheduler::AddTask() when no slot is left
+static const uint8_t SCHEDULER_NO_TASK = 0xFF;
+
+/**
+ * @defgroup Scheduler Cooperative Task Scheduler
+ * @brief Runs periodic tasks from millis()-based deadlines instead of delay() pacing.
+ *
+ * Every task has a period and a time budget. Run() calls each task whose
+ * deadline has passed, in the order the tasks were added, and returns right
+ * away; nothing in the scheduler ever waits. Deadlines advance by whole
+ * periods from the previous deadline, so a task keeps its phase even when
+ * an earlier one ran late. A task that falls behind by more than a period
+ * skips the missed runs instead of running them back to back.
+ *
+ * Tasks are cooperative: a task that needs longer than its budget is not
+ * interrupted, only counted in Overruns(), so budgets document and check
+ * what each task may take out of a pass.
+ */
+
+/// Task body; nowMs is the millis() value the scheduler started the task at
+typedef void (*SchedulerCallback)(unsigned long nowMs);
+
+/// One periodic task
+struct SchedulerTask {
+  const char* name;           ///< For diagnostics
+  SchedulerCallback callback;
+  unsigned long periodMs;     ///< 0 runs the task on every pass
+  unsigned long budgetMs;     ///< Longest run that is not counted as an overrun
+  unsigned long nextRunMs;    ///< Deadline of the next run
+  unsigned long lastRunMs;    ///< Duration of the last run
+  uint32_t runs;
+  uint32_t overruns;
+  bool enabled;
+};
+
+class Scheduler {
+  public:
+    Scheduler();
+
+    uint8_t AddTask(const char* name, SchedulerCallback callback, unsigned long periodMs,
+                    unsigned long budgetMs, unsigned long firstRunMs);
+    void SetEnabled(uint8_t task, bool enabled);
+    void SetPeriod(uint8_t task, unsigned long periodMs);
+    void RunAt(uint8_t task, unsigned long atMs);
+
+    uint8_t Run();
+    unsigned long MsUntilNextRun(unsigned long nowMs) const;
+    const SchedulerTask* Task(uint8_t task) const;
+    uint8_t TaskCount() const { return _count; }
+
+  private:
+    SchedulerTask _tasks[SCHEDULER_MAX_TASKS];
+    uint8_t _count;
+};
+
+/**
+ * @brief Spreads devices that share a period over its slots.
+ *
+ * Devices that all run a task at the same point of a shared period (every
+ * RTC minute, say) load the server in bursts. The phase hashes a device
+ * identifier to one of the slots, the same one on every boot.
+ */
+uint16_t SchedulerPhaseFromId(const char* deviceId, uint16_t slots);
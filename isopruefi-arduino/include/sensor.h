@@ -2,5 +2,66 @@
 
 #include "platform.h"
 
+/// ADT7410 resolution in 16-bit mode: counts per degree Celsius
+static const int16_t TEMP_RAW_COUNTS_PER_DEGREE = 128;
+
+// =============================================================================
+// ADT7410 CONVERSION TIMING
+// =============================================================================
+
+/// One-shot conversion time from the datasheet; the first ready check waits this long
+static const unsigned long SENSOR_CONVERSION_MS = 240;
+/// A conversion that is not ready after this long counts as a failed read
+static const unsigned long SENSOR_CONVERSION_TIMEOUT_MS = 500;
+/// Time between two ready checks once the conversion time has passed
+static const unsigned long SENSOR_POLL_INTERVAL_MS = 10;
+/// Largest number of conversions averaged into one reading
+static const uint8_t SENSOR_MAX_OVERSAMPLING = 16;
+
+/**
+ * @defgroup SensorDriver Asynchronous ADT7410 Driver
+ * @brief One-shot conversions that run while the firmware does other work.
+ *
+ * The sensor sits in shutdown between samples. SensorStartConversion()
+ * writes one-shot mode to the configuration register and returns; the
+ * ADT7410 converts for about SENSOR_CONVERSION_MS and drops back to
+ * shutdown. SensorPoll() checks the ready bit of the status register (no
+ * I2C traffic before the conversion time has passed) and reports
+ * SENSOR_READY once SensorFetch() can hand out the reading.
+ *
+ * With oversampling (SensorSetOversampling()) a reading is the rounded mean
+ * of several conversions in a row; SensorPoll() starts the next one as soon
+ * as the previous is read.
+ */
+
+enum SensorStatus : uint8_t {
+  SENSOR_IDLE = 0,        ///< No reading requested, the sensor is in shutdown
+  SENSOR_CONVERTING = 1,  ///< A conversion is running
+  SENSOR_READY = 2,       ///< The reading can be fetched
+  SENSOR_FAILED = 3       ///< The sensor did not answer or never got ready
+};
+
 bool InitSensor(Adafruit_ADT7410& sensor);
-float ReadTemperatureInCelsius();
\ No newline at end of file
+bool SensorStartConversion(unsigned long nowMs);
+SensorStatus SensorPoll(unsigned long nowMs);
+bool SensorFetch(int16_t& raw);
+unsigned long SensorMsUntilReady(unsigned long nowMs);
+void SensorSetOversampling(uint8_t conversions);
+uint8_t SensorOversampling();
+void SensorReset();
+
+bool SensorTriggerOneShot();
+bool ReadTemperatureRaw(int16_t& raw);
+float ReadTemperatureInCelsius();
+
+// --- Inline helper functions ---
+inline int16_t CelsiusToRawTemp(float celsius) {
+    float scaled = celsius * TEMP_RAW_COUNTS_PER_DEGREE;
+    if (scaled >= 32767.0f) return 32767;
+    if (scaled <= -32768.0f) return -32768;
+    return (int16_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+inline float RawTempToCelsius(int16_t raw) {
+    return (float)raw / TEMP_RAW_COUNTS_PER_DEGREE;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "platform.h"
+#include "outage_log.h"
+
+// =============================================================================
+// STAGING RING LIMITS
+// =============================================================================
+
+/// Readings the ring can hold (half an hour of one-per-minute sampling)
+static const uint8_t STAGING_RING_CAPACITY = 32;
+/// Fill level above which the oldest readings are moved to the outage log
+static const uint8_t STAGING_RING_HIGH_WATER = 24;
+
+/**
+ * @defgroup StagingRing RAM Staging Ring
+ * @brief Keeps readings of short outages in RAM instead of writing them to the card.
+ *
+ * Most outages last a few seconds to a few minutes (broker restart, WiFi
+ * roaming). Readings taken meanwhile are pushed into this fixed-size ring and
+ * recovery publishes them straight from RAM after the reconnect, so a short
+ * outage never touches the SD card.
+ *
+ * Readings are spilled to the outage log (see outage_log.h), oldest first,
+ * when the ring fills past STAGING_RING_HIGH_WATER or when the oldest one has
+ * waited longer than the age given to StagingRingTick(). Readings that are in
+ * flight as part of a recovery message are held and never spilled, so their
+ * ack always consumes the right records; while any are held, a push into a
+ * full ring goes to the outage log directly.
+ */
+
+void StagingRingReset();
+bool StagingRingPush(const OutageRecord& record, unsigned long nowMs);
+void StagingRingTick(unsigned long nowMs, unsigned long maxAgeMs);
+bool StagingRingFlush();
+
+size_t StagingRingPeek(OutageRecord* records, size_t maxRecords, size_t skip = 0);
+void StagingRingConsume(size_t count);
+void StagingRingHold(size_t count);
+
+size_t StagingRingCount();
+uint32_t StagingRingSpilledCount();
@@ -1,13 +1,22 @@
 #pragma once
 
 #include "platform.h"
+#include "outage_log.h"
+#include "staging_ring.h"
+#include "batch_manifest.h"
+#include "aggregator.h"
+#include "burst_sampler.h"
 #include <cstdio> 
 
-void SaveTempToBatchCsv(const DateTime& now, float celsius, int sequence);
+bool SaveTempToOutageLog(const DateTime& now, float celsius, int sequence);
+bool StageTempReading(const DateTime& now, float celsius, int sequence);
+bool StageRecord(const OutageRecord& record);
+OutageRecord MakeAggregateRecord(const DateTime& now, const SampleAggregate& aggregate, int sequence);
 void DeleteCsvFile(const char* filepath);
 
 void BuildJson(JsonDocument& doc, float celsius, const DateTime& now, int sequence);
-void BuildRecoveryJsonFromBatchCsv(JsonDocument& doc, const char* filepath, const DateTime& now);
+void BuildJson(JsonDocument& doc, const OutageRecord& record);
+void BuildJson(JsonDocument& doc, const BurstMessage& burst);
 
 // --- Inline helper functions ---
 inline const char* CreateFolderName(const DateTime& now) {
@@ -15,9 +24,3 @@ inline const char* CreateFolderName(const DateTime& now) {
     std::snprintf(folderName, sizeof(folderName), "%04d", now.year());
     return folderName;
 }
-
-inline void CreateCsvFilename(char* buffer, size_t bufferSize, const DateTime& now) {
-    std::snprintf(buffer, bufferSize, "%s/%02d%02d%02d%02d.csv",
-                  CreateFolderName(now),
-                  now.month(), now.day(), now.hour(), now.minute());
-}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "platform.h"
+
+// =============================================================================
+// TIME SERVICE CONFIGURATION
+// =============================================================================
+
+/// Time between two RTC reads unless TimeServiceSetResyncInterval() says otherwise
+static const unsigned long TIME_DEFAULT_RESYNC_INTERVAL_MS = 3600000UL;
+static const unsigned long TIME_MS_PER_SECOND = 1000;
+
+/**
+ * @defgroup TimeService Cached RTC Time
+ * @brief Reads the DS3231 once and extends its time with millis().
+ *
+ * Every rtc.now() is a multi-byte I2C transaction. The sample, publish and
+ * recovery tasks and the SdFat timestamp callback all need the time, so
+ * they ask this service instead: it keeps the RTC seconds together with the
+ * millis() value at which that second began and counts on from there. The
+ * RTC is read again when the resync interval has passed, or at once after
+ * TimeServiceRequestResync().
+ *
+ * When the DS3231's 1 Hz SQW output drives an interrupt, call
+ * TimeServiceOnSqwEdge() from it. Each falling edge marks the start of an
+ * RTC second, which pins the sub-second phase to the RTC without any I2C
+ * traffic and cancels millis() drift; a resync that falls due is then taken
+ * right at an edge. Without SQW the phase of a resync is unknown and the
+ * cached time may lag the RTC by up to a second until the next one.
+ */
+
+/// Time with sub-second resolution
+struct PreciseTime {
+  uint32_t unixtime;   ///< Seconds since 1970-01-01
+  uint16_t millis;     ///< Milliseconds into the second (0..999)
+};
+
+void TimeServiceReset();
+void TimeServiceSetResyncInterval(unsigned long intervalMs);
+void TimeServiceRequestResync();
+void TimeServiceOnSqwEdge();
+void TimeServiceAnchor(uint32_t unixtime, unsigned long secondStartMs);
+
+PreciseTime TimeNowPrecise(unsigned long nowMs);
+DateTime TimeNow(unsigned long nowMs);
+DateTime TimeNow();
+
+uint32_t TimeServiceRtcReads();
@@ -0,0 +1,52 @@
+#include "aggregator.h"
+
+static bool s_reportLast = false;
+
+void AggregateReset(SampleAggregate& aggregate) {
+  aggregate.sum = 0;
+  aggregate.min = 0;
+  aggregate.max = 0;
+  aggregate.last = 0;
+  aggregate.count = 0;
+}
+
+/**
+ * @brief Adds one sample to the aggregate.
+ *
+ * Samples beyond 65535 are ignored, which no interval of at most one minute
+ * sampled at most once a second can reach.
+ *
+ * @param aggregate Aggregate of the current interval
+ * @param raw Sample in ADT7410 counts
+ */
+void AggregateAdd(SampleAggregate& aggregate, int16_t raw) {
+  if (aggregate.count == 0xFFFF) return;
+
+  if (aggregate.count == 0 || raw < aggregate.min) aggregate.min = raw;
+  if (aggregate.count == 0 || raw > aggregate.max) aggregate.max = raw;
+  aggregate.sum += raw;
+  aggregate.last = raw;
+  aggregate.count++;
+}
+
+/**
+ * @brief Returns the mean of the samples, rounded half away from zero; 0 without samples.
+ */
+int16_t AggregateMean(const SampleAggregate& aggregate) {
+  if (aggregate.count == 0) return 0;
+
+  const int32_t half = aggregate.count / 2;
+  const int32_t sum = aggregate.sum;
+  return (int16_t)(sum >= 0 ? (sum + half) / aggregate.count : (sum - half) / aggregate.count);
+}
+
+/**
+ * @brief Appends the last sample of an interval to published aggregates (off by default).
+ */
+void AggregateSetReportLast(bool reportLast) {
+  s_reportLast = reportLast;
+}
+
+bool AggregateReportsLast() {
+  return s_reportLast;
+}
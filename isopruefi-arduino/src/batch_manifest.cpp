@@ -0,0 +1,347 @@
+#include "batch_manifest.h"
+#include "log_format.h"
+#include "csv_record.h"
+#include "logger.h"
+
+// =============================================================================
+// MANIFEST FORMAT CONSTANTS
+// =============================================================================
+
+/// Manifest header magic ("ISOB" little-endian)
+static const uint32_t MANIFEST_MAGIC = 0x424F5349;
+static const uint16_t MANIFEST_FORMAT_VERSION = 1;
+static const uint32_t MANIFEST_HEADER_BYTES = 16;
+/// Number of entry bytes covered by the CRC (the CRC itself is the last 4 bytes)
+static const size_t ENTRY_PAYLOAD_BYTES = BATCH_ENTRY_BYTES - 4;
+static const size_t MAX_YEAR_FOLDERS = 16;
+static const size_t NAME_BUFFER_SIZE = 16;
+static const size_t LINE_BUFFER_SIZE = 64;
+
+// =============================================================================
+// MANIFEST STATE
+// =============================================================================
+
+static bool s_loaded = false;
+/// Manifest file, kept open so recovery never reopens it per batch
+static File s_file;
+static uint16_t s_count = 0;
+/// Entries before this index are all sent or skipped
+static uint16_t s_firstPending = 0;
+
+// =============================================================================
+// ENCODING HELPERS
+// =============================================================================
+
+static void EncodeEntry(uint8_t* out, const BatchEntry& entry) {
+  memset(out, 0, BATCH_ENTRY_BYTES);
+  strncpy((char*)out, entry.path, BATCH_PATH_BYTES - 1);
+  PutU32(out + 24, entry.firstTimestamp);
+  PutU32(out + 28, entry.lastTimestamp);
+  PutU16(out + 32, entry.records);
+  out[34] = entry.state;
+  PutU32(out + ENTRY_PAYLOAD_BYTES, Crc32(0, out, ENTRY_PAYLOAD_BYTES));
+}
+
+static bool DecodeEntry(const uint8_t* in, BatchEntry& entry) {
+  if (GetU32(in + ENTRY_PAYLOAD_BYTES) != Crc32(0, in, ENTRY_PAYLOAD_BYTES)) return false;
+  memcpy(entry.path, in, BATCH_PATH_BYTES);
+  entry.path[BATCH_PATH_BYTES - 1] = '\0';
+  entry.firstTimestamp = GetU32(in + 24);
+  entry.lastTimestamp = GetU32(in + 28);
+  entry.records = GetU16(in + 32);
+  entry.state = in[34];
+  return true;
+}
+
+static uint32_t EntryOffset(uint16_t index) {
+  return MANIFEST_HEADER_BYTES + (uint32_t)index * BATCH_ENTRY_BYTES;
+}
+
+static bool WriteHeader() {
+  uint8_t header[MANIFEST_HEADER_BYTES];
+  PutU32(header, MANIFEST_MAGIC);
+  PutU16(header + 4, MANIFEST_FORMAT_VERSION);
+  PutU16(header + 6, BATCH_ENTRY_BYTES);
+  PutU16(header + 8, s_count);
+  PutU16(header + 10, s_firstPending);
+  PutU32(header + 12, Crc32(0, header, 12));
+
+  s_file.seekSet(0);
+  return s_file.write(header, sizeof(header)) == sizeof(header) && s_file.sync();
+}
+
+static bool ReadHeader() {
+  uint8_t header[MANIFEST_HEADER_BYTES];
+  s_file.seekSet(0);
+  if (s_file.read(header, sizeof(header)) != (int)sizeof(header)) return false;
+  if (GetU32(header) != MANIFEST_MAGIC || GetU16(header + 4) != MANIFEST_FORMAT_VERSION) return false;
+  if (GetU16(header + 6) != BATCH_ENTRY_BYTES) return false;
+  if (GetU32(header + 12) != Crc32(0, header, 12)) return false;
+
+  s_count = GetU16(header + 8);
+  s_firstPending = GetU16(header + 10);
+  if (s_firstPending > s_count) s_firstPending = s_count;
+  return true;
+}
+
+static bool WriteEntry(uint16_t index, const BatchEntry& entry) {
+  uint8_t encoded[BATCH_ENTRY_BYTES];
+  EncodeEntry(encoded, entry);
+  s_file.seekSet(EntryOffset(index));
+  return s_file.write(encoded, sizeof(encoded)) == sizeof(encoded);
+}
+
+static bool ReadEntry(uint16_t index, BatchEntry& entry) {
+  uint8_t encoded[BATCH_ENTRY_BYTES];
+  s_file.seekSet(EntryOffset(index));
+  if (s_file.read(encoded, sizeof(encoded)) != (int)sizeof(encoded)) return false;
+  return DecodeEntry(encoded, entry);
+}
+
+/**
+ * @brief Moves the first-pending index past entries that are sent or skipped.
+ */
+static void AdvanceFirstPending() {
+  BatchEntry entry;
+  while (s_firstPending < s_count && ReadEntry(s_firstPending, entry) && entry.state != BATCH_PENDING) {
+    s_firstPending++;
+  }
+}
+
+// =============================================================================
+// MANIFEST CONSTRUCTION
+// =============================================================================
+
+static bool IsYearFolderName(const char* name) {
+  if (strlen(name) != 4) return false;
+  for (int i = 0; i < 4; i++) {
+    if (name[i] < '0' || name[i] > '9') return false;
+  }
+  return true;
+}
+
+static bool IsCsvFileName(const char* name) {
+  size_t len = strlen(name);
+  return len > 4 && strcmp(name + len - 4, ".csv") == 0;
+}
+
+/**
+ * @brief Reads a batch file once and fills in its timestamps and record count.
+ *
+ * Uses the same parser as recovery, so the count matches what will be sent.
+ */
+static void ScanBatchFile(BatchEntry& entry) {
+  entry.firstTimestamp = 0;
+  entry.lastTimestamp = 0;
+  entry.records = 0;
+
+  File file = sd.open(entry.path, FILE_READ);
+  if (file) {
+    char line[LINE_BUFFER_SIZE];
+    while (file.available()) {
+      size_t len = file.fgets(line, sizeof(line));
+      CsvRecord record;
+      if (len == 0 || ParseCsvRecord(line, len, record) != CSV_OK) continue;
+
+      if (entry.records == 0) entry.firstTimestamp = record.timestamp;
+      entry.lastTimestamp = record.timestamp;
+      entry.records++;
+    }
+    file.close();
+  }
+  entry.state = entry.records == 0 ? BATCH_SKIPPED : BATCH_PENDING;
+}
+
+/**
+ * @brief Collects the year folders in the card root, oldest first.
+ * @return Number of folders written to years
+ */
+static size_t FindYearFolders(uint16_t* years, size_t maxYears) {
+  size_t found = 0;
+  File root = sd.open("/");
+  if (!root) return 0;
+
+  File entry;
+  while ((entry = root.openNextFile())) {
+    char name[NAME_BUFFER_SIZE];
+    entry.getName(name, sizeof(name));
+    bool isFolder = entry.isDirectory();
+    entry.close();
+    if (!isFolder || !IsYearFolderName(name) || found >= maxYears) continue;
+
+    // Insertion sort keeps the list ordered by year
+    uint16_t year = (uint16_t)atoi(name);
+    size_t pos = found++;
+    while (pos > 0 && years[pos - 1] > year) {
+      years[pos] = years[pos - 1];
+      pos--;
+    }
+    years[pos] = year;
+  }
+  root.close();
+  return found;
+}
+
+/**
+ * @brief Walks every year folder once and writes an entry per CSV batch.
+ *
+ * The header is written last, so a build interrupted by a power loss leaves
+ * an invalid manifest that is rebuilt on the next mount.
+ */
+static bool BuildManifest() {
+  LOG_INFO("Building batch manifest...");
+
+  uint8_t placeholder[MANIFEST_HEADER_BYTES] = {0};
+  s_file.seekSet(0);
+  s_file.write(placeholder, sizeof(placeholder));
+  s_count = 0;
+  s_firstPending = 0;
+
+  uint16_t years[MAX_YEAR_FOLDERS];
+  size_t yearCount = FindYearFolders(years, MAX_YEAR_FOLDERS);
+
+  for (size_t y = 0; y < yearCount && s_count < BATCH_MANIFEST_MAX_ENTRIES; y++) {
+    char folder[NAME_BUFFER_SIZE];
+    snprintf(folder, sizeof(folder), "%04u", (unsigned)years[y]);
+    File dir = sd.open(folder);
+    if (!dir) continue;
+
+    File file;
+    while (s_count < BATCH_MANIFEST_MAX_ENTRIES && (file = dir.openNextFile())) {
+      char name[NAME_BUFFER_SIZE];
+      file.getName(name, sizeof(name));
+      bool isFolder = file.isDirectory();
+      file.close();
+      if (isFolder || !IsCsvFileName(name)) continue;
+
+      BatchEntry entry;
+      if (snprintf(entry.path, sizeof(entry.path), "%s/%s", folder, name) >= (int)sizeof(entry.path)) continue;
+      ScanBatchFile(entry);
+      if (!WriteEntry(s_count, entry)) break;
+      s_count++;
+    }
+    dir.close();
+  }
+
+  AdvanceFirstPending();
+  return WriteHeader();
+}
+
+static bool EnsureLoaded() {
+  return s_loaded || BatchManifestBegin();
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+/**
+ * @brief Loads the batch manifest, building it on first use.
+ *
+ * Building walks every year folder (not only the current one) and opens each
+ * CSV batch once; afterwards recovery works from the manifest alone and the
+ * card is never rescanned.
+ *
+ * @return true if the manifest is ready
+ */
+bool BatchManifestBegin() {
+  if (s_loaded) return true;
+
+  if (!sd.exists(OUTAGE_LOG_DIR)) {
+    sd.mkdir(OUTAGE_LOG_DIR);
+  }
+
+  if (sd.exists(BATCH_MANIFEST_PATH)) {
+    s_file = sd.open(BATCH_MANIFEST_PATH, FILE_WRITE);
+    if (s_file && ReadHeader()) {
+      s_loaded = true;
+      return true;
+    }
+    if (s_file) s_file.close();
+    sd.remove(BATCH_MANIFEST_PATH);
+  }
+
+  s_file = sd.open(BATCH_MANIFEST_PATH, FILE_WRITE);
+  if (!s_file) {
+    LOG_ERROR("Failed to open batch manifest.");
+    return false;
+  }
+  if (!BuildManifest()) {
+    LOG_ERROR("Failed to write batch manifest.");
+    s_file.close();
+    return false;
+  }
+  s_loaded = true;
+  return true;
+}
+
+/**
+ * @brief Closes the manifest; the next manifest call loads it again.
+ */
+void BatchManifestEnd() {
+  if (s_file) s_file.close();
+  s_loaded = false;
+}
+
+/**
+ * @brief Returns the number of indexed batches (sent and skipped ones included).
+ */
+uint16_t BatchManifestCount() {
+  return EnsureLoaded() ? s_count : 0;
+}
+
+/**
+ * @brief Returns the index of the first batch that may still be pending.
+ *
+ * Recovery starts here, so its cost grows with the pending batches only.
+ */
+uint16_t BatchManifestFirstPending() {
+  return EnsureLoaded() ? s_firstPending : 0;
+}
+
+/**
+ * @brief Reads one manifest entry.
+ *
+ * @param index Entry index, below BatchManifestCount()
+ * @param[out] entry Decoded entry
+ * @return false if the index is out of range or the entry is corrupt
+ */
+bool BatchManifestRead(uint16_t index, BatchEntry& entry) {
+  if (!EnsureLoaded() || index >= s_count) return false;
+  return ReadEntry(index, entry);
+}
+
+/**
+ * @brief Updates the delivery state of a batch and persists it.
+ *
+ * @param index Entry index
+ * @param state New BatchState
+ * @return true if the entry and header reached the card
+ */
+bool BatchManifestSetState(uint16_t index, uint8_t state) {
+  BatchEntry entry;
+  if (!BatchManifestRead(index, entry)) return false;
+
+  entry.state = state;
+  if (!WriteEntry(index, entry)) return false;
+  if (index == s_firstPending) AdvanceFirstPending();
+  return WriteHeader();
+}
+
+/**
+ * @brief Marks the pending batch with the given path as sent.
+ *
+ * @param path Path of the deleted batch file
+ * @return true if a pending entry was found and updated
+ */
+bool BatchManifestMarkSent(const char* path) {
+  if (!EnsureLoaded()) return false;
+
+  BatchEntry entry;
+  for (uint16_t i = s_firstPending; i < s_count; i++) {
+    if (ReadEntry(i, entry) && entry.state == BATCH_PENDING && strcmp(entry.path, path) == 0) {
+      return BatchManifestSetState(i, BATCH_SENT);
+    }
+  }
+  return false;
+}
@@ -0,0 +1,143 @@
+#include "burst_sampler.h"
+
+static const uint8_t SECONDS_PER_MINUTE = 60;
+
+BurstSampler::BurstSampler() : _enabled(false) {
+  _config.rateThreshold = BURST_DEFAULT_RATE_THRESHOLD;
+  _config.periodSeconds = BURST_DEFAULT_PERIOD_SECONDS;
+  _config.holdSeconds = BURST_DEFAULT_HOLD_SECONDS;
+  Reset();
+}
+
+/**
+ * @brief Sets the sampler up; a disabled sampler never starts a burst.
+ */
+void BurstSampler::Configure(bool enabled, const BurstConfig& config) {
+  _enabled = enabled;
+  _config = config;
+  if (_config.periodSeconds < 1) _config.periodSeconds = 1;
+  Reset();
+}
+
+/**
+ * @brief Ends a running burst and forgets the detector window and messages.
+ */
+void BurstSampler::Reset() {
+  _windowCount = 0;
+  _windowHead = 0;
+  _active = false;
+  _period = 0;
+  _holdUntil = 0;
+  _decaySamples = 0;
+  _bursts = 0;
+  _building.count = 0;
+  _haveReady = false;
+}
+
+/**
+ * @brief Feeds one sample to the change detector and the current burst.
+ *
+ * @param timestamp RTC time of the sample
+ * @param raw Sample in ADT7410 counts
+ * @param basePeriodSeconds Sample period outside bursts; a burst needs a shorter one
+ */
+void BurstSampler::Add(uint32_t timestamp, int16_t raw, uint8_t basePeriodSeconds) {
+  const bool wasActive = _active;
+  const bool change = DetectChange(timestamp, raw);
+
+  if (change && _enabled && _config.periodSeconds < basePeriodSeconds) {
+    if (!_active) _bursts++;
+    _active = true;
+    _period = _config.periodSeconds;
+    _holdUntil = timestamp + _config.holdSeconds;
+    _decaySamples = 0;
+  } else if (_active && timestamp >= _holdUntil && ++_decaySamples >= BURST_DECAY_SAMPLES) {
+    // Next divisor of a minute at least twice as long, so the grid stays on the minute
+    uint8_t next = _period * 2;
+    while (next < SECONDS_PER_MINUTE && SECONDS_PER_MINUTE % next != 0) next++;
+    _period = next;
+    _decaySamples = 0;
+    if (_period >= basePeriodSeconds) _active = false;
+  }
+
+  // The sample that starts a burst and the one that ends it belong to it
+  if (wasActive || _active) Append(timestamp, raw);
+  if (wasActive && !_active) Flush();
+}
+
+/**
+ * @brief Returns the sample period to use now.
+ */
+uint8_t BurstSampler::PeriodSeconds(uint8_t basePeriodSeconds) const {
+  return _active && _period < basePeriodSeconds ? _period : basePeriodSeconds;
+}
+
+/**
+ * @brief Hands out a completed burst message once.
+ *
+ * @param[out] message Receives the message
+ * @return true if a message was waiting
+ */
+bool BurstSampler::TakeMessage(BurstMessage& message) {
+  if (!_haveReady) return false;
+  message = _ready;
+  _haveReady = false;
+  return true;
+}
+
+/**
+ * @brief Checks the sample against the window, then adds it to the window.
+ *
+ * A change is a rate above rateThreshold counts per minute between the new
+ * sample and any older one in the window.
+ */
+bool BurstSampler::DetectChange(uint32_t timestamp, int16_t raw) {
+  bool change = false;
+  for (uint8_t i = 0; i < _windowCount; i++) {
+    if (timestamp <= _windowTime[i]) continue;
+    const uint32_t dt = timestamp - _windowTime[i];
+    int32_t delta = (int32_t)raw - _windowRaw[i];
+    if (delta < 0) delta = -delta;
+    if ((int64_t)delta * SECONDS_PER_MINUTE > (int64_t)_config.rateThreshold * dt) change = true;
+  }
+
+  _windowRaw[_windowHead] = raw;
+  _windowTime[_windowHead] = timestamp;
+  _windowHead = (_windowHead + 1) % CHANGE_WINDOW_SAMPLES;
+  if (_windowCount < CHANGE_WINDOW_SAMPLES) _windowCount++;
+  return change;
+}
+
+/**
+ * @brief Adds a burst sample, closing the message when the spacing changes or it is full.
+ */
+void BurstSampler::Append(uint32_t timestamp, int16_t raw) {
+  BurstMessage& message = _building;
+  if (message.count == 1) {
+    const uint32_t spacing = timestamp - message.timestamp;
+    if (spacing == 0 || spacing > 0xFF) Flush();
+    else message.periodSeconds = (uint8_t)spacing;
+  } else if (message.count > 1 && timestamp != message.timestamp + (uint32_t)message.count * message.periodSeconds) {
+    Flush();
+  }
+
+  if (message.count == 0) {
+    message.timestamp = timestamp;
+    message.periodSeconds = 0;
+  }
+  message.raw[message.count++] = raw;
+  if (message.count == BURST_MAX_SAMPLES) Flush();
+}
+
+/**
+ * @brief Hands the message being built over to TakeMessage(); a lone sample is dropped.
+ *
+ * Lone samples say nothing the interval aggregate does not already say.
+ */
+void BurstSampler::Flush() {
+  if (_building.count > 1) {
+    _ready = _building;
+    _haveReady = true;
+  }
+  _building.count = 0;
+}
@@ -4,6 +4,20 @@
 #include "mqtt.h"
 #include "sensor.h"
 #include "storage.h"
+#include "outage_log.h"
+#include "staging_ring.h"
+#include "batch_manifest.h"
+#include "mqtt_transport.h"
+#include "publish_window.h"
+#include "scheduler.h"
+#include "reconnect_policy.h"
+#include "aggregator.h"
+#include "deadband.h"
+#include "burst_sampler.h"
+#include "time_service.h"
+#include "power.h"
+#include "sampler.h"
+#include "logger.h"
 
 #ifdef UNIT_TEST
 #include "secrets_example.h"
@@ -18,7 +32,8 @@ RTC_DS3231 rtc;
 Adafruit_ADT7410 tempsensor;   
 SdFat sd;
 static WiFiClient wifiClient;
-MqttClient mqttClient(wifiClient);
+static MqttTransportClient transportClient(wifiClient);  // reports PUBACKs by packet identifier
+MqttClient mqttClient(transportClient);
 #endif
 
 // =============================================================================
@@ -27,33 +42,103 @@ MqttClient mqttClient(wifiClient);
 
 /// SD card chip select pin
 static const uint8_t CHIP_SELECT = 4;
+/// Interrupt pin wired to the DS3231 SQW output, -1 if it is not wired
+static const int RTC_SQW_PIN = -1;
+/// Sleep between samples until an RTC alarm (needs RTC_SQW_PIN, see CoreSetLowPower())
+static const bool LOW_POWER_MODE = false;
+/// Sample in the SQW interrupt instead of the loop (needs RTC_SQW_PIN, see CoreSetInterruptSampling())
+static const bool INTERRUPT_SAMPLING = false;
 static const char* SENSOR_ID_ONE = "Sensor_One";
 static const char* SENSOR_ID_IN_USE = SENSOR_ID_ONE; 
 // static const char* SENSOR_ID_TWO = "Sensor_Two";
 // static const char* SENSOR_ID_IN_USE = SENSOR_ID_TWO; // Uncomment to use the second
 static const char* SENSOR_TYPE = "temp";
 static const char* MQTT_TOPIC = "dhbw/ai/si2023/2/";
+/// Derive the publish phase from the sensor ID instead of configuring it
+static const int PUBLISH_PHASE_FROM_SENSOR_ID = -1;
+/// Second of every minute at which this device samples and publishes (0..59)
+static const int PUBLISH_PHASE_SECONDS = PUBLISH_PHASE_FROM_SENSOR_ID;
 
 // =============================================================================
 // TIMING AND CONNECTION CONSTANTS
 // =============================================================================
 
-static const unsigned long WIFI_CONNECT_TIMEOUT_MS = 15000;
-static const unsigned long LOOP_DELAY_MS = 1000;
 static const size_t CLIENT_ID_BUFFER_SIZE = 64;
 #ifndef UNIT_TEST
 static const uint8_t SD_SCK_FREQUENCY_MHZ = 25;
 #endif
-static const int RECONNECT_INTERVAL_MS = 2000;
+static const unsigned long SECONDS_PER_MINUTE = 60;
+/// Derived phases stay in the first 50 seconds, leaving the end of the minute for retries
+static const uint16_t PUBLISH_PHASE_WINDOW_SECONDS = 50;
+/// Seconds between two samples unless CoreSetSamplePeriod() says otherwise
+static const unsigned long SAMPLE_PERIOD_SECONDS = 60;
+/// Longest time outage records stay in RAM before they are forced onto the SD card
+static const unsigned long OUTAGE_LOG_FLUSH_AGE_MS = 300000;
+/// Longest time a reading stays in the staging ring before it is spilled to the outage log
+static const unsigned long STAGING_RING_MAX_AGE_MS = 180000;
+
+// =============================================================================
+// TASK PERIODS AND BUDGETS
+// =============================================================================
+
+/// Broker polling and ack settling, often enough that acks are matched right away
+static const unsigned long PUBLISH_TASK_PERIOD_MS = 20;
+static const unsigned long PUBLISH_TASK_BUDGET_MS = 20;
+/// Reading the sensor and handing the message to the client
+static const unsigned long SAMPLE_TASK_BUDGET_MS = 50;
+/// How often the sample task takes the queued samples in interrupt sampling mode
+static const unsigned long SAMPLE_DRAIN_PERIOD_MS = 100;
+/// Connection manager steps; only a broker connect may take up to MQTT_CONNECT_TIMEOUT_MS
+static const unsigned long CONNECTION_TASK_PERIOD_MS = 100;
+static const unsigned long CONNECTION_TASK_BUDGET_MS = MQTT_CONNECT_TIMEOUT_MS;
+/// Recovery gets one settle-and-fill pass (RECOVERY_TICK_BUDGET_MS in mqtt.cpp) per period
+static const unsigned long RECOVERY_TASK_PERIOD_MS = 250;
+static const unsigned long RECOVERY_TASK_BUDGET_MS = 150;
+static const unsigned long HOUSEKEEPING_TASK_PERIOD_MS = 1000;
+static const unsigned long HOUSEKEEPING_TASK_BUDGET_MS = 50;
+/// Log drain on every pass; it only hands over what the serial port takes without waiting
+static const unsigned long LOG_TASK_BUDGET_MS = 2;
 
 // =============================================================================
 // SYSTEM STATE VARIABLES
 // =============================================================================
 
 static int lastLoggedMinute = -1;
+static int s_publishPhaseSeconds = -1;
+static unsigned long s_samplePeriodSeconds = SAMPLE_PERIOD_SECONDS;
+/// Samples taken since the last report
+static SampleAggregate s_interval = {0, 0, 0, 0, 0};
+/// RTC time of the last sample, so early re-runs within the same second take none
+static uint32_t s_lastSampleTime = 0;
+/// RTC time of the next point of the sample grid; the wake-up time in low-power mode
+static uint32_t s_nextSampleTime = 0;
+
+/// The grid point the sample task is at, kept while the sensor converts
+struct SampleGridPoint {
+  uint32_t time;          ///< RTC time of the grid point
+  unsigned long offset;   ///< Seconds since this device's reporting point of the minute
+  unsigned long startMs;  ///< millis() of the run that reached the grid point
+  uint16_t startMillis;   ///< Milliseconds into the RTC second at startMs
+  bool report;            ///< The interval is reported once the sample is in
+  bool converting;        ///< A sensor conversion for this grid point is running
+};
+static SampleGridPoint s_gridPoint = {0, 0, 0, 0, false, false};
+
 static int seqCount = 0;
 static bool recoverySent = false;
-static unsigned long lastReconnectAttempt = 0;
+/// Pin wired to the DS3231 SQW output, RTC_SQW_PIN unless CoreSetRtcSqwPin() says otherwise
+static int s_rtcSqwPin = RTC_SQW_PIN;
+
+static Scheduler s_scheduler;
+static ReconnectPolicy s_reconnectPolicy;
+/// Report-by-exception filter, off unless CoreSetDeadband() enables it
+static DeadbandFilter s_deadband;
+/// Faster sampling while the temperature changes, off unless CoreSetBurstSampling() enables it
+static BurstSampler s_burst;
+static uint8_t s_sampleTask = SCHEDULER_NO_TASK;
+static uint8_t s_connectionTask = SCHEDULER_NO_TASK;
+
+static void OnConnectionStateChange(ConnectionState from, ConnectionState to);
 
 // =============================================================================
 // CONNECTION STATUS FUNCTIONS
@@ -67,6 +152,174 @@ bool IsMqttConnected() {
   return mqttClient.connected();
 }
 
+/**
+ * @brief Returns the second of the minute at which this device samples and publishes.
+ *
+ * PUBLISH_PHASE_SECONDS when configured, otherwise a phase derived from the
+ * sensor ID, so a fleet spreads its messages over the minute instead of all
+ * publishing at second :00.
+ */
+uint8_t CorePublishPhaseSeconds() {
+  if (s_publishPhaseSeconds < 0) {
+    s_publishPhaseSeconds = PUBLISH_PHASE_SECONDS >= 0
+      ? PUBLISH_PHASE_SECONDS % SECONDS_PER_MINUTE
+      : SchedulerPhaseFromId(SENSOR_ID_IN_USE, PUBLISH_PHASE_WINDOW_SECONDS);
+  }
+  return s_publishPhaseSeconds;
+}
+
+/**
+ * @brief Sets the time between two samples; every minute still sends one message.
+ *
+ * @param seconds Sample period, clamped to 1..60; 60 sends single readings
+ */
+void CoreSetSamplePeriod(uint8_t seconds) {
+  if (seconds < 1) seconds = 1;
+  if (seconds > SECONDS_PER_MINUTE) seconds = SECONDS_PER_MINUTE;
+  s_samplePeriodSeconds = seconds;
+}
+
+/**
+ * @brief Returns the reconnect policy with its retry counters, for diagnostics.
+ */
+const ReconnectPolicy& CoreReconnectPolicy() {
+  return s_reconnectPolicy;
+}
+
+/**
+ * @brief Switches report-by-exception on or off.
+ *
+ * While on, a minute is only published (or staged) if it leaves the band of
+ * thresholdRaw counts around the last report, or if heartbeatSeconds have
+ * passed without one. The filter starts over, so the next minute is reported.
+ *
+ * @param enabled Report by exception instead of every minute
+ * @param thresholdRaw Largest change in ADT7410 counts (1/128 °C) that is skipped
+ * @param heartbeatSeconds Longest time between two reports
+ */
+void CoreSetDeadband(bool enabled, int16_t thresholdRaw, uint32_t heartbeatSeconds) {
+  s_deadband.Configure(enabled, thresholdRaw, heartbeatSeconds);
+}
+
+/**
+ * @brief Returns the report-by-exception filter with its counters, for diagnostics.
+ */
+const DeadbandFilter& CoreDeadband() {
+  return s_deadband;
+}
+
+/**
+ * @brief Switches adaptive burst sampling on or off, with the default tuning.
+ *
+ * While on, a rapid temperature change shortens the sample period to
+ * BURST_DEFAULT_PERIOD_SECONDS until it decays back to the base period; the
+ * burst samples are published as multi-value messages in between the
+ * interval reports (see BurstSampler).
+ */
+void CoreSetBurstSampling(bool enabled) {
+  BurstConfig config = {BURST_DEFAULT_RATE_THRESHOLD, BURST_DEFAULT_PERIOD_SECONDS, BURST_DEFAULT_HOLD_SECONDS};
+  s_burst.Configure(enabled, config);
+}
+
+/**
+ * @brief Returns the burst sampler with its burst counter, for diagnostics.
+ */
+const BurstSampler& CoreBurstSampler() {
+  return s_burst;
+}
+
+/**
+ * @brief Averages several sensor conversions into every sample.
+ *
+ * Each conversion takes about SENSOR_CONVERSION_MS; a sample period shorter
+ * than the whole reading delays the following grid points.
+ *
+ * @param conversions Conversions per sample, 1 to turn oversampling off
+ */
+void CoreSetOversampling(uint8_t conversions) {
+  SensorSetOversampling(conversions);
+}
+
+/**
+ * @brief Sets the MCU pin wired to the DS3231 INT/SQW output.
+ *
+ * Low-power mode and interrupt sampling need it; they check it when they are
+ * switched on.
+ *
+ * @param pin Interrupt pin, -1 if the output is not wired
+ */
+void CoreSetRtcSqwPin(int pin) {
+  s_rtcSqwPin = pin;
+}
+
+/**
+ * @brief Switches the low-power mode on or off.
+ *
+ * While on, CoreLoop() puts the MCU into standby once the sample of a grid
+ * point is taken and its messages are settled, and a DS3231 alarm wakes it
+ * for the next grid point (see power.h). An offline device retries its
+ * connection once per wake-up. A burst with a period below
+ * POWER_MIN_SLEEP_SECONDS keeps the MCU awake until it decays.
+ *
+ * @param enabled Sleep between samples instead of polling
+ * @return false if the RTC alarm cannot wake the MCU (no SQW pin wired, see CoreSetRtcSqwPin())
+ */
+bool CoreSetLowPower(bool enabled) {
+  if (enabled && SamplerRunning()) {
+    LOG_WARN("Low-power mode and interrupt sampling exclude each other.");
+    return false;
+  }
+  if (enabled && !PowerBegin(s_rtcSqwPin)) {
+    LOG_WARN("Low-power mode needs RTC_SQW_PIN.");
+    return false;
+  }
+  PowerSetEnabled(enabled, millis());
+  return true;
+}
+
+/**
+ * @brief Switches interrupt-driven sampling on or off.
+ *
+ * While on, the SQW interrupt takes the samples at their grid points and
+ * queues them (see sampler.h), and the sample task only takes them from the
+ * queue every SAMPLE_DRAIN_PERIOD_MS. A blocking connect or a long recovery
+ * in the loop then delays the report, but never moves or skips a sample.
+ * The interrupt owns the I2C bus, so the time service stops reading the RTC
+ * and keeps the time by the SQW edges alone; oversampling does not apply.
+ * Switching off hands sampling back to the loop at the next grid point.
+ *
+ * @param enabled Sample in the SQW interrupt instead of the loop
+ * @return false if the SQW output is not wired (see CoreSetRtcSqwPin()), or in low-power
+ *         mode, which needs the pin for its alarm
+ */
+bool CoreSetInterruptSampling(bool enabled) {
+  if (enabled && PowerEnabled()) {
+    LOG_WARN("Interrupt sampling and low-power mode exclude each other.");
+    return false;
+  }
+  if (enabled && s_rtcSqwPin < 0) {
+    LOG_WARN("Interrupt sampling needs RTC_SQW_PIN.");
+    return false;
+  }
+  if (enabled == SamplerRunning()) return true;
+
+  if (enabled) {
+    // The loop leaves the sensor to the interrupt, a conversion it started is dropped
+    const uint8_t oversampling = SensorOversampling();
+    SensorReset();
+    SensorSetOversampling(oversampling);
+    s_gridPoint.converting = false;
+    TimeServiceSetResyncInterval(0);
+    SamplerBegin(TimeNowPrecise(millis()).unixtime, CorePublishPhaseSeconds(),
+                 s_burst.PeriodSeconds(s_samplePeriodSeconds));
+  } else {
+    SamplerStop();
+    TimeServiceSetResyncInterval(TIME_DEFAULT_RESYNC_INTERVAL_MS);
+  }
+  s_scheduler.RunAt(s_sampleTask, millis());
+  return true;
+}
+
 // =============================================================================
 // FAT FILE SYSTEM CALLBACK FUNCTIONS
 // =============================================================================
@@ -75,8 +328,9 @@ bool IsMqttConnected() {
  * @brief Callback function for FAT file system timestamp generation
  * 
  * This function is used by the SdFat library to obtain current date and time
- * for file system operations. It retrieves the time from the RTC and converts
- * it to the FAT file system format using the appropriate macros.
+ * for file system operations. It takes the time from the time service, so
+ * file writes do not each cost an RTC read, and converts it to the FAT file
+ * system format using the appropriate macros.
  * 
  * @param[out] date Pointer to store the encoded FAT date (year, month, day)
  * @param[out] time Pointer to store the encoded FAT time (hour, minute, second)
@@ -85,7 +339,7 @@ bool IsMqttConnected() {
  * @see FAT_DATE, FAT_TIME macros for encoding format details
  */
 void FatDateTime(uint16_t* date, uint16_t* time) {
-  DateTime now = rtc.now();
+  DateTime now = TimeNow();
   *date = FAT_DATE(now.year(), now.month(), now.day());
   *time = FAT_TIME(now.hour(), now.minute(), now.second());
 }
@@ -100,38 +354,42 @@ void FatDateTime(uint16_t* date, uint16_t* time) {
  * This function performs comprehensive system initialization including:
  * 
  * **Network Setup:**
- * - Establishes WiFi connection with timeout handling
  * - Configures MQTT client with unique sensor-based ID
- * - Attempts initial MQTT broker connection
+ * - Hands the client to the connection manager, which connects WiFi and
+ *   the broker from the first CoreLoop() passes on
  * 
  * **Hardware Initialization:**
  * - Initializes DS3231 real-time clock module
  * - Adjusts RTC time if power was lost (uses compilation timestamp)
- * - Sets up SD card with SPI communication
+ * - Sets up SD card with SPI communication, mounts the outage log and
+ *   loads (or builds) the legacy batch manifest
  * - Initializes ADT7410 temperature sensor
  * 
  * **Data Recovery:**
  * - Registers FAT file system timestamp callback
  * 
+ * **Scheduling:**
+ * - Registers the CoreLoop() tasks with their periods and budgets
+ * 
  * @warning This function will halt program execution (infinite loop) if any
  *          critical component fails to initialize (RTC, SD card, or temperature sensor)
  * 
  * @note The function uses compile-time constants for timeouts and configuration
- * @see WIFI_CONNECT_TIMEOUT_MS, CLIENT_ID_BUFFER_SIZE, SD_SCK_FREQUENCY_MHZ
+ * @see CLIENT_ID_BUFFER_SIZE, SD_SCK_FREQUENCY_MHZ
  */
 void CoreSetup() {
-  ConnectToWiFi(WIFI_CONNECT_TIMEOUT_MS);
-
   char clientId[CLIENT_ID_BUFFER_SIZE];
   snprintf(clientId, sizeof(clientId), "IsoPruefi_%s", SENSOR_ID_IN_USE);
   mqttClient.setId(clientId);
 
-  if (IsWifiConnected()) {
-    ConnectToMQTT(mqttClient);
-  }
+  // Devices of a fleet draw different reconnect waits
+  s_reconnectPolicy.Seed(clientId);
+  ConnectionSetStateHandler(OnConnectionStateChange);
+  ConnectionBegin(mqttClient, &s_reconnectPolicy);
 
   if (!rtc.begin()) {
-    Serial.println("RTC not found!");
+    LOG_ERROR("RTC not found!");
+    LogFlush();
     while (1);
   }
 
@@ -139,124 +397,396 @@ void CoreSetup() {
   if (rtc.lostPower()) {
     rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
   }
+  // From here on the time comes from the time service, which reads the RTC once
+  TimeServiceRequestResync();
+#ifndef UNIT_TEST
+  if (s_rtcSqwPin >= 0 && !LOW_POWER_MODE) {
+    rtc.writeSqwPinMode(DS3231_SquareWave1Hz);
+    pinMode(s_rtcSqwPin, INPUT_PULLUP);  // open-drain output
+    attachInterrupt(digitalPinToInterrupt(s_rtcSqwPin), CoreOnSqwEdge, FALLING);
+  }
+#endif
 
   // Register callback for SD file timestamps and initialize SD card
   SdFile::dateTimeCallback(FatDateTime);
   if (!sd.begin(CHIP_SELECT, SD_SCK_MHZ(SD_SCK_FREQUENCY_MHZ))) {
-    Serial.println("SD card failed.");
+    LOG_ERROR("SD card failed.");
+    LogFlush();
     while (1);
   }
 
+  // Mount the outage log now so the first fallback write does not pay for it
+  if (!OutageLogBegin()) {
+    LOG_ERROR("Outage log unavailable.");
+  }
+  // Index legacy CSV batches once; recovery then never rescans the card
+  if (!BatchManifestBegin()) {
+    LOG_ERROR("Batch manifest unavailable.");
+  }
+
   if (!InitSensor(tempsensor)) {
-    Serial.println("ADT7410 init failed!");
+    LOG_ERROR("ADT7410 init failed!");
+    LogFlush();
     while (1);
   }
 
-  DateTime now = rtc.now();
-  Serial.print("Current time: ");
-  Serial.println(now.timestamp(DateTime::TIMESTAMP_FULL));
-  Serial.print("Lost Power? "); 
-  Serial.println(rtc.lostPower() ? "YES" : "NO");
+  DateTime now = TimeNow();
+  LOG_INFO("Current time: %s", now.timestamp(DateTime::TIMESTAMP_FULL).c_str());
+  LOG_INFO("Lost Power? %s", rtc.lostPower() ? "YES" : "NO");
+  LOG_INFO("Publish phase (s): %u", (unsigned)CorePublishPhaseSeconds());
+
+  // Registration order is the priority within a pass
+  const unsigned long startMs = millis();
+  s_sampleTask = s_scheduler.AddTask("sample", CoreSampleTask, 0, SAMPLE_TASK_BUDGET_MS, startMs);
+  s_scheduler.AddTask("publish", CorePublishTask, PUBLISH_TASK_PERIOD_MS, PUBLISH_TASK_BUDGET_MS, startMs);
+  s_connectionTask = s_scheduler.AddTask("connection", CoreConnectionTask, CONNECTION_TASK_PERIOD_MS,
+                                         CONNECTION_TASK_BUDGET_MS, startMs);
+  s_scheduler.AddTask("recovery", CoreRecoveryTask, RECOVERY_TASK_PERIOD_MS, RECOVERY_TASK_BUDGET_MS, startMs);
+  s_scheduler.AddTask("housekeeping", CoreHousekeepingTask, HOUSEKEEPING_TASK_PERIOD_MS,
+                      HOUSEKEEPING_TASK_BUDGET_MS, startMs);
+  s_scheduler.AddTask("log", CoreLogTask, 0, LOG_TASK_BUDGET_MS, startMs);
+
+  if (LOW_POWER_MODE) {
+    CoreSetLowPower(true);
+  } else if (INTERRUPT_SAMPLING) {
+    CoreSetInterruptSampling(true);
+  }
+
+  LOG_INFO("Setup complete.");
+}
 
-  Serial.println("Setup complete.");
+/**
+ * @brief Writes staged and buffered outage data to the SD card before power goes away.
+ *
+ * Hook for a planned shutdown, a reset request or a low-voltage/brown-out
+ * handler. Safe to call at any time; the next outage record mounts the log
+ * again if needed.
+ *
+ * Pending log messages are written out last.
+ *
+ * @see StagingRingFlush(), OutageLogFlush(), LogFlush()
+ */
+void CoreShutdown() {
+  if (!StagingRingFlush() || !OutageLogFlush()) {
+    LOG_ERROR("Outage log flush failed.");
+  }
+  LogFlush();
 }
 
 // =============================================================================
-// MAIN OPERATIONAL LOOP
+// SCHEDULED TASKS
 // =============================================================================
 
 /**
- * @brief Main operational loop for continuous sensor monitoring, MQTT transmission, and robust data recovery.
- *
- * This function implements the primary logic for the temperature monitoring system, including:
- * - Real-time sensor measurement and transmission via MQTT with QoS 1
- * - Intelligent WiFi and MQTT connection management with automatic reconnection
- * - Fallback to CSV batch storage during connectivity outages
- * - Recovery and transmission of offline data after successful reconnection
- * - Comprehensive error handling and status reporting
- *
- * **Operational Flow:**
- * 1. Time Management: Reads current time from RTC, tracks minute changes to avoid duplicate measurements.
- * 2. WiFi Connection: Monitors status, attempts reconnection, falls back to CSV logging if offline.
- * 3. MQTT Connection: Verifies broker connectivity, reconnects as needed, falls back to CSV logging if offline.
- * 4. Data Recovery: Sends pending CSV data after reconnection, ensures recovery only once per cycle.
- * 5. Normal Operation: Measures temperature, transmits via MQTT, polls for incoming messages.
- *
- * **Error Handling:**
- * - Network or broker failures trigger CSV fallback storage for all measurements.
- * - Connection attempts are rate-limited to prevent resource exhaustion.
- * - All measurement data is preserved and recovered after connectivity is restored.
- *
- * @note Maintains a fixed loop delay for consistent timing and system stability.
- * @see RECONNECT_INTERVAL_MS, LOOP_DELAY_MS for timing configuration
- * @see saveToCsvBatch() for offline data storage
- * @see sendPendingData() for data recovery and MQTT retransmission
+ * @brief Interrupt handler for the falling edge of the DS3231's 1 Hz SQW output.
+ *
+ * The edge pins the time service to the RTC second; while interrupt
+ * sampling is on (see CoreSetInterruptSampling()), it also takes the samples.
  */
-void CoreLoop() {
-  DateTime now = rtc.now();
-  static bool alreadyLoggedThisMinute = false;
+void CoreOnSqwEdge() {
+  TimeServiceOnSqwEdge();
+  SamplerOnSecond();
+}
 
-  if (now.minute() != lastLoggedMinute) {
-    lastLoggedMinute = now.minute();
-    alreadyLoggedThisMinute = false;
+/**
+ * @brief Reacts to connection state changes reported by the connection manager.
+ *
+ * Logs the drawn reconnect wait on every backoff. A new MQTT session re-arms
+ * the recovery of data staged meanwhile.
+ */
+static void OnConnectionStateChange(ConnectionState from, ConnectionState to) {
+  LOG_INFO("Connection state: %s", ConnectionStateName(to));
+
+  if (to == CONNECTION_BACKOFF) {
+    LOG_INFO("Retrying in ms: %lu, failures in a row: %lu", ConnectionRetryDelayMs(),
+             (unsigned long)s_reconnectPolicy.ConsecutiveFailures());
   }
 
-  // Step 1: Check WiFi connection
-  if (!IsWifiConnected()) {
-    if (millis() - lastReconnectAttempt > RECONNECT_INTERVAL_MS) {
-      lastReconnectAttempt = millis();
-      Serial.println("WiFi not connected. Trying to reconnect...");
-      ConnectToWiFi(WIFI_CONNECT_TIMEOUT_MS);
+  if (to == CONNECTION_CONNECTED) {
+    recoverySent = false; // Allow recovery again
+    ResetRecovery();      // An echo from the old session will not arrive
+  }
+}
+
+/**
+ * @brief Schedules the sample task for the next point of the sample grid.
+ *
+ * The grid ends at the next reporting point. The period is taken after the
+ * sample, so a burst that just started or ended already counts. The deadline
+ * is relative to the run that reached the grid point, so a conversion in
+ * between does not shift it.
+ */
+static void CoreScheduleNextGridPoint() {
+  const unsigned long period = s_burst.PeriodSeconds(s_samplePeriodSeconds);
+  const unsigned long offset = s_gridPoint.offset;
+  unsigned long next = (offset / period + 1) * period;
+  if (next > SECONDS_PER_MINUTE) next = SECONDS_PER_MINUTE;
+  s_nextSampleTime = s_gridPoint.time + (next - offset);
+  s_scheduler.RunAt(s_sampleTask, s_gridPoint.startMs + (next - offset) * 1000UL - s_gridPoint.startMillis);
+}
+
+/**
+ * @brief Folds a sample into the interval and reports the interval at the reporting point.
+ *
+ * @param time RTC time of the sample's grid point
+ * @param report The interval ends with this sample
+ * @param ok The sensor answered; otherwise raw is not valid and the sample is skipped
+ * @param raw Temperature in ADT7410 counts
+ */
+static void CoreAddSample(uint32_t time, bool report, bool ok, int16_t raw) {
+  DateTime now(time);
+  if (ok) {
+    AggregateAdd(s_interval, raw);
+
+    s_burst.Add(now.unixtime(), raw, s_samplePeriodSeconds);
+    BurstMessage burst;
+    // Bursts take no sequence number, so a dropped one leaves no gap
+    if (s_burst.TakeMessage(burst) && IsConnectedToServer(mqttClient)) {
+      SendBurstToMqtt(mqttClient, MQTT_TOPIC, SENSOR_TYPE, SENSOR_ID_IN_USE, burst);
     }
+  } else {
+    LOG_WARN("Temperature read failed, sample skipped.");
+  }
 
-    if (!IsWifiConnected()) {
-      Serial.println("WiFi reconnect failed. Skipping loop.");
-      if (!alreadyLoggedThisMinute) {
-        float c = ReadTemperatureInCelsius();
-        SaveTempToBatchCsv(now, c, seqCount);
-        alreadyLoggedThisMinute = true;
-        seqCount++;
+  // An interval without a single successful read has nothing to report
+  if (report && s_interval.count == 0) {
+    lastLoggedMinute = now.minute();
+  } else if (report) {
+    lastLoggedMinute = now.minute();
+    DateTime minuteStart(now.year(), now.month(), now.day(), now.hour(), now.minute(), 0);
+    const OutageRecord record = MakeAggregateRecord(minuteStart, s_interval, seqCount);
+    if (s_deadband.Offer(record)) {
+      if (IsConnectedToServer(mqttClient)) {
+        SendAggregateToMqtt(mqttClient, MQTT_TOPIC, SENSOR_TYPE, SENSOR_ID_IN_USE, s_interval, minuteStart, seqCount);
+      } else {
+        StageRecord(record);
       }
-      delay(LOOP_DELAY_MS);
-      return;
+      seqCount++;
     }
+    AggregateReset(s_interval);
+  }
+}
+
+/**
+ * @brief Takes the samples the SQW interrupt queued, in the order they were taken.
+ *
+ * The sampler gets the period back afterwards, so a burst that started or
+ * ended with these samples applies from the next grid point on.
+ */
+static void CoreDrainSamples() {
+  SampleRecord record;
+  while (SamplerTake(record)) {
+    CoreAddSample(record.time, (record.flags & SAMPLE_FLAG_REPORT) != 0,
+                  (record.flags & SAMPLE_FLAG_FAILED) == 0, record.raw);
   }
+  SamplerSetPeriod(s_burst.PeriodSeconds(s_samplePeriodSeconds));
+}
 
-  // Step 2: Check MQTT connection
-  if (!IsMqttConnected()) {
-    Serial.println("MQTT not connected. Trying to reconnect...");
-    if (!ConnectToMQTT(mqttClient)) {
-      Serial.println("MQTT reconnect failed. Skipping loop.");
-      if (!alreadyLoggedThisMinute) {
-        float c = ReadTemperatureInCelsius();
-        SaveTempToBatchCsv(now, c, seqCount);
-        alreadyLoggedThisMinute = true;
-        seqCount++;
-      }
-      delay(LOOP_DELAY_MS);
+/**
+ * @brief Samples the sensor and publishes or stages the aggregate of every minute.
+ *
+ * Samples every sample period (see CoreSetSamplePeriod()) on a grid that starts at this device's
+ * phase of the minute (see CorePublishPhaseSeconds()), folding them into
+ * the aggregate of the current reporting interval. At the phase of every RTC
+ * minute the interval is published as one message and a new one begins; with
+ * the default period of a minute that is one reading per message, as before.
+ *
+ * After each run the task aligns its next deadline with the start of an RTC
+ * second (the time service knows the milliseconds into the current one), so
+ * millis() drift never moves or doubles a sample. Runs early within the same
+ * second only re-align. The report is stamped with the start of its minute,
+ * so the phase never shows in the data.
+ *
+ * With report-by-exception on (see CoreSetDeadband()) minutes without news
+ * are dropped before they are published or staged. They take no sequence
+ * number, so a sequence gap still means lost data.
+ *
+ * While a burst runs (see CoreSetBurstSampling()) the grid uses the shorter
+ * burst period. Burst samples still go into the interval aggregate; each
+ * completed burst message is published right away while connected, without
+ * a sequence number, and dropped while offline, where the aggregate keeps their min/max/count.
+ *
+ * A sample is taken asynchronously: the run at the grid point starts a
+ * one-shot conversion and returns, and the task comes back when the
+ * conversion time has passed (see SensorPoll()). The other tasks run in
+ * between. The sample still counts for its grid point.
+ *
+ * With interrupt sampling on (see CoreSetInterruptSampling()) the samples
+ * are taken in the SQW interrupt instead, and the task only takes them
+ * from the queue every SAMPLE_DRAIN_PERIOD_MS.
+ *
+ * @param nowMs millis() at the start of the run
+ */
+void CoreSampleTask(unsigned long nowMs) {
+  if (SamplerRunning()) {
+    CoreDrainSamples();
+    s_scheduler.RunAt(s_sampleTask, nowMs + SAMPLE_DRAIN_PERIOD_MS);
+    return;
+  }
+
+  if (!s_gridPoint.converting) {
+    const PreciseTime precise = TimeNowPrecise(nowMs);
+    DateTime now(precise.unixtime);
+    const unsigned long phase = CorePublishPhaseSeconds();
+    const unsigned long second = now.second();
+
+    s_gridPoint.time = precise.unixtime;
+    s_gridPoint.offset = (second + SECONDS_PER_MINUTE - phase) % SECONDS_PER_MINUTE;
+    s_gridPoint.startMs = nowMs;
+    s_gridPoint.startMillis = precise.millis;
+    s_gridPoint.report = now.minute() != lastLoggedMinute && second >= phase;
+
+    const unsigned long period = s_burst.PeriodSeconds(s_samplePeriodSeconds);
+    const bool sample = s_gridPoint.report ||
+                        (s_gridPoint.offset % period == 0 && now.unixtime() != s_lastSampleTime);
+    if (!sample) {
+      CoreScheduleNextGridPoint();
       return;
     }
+    s_lastSampleTime = now.unixtime();
+    // A sensor that does not answer shows up as SENSOR_FAILED below
+    SensorStartConversion(nowMs);
+    s_gridPoint.converting = true;
+  }
 
-    Serial.println("MQTT reconnected successfully.");
-    recoverySent = false; // Allow recovery again
+  if (SensorPoll(nowMs) == SENSOR_CONVERTING) {
+    s_scheduler.RunAt(s_sampleTask, nowMs + SensorMsUntilReady(nowMs));
+    return;
   }
+  s_gridPoint.converting = false;
 
-  // Step 3: After successful MQTT reconnect → send old CSVs
-  if (!recoverySent && IsConnectedToServer(mqttClient)) {
-    if (SendPendingDataToMqtt(mqttClient, MQTT_TOPIC, SENSOR_TYPE, SENSOR_ID_IN_USE, now)) {
-      recoverySent = true;
-    }
+  int16_t raw = 0;
+  const bool ok = SensorFetch(raw);
+  CoreAddSample(s_gridPoint.time, s_gridPoint.report, ok, raw);
+  CoreScheduleNextGridPoint();
+}
+
+/**
+ * @brief Polls the broker and settles the publish window.
+ *
+ * Acknowledged messages are released, readings whose ack timed out are
+ * staged for recovery.
+ */
+void CorePublishTask(unsigned long nowMs) {
+  ServicePublishWindow(mqttClient, TimeNow(nowMs));
+}
+
+/**
+ * @brief Advances the WiFi/MQTT connection manager by one non-blocking step.
+ *
+ * @see ConnectionTick()
+ */
+void CoreConnectionTask(unsigned long nowMs) {
+  ConnectionTick(nowMs);
+}
+
+/**
+ * @brief Advances the recovery of pending data by one pass after a reconnect.
+ *
+ * The pass publishes what fits into the publish window and returns; the acks
+ * are collected by CorePublishTask() before the next period.
+ */
+void CoreRecoveryTask(unsigned long nowMs) {
+  if (recoverySent || !IsConnectedToServer(mqttClient)) return;
+  if (SendPendingDataToMqtt(mqttClient, MQTT_TOPIC, SENSOR_TYPE, SENSOR_ID_IN_USE, TimeNow(nowMs))) {
+    recoverySent = true;
   }
+}
+
+/**
+ * @brief Bounds how many staged and buffered outage records a power cut can take with it.
+ */
+void CoreHousekeepingTask(unsigned long nowMs) {
+  StagingRingTick(nowMs, STAGING_RING_MAX_AGE_MS);
+  OutageLogTick(nowMs, OUTAGE_LOG_FLUSH_AGE_MS);
+}
+
+/**
+ * @brief Hands buffered log messages to the serial port as far as it takes them without waiting.
+ *
+ * @see LogDrain()
+ */
+void CoreLogTask(unsigned long nowMs) {
+  (void)nowMs;
+  LogDrain();
+}
 
-  // Step 4: Normal measurement and MQTT transmission
-  if (!alreadyLoggedThisMinute && IsConnectedToServer(mqttClient)) {
-    float c = ReadTemperatureInCelsius();
-    SendTempToMqtt(mqttClient, MQTT_TOPIC, SENSOR_TYPE, SENSOR_ID_IN_USE, c, now, seqCount);
-    alreadyLoggedThisMinute = true;
-    seqCount++;
+/**
+ * @brief Checks that nothing but the next sample is left to do.
+ *
+ * No message waits for its ack, and the device is either connected with
+ * its recovery done or waiting to retry the connection.
+ */
+static bool CoreIsIdle() {
+  if (PublishWindowCount(PUBLISH_LIVE) > 0 || PublishWindowCount(PUBLISH_BURST) > 0 ||
+      PublishWindowCount(PUBLISH_LIVE_BATCH) > 0 || PublishWindowRecoveryCount() > 0) {
+    return false;
   }
+  const ConnectionState state = ConnectionGetState();
+  return (state == CONNECTION_CONNECTED && recoverySent) || state == CONNECTION_BACKOFF;
+}
+
+/**
+ * @brief Sleeps until the next sample once the work of this wake-up is done or its window is over.
+ *
+ * Standby stops millis(), so the sample task is re-armed for right now
+ * after the wake-up (the alarm went off at its grid point). The sleep
+ * counts towards a connection backoff, and the connection task runs right
+ * away too, so an offline device retries on every wake-up. The ages of
+ * staged readings and outage log buffers only count awake time.
+ */
+static void CoreSleepIfIdle(unsigned long nowMs) {
+  // The sample of this grid point has not been taken yet
+  if (s_nextSampleTime <= TimeNowPrecise(nowMs).unixtime) return;
+
+  const bool idle = CoreIsIdle();
+  if (!idle && !PowerWindowExpired(nowMs)) return;
+  if (PowerSleepUntil(s_nextSampleTime, nowMs, !idle)) {
+    ConnectionAddSleepTime(PowerGetStats().lastSleptMs);
+    const unsigned long wakeMs = millis();
+    s_scheduler.RunAt(s_sampleTask, wakeMs);
+    s_scheduler.RunAt(s_connectionTask, wakeMs);
+  }
+}
+
+// =============================================================================
+// MAIN OPERATIONAL LOOP
+// =============================================================================
 
-  // Step 5: MQTT loop and wait time
-  mqttClient.poll();
-  delay(LOOP_DELAY_MS);
+/**
+ * @brief Main operational loop: runs every scheduled task that is due, then returns.
+ *
+ * The work of the firmware is split into cooperative tasks (see scheduler.h),
+ * each with its own period and time budget, registered by CoreSetup() in
+ * priority order:
+ *
+ * 1. Sampling (CoreSampleTask): one measurement at the start of every RTC
+ *    minute, published with QoS 1 when connected and staged for recovery
+ *    otherwise, independent of the connection state. With interrupt
+ *    sampling on, it only takes the samples the SQW interrupt queued.
+ * 2. Publishing (CorePublishTask): polls the broker and settles the publish
+ *    window every PUBLISH_TASK_PERIOD_MS.
+ * 3. Connection (CoreConnectionTask): steps the non-blocking WiFi/MQTT
+ *    connection manager; a new session re-arms recovery.
+ * 4. Recovery (CoreRecoveryTask): one recovery pass per
+ *    RECOVERY_TASK_PERIOD_MS until the backlog is drained; it never waits
+ *    for acks.
+ * 5. Housekeeping (CoreHousekeepingTask): spills aged staged readings and
+ *    flushes aged outage log buffers.
+ * 6. Logging (CoreLogTask): writes buffered log messages (see logger.h) to
+ *    the serial port on every pass, as far as it takes them without waiting.
+ *
+ * Nothing here waits with delay(); a pass without due tasks returns at once.
+ * In low-power mode (see CoreSetLowPower()) a pass that leaves nothing to do
+ * before the next sample puts the MCU into standby until then.
+ *
+ * @see Scheduler::Run()
+ * @see StageTempReading() for offline data storage
+ * @see SendPendingDataToMqtt() for data recovery and MQTT retransmission
+ */
+void CoreLoop() {
+  s_scheduler.Run();
+  if (PowerEnabled()) {
+    CoreSleepIfIdle(millis());
+  }
 }
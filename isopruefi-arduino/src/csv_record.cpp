@@ -0,0 +1,134 @@
+#include "csv_record.h"
+
+// =============================================================================
+// PARSER LIMITS
+// =============================================================================
+
+/// Largest integer part that still fits milli-degrees into an int32
+static const int32_t MAX_TEMP_INTEGER_PART = 2000000;
+/// Decimal places kept by the fixed-point temperature
+static const int TEMP_FRACTION_DIGITS = 3;
+
+// =============================================================================
+// FIELD SCANNERS
+// =============================================================================
+// Each scanner advances pos over one field and returns false on a malformed
+// field. They never read past end and never write outside their outputs.
+
+static bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static bool ScanUnsigned(const char* line, size_t end, size_t& pos, uint32_t maxValue, uint32_t& value) {
+  size_t start = pos;
+  value = 0;
+  while (pos < end && IsDigit(line[pos])) {
+    uint32_t digit = (uint32_t)(line[pos] - '0');
+    if (value > (maxValue - digit) / 10) return false;
+    value = value * 10 + digit;
+    pos++;
+  }
+  return pos > start;
+}
+
+static bool ScanFixedPoint(const char* line, size_t end, size_t& pos, int32_t& milli) {
+  bool negative = false;
+  if (pos < end && (line[pos] == '-' || line[pos] == '+')) {
+    negative = line[pos] == '-';
+    pos++;
+  }
+
+  size_t start = pos;
+  uint32_t integerPart = 0;
+  if (pos < end && IsDigit(line[pos]) &&
+      !ScanUnsigned(line, end, pos, (uint32_t)MAX_TEMP_INTEGER_PART, integerPart)) {
+    return false;
+  }
+  bool hasDigits = pos > start;
+
+  uint32_t fraction = 0;
+  int fractionDigits = 0;
+  bool roundUp = false;
+  if (pos < end && line[pos] == '.') {
+    pos++;
+    while (pos < end && IsDigit(line[pos])) {
+      if (fractionDigits < TEMP_FRACTION_DIGITS) {
+        fraction = fraction * 10 + (uint32_t)(line[pos] - '0');
+      } else if (fractionDigits == TEMP_FRACTION_DIGITS) {
+        roundUp = line[pos] >= '5';
+      }
+      fractionDigits++;
+      hasDigits = true;
+      pos++;
+    }
+  }
+  if (!hasDigits) return false;
+
+  for (int i = fractionDigits; i < TEMP_FRACTION_DIGITS; i++) fraction *= 10;
+  int32_t magnitude = (int32_t)(integerPart * CSV_TEMP_SCALE + fraction) + (roundUp ? 1 : 0);
+  milli = negative ? -magnitude : magnitude;
+  return true;
+}
+
+static bool ScanSigned(const char* line, size_t end, size_t& pos, int32_t& value) {
+  bool negative = false;
+  if (pos < end && line[pos] == '-') {
+    negative = true;
+    pos++;
+  }
+  uint32_t magnitude = 0;
+  if (!ScanUnsigned(line, end, pos, negative ? 2147483648UL : 2147483647UL, magnitude)) return false;
+  value = negative ? (int32_t)(0 - magnitude) : (int32_t)magnitude;
+  return true;
+}
+
+static bool ExpectComma(const char* line, size_t end, size_t& pos) {
+  if (pos >= end || line[pos] != ',') return false;
+  pos++;
+  return true;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+/**
+ * @brief Parses one "timestamp,temperature,sequence" CSV line in a single pass.
+ *
+ * Reentrant and allocation-free: the line is only read (no strtok-style
+ * mutation, no static state), integers are accumulated with overflow checks
+ * and the temperature is converted to milli-degrees without floating point.
+ * A trailing "\n" or "\r\n" is accepted, a terminating NUL inside the length
+ * ends the line.
+ *
+ * @param[in]  line   Line to parse, need not be NUL-terminated
+ * @param[in]  length Number of bytes in line
+ * @param[out] record Parsed fields, only valid when CSV_OK is returned
+ * @return CSV_OK or the error of the first malformed field
+ */
+CsvParseResult ParseCsvRecord(const char* line, size_t length, CsvRecord& record) {
+  size_t end = 0;
+  while (end < length && line[end] != '\0') end++;
+  while (end > 0 && (line[end - 1] == '\n' || line[end - 1] == '\r')) end--;
+  if (end == 0) return CSV_ERR_EMPTY;
+
+  size_t pos = 0;
+  uint32_t timestamp = 0;
+  if (!ScanUnsigned(line, end, pos, 0xFFFFFFFFUL, timestamp) || !ExpectComma(line, end, pos)) {
+    return CSV_ERR_TIMESTAMP;
+  }
+
+  int32_t milli = 0;
+  if (!ScanFixedPoint(line, end, pos, milli) || !ExpectComma(line, end, pos)) {
+    return CSV_ERR_TEMPERATURE;
+  }
+
+  int32_t sequence = 0;
+  if (!ScanSigned(line, end, pos, sequence)) return CSV_ERR_SEQUENCE;
+  if (pos != end) return CSV_ERR_TRAILING;
+
+  record.timestamp = timestamp;
+  record.milliCelsius = milli;
+  record.sequence = sequence;
+  return CSV_OK;
+}
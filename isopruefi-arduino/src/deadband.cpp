@@ -0,0 +1,60 @@
+#include "deadband.h"
+
+DeadbandFilter::DeadbandFilter()
+  : _enabled(false), _thresholdRaw(DEADBAND_DEFAULT_THRESHOLD_RAW),
+    _heartbeatSeconds(DEADBAND_DEFAULT_HEARTBEAT_SECONDS) {
+  Reset();
+}
+
+/**
+ * @brief Sets the filter up; a disabled filter reports every reading.
+ *
+ * @param enabled Report by exception instead of every interval
+ * @param thresholdRaw Largest change in ADT7410 counts that is not reported
+ * @param heartbeatSeconds Longest time between two reports
+ */
+void DeadbandFilter::Configure(bool enabled, int16_t thresholdRaw, uint32_t heartbeatSeconds) {
+  _enabled = enabled;
+  _thresholdRaw = thresholdRaw < 0 ? 0 : thresholdRaw;
+  _heartbeatSeconds = heartbeatSeconds;
+  Reset();
+}
+
+/**
+ * @brief Forgets the last report and the counters; the next reading is reported.
+ */
+void DeadbandFilter::Reset() {
+  _haveLast = false;
+  _lastRaw = 0;
+  _lastTimestamp = 0;
+  _reported = 0;
+  _skipped = 0;
+}
+
+/**
+ * @brief Decides whether a reading is reported, and remembers it if so.
+ *
+ * An aggregate is reported when its lowest or highest sample leaves the
+ * band around the last reported value, so a short spike is not averaged away.
+ *
+ * @param record Reading or interval aggregate (see MakeAggregateRecord())
+ * @return true if the reading is to be published or staged
+ */
+bool DeadbandFilter::Offer(const OutageRecord& record) {
+  const int32_t low = record.count > 1 ? record.rawMin : record.rawTemp;
+  const int32_t high = record.count > 1 ? record.rawMax : record.rawTemp;
+
+  bool report = !_enabled || !_haveLast ||
+                high - _lastRaw > _thresholdRaw || _lastRaw - low > _thresholdRaw ||
+                record.timestamp - _lastTimestamp >= _heartbeatSeconds;
+  if (!report) {
+    _skipped++;
+    return false;
+  }
+
+  _haveLast = true;
+  _lastRaw = record.rawTemp;
+  _lastTimestamp = record.timestamp;
+  _reported++;
+  return true;
+}
@@ -0,0 +1,69 @@
+#include "fixed_point.h"
+#include "sensor.h"
+
+/**
+ * @brief Prints an unsigned integer in decimal.
+ *
+ * @param buffer Output, at least FIXED_POINT_BUFFER_SIZE bytes
+ * @return Number of characters written (without terminator)
+ */
+size_t FormatUnsigned(char* buffer, uint32_t value) {
+  char digits[10];
+  size_t n = 0;
+  do {
+    digits[n++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+
+  for (size_t i = 0; i < n; i++) buffer[i] = digits[n - 1 - i];
+  buffer[n] = '\0';
+  return n;
+}
+
+/**
+ * @brief Prints a signed integer in decimal, INT32_MIN included.
+ */
+size_t FormatSigned(char* buffer, int32_t value) {
+  if (value >= 0) return FormatUnsigned(buffer, (uint32_t)value);
+  buffer[0] = '-';
+  return 1 + FormatUnsigned(buffer + 1, 0u - (uint32_t)value);
+}
+
+/**
+ * @brief Prints value / scale as a decimal number without going through a float.
+ *
+ * Scales that are powers of two or ten terminate after a few digits, so the
+ * result is exact: 3264 counts at scale 128 print as "25.5", 1 count as
+ * "0.0078125". Trailing zeros are dropped, whole numbers have no point.
+ *
+ * @param buffer Output, at least FIXED_POINT_BUFFER_SIZE bytes
+ * @param value Fixed-point value
+ * @param scale Units per degree
+ * @return Number of characters written (without terminator)
+ */
+size_t FormatFixedPoint(char* buffer, int32_t value, uint16_t scale) {
+  size_t n = 0;
+  uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+  if (value < 0) buffer[n++] = '-';
+  n += FormatUnsigned(buffer + n, magnitude / scale);
+
+  uint32_t remainder = magnitude % scale;
+  if (remainder != 0) {
+    buffer[n++] = '.';
+    // Seven digits cover 1/128; any other scale is cut off there
+    for (int digit = 0; digit < 7 && remainder != 0; digit++) {
+      remainder *= 10;
+      buffer[n++] = (char)('0' + remainder / scale);
+      remainder %= scale;
+    }
+  }
+  buffer[n] = '\0';
+  return n;
+}
+
+/**
+ * @brief Prints a temperature in ADT7410 counts as degrees Celsius.
+ */
+size_t FormatRawTemp(char* buffer, int16_t raw) {
+  return FormatFixedPoint(buffer, raw, TEMP_RAW_COUNTS_PER_DEGREE);
+}
@@ -0,0 +1,87 @@
+#include "json_arena.h"
+
+/// _lastBlock when the last block is unknown, e.g. right after it was reclaimed
+static const size_t NO_BLOCK = (size_t)-1;
+
+static size_t AlignUp(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+JsonArena::JsonArena()
+  : _used(0), _lastBlock(NO_BLOCK), _highWater(0), _blocks(0), _failures(0) {}
+
+/**
+ * @brief Hands out a block from the buffer.
+ *
+ * @param size Bytes requested
+ * @return Block aligned for any scalar, nullptr if the buffer is exhausted
+ */
+void* JsonArena::allocate(size_t size) {
+  const size_t header = AlignUp(_used, ALIGNMENT);
+  if (header > JSON_ARENA_SIZE || JSON_ARENA_SIZE - header < ALIGNMENT ||
+      JSON_ARENA_SIZE - header - ALIGNMENT < size) {
+    _failures++;
+    return nullptr;
+  }
+
+  memcpy(_buffer + header, &size, sizeof(size));
+  _lastBlock = header;
+  _used = header + ALIGNMENT + size;
+  if (_used > _highWater) _highWater = _used;
+  _blocks++;
+  return _buffer + header + ALIGNMENT;
+}
+
+/**
+ * @brief Returns a block; the space is reused once it is the last or all blocks are free.
+ */
+void JsonArena::deallocate(void* pointer) {
+  if (!pointer || _blocks == 0) return;
+
+  if (--_blocks == 0) {
+    _used = 0;
+    _lastBlock = NO_BLOCK;
+  } else if (IsLast(pointer)) {
+    _used = _lastBlock;
+    _lastBlock = NO_BLOCK;
+  }
+}
+
+/**
+ * @brief Grows or shrinks a block, in place if it is the last one.
+ *
+ * ArduinoJson uses this to grow its pool list and to shrink pools to fit.
+ *
+ * @return The moved or resized block, nullptr if it does not fit (the old block stays valid)
+ */
+void* JsonArena::reallocate(void* pointer, size_t newSize) {
+  if (!pointer) return allocate(newSize);
+
+  if (IsLast(pointer)) {
+    if (JSON_ARENA_SIZE - _lastBlock - ALIGNMENT < newSize) {
+      _failures++;
+      return nullptr;
+    }
+    memcpy(_buffer + _lastBlock, &newSize, sizeof(newSize));
+    _used = _lastBlock + ALIGNMENT + newSize;
+    if (_used > _highWater) _highWater = _used;
+    return pointer;
+  }
+
+  void* moved = allocate(newSize);
+  if (!moved) return nullptr;
+  const size_t oldSize = BlockSize(pointer);
+  memcpy(moved, pointer, oldSize < newSize ? oldSize : newSize);
+  deallocate(pointer);
+  return moved;
+}
+
+size_t JsonArena::BlockSize(const void* pointer) const {
+  size_t size;
+  memcpy(&size, (const uint8_t*)pointer - ALIGNMENT, sizeof(size));
+  return size;
+}
+
+bool JsonArena::IsLast(const void* pointer) const {
+  return _lastBlock != NO_BLOCK && pointer == _buffer + _lastBlock + ALIGNMENT;
+}
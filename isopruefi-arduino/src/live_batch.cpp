@@ -0,0 +1,143 @@
+#include "live_batch.h"
+#include "staging_ring.h"
+
+// =============================================================================
+// BATCH STATE
+// =============================================================================
+
+static uint8_t s_size = LIVE_BATCH_DEFAULT_SIZE;
+static unsigned long s_maxLatencyMs = LIVE_BATCH_DEFAULT_MAX_LATENCY_MS;
+
+static OutageRecord s_queued[LIVE_BATCH_MAX_RECORDS];
+static size_t s_queuedCount = 0;
+static unsigned long s_oldestQueuedMs = 0;
+
+static OutageRecord s_inFlight[LIVE_BATCH_MAX_RECORDS];
+static size_t s_inFlightCount = 0;
+
+/// Pushes records to the staging ring in order and returns how many were pushed
+static size_t SpillRecords(const OutageRecord* records, size_t count, unsigned long nowMs) {
+  size_t spilled = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (StagingRingPush(records[i], nowMs)) spilled++;
+  }
+  return spilled;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+/**
+ * @brief Drops queued and in-flight readings and restores the default configuration.
+ */
+void LiveBatchReset() {
+  s_size = LIVE_BATCH_DEFAULT_SIZE;
+  s_maxLatencyMs = LIVE_BATCH_DEFAULT_MAX_LATENCY_MS;
+  s_queuedCount = 0;
+  s_oldestQueuedMs = 0;
+  s_inFlightCount = 0;
+}
+
+/**
+ * @brief Sets how many readings a live message carries and how long they may wait for it.
+ *
+ * @param size Readings per message, clamped to 1..LIVE_BATCH_MAX_RECORDS; 1 turns batching off
+ * @param maxLatencyMs Longest time the oldest queued reading waits before the batch is sent anyway
+ */
+void LiveBatchConfigure(uint8_t size, unsigned long maxLatencyMs) {
+  if (size < 1) size = 1;
+  if (size > LIVE_BATCH_MAX_RECORDS) size = LIVE_BATCH_MAX_RECORDS;
+  s_size = size;
+  s_maxLatencyMs = maxLatencyMs;
+}
+
+uint8_t LiveBatchSize() {
+  return s_size;
+}
+
+/**
+ * @brief Queues a reading for the next batch.
+ *
+ * @return false if the queue is full, because the batch in flight was not settled yet
+ */
+bool LiveBatchAdd(const OutageRecord& record, unsigned long nowMs) {
+  if (s_queuedCount >= s_size) return false;
+  if (s_queuedCount == 0) s_oldestQueuedMs = nowMs;
+  s_queued[s_queuedCount++] = record;
+  return true;
+}
+
+size_t LiveBatchQueuedCount() {
+  return s_queuedCount;
+}
+
+/**
+ * @brief Checks whether the queue should be sent now: it is full or its oldest reading waited long enough.
+ *
+ * Never due while the previous batch is still in flight.
+ */
+bool LiveBatchDue(unsigned long nowMs) {
+  if (s_queuedCount == 0 || s_inFlightCount > 0) return false;
+  return s_queuedCount >= s_size || nowMs - s_oldestQueuedMs >= s_maxLatencyMs;
+}
+
+/**
+ * @brief Makes the queued readings the batch in flight.
+ *
+ * @return Number of readings in the batch, 0 if a batch is in flight already
+ */
+size_t LiveBatchStart() {
+  if (s_inFlightCount > 0) return 0;
+  for (size_t i = 0; i < s_queuedCount; i++) s_inFlight[i] = s_queued[i];
+  s_inFlightCount = s_queuedCount;
+  s_queuedCount = 0;
+  return s_inFlightCount;
+}
+
+size_t LiveBatchInFlightCount() {
+  return s_inFlightCount;
+}
+
+/**
+ * @brief Copies readings of the batch in flight, like StagingRingPeek() does for the ring.
+ */
+size_t LiveBatchPeekInFlight(OutageRecord* records, size_t maxRecords, size_t skip) {
+  size_t copied = 0;
+  for (size_t i = skip; i < s_inFlightCount && copied < maxRecords; i++) {
+    records[copied++] = s_inFlight[i];
+  }
+  return copied;
+}
+
+/**
+ * @brief Forgets the batch in flight after its ack.
+ */
+void LiveBatchSettle() {
+  s_inFlightCount = 0;
+}
+
+/**
+ * @brief Moves the whole batch in flight to the staging ring after a failed or missing ack.
+ *
+ * All records are pushed in order within this one call, before the next
+ * batch can start, so recovery sees the batch exactly as it was sent.
+ *
+ * @return Number of records stored
+ */
+size_t LiveBatchSpill(unsigned long nowMs) {
+  const size_t spilled = SpillRecords(s_inFlight, s_inFlightCount, nowMs);
+  s_inFlightCount = 0;
+  return spilled;
+}
+
+/**
+ * @brief Moves queued readings that cannot be published (no connection) to the staging ring.
+ *
+ * @return Number of records stored
+ */
+size_t LiveBatchSpillQueued(unsigned long nowMs) {
+  const size_t spilled = SpillRecords(s_queued, s_queuedCount, nowMs);
+  s_queuedCount = 0;
+  return spilled;
+}
@@ -0,0 +1,30 @@
+#include "log_format.h"
+
+/**
+ * @brief Computes a CRC32 (IEEE 802.3) over a buffer, seeded with a generation number.
+ *
+ * Uses a 16-entry nibble table to keep flash usage small on the SAMD21.
+ * Seeding with the segment generation makes records from an earlier use
+ * of the same segment file fail validation.
+ *
+ * @param seed Generation number mixed in before the data
+ * @param data Bytes to checksum
+ * @param len Number of bytes
+ * @return CRC32 value
+ */
+uint32_t Crc32(uint32_t seed, const uint8_t* data, size_t len) {
+  static const uint32_t NIBBLE_TABLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+  };
+  uint8_t seedBytes[4];
+  PutU32(seedBytes, seed);
+
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < sizeof(seedBytes) + len; i++) {
+    uint8_t b = i < sizeof(seedBytes) ? seedBytes[i] : data[i - sizeof(seedBytes)];
+    crc = NIBBLE_TABLE[(crc ^ b) & 0x0F] ^ (crc >> 4);
+    crc = NIBBLE_TABLE[(crc ^ (b >> 4)) & 0x0F] ^ (crc >> 4);
+  }
+  return ~crc;
+}
@@ -0,0 +1,157 @@
+#include "logger.h"
+#include <stdarg.h>
+
+/// LogFlush() gives up once the sink has taken nothing for this long
+static const unsigned long LOG_FLUSH_TIMEOUT_MS = 1000;
+/// One-letter tags by level, then a space: "E Outage log full..."
+static const char LEVEL_TAGS[] = {'-', 'E', 'W', 'I', 'D'};
+static const size_t LEVEL_TAG_BYTES = 2;
+
+static char s_buffer[LOG_BUFFER_BYTES];
+static size_t s_head = 0;           // next byte to write
+static size_t s_tail = 0;           // next byte to hand to the sink
+static size_t s_used = 0;
+static LogSink s_sink = nullptr;
+static uint32_t s_written = 0;
+static uint32_t s_dropped = 0;
+static uint32_t s_unreported = 0;   // drops the ring has not noted yet
+
+/**
+ * @brief Copies a whole line into the ring, or nothing if it does not fit.
+ */
+static bool Enqueue(const char* line, size_t len) {
+  if (len > LOG_BUFFER_BYTES - s_used) return false;
+  for (size_t i = 0; i < len; i++) {
+    s_buffer[s_head] = line[i];
+    s_head = (s_head + 1) % LOG_BUFFER_BYTES;
+  }
+  s_used += len;
+  return true;
+}
+
+/**
+ * @brief Formats a tagged line; text beyond LOG_LINE_MAX is cut.
+ *
+ * @param[out] line LOG_LINE_MAX bytes
+ * @return Length of the line including its newline, no terminator
+ */
+static size_t FormatLineV(char* line, uint8_t level, const char* format, va_list args) {
+  const size_t room = LOG_LINE_MAX - LEVEL_TAG_BYTES - 1;
+  line[0] = LEVEL_TAGS[level < sizeof(LEVEL_TAGS) ? level : 0];
+  line[1] = ' ';
+  const int n = vsnprintf(line + LEVEL_TAG_BYTES, room + 1, format, args);
+  const size_t textLen = n < 0 ? 0 : ((size_t)n < room ? (size_t)n : room);
+  line[LEVEL_TAG_BYTES + textLen] = '\n';
+  return LEVEL_TAG_BYTES + textLen + 1;
+}
+
+static size_t FormatLine(char* line, uint8_t level, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  const size_t len = FormatLineV(line, level, format, args);
+  va_end(args);
+  return len;
+}
+
+/**
+ * @brief Sets where LogDrain() writes to; messages logged before are kept.
+ *
+ * @param sink Takes text without waiting (see LogSink), nullptr to hold it
+ */
+void LogBegin(LogSink sink) {
+  s_sink = sink;
+}
+
+/**
+ * @brief Formats a message into the ring; use the LOG_* macros instead.
+ *
+ * Never waits: a message that does not fit is dropped and counted.
+ *
+ * @param level LOG_LEVEL_ERROR..LOG_LEVEL_DEBUG, shown as a one-letter tag
+ * @param format printf format, without a trailing newline
+ */
+void LogWrite(uint8_t level, const char* format, ...) {
+  char line[LOG_LINE_MAX];
+  va_list args;
+  va_start(args, format);
+  const size_t len = FormatLineV(line, level, format, args);
+  va_end(args);
+
+  if (!Enqueue(line, len)) {
+    s_dropped++;
+    s_unreported++;
+    return;
+  }
+  s_written++;
+}
+
+/**
+ * @brief Hands buffered text to the sink as far as it takes it without waiting.
+ *
+ * Once the ring is empty, a note on messages dropped since the last note is
+ * queued; the next drain writes it.
+ *
+ * @return Bytes the sink took
+ */
+size_t LogDrain() {
+  if (!s_sink) return 0;
+
+  size_t total = 0;
+  while (s_used > 0) {
+    // The sink gets the part up to the end of the array, then the rest
+    const size_t chunk = s_used < LOG_BUFFER_BYTES - s_tail ? s_used : LOG_BUFFER_BYTES - s_tail;
+    size_t taken = s_sink(s_buffer + s_tail, chunk);
+    if (taken > chunk) taken = chunk;
+    s_tail = (s_tail + taken) % LOG_BUFFER_BYTES;
+    s_used -= taken;
+    total += taken;
+    if (taken < chunk) break;
+  }
+
+  if (s_used == 0 && s_unreported > 0) {
+    char line[LOG_LINE_MAX];
+    const size_t len = FormatLine(line, LOG_LEVEL_WARN, "%lu log messages dropped", (unsigned long)s_unreported);
+    if (Enqueue(line, len)) s_unreported = 0;
+  }
+  return total;
+}
+
+/**
+ * @brief Drains the ring completely, waiting for the sink.
+ *
+ * For the last messages before the firmware halts. Gives up when the sink
+ * takes nothing for LOG_FLUSH_TIMEOUT_MS (no serial monitor attached).
+ */
+void LogFlush() {
+  if (!s_sink) return;
+  unsigned long lastProgressMs = millis();
+  while (s_used > 0 || s_unreported > 0) {
+    if (LogDrain() > 0) {
+      lastProgressMs = millis();
+    } else if (millis() - lastProgressMs >= LOG_FLUSH_TIMEOUT_MS) {
+      return;
+    }
+  }
+}
+
+size_t LogPendingBytes() {
+  return s_used;
+}
+
+LogStats LogGetStats() {
+  LogStats stats = {s_written, s_dropped};
+  return stats;
+}
+
+/**
+ * @brief Empties the ring, clears the counters and detaches the sink.
+ */
+void LogReset() {
+  s_head = 0;
+  s_tail = 0;
+  s_used = 0;
+  s_sink = nullptr;
+  s_written = 0;
+  s_dropped = 0;
+  s_unreported = 0;
+}
@@ -1,12 +1,24 @@
 #include "platform.h"
 #include "core.h"
+#include "logger.h"
 
 #ifndef UNIT_TEST
 
+/**
+ * @brief Log sink: writes only what fits into the serial transmit buffer.
+ */
+static size_t SerialLogSink(const char* data, size_t len) {
+  const int room = Serial.availableForWrite();
+  if (room <= 0) return 0;
+  if (len > (size_t)room) len = (size_t)room;
+  return Serial.write((const uint8_t*)data, len);
+}
+
 void setup() {
   Serial.begin(9600);
   unsigned long startTime = millis();
   while (!Serial && (millis() - startTime < 3000));
+  LogBegin(SerialLogSink);
   CoreSetup();
 }
 
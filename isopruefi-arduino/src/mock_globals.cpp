@@ -4,9 +4,12 @@
 // Global mock objects for testing
 MockSdFat sd;
 MockRTC rtc;
+MockLowPower LowPower;
 MockTempSensor tempsensor;
+MockTempSensor* mockI2cTempSensor = &tempsensor;
 MockWiFiClass WiFi;
 MockWiFiClient wifiClient;
 MockMqttClient mqttClient(wifiClient);
+uintptr_t mockStackLowWater = UINTPTR_MAX;
 
 #endif
\ No newline at end of file
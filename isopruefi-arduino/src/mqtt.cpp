@@ -1,5 +1,12 @@
 #include "mqtt.h"
 #include "storage.h"
+#include "sensor.h"
+#include "publish_window.h"
+#include "recovery_stream.h"
+#include "staging_ring.h"
+#include "live_batch.h"
+#include "json_arena.h"
+#include "logger.h"
 
 // =============================================================================
 // BUFFER SIZE CONSTANTS
@@ -7,25 +14,25 @@
 
 /// Buffer size for small MQTT topics, payloads, and JSON documents
 static const size_t SMALL_BUFFER_SIZE = 128;
-/// Buffer size for large MQTT payloads and JSON documents (recovery data)
-static const size_t LARGE_BUFFER_SIZE = 2048;
-static const size_t FILE_NAME_BUFFER_SIZE = 64;
+/// Live payloads up to a full burst message; echoes are read into a buffer of the same size
+static const size_t LIVE_PAYLOAD_SIZE = SMALL_BUFFER_SIZE * 2;
+/// Recovery messages published per CoreLoop tick at most
 static const int MAX_RECOVERY_FILES_PER_LOOP = 3;
 
 // =============================================================================
 // FILE SYSTEM AND TIMING CONSTANTS
 // =============================================================================
 
-static const size_t FOLDER_NAME_BUFFER_SIZE = 8;
-static const size_t FULL_PATH_BUFFER_SIZE = 64;
-/// Buffer size for reading individual CSV lines
-static const size_t LINE_BUFFER_SIZE = 64;
 static const uint32_t SECONDS_IN_24_HOURS = 86400;
-/// Timeout for recovery operations in milliseconds (60 seconds)
-static const unsigned long RECOVERY_TIMEOUT_MS = 60000;
 static const unsigned long ACK_TIMEOUT_MS = 5000;
+/// Time a recovery message may wait for its echo before it is sent again
 static const unsigned long RECOVERY_ACK_TIMEOUT_MS  = 10000;
-static const unsigned long DELAY_POLLING_LOOP_MS = 10;
+/// Time a recovery tick may spend publishing, so live sampling never waits on backlog
+static const unsigned long RECOVERY_TICK_BUDGET_MS = 100;
+/// Pause after a failed or unacknowledged recovery publish
+static const unsigned long RECOVERY_RETRY_DELAY_MS = 5000;
+/// Publishes of one recovery message before recovery backs off
+static const uint8_t PUBLISH_MAX_ATTEMPTS = 3;
 
 // =============================================================================
 // ACK/ECHO-HANDLING 
@@ -40,11 +47,16 @@ static const unsigned long DELAY_POLLING_LOOP_MS = 10;
  * that published messages are confirmed before considering them delivered. If no acknowledgment is
  * received, data is saved for later recovery.
  *
- * - Uses topic-based filtering to only process echoes for the current publish topic
+ * By default (MQTT_ACK_PUBACK) messages are confirmed by the broker's PUBACK, matched by packet
+ * identifier through the transport layer (see mqtt_transport.h): no subscription, no downlink copy
+ * of the payload and no JSON scanning. MQTT_ACK_ECHO keeps the echo scheme below for brokers that
+ * need it.
+ *
+ * - Subscribes only to the publish and recovery topics, so every echo is one of ours
  * - Handles retained messages and ignores them for acknowledgment
  * - Extracts sequence numbers from JSON payloads for matching
  * - Registers a callback for incoming MQTT messages to detect PUBACK/echo
- * - Uses topic-based filtering to only process echoes for the current publish topic
+ * - Tells recovery echoes from live ones by their payload, without a String copy of the topic
  * - Handles retained messages and ignores them for acknowledgment
  * - Extracts sequence numbers from JSON payloads for matching
  * - Registers a callback for incoming MQTT messages to detect PUBACK/echo
@@ -53,10 +65,13 @@ static const unsigned long DELAY_POLLING_LOOP_MS = 10;
  * @note This logic is critical for QoS 1 delivery and robust offline recovery.
  */
 
-static volatile bool  s_ackSeen   = false;
-static volatile long  s_ackSeq    = -1;
-static String         s_pubTopic;           // z. B. "<prefix>temp/Sensor_Two"
+static char           s_pubTopic[SMALL_BUFFER_SIZE];       // z. B. "<prefix>temp/Sensor_Two"
+static char           s_recoveryTopic[SMALL_BUFFER_SIZE + sizeof("/recovered")];  // s_pubTopic + "/recovered"
+/// Memory of the live JSON documents; one is alive at a time
+static JsonArena      s_jsonArena;
 static bool           s_ackInit   = false;
+static MqttAckMode    s_ackMode   = MQTT_ACK_PUBACK;
+static size_t         s_messageLimit = RECOVERY_DEFAULT_MESSAGE_BYTES;
 
 /**
  * @brief Extracts the sequence number from a JSON string.
@@ -80,39 +95,143 @@ static bool ExtractSequence(const char* json, long& outSeq) {
   return true;
 }
 
+/**
+ * @brief Extracts the first recovered timestamp ("meta":{"t":[...]}) from a JSON string.
+ *
+ * The first timestamp identifies a recovery message: records are stored in time order,
+ * so no two recovery messages start with the same one. It sits near the start of the
+ * payload and survives the truncation of long echoes.
+ *
+ * @param json The JSON string to search
+ * @param outTs Reference to store the extracted timestamp
+ * @return true if a timestamp was found
+ */
+static bool ExtractFirstRecoveryTimestamp(const char* json, uint32_t& outTs) {
+  const char* p = strstr(json, "\"t\":[");
+  if (!p) return false;
+  p += 5; // length of "\"t\":["
+  char* end = nullptr;
+  outTs = strtoul(p, &end, 10);
+  return end != p;
+}
+
+/**
+ * @brief Extracts the first sample time of a burst ("meta":{"burst":...}) from a JSON string.
+ *
+ * Bursts carry no sequence number; only one is in flight at a time, so its
+ * timestamp identifies it.
+ *
+ * @param json The JSON string to search
+ * @param outTs Reference to store the extracted timestamp
+ * @return true if the message is a burst with a timestamp
+ */
+static bool ExtractBurstTimestamp(const char* json, uint32_t& outTs) {
+  if (!strstr(json, "\"burst\":")) return false;
+  const char* p = strstr(json, "\"timestamp\":");
+  if (!p) return false;
+  p += 12; // length of "\"timestamp\":"
+  char* end = nullptr;
+  outTs = strtoul(p, &end, 10);
+  return end != p;
+}
+
 /**
  * @brief MQTT message callback to detect PUBACK/echo for published messages.
  *
- * Processes incoming MQTT messages, filtering by MQTT_TOPIC and retain flag. If the message
- * is an echo for the current publish MQTT_TOPIC and not retained, extracts the sequence number
- * and sets acknowledgment flags.
+ * Processes incoming MQTT messages, filtering by the retain flag. Only the publish and
+ * recovery topics are subscribed, so every other message is an echo of one of ours. Echoes
+ * of recovery messages carry "meta":{"t":[...]} and are matched by their first recovered
+ * timestamp, burst echoes by their timestamp and other live echoes by their sequence
+ * number.
+ *
+ * The topic is not compared: messageTopic() returns a String copy, which would put a
+ * heap allocation on every inbound message.
  *
  * @param messageSize Size of the incoming message (needed because of the MQTT library's callback interface)
  */
 static void OnMqttEchoMessage(int messageSize) {
   (void)messageSize;
-  if (mqttClient.messageTopic() != s_pubTopic) return;
+  if (s_ackMode != MQTT_ACK_ECHO) return;
   if (mqttClient.messageRetain()) return;
 
-  static char buf[SMALL_BUFFER_SIZE * 2];
+  static char buf[LIVE_PAYLOAD_SIZE];
   int n = 0;
   while (mqttClient.available() && n < (int)sizeof(buf) - 1) {
     buf[n++] = mqttClient.read();
   }
   buf[n] = 0;
 
+  uint32_t ts;
+  if (ExtractFirstRecoveryTimestamp(buf, ts)) {
+    PublishWindowAck(true, ts);
+    return;
+  }
+
+  if (ExtractBurstTimestamp(buf, ts)) {
+    PublishEntry* burst = PublishWindowOldest(PUBLISH_BURST);
+    if (burst && burst->state == PUBLISH_IN_FLIGHT && burst->key == ts) burst->state = PUBLISH_ACKED;
+    return;
+  }
+
   long seq;
   if (ExtractSequence(buf, seq)) {
-    s_ackSeq  = seq;
-    s_ackSeen = true;
+    PublishWindowAck(false, (uint32_t)seq);
   }
 }
 
 /**
- * @brief Initializes ACK/Echo handling and subscribes to the publish MQTT_TOPIC.
+ * @brief Transport callback for every PUBACK received from the broker.
+ *
+ * @param packetId Packet identifier of the acknowledged PUBLISH
+ */
+static void OnMqttPuback(uint16_t packetId) {
+  if (s_ackMode == MQTT_ACK_PUBACK) PublishWindowAckPacket(packetId);
+}
+
+/**
+ * @brief Selects how published messages are confirmed.
+ *
+ * @param mode MQTT_ACK_PUBACK (default) or MQTT_ACK_ECHO for brokers whose PUBACK
+ *             cannot be relied on
+ */
+void SetMqttAckMode(MqttAckMode mode) {
+  s_ackMode = mode;
+}
+
+/**
+ * @brief Sets the largest recovery payload, e.g. to match the broker's message size limit.
+ *
+ * Recovery packs staged and outage log records and consecutive CSV batches into
+ * messages of up to this size. Payloads are streamed, so a larger limit
+ * costs no RAM, only broker and backend capacity.
+ *
+ * @param maxBytes Payload limit, clamped to RECOVERY_MIN_MESSAGE_BYTES..RECOVERY_MAX_MESSAGE_BYTES
+ */
+void SetRecoveryMessageLimit(size_t maxBytes) {
+  if (maxBytes < RECOVERY_MIN_MESSAGE_BYTES) maxBytes = RECOVERY_MIN_MESSAGE_BYTES;
+  if (maxBytes > RECOVERY_MAX_MESSAGE_BYTES) maxBytes = RECOVERY_MAX_MESSAGE_BYTES;
+  s_messageLimit = maxBytes;
+}
+
+/**
+ * @brief Sends live readings in batches instead of one message each.
+ *
+ * A batch is published once it holds the given number of readings or its
+ * oldest reading waited maxLatencyMs, whichever comes first; see live_batch.h.
  *
- * Sets up the publish MQTT_TOPIC and registers the MQTT message callback for echo detection.
- * Ensures the callback is registered only once, and re-subscribes to the MQTT_TOPIC after each reconnect.
+ * @param readings Readings per message, clamped to 1..LIVE_BATCH_MAX_RECORDS; 1 turns batching off
+ * @param maxLatencyMs Longest time a reading waits for its batch
+ */
+void SetLiveBatching(uint8_t readings, unsigned long maxLatencyMs) {
+  LiveBatchConfigure(readings, maxLatencyMs);
+}
+
+/**
+ * @brief Initializes ACK handling and, in echo mode, subscribes to the publish and recovery topics.
+ *
+ * Sets up the publish MQTT_TOPIC and registers the PUBACK handler and the MQTT message callback
+ * for echo detection. Ensures the callbacks are registered only once, and re-subscribes to the
+ * MQTT_TOPIC after each reconnect when echo mode is used.
  *
  * @param client Reference to the MQTT client
  * @param topicPrefix Topic prefix for MQTT publishing
@@ -121,19 +240,20 @@ static void OnMqttEchoMessage(int messageSize) {
  */
 static void EnsureAckInit(MqttClient& client, const char* topicPrefix, const char* sensorType, const char* sensorId) {
   if (!s_ackInit) {
-    char fullTopic[SMALL_BUFFER_SIZE];
     if (sensorType && sensorId) {
-      snprintf(fullTopic, sizeof(fullTopic), "%s%s/%s", topicPrefix, sensorType, sensorId);
-      s_pubTopic = fullTopic;
+      snprintf(s_pubTopic, sizeof(s_pubTopic), "%s%s/%s", topicPrefix, sensorType, sensorId);
+      snprintf(s_recoveryTopic, sizeof(s_recoveryTopic), "%s/recovered", s_pubTopic);
       s_ackInit  = true;
     } else {
       return; 
     }
     client.onMessage(OnMqttEchoMessage); // Callback register
+    MqttTransportSetPubackHandler(OnMqttPuback);
   }
 
-  if (client.connected()) {
-    client.subscribe(s_pubTopic.c_str());
+  if (s_ackMode == MQTT_ACK_ECHO && client.connected()) {
+    client.subscribe(s_pubTopic);
+    client.subscribe(s_recoveryTopic);
   }
 }
 
@@ -148,17 +268,377 @@ void CreateFullTopic(char* buffer, size_t bufferSize, const char* topicPrefix,
   }
 }
 
+// =============================================================================
+// PUBLISH WINDOW
+// =============================================================================
+
+/**
+ * @defgroup PublishPipeline Pipelined QoS 1 Publishing
+ * @brief Keeps several unacknowledged messages in flight instead of stop-and-wait.
+ *
+ * Every QoS 1 publish claims a slot in the publish window (see publish_window.h)
+ * and returns right away. Acks are matched back to their slot by
+ * OnMqttEchoMessage(), and ServicePublishWindow() settles the window once per
+ * loop:
+ *
+ * - acknowledged live readings are released
+ * - acknowledged recovery messages consume their staging ring or outage log
+ *   records (in ring or log order) or delete their CSV batches
+ * - a live reading without ack after ACK_TIMEOUT_MS is staged for recovery
+ * - a recovery message without ack after RECOVERY_ACK_TIMEOUT_MS is published
+ *   again, up to PUBLISH_MAX_ATTEMPTS times, then recovery backs off
+ *
+ * Only the messages that actually time out are retried or spilled; messages
+ * behind them in the window are not affected.
+ */
+
+enum RecoveryState {
+  RECOVERY_ACTIVE,
+  RECOVERY_BACKOFF,
+  RECOVERY_COMPLETE
+};
+
+enum PublishResult {
+  PUBLISH_STARTED,
+  PUBLISH_NOTHING_LEFT,
+  PUBLISH_FAILED
+};
+
+static RecoveryState  s_recoveryState = RECOVERY_COMPLETE;
+static unsigned long  s_recoveryStateSince = 0;
+/// Manifest position of this run, so a batch that cannot be sent does not block the rest
+static RecoveryPosition s_nextCsv = {0, 0};
+/// Acknowledged prefix of a partly sent batch, so a restarted run does not send it again
+static char           s_resumePath[BATCH_PATH_BYTES] = "";
+static uint32_t       s_resumeOffset = 0;
+static int            s_sentCount = 0;
+
+static void EnterRecoveryState(RecoveryState state) {
+  s_recoveryState = state;
+  s_recoveryStateSince = millis();
+}
+
+/// Keeps staged readings that are part of in-flight messages from being spilled to the card
+static void HoldStagedRecords() {
+  StagingRingHold(PublishWindowRecordsBefore(nullptr, PUBLISH_RECOVERY_RAM));
+}
+
+/// Remembers the packet identifier of the PUBLISH just written, the PUBACK match key
+static void RememberPacketId(PublishEntry* entry) {
+  entry->packetId = s_ackMode == MQTT_ACK_PUBACK ? MqttTransportLastPublishId() : 0;
+}
+
+/**
+ * @brief Publishes one QoS 1 message and remembers its packet identifier in the window entry.
+ *
+ * @return true if the message was handed to the client
+ */
+static bool PublishPayload(MqttClient& mqttClient, const char* fullTopic, const char* payload,
+                           PublishEntry* entry) {
+  if (!mqttClient.beginMessage(fullTopic, false, 1)) return false;
+  mqttClient.print(payload);
+  if (!mqttClient.endMessage()) return false;
+  RememberPacketId(entry);
+  return true;
+}
+
+/**
+ * @brief Streams a measured recovery message from the card to the broker as one QoS 1 publish.
+ *
+ * The payload length is announced in beginMessage(), so the client writes the
+ * bytes to the socket as they are printed instead of buffering the message.
+ * If the card no longer delivers the measured records, the announced length
+ * cannot be met and the connection is dropped rather than left out of step;
+ * the reconnect starts recovery over.
+ *
+ * @return true if the message was handed to the client
+ */
+static bool PublishRecoveryMessage(MqttClient& mqttClient, const char* fullTopic, RecoveryRecordSource& source,
+                                   const RecoveryMessageInfo& info, uint32_t timestamp, PublishEntry* entry) {
+  if (!mqttClient.beginMessage(fullTopic, (unsigned long)info.bytes, false, 1)) return false;
+  if (!RecoveryStreamMessage(mqttClient, source, timestamp, info)) {
+    LOG_WARN("Recovery data changed while streaming → reconnecting.");
+    mqttClient.stop();
+    return false;
+  }
+  if (!mqttClient.endMessage()) return false;
+  RememberPacketId(entry);
+  return true;
+}
+
+/**
+ * @brief Publishes a recovery message that timed out once more.
+ *
+ * The payload is streamed from RAM or the card again: the records are still
+ * there because nothing is consumed or deleted before its ack.
+ *
+ * @return true if the message was handed to the client again
+ */
+static bool RepublishRecoveryEntry(MqttClient& mqttClient, PublishEntry* entry, const DateTime& now,
+                                   unsigned long nowMs) {
+  const uint32_t timestamp = now.unixtime();
+  RecoveryMessageInfo info;
+  bool published;
+
+  if (entry->kind != PUBLISH_RECOVERY_CSV) {
+    OutageRecordPeek peek = entry->kind == PUBLISH_RECOVERY_RAM ? StagingRingPeek : OutageLogPeek;
+    OutageLogRecordSource source(PublishWindowRecordsBefore(entry), entry->records, peek);
+    if (!RecoveryMeasure(source, timestamp, RECOVERY_MAX_MESSAGE_BYTES, info) || info.records != entry->records) {
+      return false;
+    }
+    published = PublishRecoveryMessage(mqttClient, s_recoveryTopic, source, info, timestamp, entry);
+  } else {
+    CsvManifestRecordSource source(entry->start, 0, entry->records);
+    if (!RecoveryMeasure(source, timestamp, RECOVERY_MAX_MESSAGE_BYTES, info) || info.records != entry->records) {
+      return false;
+    }
+    published = PublishRecoveryMessage(mqttClient, s_recoveryTopic, source, info, timestamp, entry);
+  }
+
+  if (!published) return false;
+  entry->attempts++;
+  entry->sentAtMs = nowMs;
+  return true;
+}
+
+/**
+ * @brief Removes the CSV batches an acknowledged message fully covered.
+ *
+ * Every pending batch before entry->end is deleted. A batch the message
+ * ends in the middle of stays on the card; the acknowledged part is
+ * remembered so the next message continues after it. Older messages are
+ * settled already, so nothing before entry->start is still waiting.
+ */
+static void SettleCsvMessage(const PublishEntry* entry) {
+  for (uint16_t index = entry->start.batch; index < entry->end.batch; index++) {
+    BatchEntry batch;
+    if (!BatchManifestRead(index, batch) || batch.state != BATCH_PENDING) continue;
+    LOG_DEBUG("Published and deleting file.");
+    DeleteCsvFile(batch.path);
+  }
+
+  s_resumePath[0] = '\0';
+  BatchEntry partial;
+  if (entry->end.offset > 0 && BatchManifestRead(entry->end.batch, partial)) {
+    strncpy(s_resumePath, partial.path, sizeof(s_resumePath));
+    s_resumePath[sizeof(s_resumePath) - 1] = '\0';
+    s_resumeOffset = entry->end.offset;
+  }
+}
+
+/**
+ * @brief Publishes the queued live readings as one message once the batch is due.
+ *
+ * The batch uses the recovery message format (see recovery_stream.h) on the
+ * recovery topic, which already carries one timestamp, value and sequence
+ * per reading. Without a connection, or if the publish fails, the whole
+ * batch goes to the staging ring.
+ *
+ * @param timestamp Send time written into the message
+ * @param nowMs millis() now, for the batch latency
+ */
+static void ServiceLiveBatch(MqttClient& mqttClient, uint32_t timestamp, unsigned long nowMs) {
+  if (!LiveBatchDue(nowMs)) return;
+
+  if (!s_ackInit || !mqttClient.connected()) {
+    LOG_WARN("MQTT not connected → staging live batch for recovery.");
+    LiveBatchSpillQueued(nowMs);
+    return;
+  }
+
+  const size_t count = LiveBatchStart();
+  OutageLogRecordSource source(0, count, LiveBatchPeekInFlight);
+  RecoveryMessageInfo info;
+  PublishEntry* entry = nullptr;
+  if (RecoveryMeasure(source, timestamp, RECOVERY_MAX_MESSAGE_BYTES, info)) {
+    entry = PublishWindowAdd(PUBLISH_LIVE_BATCH, info.firstTimestamp, nowMs);
+  }
+  if (!entry || !PublishRecoveryMessage(mqttClient, s_recoveryTopic, source, info, timestamp, entry)) {
+    if (entry) PublishWindowRelease(entry);
+    LOG_WARN("Live batch not published → staging for recovery.");
+    LiveBatchSpill(nowMs);
+    return;
+  }
+  entry->records = (uint16_t)count;
+
+  LOG_DEBUG("Published live batch: %lu", (unsigned long)count);
+}
+
+/**
+ * @brief Settles acknowledged and timed-out messages of the publish window.
+ *
+ * Called by CoreLoop() once per loop and by every recovery tick. Polls the
+ * client first so that pending acks are matched.
+ *
+ * @param mqttClient Reference to the MQTT client instance
+ * @param now Current timestamp, used when a recovery payload has to be rebuilt
+ */
+void ServicePublishWindow(MqttClient& mqttClient, const DateTime& now) {
+  mqttClient.poll();
+
+  // Acknowledged messages: remove their data from the card
+  PublishEntry* entry;
+  while ((entry = PublishWindowNextSettled(PUBLISH_LIVE)) != nullptr) {
+    PublishWindowRelease(entry);
+  }
+  while ((entry = PublishWindowNextSettled(PUBLISH_BURST)) != nullptr) {
+    PublishWindowRelease(entry);
+  }
+  while ((entry = PublishWindowNextSettled(PUBLISH_LIVE_BATCH)) != nullptr) {
+    LiveBatchSettle();
+    PublishWindowRelease(entry);
+  }
+  while ((entry = PublishWindowNextSettled(PUBLISH_RECOVERY_RAM)) != nullptr) {
+    StagingRingConsume(entry->records);
+    PublishWindowRelease(entry);
+    s_sentCount++;
+  }
+  while ((entry = PublishWindowNextSettled(PUBLISH_RECOVERY_LOG)) != nullptr) {
+    OutageLogConsume(entry->records);
+    PublishWindowRelease(entry);
+    s_sentCount++;
+  }
+  while ((entry = PublishWindowNextSettled(PUBLISH_RECOVERY_CSV)) != nullptr) {
+    SettleCsvMessage(entry);
+    PublishWindowRelease(entry);
+    s_sentCount++;
+  }
+
+  // Timed-out live readings are kept for recovery
+  const unsigned long nowMs = millis();
+  while ((entry = PublishWindowNextExpired(PUBLISH_LIVE, nowMs, ACK_TIMEOUT_MS)) != nullptr) {
+    LOG_WARN("No Echo/PUBACK within timeout → staging for recovery.");
+    StagingRingPush(entry->record, nowMs);
+    PublishWindowRelease(entry);
+  }
+  // Burst samples are also in the interval aggregate, so a lost burst is only dropped
+  while ((entry = PublishWindowNextExpired(PUBLISH_BURST, nowMs, ACK_TIMEOUT_MS)) != nullptr) {
+    LOG_WARN("No Echo/PUBACK for burst → dropped.");
+    PublishWindowRelease(entry);
+  }
+  while ((entry = PublishWindowNextExpired(PUBLISH_LIVE_BATCH, nowMs, ACK_TIMEOUT_MS)) != nullptr) {
+    LOG_WARN("No Echo/PUBACK for live batch → staging for recovery.");
+    LiveBatchSpill(nowMs);
+    PublishWindowRelease(entry);
+  }
+
+  // Queued live readings whose batch is full or waited long enough
+  ServiceLiveBatch(mqttClient, now.unixtime(), nowMs);
+
+  // Timed-out recovery messages are published again, the rest of the window keeps going
+  PublishKind recoveryKinds[] = {PUBLISH_RECOVERY_RAM, PUBLISH_RECOVERY_LOG, PUBLISH_RECOVERY_CSV};
+  for (PublishKind kind : recoveryKinds) {
+    while ((entry = PublishWindowNextExpired(kind, nowMs, RECOVERY_ACK_TIMEOUT_MS)) != nullptr) {
+      if (entry->attempts >= PUBLISH_MAX_ATTEMPTS || !RepublishRecoveryEntry(mqttClient, entry, now, nowMs)) {
+        LOG_WARN("No Echo/PUBACK for recovered data → retrying later.");
+        PublishWindowReleaseRecovery();
+        HoldStagedRecords();
+        EnterRecoveryState(RECOVERY_BACKOFF);
+        return;
+      }
+      LOG_INFO("No Echo/PUBACK for recovered data → published again.");
+    }
+  }
+}
+
 // =============================================================================
 // REAL-TIME DATA TRANSMISSION FUNCTIONS
 // =============================================================================
 
+/**
+ * @brief Gives up on a live message: a reading is staged for recovery, a burst is dropped.
+ */
+static void AbandonLiveRecord(PublishKind kind, const OutageRecord& record, const char* reason) {
+  if (kind == PUBLISH_BURST) {
+    LOG_WARN("%s → burst dropped.", reason);
+    return;
+  }
+  LOG_WARN("%s → staging for recovery.", reason);
+  StageRecord(record);
+}
+
+/**
+ * @brief Publishes a live JSON document, or stages its record when that is not possible.
+ *
+ * With live batching on (see SetLiveBatching()) a reading is queued instead
+ * and published with the next batch.
+ *
+ * @param kind PUBLISH_LIVE, or PUBLISH_BURST for a burst that is dropped instead of staged
+ * @param key Publish window key its echo is matched by: the sequence of a
+ *            reading, the timestamp of a burst
+ * @param record Record the document was built from; staged on failure, kept
+ *               in the publish window until the ack arrives
+ * @param jsonDoc Live document, see BuildJson()
+ * @return true if handed to the broker, false if staged (or dropped) right away
+ */
+static bool PublishLiveRecord(MqttClient& mqttClient, const char* topicPrefix, const char* sensorType,
+                              const char* sensorId, PublishKind kind, uint32_t key, const OutageRecord& record,
+                              JsonDocument& jsonDoc) {
+  if (!sensorType || !sensorId || !*sensorType || !*sensorId) {
+    AbandonLiveRecord(kind, record, "Invalid MQTT topic");
+    return false;
+  }
+
+  EnsureAckInit(mqttClient, topicPrefix, sensorType, sensorId);
+
+  mqttClient.poll();
+
+  if (kind == PUBLISH_LIVE && LiveBatchSize() > 1) {
+    if (!mqttClient.connected()) {
+      AbandonLiveRecord(kind, record, "MQTT not connected");
+      return false;
+    }
+    const unsigned long nowMs = millis();
+    if (!LiveBatchAdd(record, nowMs)) {
+      AbandonLiveRecord(kind, record, "Live batch full");
+      return false;
+    }
+    ServiceLiveBatch(mqttClient, record.timestamp, nowMs);
+    return true;
+  }
+
+  char fullTopic[SMALL_BUFFER_SIZE];
+  CreateFullTopic(fullTopic, sizeof(fullTopic), topicPrefix, sensorType, sensorId);
+
+  if (jsonDoc.overflowed()) {
+    AbandonLiveRecord(kind, record, "JSON arena exhausted");
+    return false;
+  }
+  char payload[LIVE_PAYLOAD_SIZE];
+  serializeJson(jsonDoc, payload, sizeof(payload));
+
+  if (!mqttClient.connected()) {
+    AbandonLiveRecord(kind, record, "MQTT not connected");
+    return false;
+  }
+
+  PublishEntry* entry = PublishWindowAdd(kind, key, millis());
+  if (!entry) {
+    AbandonLiveRecord(kind, record, "Publish window full");
+    return false;
+  }
+
+  if (!PublishPayload(mqttClient, fullTopic, payload, entry)) {
+    PublishWindowRelease(entry);
+    AbandonLiveRecord(kind, record, "MQTT publish failed");
+    return false;
+  }
+
+  // Kept until the ack arrives, staged for recovery if it does not
+  entry->record = record;
+
+  LOG_INFO("Published to %s", fullTopic);
+  LOG_DEBUG("%s", payload);
+  return true;
+}
+
 /**
  * @brief Publishes real-time sensor data to the MQTT broker with QoS 1 delivery.
  *
  * This function builds a JSON payload from the provided sensor data and publishes it
- * to the specified MQTT topic. After publishing, it waits briefly for a PUBACK
- * handshake from the broker to confirm delivery. If no acknowledgment is received within
- * the timeout window, the data is saved to a CSV file for later recovery.
+ * to the specified MQTT topic without waiting for the broker. The reading stays in
+ * the publish window until its echo/PUBACK arrives; ServicePublishWindow() stages it
+ * for recovery if that does not happen within ACK_TIMEOUT_MS.
  *
  * @param mqttClient Reference to the MQTT client instance
  * @param topicPrefix Topic prefix for MQTT publishing (e.g., "dhbw/ai/si2023/2/")
@@ -167,218 +647,324 @@ void CreateFullTopic(char* buffer, size_t bufferSize, const char* topicPrefix,
  * @param celsius Measured temperature value in Celsius
  * @param now Current timestamp (DateTime)
  * @param sequence Sequence number for the measurement
- * @return true if published and acknowledged by broker, false if fallback to CSV
+ * @return true if handed to the broker, false if staged for recovery right away
  *
- * @note Uses QoS 1 for reliable delivery. If broker does not echo/PUBACK within
- *       the timeout, data is persisted for later transmission.
+ * @note Uses QoS 1 for reliable delivery. Returning true does not mean the broker
+ *       acknowledged the message yet.
  */
 bool SendTempToMqtt(MqttClient& mqttClient, const char* topicPrefix, const char* sensorType,
                 const char* sensorId, float celsius, const DateTime& now, int sequence) {
-  EnsureAckInit(mqttClient, topicPrefix, sensorType, sensorId);
+  OutageRecord record = {};
+  record.timestamp = now.unixtime();
+  record.sequence = (uint32_t)sequence;
+  record.rawTemp = CelsiusToRawTemp(celsius);
+
+  JsonDocument jsonDoc(&s_jsonArena);
+  BuildJson(jsonDoc, record);
+  return PublishLiveRecord(mqttClient, topicPrefix, sensorType, sensorId, PUBLISH_LIVE, record.sequence, record,
+                           jsonDoc);
+}
 
-  mqttClient.poll();
+/**
+ * @brief Publishes the aggregate of a reporting interval like SendTempToMqtt() does a reading.
+ *
+ * The aggregate travels in the value array (see BuildJson()); staged for
+ * recovery, it stays one record with the same statistics.
+ *
+ * @param aggregate Samples of the interval
+ * @param now Timestamp of the interval
+ * @param sequence Sequence number of the interval
+ * @return true if handed to the broker, false if staged for recovery right away
+ */
+bool SendAggregateToMqtt(MqttClient& mqttClient, const char* topicPrefix, const char* sensorType,
+                         const char* sensorId, const SampleAggregate& aggregate, const DateTime& now,
+                         int sequence) {
+  const OutageRecord record = MakeAggregateRecord(now, aggregate, sequence);
+
+  JsonDocument jsonDoc(&s_jsonArena);
+  BuildJson(jsonDoc, record);
+  return PublishLiveRecord(mqttClient, topicPrefix, sensorType, sensorId, PUBLISH_LIVE, record.sequence, record,
+                           jsonDoc);
+}
 
-  char fullTopic[SMALL_BUFFER_SIZE];
-  CreateFullTopic(fullTopic, sizeof(fullTopic), topicPrefix, sensorType, sensorId);
+/**
+ * @brief Publishes the samples of a burst as one multi-value message.
+ *
+ * The samples are also part of their interval aggregate, so a burst that
+ * cannot be published, or is not acknowledged, is dropped rather than staged.
+ *
+ * @param burst Evenly spaced samples, see BurstSampler
+ * @return true if handed to the broker
+ */
+bool SendBurstToMqtt(MqttClient& mqttClient, const char* topicPrefix, const char* sensorType,
+                     const char* sensorId, const BurstMessage& burst) {
+  OutageRecord record = {};
+  record.timestamp = burst.timestamp;
+
+  JsonDocument jsonDoc(&s_jsonArena);
+  BuildJson(jsonDoc, burst);
+  // A burst has no sequence number; its echo is matched by the timestamp
+  return PublishLiveRecord(mqttClient, topicPrefix, sensorType, sensorId, PUBLISH_BURST, burst.timestamp, record,
+                           jsonDoc);
+}
 
-  StaticJsonDocument<SMALL_BUFFER_SIZE> jsonDoc;
-  BuildJson(jsonDoc, celsius, now, sequence);
+// =============================================================================
+// DATA RECOVERY AND OFFLINE TRANSMISSION FUNCTIONS
+// =============================================================================
 
-  char payload[SMALL_BUFFER_SIZE];
-  serializeJson(jsonDoc, payload, sizeof(payload));
+/**
+ * @defgroup RecoveryStateMachine Incremental Recovery
+ * @brief Drains the offline backlog in small, bounded steps from CoreLoop().
+ *
+ * Each call of SendPendingDataToMqtt() settles the publish window once and
+ * publishes at most MAX_RECOVERY_FILES_PER_LOOP new messages, stopping early
+ * once RECOVERY_TICK_BUDGET_MS is spent:
+ *
+ * - RECOVERY_ACTIVE:   keep the publish window filled with the next batches
+ *                      (staging ring first, then the outage log, then legacy
+ *                      CSV batches) and drop
+ *                      stale data; acks and timeouts are settled by
+ *                      ServicePublishWindow()
+ * - RECOVERY_BACKOFF:  wait after a failed publish or a batch that was never
+ *                      acknowledged; all batches stay on the card and are sent again
+ * - RECOVERY_COMPLETE: nothing left; the next call starts a new run
+ *
+ * The state survives between ticks, so no call ever waits for an ack; the
+ * publish task collects them in between, and live sampling keeps its schedule.
+ */
 
-  // Reset ACK-Flags
-  s_ackSeen = false;
-  s_ackSeq  = -1;
+/**
+ * @brief Publishes the oldest staging ring readings that are not in flight.
+ *
+ * The ring spills readings to the outage log long before they are 24h old,
+ * so there is nothing stale to drop here.
+ */
+static PublishResult PublishNextStagedBatch(MqttClient& mqttClient, const char* fullTopic, const DateTime& now) {
+  const uint32_t timestamp = now.unixtime();
+  OutageLogRecordSource source(PublishWindowRecordsBefore(nullptr, PUBLISH_RECOVERY_RAM), SIZE_MAX, StagingRingPeek);
 
+  RecoveryMessageInfo info;
+  if (!RecoveryMeasure(source, timestamp, s_messageLimit, info)) return PUBLISH_NOTHING_LEFT;
 
-  if (mqttClient.beginMessage(fullTopic, false, 1)) {
-    mqttClient.print(payload);
-    if (!mqttClient.endMessage()) {
-      Serial.println("MQTT endMessage() failed → saving to CSV.");
-      SaveTempToBatchCsv(now, celsius, sequence);
-      return false;
+  PublishEntry* entry = PublishWindowAdd(PUBLISH_RECOVERY_RAM, info.firstTimestamp, millis());
+  if (!entry) return PUBLISH_FAILED;
+  entry->records = (uint16_t)info.records;
+
+  LOG_INFO("Publishing staged records: %lu", (unsigned long)info.records);
+
+  if (!PublishRecoveryMessage(mqttClient, fullTopic, source, info, timestamp, entry)) {
+    PublishWindowRelease(entry);
+    return PUBLISH_FAILED;
+  }
+  HoldStagedRecords();
+  return PUBLISH_STARTED;
+}
+
+/**
+ * @brief Publishes the oldest outage log records that are not in flight and not older than 24h.
+ *
+ * Stale records form a prefix (the log is in time order) and are consumed
+ * without being sent, which is only possible while nothing is in flight.
+ */
+static PublishResult PublishNextOutageLogBatch(MqttClient& mqttClient, const char* fullTopic, const DateTime& now) {
+  const uint32_t timestamp = now.unixtime();
+
+  while (true) {
+    const uint32_t inFlight = PublishWindowRecordsBefore(nullptr);
+    OutageLogRecordSource source(inFlight, SIZE_MAX);
+
+    RecoveryRecord record;
+    size_t stale = 0;
+    while (inFlight == 0 && source.Next(record) && record.timestamp + SECONDS_IN_24_HOURS < timestamp) {
+      stale++;
+    }
+    if (stale > 0) {
+      LOG_WARN("Discarding outage log records older than 24h.");
+      OutageLogConsume(stale);
+      continue;
     }
 
-    // delay for a short window to allow poll() to process the PUBACK/echo
-    unsigned long startTime = millis();
-    bool ackOk = false;
-    while (millis() - startTime < ACK_TIMEOUT_MS) {
-      mqttClient.poll();
-      if (s_ackSeen && s_ackSeq == sequence) {
-        ackOk = true;
-        break;
-      }
-      delay(DELAY_POLLING_LOOP_MS);
+    RecoveryMessageInfo info;
+    if (!RecoveryMeasure(source, timestamp, s_messageLimit, info)) return PUBLISH_NOTHING_LEFT;
+
+    PublishEntry* entry = PublishWindowAdd(PUBLISH_RECOVERY_LOG, info.firstTimestamp, millis());
+    if (!entry) return PUBLISH_FAILED;
+    entry->records = (uint16_t)info.records;
+
+    LOG_INFO("Publishing recovered records: %lu", (unsigned long)info.records);
+
+    if (!PublishRecoveryMessage(mqttClient, fullTopic, source, info, timestamp, entry)) {
+      PublishWindowRelease(entry);
+      return PUBLISH_FAILED;
+    }
+    return PUBLISH_STARTED;
+  }
+}
+
+/**
+ * @brief Publishes the next message of the pending legacy CSV batches listed in the batch manifest.
+ *
+ * Records of consecutive batches are packed into one message up to the
+ * recovery message limit (see SetRecoveryMessageLimit()), so a backlog of
+ * small batches costs one round trip per message instead of one per file.
+ * A message may end in the middle of a batch; the next one continues at
+ * that byte offset. Batches that are too old or cannot be read are marked
+ * skipped in the manifest and never visited again.
+ */
+static PublishResult PublishNextCsvBatch(MqttClient& mqttClient, const char* fullTopic, const DateTime& now) {
+  const uint32_t timestamp = now.unixtime();
+  const uint16_t batchCount = BatchManifestCount();
+  if (s_nextCsv.batch < BatchManifestFirstPending()) {
+    s_nextCsv.batch = BatchManifestFirstPending();
+    s_nextCsv.offset = 0;
+  }
+
+  for (; s_nextCsv.batch < batchCount; s_nextCsv.batch++, s_nextCsv.offset = 0) {
+    BatchEntry batch;
+    if (!BatchManifestRead(s_nextCsv.batch, batch) || batch.state != BATCH_PENDING) continue;
+
+    // Validate batch age from the manifest (skip batches older than 24 hours)
+    if (timestamp - batch.firstTimestamp > SECONDS_IN_24_HOURS) {
+      LOG_WARN("Skipping old CSV file (>24h): %s", batch.path);
+      BatchManifestSetState(s_nextCsv.batch, BATCH_SKIPPED);
+      continue;
     }
 
-    if (!ackOk) {
-      Serial.println("No Echo/PUBACK within timeout → saving to CSV.");
-      SaveTempToBatchCsv(now, celsius, sequence);
-      return false;
+    // The acknowledged part of a partly sent batch is not sent again
+    if (s_nextCsv.offset == 0 && strcmp(batch.path, s_resumePath) == 0) s_nextCsv.offset = s_resumeOffset;
+
+    // Following batches join the message until it is full or one of them is too old
+    CsvManifestRecordSource source(s_nextCsv, timestamp - SECONDS_IN_24_HOURS, SIZE_MAX);
+    RecoveryMessageInfo info;
+    if (!RecoveryMeasure(source, timestamp, s_messageLimit, info)) {
+      LOG_WARN("No valid data in: %s", batch.path);
+      BatchManifestSetState(s_nextCsv.batch, BATCH_SKIPPED);
+      continue;
     }
 
-    Serial.print("Published to ");
-    Serial.println(fullTopic);
-    Serial.println(payload);
-    return true;
-  } else {
-    Serial.println("MQTT beginMessage() failed → saving to CSV.");
-    SaveTempToBatchCsv(now, celsius, sequence);
-    return false;
+    PublishEntry* entry = PublishWindowAdd(PUBLISH_RECOVERY_CSV, info.firstTimestamp, millis());
+    if (!entry) return PUBLISH_FAILED;
+    entry->records = (uint16_t)info.records;
+    entry->start = s_nextCsv;
+    entry->end = info.end;
+
+    LOG_INFO("Publishing recovered CSV from: %s, records: %lu", batch.path, (unsigned long)info.records);
+
+    if (!PublishRecoveryMessage(mqttClient, fullTopic, source, info, timestamp, entry)) {
+      PublishWindowRelease(entry);
+      return PUBLISH_FAILED;
+    }
+    s_nextCsv = info.end;
+    return PUBLISH_STARTED;
   }
+  return PUBLISH_NOTHING_LEFT;
 }
 
-// =============================================================================
-// DATA RECOVERY AND OFFLINE TRANSMISSION FUNCTIONS
-// =============================================================================
+/**
+ * @brief Drops any in-flight recovery batches and starts over with the next call.
+ *
+ * Call after a reconnect: acks from the previous session will not arrive,
+ * and the unacknowledged batches are still in RAM or on the card, so they are simply sent again.
+ */
+void ResetRecovery() {
+  PublishWindowReleaseRecovery();
+  HoldStagedRecords();
+  s_recoveryState = RECOVERY_COMPLETE;
+}
 
 /**
- * @brief Processes and transmits pending CSV files from offline periods to the MQTT broker.
+ * @brief Advances the recovery of data from offline periods by one bounded step.
  *
- * This function scans the SD card for CSV files containing unsent sensor data from previous offline periods.
- * Each file is converted to a JSON payload and published to the MQTT topic <topic>/recovered with QoS 1.
- * After publishing, it waits briefly for a PUBACK handshake from the broker to confirm delivery.
- * If the PUBACK is not received within the timeout period, the file is saved for later transmission.
- * Files are only deleted if the publish operation succeeds. Files older than 24 hours or with invalid data are skipped.
+ * Recovery first drains the readings staged in RAM (see staging_ring.h), then the
+ * outage log (see outage_log.h), then the legacy CSV batches
+ * written by firmware versions before the outage log, as listed in the batch manifest
+ * (see batch_manifest.h). Records are packed into JSON payloads of up to the recovery
+ * message limit (see SetRecoveryMessageLimit()), across batch boundaries, and published
+ * to the MQTT topic <topic>/recovered with QoS 1. Up to PublishWindowSize() messages wait
+ * for their ack at the same time, so throughput scales with the window on a slow link.
+ * Records are only consumed and files only deleted once the broker acknowledged every
+ * message they were part of; unacknowledged messages are sent again. Data older than
+ * 24 hours or with invalid content is skipped.
+ *
+ * A call never waits for acks: it settles what has arrived, publishes at most
+ * MAX_RECOVERY_FILES_PER_LOOP new messages while RECOVERY_TICK_BUDGET_MS lasts (the
+ * last SD read and publish may run over), and returns once nothing more can be published.
+ * The state is kept between calls, so CoreLoop() calls this once per recovery period
+ * until it returns true.
  *
  * @param mqttClient Reference to the MQTT client instance
  * @param topicPrefix Topic prefix for MQTT publishing (e.g., "dhbw/ai/si2023/2/")
  * @param sensorType Sensor type string (e.g., "temp")
  * @param sensorId Unique sensor identifier
  * @param now Current timestamp (DateTime)
- * @return true if all valid files were published and deleted, false if any files remain or errors occurred
+ * @return true once all pending data was published and acknowledged, false while recovery continues
  *
- * @note Uses QoS 1 for reliable delivery. Skips files older than 24 hours or with invalid content. Aborts if recovery exceeds time limit.
+ * @note Uses QoS 1 for reliable delivery.
+ * @see ResetRecovery(), ServicePublishWindow()
  */
 bool SendPendingDataToMqtt(MqttClient& mqttClient, const char* topicPrefix, const char* sensorType,
                      const char* sensorId, const DateTime& now) {
-  Serial.println("Looking for pending CSV files...");
-
-  // Track processing time to prevent infinite loops
-  const unsigned long startMillis = millis();
-  bool allFilesSent = true;
-
-  // Open the current date folder
-  char folder[FOLDER_NAME_BUFFER_SIZE];
-  strncpy(folder, CreateFolderName(now), sizeof(folder));
-  File root = sd.open(folder);
-  if (!root) {
-    Serial.println("No folder found for pending data.");
-    return true;
-  }
-
-  // Initialize processing counters
-  int sentCount = 0;
-  int checkedFiles = 0;
-  int skippedEmptyFiles = 0;
-
-  File entry;
-  while ((entry = root.openNextFile())) {
-    if (entry.isDirectory()) continue;
-
-    char filename[FILE_NAME_BUFFER_SIZE];
-    entry.getName(filename, sizeof(filename));
-    entry.close();
-
-    String nameStr(filename);
-    if (!nameStr.endsWith(".csv")) continue;
-
-    checkedFiles++;
-
-    // Validate file age (skip files older than 24 hours)
-    char fullPath[FULL_PATH_BUFFER_SIZE];
-    snprintf(fullPath, sizeof(fullPath), "%s/%s", folder, filename);
-    File tsFile = sd.open(fullPath, FILE_READ);
-    if (tsFile) {
-      char line[LINE_BUFFER_SIZE];
-      if (tsFile.fgets(line, sizeof(line)) > 0) {
-        char* p = strtok(line, ",");
-        if (p) {
-          Serial.print("Malformed CSV line (no timestamp): ");
-          Serial.println(line);
-          uint32_t ts = atol(p);
-          if (now.unixtime() - ts > SECONDS_IN_24_HOURS) {
-            Serial.print("Skipping old CSV file (>24h): ");
-            Serial.println(nameStr);
-            tsFile.close();
-            continue;
-          }
-        }
-      }
-      tsFile.close();
-    }
+  EnsureAckInit(mqttClient, topicPrefix, sensorType, sensorId);
 
-    // Convert CSV content to JSON format
-    StaticJsonDocument<LARGE_BUFFER_SIZE> doc;
-    BuildRecoveryJsonFromBatchCsv(doc, fullPath, now);
+  char fullTopic[SMALL_BUFFER_SIZE];
+  CreateFullTopic(fullTopic, sizeof(fullTopic), topicPrefix, sensorType, sensorId, "recovered");
+
+  if (s_recoveryState == RECOVERY_COMPLETE) {
+    LOG_INFO("Looking for pending data...");
+    s_recoveryState = RECOVERY_ACTIVE;
+    s_nextCsv.batch = 0;
+    s_nextCsv.offset = 0;
+    s_sentCount = 0;
+  }
 
-    // Validate that the file contains usable data
-    if (!doc["meta"].is<JsonObject>() || doc["meta"].size() == 0) {
-      Serial.println("No valid data in: " + nameStr);
-      skippedEmptyFiles++;
-      continue;
-    }
+  // Settle the acks that arrived since the last tick
+  ServicePublishWindow(mqttClient, now);
 
-    // Serialize JSON and check payload size
-    char payload[LARGE_BUFFER_SIZE];
-    size_t len = serializeJson(doc, payload, sizeof(payload));
-    if (len >= sizeof(payload)) {
-      Serial.println("Payload too large, skipping file: " + nameStr);
-      allFilesSent = false;
-      continue;
-    }
+  if (s_recoveryState == RECOVERY_BACKOFF) {
+    if (millis() - s_recoveryStateSince < RECOVERY_RETRY_DELAY_MS) return false;
+    s_recoveryState = RECOVERY_ACTIVE;
+    s_nextCsv.batch = 0;
+    s_nextCsv.offset = 0;
+  }
 
-    char fullTopic[SMALL_BUFFER_SIZE];
-    CreateFullTopic(fullTopic, sizeof(fullTopic), topicPrefix, sensorType, sensorId, "recovered");
-
-    Serial.print("Publishing recovered CSV: ");
-    Serial.println(nameStr);
-    Serial.print("MQTT payload: ");
-    Serial.println(payload);
-
-    bool published = false;
-    if (mqttClient.beginMessage(fullTopic, false, 1)) {
-      mqttClient.print(payload);
-      if (mqttClient.endMessage()) {
-        // wait for echo/PUBACK handshake
-        unsigned long startTime = millis();
-        while (millis() - startTime < RECOVERY_ACK_TIMEOUT_MS) {
-          mqttClient.poll();
-          delay(DELAY_POLLING_LOOP_MS);
-        }
-        published = true;
-      }
+  // Keep the window filled while the tick budget lasts
+  const unsigned long tickStart = millis();
+  int publishedThisTick = 0;
+  bool nothingLeft = false;
+  while (publishedThisTick < MAX_RECOVERY_FILES_PER_LOOP && PublishWindowHasRoom(PUBLISH_RECOVERY_LOG)) {
+    PublishResult result = PublishNextStagedBatch(mqttClient, fullTopic, now);
+    if (result == PUBLISH_NOTHING_LEFT) {
+      result = PublishNextOutageLogBatch(mqttClient, fullTopic, now);
     }
-
-    if (published) {
-      Serial.println("Published and deleting file.");
-      DeleteCsvFile(fullPath);
-      sentCount++;
-    } else {
-      Serial.println("Failed to publish. Keeping file: " + nameStr);
-      allFilesSent = false;
+    if (result == PUBLISH_NOTHING_LEFT) {
+      result = PublishNextCsvBatch(mqttClient, fullTopic, now);
     }
 
-    // Check for overall timeout to prevent blocking too long
-    if (millis() - startMillis > RECOVERY_TIMEOUT_MS) {
-      Serial.println("Aborting recovery: 60s time limit exceeded.");
-      allFilesSent = false;
+    if (result == PUBLISH_NOTHING_LEFT) {
+      nothingLeft = true;
       break;
     }
+    if (result == PUBLISH_FAILED) {
+      LOG_WARN("Failed to publish. Keeping pending data.");
+      PublishWindowReleaseRecovery();
+      HoldStagedRecords();
+      EnterRecoveryState(RECOVERY_BACKOFF);
+      return false;
+    }
+    publishedThisTick++;
+    if (millis() - tickStart >= RECOVERY_TICK_BUDGET_MS) break;
   }
 
-  root.close();
-
-  // Provide summary of recovery operation
-  if (checkedFiles == 0) {
-    Serial.println("No CSV recovery files found.");
-  } else if (sentCount == 0 && skippedEmptyFiles == checkedFiles) {
-    Serial.println("All found recovery files were empty, too old, or invalid.");
-  } else {
-    Serial.print("Recovered files sent this loop: ");
-    Serial.println(sentCount);
+  if (nothingLeft && PublishWindowRecoveryCount() == 0) {
+    s_recoveryState = RECOVERY_COMPLETE;
+    if (s_sentCount == 0) {
+      LOG_INFO("No pending data found.");
+    } else {
+      LOG_INFO("Recovered messages sent: %d", s_sentCount);
+    }
+    return true;
   }
 
-  return allFilesSent;
+  // The rest waits for acks, which the publish task collects in between
+  return false;
 }
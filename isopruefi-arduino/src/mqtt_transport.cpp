@@ -0,0 +1,191 @@
+#include "mqtt_transport.h"
+
+// =============================================================================
+// MQTT FRAMING
+// =============================================================================
+
+enum ScanPhase : uint8_t {
+  SCAN_HEADER = 0,
+  SCAN_LENGTH = 1,
+  SCAN_BODY = 2
+};
+
+/// Largest remaining length multiplier of the four-byte varint (MQTT 3.1.1, 2.2.3)
+static const uint32_t MAX_LENGTH_MULTIPLIER = 128UL * 128UL * 128UL;
+
+/**
+ * @brief Returns true for packets whose variable header starts with the packet identifier.
+ *
+ * PUBACK, PUBREC, PUBREL, PUBCOMP, SUBSCRIBE, SUBACK, UNSUBSCRIBE and UNSUBACK.
+ */
+static bool StartsWithPacketId(uint8_t packetType) {
+  return packetType >= 4 && packetType <= 11;
+}
+
+static void FinishPacket(MqttPacketScanner& scanner, MqttPacketHandler handler) {
+  if (handler) handler(scanner.header >> 4, scanner.header, scanner.packetId);
+  scanner.phase = SCAN_HEADER;
+}
+
+static void ScanBodyByte(MqttPacketScanner& scanner, uint8_t byte) {
+  const uint8_t packetType = scanner.header >> 4;
+  const uint32_t i = scanner.bodyIndex;
+
+  if (packetType == MQTT_PACKET_PUBLISH) {
+    // Topic length, topic, then the identifier if QoS > 0
+    if (i == 0) scanner.topicLength = (uint16_t)(byte << 8);
+    else if (i == 1) scanner.topicLength |= byte;
+    else if ((scanner.header & 0x06) != 0) {
+      uint32_t idStart = 2UL + scanner.topicLength;
+      if (i == idStart) scanner.packetId = (uint16_t)(byte << 8);
+      else if (i == idStart + 1) scanner.packetId |= byte;
+    }
+  } else if (StartsWithPacketId(packetType)) {
+    if (i == 0) scanner.packetId = (uint16_t)(byte << 8);
+    else if (i == 1) scanner.packetId |= byte;
+  }
+  scanner.bodyIndex++;
+}
+
+/**
+ * @brief Resets a scanner to the start of a packet, e.g. after a new connection.
+ */
+void MqttScannerReset(MqttPacketScanner& scanner) {
+  memset(&scanner, 0, sizeof(scanner));
+  scanner.phase = SCAN_HEADER;
+}
+
+/**
+ * @brief Feeds stream bytes to a scanner; packets may be split at any byte.
+ *
+ * @param scanner Scanner state of one stream direction
+ * @param data Bytes as they were written to or read from the socket
+ * @param length Number of bytes
+ * @param handler Called once per complete packet, may be nullptr
+ */
+void MqttScannerFeed(MqttPacketScanner& scanner, const uint8_t* data, size_t length, MqttPacketHandler handler) {
+  for (size_t n = 0; n < length; n++) {
+    const uint8_t byte = data[n];
+    switch (scanner.phase) {
+      case SCAN_HEADER:
+        scanner.header = byte;
+        scanner.remaining = 0;
+        scanner.lengthMultiplier = 1;
+        scanner.bodyIndex = 0;
+        scanner.topicLength = 0;
+        scanner.packetId = 0;
+        scanner.phase = SCAN_LENGTH;
+        break;
+
+      case SCAN_LENGTH:
+        scanner.remaining += (uint32_t)(byte & 0x7F) * scanner.lengthMultiplier;
+        if (byte & 0x80) {
+          // A fifth length byte is malformed; resynchronise on the next byte
+          if (scanner.lengthMultiplier >= MAX_LENGTH_MULTIPLIER) scanner.phase = SCAN_HEADER;
+          scanner.lengthMultiplier *= 128;
+        } else if (scanner.remaining == 0) {
+          FinishPacket(scanner, handler);
+        } else {
+          scanner.phase = SCAN_BODY;
+        }
+        break;
+
+      case SCAN_BODY:
+        ScanBodyByte(scanner, byte);
+        if (--scanner.remaining == 0) FinishPacket(scanner, handler);
+        break;
+    }
+  }
+}
+
+// =============================================================================
+// TRANSPORT STATE
+// =============================================================================
+
+static MqttPacketScanner s_outbound;
+static MqttPacketScanner s_inbound;
+static uint16_t s_lastPublishId = 0;
+static void (*s_pubackHandler)(uint16_t packetId) = nullptr;
+
+static void OnOutboundPacket(uint8_t packetType, uint8_t header, uint16_t packetId) {
+  if (packetType == MQTT_PACKET_PUBLISH && (header & 0x06) != 0) s_lastPublishId = packetId;
+}
+
+static void OnInboundPacket(uint8_t packetType, uint8_t header, uint16_t packetId) {
+  (void)header;
+  if (packetType == MQTT_PACKET_PUBACK && s_pubackHandler) s_pubackHandler(packetId);
+}
+
+/**
+ * @brief Starts both directions at a packet boundary; call when a new connection is opened.
+ */
+void MqttTransportReset() {
+  MqttScannerReset(s_outbound);
+  MqttScannerReset(s_inbound);
+  s_lastPublishId = 0;
+}
+
+void MqttTransportObserveOutbound(const uint8_t* data, size_t length) {
+  MqttScannerFeed(s_outbound, data, length, OnOutboundPacket);
+}
+
+void MqttTransportObserveInbound(const uint8_t* data, size_t length) {
+  MqttScannerFeed(s_inbound, data, length, OnInboundPacket);
+}
+
+/**
+ * @brief Returns the packet identifier of the last QoS 1 PUBLISH written to the socket.
+ *
+ * @return Packet identifier, 0 if no QoS 1 PUBLISH was written on this connection
+ */
+uint16_t MqttTransportLastPublishId() {
+  return s_lastPublishId;
+}
+
+/**
+ * @brief Sets the function that is called with the packet identifier of every PUBACK.
+ */
+void MqttTransportSetPubackHandler(void (*handler)(uint16_t packetId)) {
+  s_pubackHandler = handler;
+}
+
+// =============================================================================
+// CLIENT DECORATOR
+// =============================================================================
+
+#ifndef UNIT_TEST
+int MqttTransportClient::connect(IPAddress ip, uint16_t port) {
+  MqttTransportReset();
+  return _inner.connect(ip, port);
+}
+
+int MqttTransportClient::connect(const char* host, uint16_t port) {
+  MqttTransportReset();
+  return _inner.connect(host, port);
+}
+
+size_t MqttTransportClient::write(uint8_t data) {
+  MqttTransportObserveOutbound(&data, 1);
+  return _inner.write(data);
+}
+
+size_t MqttTransportClient::write(const uint8_t* buffer, size_t size) {
+  MqttTransportObserveOutbound(buffer, size);
+  return _inner.write(buffer, size);
+}
+
+int MqttTransportClient::read() {
+  int data = _inner.read();
+  if (data >= 0) {
+    uint8_t byte = (uint8_t)data;
+    MqttTransportObserveInbound(&byte, 1);
+  }
+  return data;
+}
+
+int MqttTransportClient::read(uint8_t* buffer, size_t size) {
+  int n = _inner.read(buffer, size);
+  if (n > 0) MqttTransportObserveInbound(buffer, (size_t)n);
+  return n;
+}
+#endif
@@ -7,36 +7,198 @@
 #endif
 
 #include "mqtt.h"
+#include "logger.h"
 
 static const char SSID[]     = SECRET_SSID;
 static const char PASSWORD[] = SECRET_PASS;
 static const char* BROKER    = "aicon.dhbw-heidenheim.de";
 static const int port        = 1883;
 
+// =============================================================================
+// CONNECTION MANAGER
+// =============================================================================
+
+static MqttClient*            s_client = nullptr;
+static ConnectionState        s_state = CONNECTION_IDLE;
+static unsigned long          s_stateSinceMs = 0;
+static ConnectionStateHandler s_stateHandler = nullptr;
+static ReconnectPolicy*       s_policy = nullptr;
+static unsigned long          s_retryDelayMs = CONNECTION_RETRY_DELAY_MS;
+
+static void EnterState(ConnectionState state, unsigned long nowMs) {
+  ConnectionState previous = s_state;
+  s_state = state;
+  s_stateSinceMs = nowMs;
+  if (previous != state && s_stateHandler) s_stateHandler(previous, state);
+}
+
+/// Enters BACKOFF with the wait the policy draws for this failure
+static void EnterBackoff(unsigned long nowMs) {
+  s_retryDelayMs = s_policy ? s_policy->NextDelayMs() : CONNECTION_RETRY_DELAY_MS;
+  EnterState(CONNECTION_BACKOFF, nowMs);
+}
+
+/**
+ * @brief Prepares the manager for a client; the first ConnectionTick() starts connecting.
+ *
+ * Sets the broker credentials and bounds the client's blocking connect.
+ * A session that is already up is taken over as CONNECTED.
+ *
+ * @param mqttClient MQTT client the manager keeps connected
+ * @param policy Backoff between attempts; nullptr waits CONNECTION_RETRY_DELAY_MS
+ */
+void ConnectionBegin(MqttClient& mqttClient, ReconnectPolicy* policy) {
+  s_client = &mqttClient;
+  s_policy = policy;
+  s_retryDelayMs = CONNECTION_RETRY_DELAY_MS;
+  mqttClient.setUsernamePassword(SECRET_MQTT_USER, SECRET_MQTT_PASS);
+  mqttClient.setConnectionTimeout(MQTT_CONNECT_TIMEOUT_MS);
+  // WiFi.begin() returns right away; association is polled by ConnectionTick()
+  WiFi.setTimeout(0);
+
+  s_state = CONNECTION_IDLE;
+  s_stateSinceMs = millis();
+  if (WiFi.status() == WL_CONNECTED && mqttClient.connected()) {
+    EnterState(CONNECTION_CONNECTED, s_stateSinceMs);
+  }
+}
+
+/**
+ * @brief Advances the connection by one step without waiting.
+ *
+ * Call periodically, e.g. from a scheduler task. Apart from one broker
+ * connect per attempt (at most MQTT_CONNECT_TIMEOUT_MS), the call returns
+ * right away in every state.
+ *
+ * @param nowMs Current millis() value
+ */
+void ConnectionTick(unsigned long nowMs) {
+  if (!s_client) return;
+
+  switch (s_state) {
+    case CONNECTION_IDLE:
+      if (WiFi.status() == WL_CONNECTED) {
+        EnterState(CONNECTION_CONNECTING_BROKER, nowMs);
+        break;
+      }
+      LOG_INFO("Connecting to WiFi...");
+      WiFi.begin(SSID, PASSWORD);
+      EnterState(CONNECTION_ASSOCIATING, nowMs);
+      break;
+
+    case CONNECTION_ASSOCIATING:
+      if (WiFi.status() == WL_CONNECTED) {
+        LOG_INFO("WiFi is connected.");
+        EnterState(CONNECTION_CONNECTING_BROKER, nowMs);
+      } else if (nowMs - s_stateSinceMs >= WIFI_ASSOCIATE_TIMEOUT_MS) {
+        LOG_WARN("WiFi connection timed out.");
+        WiFi.disconnect();
+        EnterBackoff(nowMs);
+      }
+      break;
+
+    case CONNECTION_CONNECTING_BROKER:
+      if (WiFi.status() != WL_CONNECTED) {
+        EnterBackoff(nowMs);
+        break;
+      }
+      LOG_INFO("Connecting to MQTT...");
+      if (s_client->connect(BROKER, port)) {
+        LOG_INFO("MQTT connected.");
+        if (s_policy) s_policy->RecordSuccess();
+        EnterState(CONNECTION_CONNECTED, nowMs);
+      } else {
+        LOG_WARN("MQTT connection failed.");
+        EnterBackoff(nowMs);
+      }
+      break;
+
+    case CONNECTION_CONNECTED:
+      if (WiFi.status() != WL_CONNECTED || !s_client->connected()) {
+        LOG_WARN("Connection lost.");
+        s_client->stop();
+        EnterBackoff(nowMs);
+      }
+      break;
+
+    case CONNECTION_BACKOFF:
+      if (nowMs - s_stateSinceMs >= s_retryDelayMs) EnterState(CONNECTION_IDLE, nowMs);
+      break;
+  }
+}
+
+/**
+ * @brief Counts time the MCU spent in standby towards the wait of the current state.
+ *
+ * millis() stands still in standby, so without this a BACKOFF would only
+ * run down while the device is awake.
+ *
+ * @param sleptMs Time in standby
+ */
+void ConnectionAddSleepTime(unsigned long sleptMs) {
+  s_stateSinceMs -= sleptMs;
+}
+
+ConnectionState ConnectionGetState() {
+  return s_state;
+}
+
+/**
+ * @brief Returns the wait of the current (or last) BACKOFF, for diagnostics.
+ */
+unsigned long ConnectionRetryDelayMs() {
+  return s_retryDelayMs;
+}
+
+/**
+ * @brief Sets the function that is told about every state change (nullptr for none).
+ */
+void ConnectionSetStateHandler(ConnectionStateHandler handler) {
+  s_stateHandler = handler;
+}
+
+/**
+ * @brief Returns a printable name of a state, for logs.
+ */
+const char* ConnectionStateName(ConnectionState state) {
+  switch (state) {
+    case CONNECTION_IDLE:              return "idle";
+    case CONNECTION_ASSOCIATING:       return "associating";
+    case CONNECTION_CONNECTING_BROKER: return "connecting-broker";
+    case CONNECTION_CONNECTED:         return "connected";
+    default:                           return "backoff";
+  }
+}
+
+// =============================================================================
+// BLOCKING CONNECTION HELPERS
+// =============================================================================
+
 /**
  * @brief Establishes a WiFi connection with the configured network.
  *
  * Attempts to connect to the WiFi network using credentials from the secrets file.
- * Provides visual feedback via serial output and enforces a connection timeout.
+ * Logs the outcome and enforces a connection timeout.
  *
  * @param timeoutMs Maximum time in milliseconds to wait for connection (default: 10000ms).
  * @return true if WiFi connection is successful, false if timeout occurs.
+ *
+ * @note Blocks until connected or timed out; the firmware loop uses ConnectionTick() instead.
  */
 bool ConnectToWiFi(unsigned long timeoutMs) {
-  Serial.print("Connecting to WiFi...");
+  LOG_INFO("Connecting to WiFi...");
   WiFi.begin(SSID, PASSWORD);
 
   unsigned long startAttemptTime = millis();
   while (WiFi.status() != WL_CONNECTED) {
     if (millis() - startAttemptTime >= timeoutMs) {
-      Serial.println("WiFi connection timed out.");
+      LOG_WARN("WiFi connection timed out.");
       return false;
     }
     delay(500);
-    Serial.print(".");
   }
 
-  Serial.println("WiFi is connected.");
+  LOG_INFO("WiFi is connected.");
   return true;
 }
 
@@ -44,15 +206,18 @@ bool ConnectToWiFi(unsigned long timeoutMs) {
  * @brief Establishes an authenticated MQTT connection to the broker.
  *
  * Sets up MQTT client credentials using values from the secrets file and attempts
- * to connect to the configured MQTT broker. Provides visual feedback and enforces
- * a connection timeout.
+ * to connect to the configured MQTT broker. Logs the outcome and enforces a
+ * connection timeout.
  *
  * @param mqttClient Reference to the MQTT client instance to connect.
  * @param timeoutMs Maximum time in milliseconds to wait for connection (default: 10000ms).
+ * @param policy Backoff between attempts; nullptr retries every second.
  * @return true if MQTT connection is successful, false if timeout occurs.
+ *
+ * @note Blocks until connected or timed out; the firmware loop uses ConnectionTick() instead.
  */
-bool ConnectToMQTT(MqttClient& mqttClient, unsigned long timeoutMs) {
-  Serial.print("Connecting to MQTT...");
+bool ConnectToMQTT(MqttClient& mqttClient, unsigned long timeoutMs, ReconnectPolicy* policy) {
+  LOG_INFO("Connecting to MQTT...");
   
   mqttClient.setUsernamePassword(SECRET_MQTT_USER, SECRET_MQTT_PASS);
   
@@ -60,13 +225,13 @@ bool ConnectToMQTT(MqttClient& mqttClient, unsigned long timeoutMs) {
 
   while (!mqttClient.connect(BROKER, port)) {
     if (millis() - startAttemptTime >= timeoutMs) {
-      Serial.println("MQTT connection timed out.");
+      LOG_WARN("MQTT connection timed out.");
       return false;
     }
-    Serial.print(".");
-    delay(1000);
+    delay(policy ? policy->NextDelayMs() : 1000);
   }
 
-  Serial.println(" connected.");
+  if (policy) policy->RecordSuccess();
+  LOG_INFO("MQTT connected.");
   return true;
 }
@@ -0,0 +1,620 @@
+#include "outage_log.h"
+#include "log_format.h"
+#include "logger.h"
+
+// =============================================================================
+// SEGMENT FORMAT CONSTANTS
+// =============================================================================
+
+/// Segment header magic ("ISOL" little-endian)
+static const uint32_t SEGMENT_MAGIC = 0x4C4F5349;
+/// Cursor file magic ("ISOC" little-endian)
+static const uint32_t CURSOR_MAGIC = 0x434F5349;
+/// Version 2: 32-byte records that carry interval aggregates
+static const uint16_t SEGMENT_FORMAT_VERSION = 2;
+/// Number of record bytes covered by the CRC (the CRC itself is the last 4 bytes)
+static const size_t RECORD_PAYLOAD_BYTES = OUTAGE_LOG_RECORD_BYTES - 4;
+/// Records read per SD access while peeking or scanning
+static const size_t READ_CHUNK_RECORDS = 4;
+static const size_t PATH_BUFFER_SIZE = 24;
+static const char* CURSOR_PATH = OUTAGE_LOG_DIR "/CURSOR.BIN";
+
+// =============================================================================
+// LOG STATE
+// =============================================================================
+
+static bool s_mounted = false;
+/// Generation per segment slot, 0 marks a slot that was never written
+static uint32_t s_generation[OUTAGE_LOG_SEGMENT_COUNT];
+/// Readable records per segment slot
+static uint32_t s_count[OUTAGE_LOG_SEGMENT_COUNT];
+static uint8_t s_headSlot = 0;
+static File s_headFile;
+static uint8_t s_tailSlot = 0;
+/// Index of the next unconsumed record inside the tail segment
+static uint32_t s_tailIndex = 0;
+static uint32_t s_dropped = 0;
+
+// Write-behind buffer: an image of the head segment's current card sector.
+// Appends land here and reach the card as one sector write when the sector is
+// full, when the buffered data gets too old, or on an explicit flush.
+static uint8_t s_sector[OUTAGE_LOG_SECTOR_BYTES];
+/// Sector number inside the head segment the buffer mirrors
+static uint32_t s_sectorIndex = 0;
+/// Valid bytes in the buffer (header and records, from the sector start)
+static uint32_t s_sectorFill = 0;
+/// Leading buffer bytes that are already on the card
+static uint32_t s_sectorFlushed = 0;
+static bool s_ageTracked = false;
+static unsigned long s_unflushedSinceMs = 0;
+
+// =============================================================================
+// RECORD ENCODING
+// =============================================================================
+
+static void EncodeRecord(uint8_t* out, const OutageRecord& record, uint32_t generation) {
+  PutU32(out, record.timestamp);
+  PutU32(out + 4, record.sequence);
+  PutU16(out + 8, (uint16_t)record.rawTemp);
+  PutU16(out + 10, record.flags);
+  PutU16(out + 12, (uint16_t)record.rawMin);
+  PutU16(out + 14, (uint16_t)record.rawMax);
+  PutU16(out + 16, record.count);
+  PutU16(out + 18, (uint16_t)record.rawLast);
+  memset(out + 20, 0, RECORD_PAYLOAD_BYTES - 20);
+  PutU32(out + RECORD_PAYLOAD_BYTES, Crc32(generation, out, RECORD_PAYLOAD_BYTES));
+}
+
+static bool DecodeRecord(const uint8_t* in, uint32_t generation, OutageRecord& record) {
+  if (GetU32(in + RECORD_PAYLOAD_BYTES) != Crc32(generation, in, RECORD_PAYLOAD_BYTES)) {
+    return false;
+  }
+  record.timestamp = GetU32(in);
+  record.sequence = GetU32(in + 4);
+  record.rawTemp = (int16_t)GetU16(in + 8);
+  record.flags = GetU16(in + 10);
+  record.rawMin = (int16_t)GetU16(in + 12);
+  record.rawMax = (int16_t)GetU16(in + 14);
+  record.count = GetU16(in + 16);
+  record.rawLast = (int16_t)GetU16(in + 18);
+  return true;
+}
+
+// =============================================================================
+// SEGMENT HELPERS
+// =============================================================================
+
+static void SegmentPath(char* buffer, size_t bufferSize, uint8_t slot) {
+  snprintf(buffer, bufferSize, "%s/SEG%u.BIN", OUTAGE_LOG_DIR, (unsigned)slot);
+}
+
+static uint8_t NextSlot(uint8_t slot) {
+  return (uint8_t)((slot + 1) % OUTAGE_LOG_SEGMENT_COUNT);
+}
+
+static uint32_t RecordOffset(uint32_t index) {
+  return (index + 1) * OUTAGE_LOG_RECORD_BYTES;
+}
+
+/**
+ * @brief Points the sector buffer at the sector that holds the given file offset.
+ *
+ * Bytes before the offset inside that sector are loaded from the head file,
+ * so later sector writes never clobber data that is already on the card.
+ */
+static void LoadSectorBuffer(uint32_t offset) {
+  s_sectorIndex = offset / OUTAGE_LOG_SECTOR_BYTES;
+  s_sectorFill = offset % OUTAGE_LOG_SECTOR_BYTES;
+  s_sectorFlushed = s_sectorFill;
+  s_ageTracked = false;
+  if (s_sectorFill == 0) return;
+
+  s_headFile.seekSet(s_sectorIndex * OUTAGE_LOG_SECTOR_BYTES);
+  int n = s_headFile.read(s_sector, s_sectorFill);
+  if (n < (int)s_sectorFill) {
+    memset(s_sector + (n > 0 ? n : 0), 0, s_sectorFill - (n > 0 ? n : 0));
+  }
+}
+
+/**
+ * @brief Writes the unflushed part of the sector buffer to the head segment.
+ *
+ * A full buffer that was never partially flushed goes out as one aligned
+ * 512-byte write, which SdFat passes to the card without a read-modify-write.
+ * After a full sector is on the card the buffer moves on to the next sector.
+ */
+static bool FlushSectorBuffer() {
+  if (s_sectorFill > s_sectorFlushed) {
+    s_headFile.seekSet(s_sectorIndex * OUTAGE_LOG_SECTOR_BYTES + s_sectorFlushed);
+    size_t len = s_sectorFill - s_sectorFlushed;
+    if (s_headFile.write(s_sector + s_sectorFlushed, len) != len || !s_headFile.sync()) {
+      LOG_ERROR("Failed to flush outage log buffer.");
+      return false;
+    }
+    s_sectorFlushed = s_sectorFill;
+  }
+  s_ageTracked = false;
+
+  if (s_sectorFill == OUTAGE_LOG_SECTOR_BYTES) {
+    s_sectorIndex++;
+    s_sectorFill = 0;
+    s_sectorFlushed = 0;
+  }
+  return true;
+}
+
+/**
+ * @brief Reads the header of a segment slot.
+ * @return Generation stored in a valid header, 0 if the slot is missing or invalid
+ */
+static uint32_t ReadSegmentGeneration(uint8_t slot) {
+  char path[PATH_BUFFER_SIZE];
+  SegmentPath(path, sizeof(path), slot);
+  if (!sd.exists(path)) return 0;
+
+  File file = sd.open(path, FILE_READ);
+  if (!file) return 0;
+  uint8_t header[OUTAGE_LOG_RECORD_BYTES];
+  int n = file.read(header, sizeof(header));
+  file.close();
+
+  if (n != (int)sizeof(header)) return 0;
+  if (GetU32(header) != SEGMENT_MAGIC || GetU16(header + 4) != SEGMENT_FORMAT_VERSION) return 0;
+  if (GetU16(header + 6) != OUTAGE_LOG_RECORD_BYTES) return 0;
+  if (GetU32(header + RECORD_PAYLOAD_BYTES) != Crc32(0, header, RECORD_PAYLOAD_BYTES)) return 0;
+  return GetU32(header + 8);
+}
+
+/**
+ * @brief Counts the valid records at the start of a segment.
+ *
+ * Stops at the first record that fails its CRC, which marks the end of the
+ * data written under the segment's current generation.
+ */
+static uint32_t ScanSegmentRecords(uint8_t slot) {
+  char path[PATH_BUFFER_SIZE];
+  SegmentPath(path, sizeof(path), slot);
+  File file = sd.open(path, FILE_READ);
+  if (!file) return 0;
+
+  uint8_t chunk[READ_CHUNK_RECORDS * OUTAGE_LOG_RECORD_BYTES];
+  uint32_t count = 0;
+  file.seekSet(RecordOffset(0));
+  while (count < OUTAGE_LOG_RECORDS_PER_SEGMENT) {
+    int n = file.read(chunk, sizeof(chunk));
+    if (n < (int)OUTAGE_LOG_RECORD_BYTES) break;
+
+    size_t records = (size_t)n / OUTAGE_LOG_RECORD_BYTES;
+    size_t i = 0;
+    OutageRecord record;
+    while (i < records && count < OUTAGE_LOG_RECORDS_PER_SEGMENT &&
+           DecodeRecord(chunk + i * OUTAGE_LOG_RECORD_BYTES, s_generation[slot], record)) {
+      i++;
+      count++;
+    }
+    if (i < records) break;
+  }
+  file.close();
+  return count;
+}
+
+/**
+ * @brief (Re)initializes a segment slot as the new head with the given generation.
+ *
+ * The segment file is created and preallocated once; later reuse only rewrites
+ * the header, so rotating segments never touches the FAT or the directory.
+ */
+static bool StartSegment(uint8_t slot, uint32_t generation) {
+  if (s_headFile) {
+    FlushSectorBuffer();
+    s_headFile.close();
+  }
+
+  char path[PATH_BUFFER_SIZE];
+  SegmentPath(path, sizeof(path), slot);
+  s_headFile = sd.open(path, FILE_WRITE);
+  if (!s_headFile) {
+    LOG_ERROR("Failed to open outage log segment.");
+    return false;
+  }
+  if (s_headFile.fileSize() == 0) {
+    // Contiguous clusters keep the FAT untouched while the segment fills
+    s_headFile.preAllocate(OUTAGE_LOG_SEGMENT_BYTES);
+  }
+
+  uint8_t header[OUTAGE_LOG_RECORD_BYTES];
+  memset(header, 0, sizeof(header));
+  PutU32(header, SEGMENT_MAGIC);
+  PutU16(header + 4, SEGMENT_FORMAT_VERSION);
+  PutU16(header + 6, OUTAGE_LOG_RECORD_BYTES);
+  PutU32(header + 8, generation);
+  PutU32(header + RECORD_PAYLOAD_BYTES, Crc32(0, header, RECORD_PAYLOAD_BYTES));
+
+  s_headFile.seekSet(0);
+  if (s_headFile.write(header, sizeof(header)) != sizeof(header) || !s_headFile.sync()) {
+    LOG_ERROR("Failed to write outage log segment header.");
+    return false;
+  }
+
+  memcpy(s_sector, header, sizeof(header));
+  s_sectorIndex = 0;
+  s_sectorFill = sizeof(header);
+  s_sectorFlushed = sizeof(header);
+  s_ageTracked = false;
+
+  s_generation[slot] = generation;
+  s_count[slot] = 0;
+  s_headSlot = slot;
+  return true;
+}
+
+static void SaveCursor() {
+  uint8_t cursor[OUTAGE_LOG_RECORD_BYTES];
+  memset(cursor, 0, sizeof(cursor));
+  PutU32(cursor, CURSOR_MAGIC);
+  PutU32(cursor + 4, s_generation[s_tailSlot]);
+  PutU32(cursor + 8, s_tailIndex);
+  PutU32(cursor + RECORD_PAYLOAD_BYTES, Crc32(0, cursor, RECORD_PAYLOAD_BYTES));
+
+  File file = sd.open(CURSOR_PATH, FILE_WRITE);
+  if (!file) {
+    LOG_ERROR("Failed to persist outage log cursor.");
+    return;
+  }
+  file.seekSet(0);
+  file.write(cursor, sizeof(cursor));
+  file.close();
+}
+
+/**
+ * @brief Restores the consume cursor, falling back to the oldest segment.
+ */
+static void LoadCursor() {
+  // Default: start of the oldest segment that holds data
+  s_tailSlot = s_headSlot;
+  for (uint8_t slot = 0; slot < OUTAGE_LOG_SEGMENT_COUNT; slot++) {
+    if (s_generation[slot] != 0 && s_generation[slot] < s_generation[s_tailSlot]) {
+      s_tailSlot = slot;
+    }
+  }
+  s_tailIndex = 0;
+
+  File file = sd.open(CURSOR_PATH, FILE_READ);
+  if (!file) return;
+  uint8_t cursor[OUTAGE_LOG_RECORD_BYTES];
+  int n = file.read(cursor, sizeof(cursor));
+  file.close();
+
+  if (n != (int)sizeof(cursor) || GetU32(cursor) != CURSOR_MAGIC) return;
+  if (GetU32(cursor + RECORD_PAYLOAD_BYTES) != Crc32(0, cursor, RECORD_PAYLOAD_BYTES)) return;
+
+  uint32_t generation = GetU32(cursor + 4);
+  for (uint8_t slot = 0; slot < OUTAGE_LOG_SEGMENT_COUNT; slot++) {
+    if (generation != 0 && s_generation[slot] == generation) {
+      s_tailSlot = slot;
+      s_tailIndex = GetU32(cursor + 8);
+      if (s_tailIndex > s_count[slot]) s_tailIndex = s_count[slot];
+      return;
+    }
+  }
+  // Cursor points to a segment that has since been overwritten: keep the default
+}
+
+/**
+ * @brief Moves the tail past fully consumed, non-head segments.
+ */
+static void NormalizeTail() {
+  while (s_tailSlot != s_headSlot && s_tailIndex >= s_count[s_tailSlot]) {
+    s_tailSlot = NextSlot(s_tailSlot);
+    s_tailIndex = 0;
+  }
+}
+
+/**
+ * @brief Closes the full head segment and continues in the next slot.
+ *
+ * If the next slot still holds unconsumed records the log is full, and the
+ * oldest segment is dropped to make room (old data would be discarded by the
+ * 24h recovery window anyway).
+ */
+static bool RotateHead() {
+  uint8_t next = NextSlot(s_headSlot);
+  uint32_t generation = s_generation[s_headSlot] + 1;
+
+  if (s_tailSlot == next) {
+    s_dropped += s_count[next] - s_tailIndex;
+    s_tailSlot = NextSlot(next);
+    s_tailIndex = 0;
+    LOG_WARN("Outage log full, dropped oldest segment.");
+  }
+
+  bool tailAtHead = (s_tailSlot == s_headSlot && s_tailIndex >= s_count[s_headSlot]);
+  if (!StartSegment(next, generation)) return false;
+
+  if (tailAtHead) {
+    s_tailSlot = next;
+    s_tailIndex = 0;
+  }
+  NormalizeTail();
+  SaveCursor();
+  return true;
+}
+
+static bool EnsureMounted() {
+  return s_mounted || OutageLogBegin();
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+/**
+ * @brief Mounts the outage log from the SD card.
+ *
+ * Reads the header of every segment slot, finds the head (highest generation),
+ * counts its valid records and restores the consume cursor. A fresh card gets
+ * its first segment created and preallocated.
+ *
+ * @return true if the log is ready for appends
+ * @note Called from CoreSetup(); the other functions mount lazily as well.
+ */
+bool OutageLogBegin() {
+  if (s_mounted) return true;
+
+  if (!sd.exists(OUTAGE_LOG_DIR)) {
+    sd.mkdir(OUTAGE_LOG_DIR);
+  }
+
+  s_dropped = 0;
+  uint8_t headSlot = 0;
+  uint32_t headGeneration = 0;
+  for (uint8_t slot = 0; slot < OUTAGE_LOG_SEGMENT_COUNT; slot++) {
+    s_generation[slot] = ReadSegmentGeneration(slot);
+    // Non-head segments were full when the head moved on
+    s_count[slot] = s_generation[slot] != 0 ? OUTAGE_LOG_RECORDS_PER_SEGMENT : 0;
+    if (s_generation[slot] > headGeneration) {
+      headGeneration = s_generation[slot];
+      headSlot = slot;
+    }
+  }
+
+  if (headGeneration == 0) {
+    if (!StartSegment(0, 1)) return false;
+  } else {
+    s_headSlot = headSlot;
+    s_count[headSlot] = ScanSegmentRecords(headSlot);
+
+    char path[PATH_BUFFER_SIZE];
+    SegmentPath(path, sizeof(path), headSlot);
+    s_headFile = sd.open(path, FILE_WRITE);
+    if (!s_headFile) {
+      LOG_ERROR("Failed to open outage log head segment.");
+      return false;
+    }
+    LoadSectorBuffer(RecordOffset(s_count[headSlot]));
+  }
+
+  LoadCursor();
+  NormalizeTail();
+  s_mounted = true;
+  return true;
+}
+
+/**
+ * @brief Flushes buffered records and closes the head segment.
+ *
+ * The next log call mounts again.
+ */
+void OutageLogEnd() {
+  if (s_headFile) {
+    if (s_mounted) FlushSectorBuffer();
+    s_headFile.close();
+  }
+  s_mounted = false;
+}
+
+/**
+ * @brief Writes all buffered records to the card.
+ *
+ * Call before a planned reset, power-down or when the supply voltage drops;
+ * otherwise buffered records survive only as long as the RAM does.
+ *
+ * @return true if nothing was pending or the data reached the card
+ */
+bool OutageLogFlush() {
+  if (!s_mounted) return true;
+  return FlushSectorBuffer();
+}
+
+/**
+ * @brief Flushes the buffer once its oldest record has waited long enough.
+ *
+ * The age is measured from the first tick that sees unflushed data, so the
+ * log itself never reads the clock.
+ *
+ * @param nowMs Current millis() value
+ * @param maxAgeMs Longest time a record may stay in RAM only
+ */
+void OutageLogTick(unsigned long nowMs, unsigned long maxAgeMs) {
+  if (!s_mounted || s_sectorFill == s_sectorFlushed) {
+    s_ageTracked = false;
+    return;
+  }
+  if (!s_ageTracked) {
+    s_ageTracked = true;
+    s_unflushedSinceMs = nowMs;
+    return;
+  }
+  if (nowMs - s_unflushedSinceMs >= maxAgeMs) {
+    FlushSectorBuffer();
+  }
+}
+
+/**
+ * @brief Returns the number of bytes waiting in the write-behind buffer.
+ */
+uint32_t OutageLogBufferedBytes() {
+  return s_mounted ? s_sectorFill - s_sectorFlushed : 0;
+}
+
+/**
+ * @brief Appends one record at the head of the log.
+ *
+ * The record goes into the sector buffer; the card is only written when the
+ * sector is full (every 32 records), so an hour-long outage costs two sector
+ * writes instead of sixty write-and-sync cycles. Use OutageLogTick() to bound
+ * how long records stay in RAM and OutageLogFlush() before power is lost.
+ *
+ * @param record Reading to store
+ * @return true if the record was buffered (and, on a full sector, written)
+ */
+bool OutageLogAppend(const OutageRecord& record) {
+  if (!EnsureMounted()) return false;
+  if (s_count[s_headSlot] >= OUTAGE_LOG_RECORDS_PER_SEGMENT && !RotateHead()) return false;
+
+  EncodeRecord(s_sector + s_sectorFill, record, s_generation[s_headSlot]);
+  s_sectorFill += OUTAGE_LOG_RECORD_BYTES;
+
+  if (s_sectorFill == OUTAGE_LOG_SECTOR_BYTES && !FlushSectorBuffer()) {
+    // Keep the buffer consistent with the card; the caller reports the loss
+    s_sectorFill -= OUTAGE_LOG_RECORD_BYTES;
+    return false;
+  }
+  s_count[s_headSlot]++;
+  return true;
+}
+
+/**
+ * @brief Copies the oldest unconsumed records without consuming them.
+ *
+ * A record that fails its CRC inside an older segment ends that segment early;
+ * the remaining slots of the segment are skipped.
+ *
+ * @param[out] records Destination array
+ * @param[in] maxRecords Capacity of the destination array
+ * @param[in] skip Number of oldest records to pass over first (records that
+ *                 are already in flight but not consumed yet)
+ * @return Number of records copied, in log order
+ */
+size_t OutageLogPeek(OutageRecord* records, size_t maxRecords, size_t skip) {
+  if (!EnsureMounted()) return 0;
+
+  size_t copied = 0;
+  uint8_t slot = s_tailSlot;
+  uint32_t index = s_tailIndex;
+  uint8_t chunk[READ_CHUNK_RECORDS * OUTAGE_LOG_RECORD_BYTES];
+
+  while (skip > 0) {
+    uint32_t available = s_count[slot] - index;
+    if (available == 0) {
+      if (slot == s_headSlot) return 0;
+      slot = NextSlot(slot);
+      index = 0;
+      continue;
+    }
+    uint32_t step = skip < available ? (uint32_t)skip : available;
+    index += step;
+    skip -= step;
+  }
+
+  while (copied < maxRecords) {
+    if (index >= s_count[slot]) {
+      if (slot == s_headSlot) break;
+      slot = NextSlot(slot);
+      index = 0;
+      continue;
+    }
+
+    uint32_t end = s_count[slot];
+    if (slot == s_headSlot) {
+      uint32_t firstBuffered = s_sectorIndex == 0 ? 0 : s_sectorIndex * OUTAGE_LOG_SECTOR_BYTES / OUTAGE_LOG_RECORD_BYTES - 1;
+      if (end > firstBuffered) end = firstBuffered;
+    }
+
+    if (index >= end) {
+      // Records in the current sector are served from the buffer, so a short
+      // outage can be recovered without the data ever touching the card
+      while (copied < maxRecords && index < s_count[slot]) {
+        uint32_t offset = RecordOffset(index) - s_sectorIndex * OUTAGE_LOG_SECTOR_BYTES;
+        DecodeRecord(s_sector + offset, s_generation[slot], records[copied]);
+        copied++;
+        index++;
+      }
+      break;
+    }
+
+    char path[PATH_BUFFER_SIZE];
+    SegmentPath(path, sizeof(path), slot);
+    File file = sd.open(path, FILE_READ);
+    if (!file) break;
+    file.seekSet(RecordOffset(index));
+
+    while (copied < maxRecords && index < end) {
+      size_t want = end - index;
+      if (want > maxRecords - copied) want = maxRecords - copied;
+      if (want > READ_CHUNK_RECORDS) want = READ_CHUNK_RECORDS;
+
+      int n = file.read(chunk, want * OUTAGE_LOG_RECORD_BYTES);
+      size_t got = n > 0 ? (size_t)n / OUTAGE_LOG_RECORD_BYTES : 0;
+      size_t i = 0;
+      while (i < got && DecodeRecord(chunk + i * OUTAGE_LOG_RECORD_BYTES, s_generation[slot], records[copied])) {
+        i++;
+        copied++;
+        index++;
+      }
+      if (i < want) {
+        // Corrupt or missing data: the segment ends here
+        s_count[slot] = index;
+        end = index;
+        break;
+      }
+    }
+    file.close();
+  }
+  return copied;
+}
+
+/**
+ * @brief Marks the oldest records as delivered and persists the cursor.
+ *
+ * @param count Number of records to consume (as returned by OutageLogPeek())
+ */
+void OutageLogConsume(size_t count) {
+  if (!EnsureMounted() || count == 0) return;
+
+  while (count > 0) {
+    uint32_t available = s_count[s_tailSlot] - s_tailIndex;
+    uint32_t step = count < available ? (uint32_t)count : available;
+    s_tailIndex += step;
+    count -= step;
+    if (s_tailIndex < s_count[s_tailSlot] || s_tailSlot == s_headSlot) break;
+    NormalizeTail();
+  }
+  NormalizeTail();
+  SaveCursor();
+}
+
+/**
+ * @brief Returns the number of records that are stored but not yet consumed.
+ */
+uint32_t OutageLogPendingCount() {
+  if (!EnsureMounted()) return 0;
+
+  uint32_t pending = 0;
+  uint8_t slot = s_tailSlot;
+  uint32_t index = s_tailIndex;
+  while (true) {
+    pending += s_count[slot] - index;
+    if (slot == s_headSlot) break;
+    slot = NextSlot(slot);
+    index = 0;
+  }
+  return pending;
+}
+
+/**
+ * @brief Returns the number of records dropped because the log was full.
+ */
+uint32_t OutageLogDroppedCount() {
+  return s_dropped;
+}
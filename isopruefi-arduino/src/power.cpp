@@ -0,0 +1,123 @@
+#include "power.h"
+#include "time_service.h"
+
+static bool s_enabled = false;
+static unsigned long s_wakeMs = 0;      // millis() of the last wake-up, or of enabling
+static PowerStats s_stats = {0, 0, 0, 0, 0, 0};
+
+// Set by the wake-up interrupt: the DS3231 alarm pulled INT/SQW low
+static volatile bool s_alarmWake = false;
+
+static void OnAlarmWake() {
+  s_alarmWake = true;
+}
+
+/**
+ * @brief Makes the DS3231 INT/SQW pin an alarm output and registers it as wake-up source.
+ *
+ * @param wakePin MCU pin wired to INT/SQW
+ * @return false if no pin is wired, so nothing could wake the MCU again
+ */
+bool PowerBegin(int wakePin) {
+  if (wakePin < 0) return false;
+  pinMode(wakePin, INPUT_PULLUP);  // open-drain output
+  rtc.writeSqwPinMode(DS3231_OFF);
+  rtc.disableAlarm(2);
+  rtc.clearAlarm(1);
+  rtc.clearAlarm(2);
+  LowPower.attachInterruptWakeup(wakePin, OnAlarmWake, FALLING);
+  return true;
+}
+
+/**
+ * @brief Allows or forbids sleeping; the awake window starts over.
+ */
+void PowerSetEnabled(bool enabled, unsigned long nowMs) {
+  s_enabled = enabled;
+  s_wakeMs = nowMs;
+}
+
+bool PowerEnabled() {
+  return s_enabled;
+}
+
+/**
+ * @brief Disables sleeping and clears the counters.
+ */
+void PowerReset() {
+  s_enabled = false;
+  s_wakeMs = 0;
+  s_stats = PowerStats{0, 0, 0, 0, 0, 0};
+  s_alarmWake = false;
+}
+
+/**
+ * @brief Checks whether the awake window since the last wake-up is used up.
+ */
+bool PowerWindowExpired(unsigned long nowMs) {
+  return nowMs - s_wakeMs >= POWER_AWAKE_WINDOW_MS;
+}
+
+/**
+ * @brief Sleeps in standby until the RTC reaches wakeUnix.
+ *
+ * Does nothing if the wake-up time is less than POWER_MIN_SLEEP_SECONDS
+ * ahead: the DS3231 alarm matches hour, minute and second, so an alarm
+ * second that passed before standby would only fire a day later. The
+ * WiFi module, if connected, sleeps in its power-save mode meanwhile.
+ *
+ * @param wakeUnix RTC time to wake up at
+ * @param nowMs Current millis() value
+ * @param forced The caller still had work; counted as a window overrun
+ * @return true if the MCU slept
+ */
+bool PowerSleepUntil(uint32_t wakeUnix, unsigned long nowMs, bool forced) {
+  const PreciseTime now = TimeNowPrecise(nowMs);
+  if (!s_enabled || wakeUnix < now.unixtime + POWER_MIN_SLEEP_SECONDS) return false;
+
+  const unsigned long awakeMs = nowMs - s_wakeMs;
+  s_stats.awakeMs += awakeMs;
+  if (awakeMs > s_stats.longestAwakeMs) s_stats.longestAwakeMs = awakeMs;
+  if (forced) s_stats.windowOverruns++;
+  s_stats.sleeps++;
+
+  rtc.clearAlarm(1);
+  rtc.setAlarm1(DateTime(wakeUnix), DS3231_A1_Hour);
+  const bool radio = WiFi.status() == WL_CONNECTED;
+  if (radio) WiFi.lowPowerMode();
+
+  s_alarmWake = false;
+  LowPower.deepSleep();
+
+  // millis() stood still; the alarm marks the start of wakeUnix
+  const unsigned long wakeMs = millis();
+  if (s_alarmWake) {
+    TimeServiceAnchor(wakeUnix, wakeMs);
+  } else {
+    TimeServiceRequestResync();
+  }
+  rtc.clearAlarm(1);
+  if (radio) WiFi.noLowPowerMode();
+
+  const PreciseTime woke = TimeNowPrecise(wakeMs);
+  s_stats.lastSleptMs = (woke.unixtime - now.unixtime) * TIME_MS_PER_SECOND + woke.millis - now.millis;
+  s_stats.sleptMs += s_stats.lastSleptMs;
+  s_wakeMs = wakeMs;
+  return true;
+}
+
+/**
+ * @brief Returns the sleep counters, for diagnostics and the native duty-cycle tests.
+ */
+const PowerStats& PowerGetStats() {
+  return s_stats;
+}
+
+/**
+ * @brief Returns the share of time awake in per mille, over all completed sleep cycles.
+ */
+uint16_t PowerDutyCyclePermille() {
+  const unsigned long total = s_stats.awakeMs + s_stats.sleptMs;
+  if (total == 0) return 1000;
+  return (uint16_t)((unsigned long long)s_stats.awakeMs * 1000 / total);
+}
@@ -0,0 +1,225 @@
+#include "publish_window.h"
+
+// =============================================================================
+// WINDOW STATE
+// =============================================================================
+
+static PublishEntry s_entries[PUBLISH_WINDOW_CAPACITY];
+static uint8_t s_windowSize = PUBLISH_WINDOW_DEFAULT_SIZE;
+static uint32_t s_nextOrder = 0;
+
+static bool IsRecoveryKind(uint8_t kind) {
+  return kind == PUBLISH_RECOVERY_LOG || kind == PUBLISH_RECOVERY_CSV || kind == PUBLISH_RECOVERY_RAM;
+}
+
+/// Messages on the recovery topic, whose echo carries their first timestamp
+static bool IsRecoveryTopicKind(uint8_t kind) {
+  return IsRecoveryKind(kind) || kind == PUBLISH_LIVE_BATCH;
+}
+
+static bool IsUsed(const PublishEntry& entry) {
+  return entry.state != PUBLISH_FREE;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+/**
+ * @brief Forgets all in-flight messages and restores the default window size.
+ */
+void PublishWindowReset() {
+  for (uint8_t i = 0; i < PUBLISH_WINDOW_CAPACITY; i++) s_entries[i].state = PUBLISH_FREE;
+  s_windowSize = PUBLISH_WINDOW_DEFAULT_SIZE;
+  s_nextOrder = 0;
+}
+
+/**
+ * @brief Sets how many recovery messages may wait for their ack at once.
+ *
+ * A size of 1 is the classic stop-and-wait behaviour; larger windows keep a
+ * high-latency link busy. Live readings use the reserve on top of the window.
+ *
+ * @param size Window size, clamped to 1..PUBLISH_WINDOW_MAX_SIZE
+ */
+void PublishWindowSetSize(uint8_t size) {
+  if (size < 1) size = 1;
+  if (size > PUBLISH_WINDOW_MAX_SIZE) size = PUBLISH_WINDOW_MAX_SIZE;
+  s_windowSize = size;
+}
+
+uint8_t PublishWindowSize() {
+  return s_windowSize;
+}
+
+/**
+ * @brief Claims a slot for a message that is about to be published.
+ *
+ * @param kind What the message carries
+ * @param key Echo match key (sequence or first recovered timestamp)
+ * @param nowMs Current millis(), start of the ack timeout
+ * @return The new entry for the caller to fill in, or nullptr if the window is full
+ */
+PublishEntry* PublishWindowAdd(PublishKind kind, uint32_t key, unsigned long nowMs) {
+  if (!PublishWindowHasRoom(kind)) return nullptr;
+
+  for (uint8_t i = 0; i < PUBLISH_WINDOW_CAPACITY; i++) {
+    PublishEntry& entry = s_entries[i];
+    if (IsUsed(entry)) continue;
+    memset(&entry, 0, sizeof(entry));
+    entry.kind = kind;
+    entry.state = PUBLISH_IN_FLIGHT;
+    entry.attempts = 1;
+    entry.key = key;
+    entry.order = s_nextOrder++;
+    entry.sentAtMs = nowMs;
+    return &entry;
+  }
+  return nullptr;
+}
+
+void PublishWindowRelease(PublishEntry* entry) {
+  if (entry) entry->state = PUBLISH_FREE;
+}
+
+/**
+ * @brief Drops all recovery messages; their data is still on the card and is sent again.
+ */
+void PublishWindowReleaseRecovery() {
+  for (uint8_t i = 0; i < PUBLISH_WINDOW_CAPACITY; i++) {
+    if (IsRecoveryKind(s_entries[i].kind)) s_entries[i].state = PUBLISH_FREE;
+  }
+}
+
+/**
+ * @brief Marks the oldest in-flight message with a matching key as acknowledged.
+ *
+ * @param recovery true for an ack on the recovery topic, false for the live topic
+ * @param key Ack match key taken from the acknowledgment
+ * @return true if an in-flight message matched
+ */
+bool PublishWindowAck(bool recovery, uint32_t key) {
+  PublishEntry* match = nullptr;
+  for (uint8_t i = 0; i < PUBLISH_WINDOW_CAPACITY; i++) {
+    PublishEntry& entry = s_entries[i];
+    if (entry.state != PUBLISH_IN_FLIGHT || IsRecoveryTopicKind(entry.kind) != recovery || entry.key != key) continue;
+    if (!match || entry.order < match->order) match = &entry;
+  }
+  if (!match) return false;
+  match->state = PUBLISH_ACKED;
+  return true;
+}
+
+/**
+ * @brief Marks the in-flight message that was published with this packet identifier as acknowledged.
+ *
+ * @param packetId Packet identifier of a PUBACK
+ * @return true if an in-flight message matched
+ */
+bool PublishWindowAckPacket(uint16_t packetId) {
+  if (packetId == 0) return false;
+  for (uint8_t i = 0; i < PUBLISH_WINDOW_CAPACITY; i++) {
+    PublishEntry& entry = s_entries[i];
+    if (entry.state == PUBLISH_IN_FLIGHT && entry.packetId == packetId) {
+      entry.state = PUBLISH_ACKED;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Returns the earliest published message of a kind that is not settled yet.
+ */
+PublishEntry* PublishWindowOldest(PublishKind kind) {
+  PublishEntry* oldest = nullptr;
+  for (uint8_t i = 0; i < PUBLISH_WINDOW_CAPACITY; i++) {
+    PublishEntry& entry = s_entries[i];
+    if (!IsUsed(entry) || entry.kind != kind) continue;
+    if (!oldest || entry.order < oldest->order) oldest = &entry;
+  }
+  return oldest;
+}
+
+/**
+ * @brief Returns an acknowledged message whose data may now be removed from the card.
+ *
+ * Outage log records can only be consumed from the front of the log, and a
+ * CSV batch that was split into several messages may only be deleted after
+ * all of its parts arrived, so acknowledged recovery messages are returned
+ * only once every older one of the same kind is settled. Live readings are
+ * returned in any order.
+ */
+PublishEntry* PublishWindowNextSettled(PublishKind kind) {
+  if (IsRecoveryKind(kind)) {
+    PublishEntry* oldest = PublishWindowOldest(kind);
+    return oldest && oldest->state == PUBLISH_ACKED ? oldest : nullptr;
+  }
+  for (uint8_t i = 0; i < PUBLISH_WINDOW_CAPACITY; i++) {
+    if (s_entries[i].state == PUBLISH_ACKED && s_entries[i].kind == kind) return &s_entries[i];
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Returns an in-flight message of a kind that waited longer than timeoutMs.
+ */
+PublishEntry* PublishWindowNextExpired(PublishKind kind, unsigned long nowMs, unsigned long timeoutMs) {
+  for (uint8_t i = 0; i < PUBLISH_WINDOW_CAPACITY; i++) {
+    PublishEntry& entry = s_entries[i];
+    if (entry.state != PUBLISH_IN_FLIGHT || entry.kind != kind) continue;
+    if (nowMs - entry.sentAtMs >= timeoutMs) return &entry;
+  }
+  return nullptr;
+}
+
+uint8_t PublishWindowCount(PublishKind kind) {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < PUBLISH_WINDOW_CAPACITY; i++) {
+    if (IsUsed(s_entries[i]) && s_entries[i].kind == kind) count++;
+  }
+  return count;
+}
+
+uint8_t PublishWindowRecoveryCount() {
+  return PublishWindowCount(PUBLISH_RECOVERY_LOG) + PublishWindowCount(PUBLISH_RECOVERY_CSV) +
+         PublishWindowCount(PUBLISH_RECOVERY_RAM);
+}
+
+/**
+ * @brief Checks whether another message of a kind may be published now.
+ *
+ * Recovery messages are limited by the window size, live readings only by
+ * the total capacity. One burst may be in flight, and only while a slot
+ * stays free for the next live reading.
+ */
+bool PublishWindowHasRoom(PublishKind kind) {
+  uint8_t used = 0;
+  for (uint8_t i = 0; i < PUBLISH_WINDOW_CAPACITY; i++) {
+    if (IsUsed(s_entries[i])) used++;
+  }
+  if (used >= PUBLISH_WINDOW_CAPACITY) return false;
+  if (kind == PUBLISH_BURST) return used + 1 < PUBLISH_WINDOW_CAPACITY && PublishWindowCount(PUBLISH_BURST) == 0;
+  return kind == PUBLISH_LIVE || kind == PUBLISH_LIVE_BATCH || PublishWindowRecoveryCount() < s_windowSize;
+}
+
+/**
+ * @brief Counts the records covered by messages of the same kind published before entry.
+ *
+ * This is the log (or ring) offset of the entry's first record, since
+ * unsettled messages have not been consumed yet.
+ *
+ * @param entry A PUBLISH_RECOVERY_LOG or PUBLISH_RECOVERY_RAM entry, or nullptr for all of them
+ * @param kind Kind to count when entry is nullptr
+ */
+uint32_t PublishWindowRecordsBefore(const PublishEntry* entry, PublishKind kind) {
+  if (entry) kind = (PublishKind)entry->kind;
+  uint32_t records = 0;
+  for (uint8_t i = 0; i < PUBLISH_WINDOW_CAPACITY; i++) {
+    const PublishEntry& other = s_entries[i];
+    if (!IsUsed(other) || other.kind != kind) continue;
+    if (entry && other.order >= entry->order) continue;
+    records += other.records;
+  }
+  return records;
+}
@@ -0,0 +1,78 @@
+#include "reconnect_policy.h"
+
+/// Seed used before Seed() is called and for an empty identifier
+static const uint32_t DEFAULT_SEED = 0x9E3779B9UL;
+
+/// FNV-1a hash of a string, never 0 (xorshift would stay at 0)
+static uint32_t HashDeviceId(const char* deviceId) {
+  uint32_t hash = 2166136261UL;
+  for (const char* c = deviceId; c && *c; c++) {
+    hash ^= (uint8_t)*c;
+    hash *= 16777619UL;
+  }
+  return hash ? hash : DEFAULT_SEED;
+}
+
+ReconnectPolicy::ReconnectPolicy()
+  : _state(DEFAULT_SEED), _consecutiveFailures(0), _totalFailures(0), _successes(0),
+    _lastDelayMs(0) {
+  _config.firstRetryMs = RECONNECT_FIRST_RETRY_MS;
+  _config.baseDelayMs = RECONNECT_BASE_DELAY_MS;
+  _config.maxDelayMs = RECONNECT_MAX_DELAY_MS;
+}
+
+void ReconnectPolicy::Configure(const ReconnectPolicyConfig& config) {
+  _config = config;
+}
+
+/**
+ * @brief Seeds the jitter from a device identifier.
+ *
+ * @param deviceId Identifier unique within the fleet, e.g. the MQTT client ID
+ */
+void ReconnectPolicy::Seed(const char* deviceId) {
+  _state = HashDeviceId(deviceId);
+}
+
+/**
+ * @brief Returns the ceiling of the wait that follows the next failure.
+ */
+unsigned long ReconnectPolicy::CeilingMs() const {
+  unsigned long ceiling = _config.firstRetryMs;
+  if (_consecutiveFailures > 0) {
+    ceiling = _config.baseDelayMs;
+    for (uint32_t i = 1; i < _consecutiveFailures && ceiling < _config.maxDelayMs; i++) {
+      ceiling *= 2;
+    }
+  }
+  return ceiling < _config.maxDelayMs ? ceiling : _config.maxDelayMs;
+}
+
+/**
+ * @brief Records a failed attempt or a lost link and returns the wait before the next attempt.
+ *
+ * @return Random wait in [0, CeilingMs()] in milliseconds
+ */
+unsigned long ReconnectPolicy::NextDelayMs() {
+  const unsigned long ceiling = CeilingMs();
+  _consecutiveFailures++;
+  _totalFailures++;
+  _lastDelayMs = NextRandom() % (ceiling + 1);
+  return _lastDelayMs;
+}
+
+/**
+ * @brief Records an established connection; the next failure uses the fast first retry.
+ */
+void ReconnectPolicy::RecordSuccess() {
+  _consecutiveFailures = 0;
+  _successes++;
+}
+
+/// xorshift32: small, fast and good enough to decorrelate devices
+uint32_t ReconnectPolicy::NextRandom() {
+  _state ^= _state << 13;
+  _state ^= _state >> 17;
+  _state ^= _state << 5;
+  return _state;
+}
@@ -0,0 +1,402 @@
+#include "recovery_stream.h"
+#include "fixed_point.h"
+
+// =============================================================================
+// PAYLOAD LAYOUT
+// =============================================================================
+
+static const char PAYLOAD_HEAD[] = "{\"timestamp\":";
+static const char PAYLOAD_META[] = ",\"sequence\":null,\"value\":[null],\"meta\":{\"t\":[";
+static const char PAYLOAD_VALUES[] = "],\"v\":[";
+static const char PAYLOAD_SEQUENCES[] = "],\"s\":[";
+static const char PAYLOAD_MINIMA[] = "],\"mn\":[";
+static const char PAYLOAD_MAXIMA[] = "],\"mx\":[";
+static const char PAYLOAD_COUNTS[] = "],\"n\":[";
+static const char PAYLOAD_LAST[] = "],\"l\":[";
+static const char PAYLOAD_TAIL[] = "]}}";
+
+/// Bytes of the payload that do not depend on the records
+static const size_t PAYLOAD_FIXED_BYTES = (sizeof(PAYLOAD_HEAD) - 1) + (sizeof(PAYLOAD_META) - 1) +
+    (sizeof(PAYLOAD_VALUES) - 1) + (sizeof(PAYLOAD_SEQUENCES) - 1) + (sizeof(PAYLOAD_TAIL) - 1);
+/// Bytes the statistics columns of an aggregated message add without their records
+static const size_t PAYLOAD_STATS_FIXED_BYTES = (sizeof(PAYLOAD_MINIMA) - 1) + (sizeof(PAYLOAD_MAXIMA) - 1) +
+    (sizeof(PAYLOAD_COUNTS) - 1);
+
+/// Room for the longest formatted number
+static const size_t NUMBER_BUFFER_SIZE = FIXED_POINT_BUFFER_SIZE;
+/// Bytes collected before they are handed to the client
+static const size_t PRINT_CHUNK_BYTES = 64;
+
+enum RecoveryColumn {
+  COLUMN_TIMESTAMP,
+  COLUMN_VALUE,
+  COLUMN_SEQUENCE,
+  COLUMN_MIN,
+  COLUMN_MAX,
+  COLUMN_COUNT,
+  COLUMN_LAST
+};
+
+// =============================================================================
+// NUMBER FORMATTING
+// =============================================================================
+
+static size_t FormatColumn(char* buffer, const RecoveryRecord& record, RecoveryColumn column) {
+  switch (column) {
+    case COLUMN_TIMESTAMP: return FormatUnsigned(buffer, record.timestamp);
+    case COLUMN_VALUE:     return FormatFixedPoint(buffer, record.value, record.scale);
+    case COLUMN_MIN:       return FormatFixedPoint(buffer, record.min, record.scale);
+    case COLUMN_MAX:       return FormatFixedPoint(buffer, record.max, record.scale);
+    case COLUMN_COUNT:     return FormatUnsigned(buffer, record.count);
+    case COLUMN_LAST:      return FormatFixedPoint(buffer, record.last, record.scale);
+    default:               return FormatSigned(buffer, record.sequence);
+  }
+}
+
+/// Fills the statistics of a record that stands for one reading
+static void SetSingleReading(RecoveryRecord& record) {
+  record.min = record.value;
+  record.max = record.value;
+  record.last = record.value;
+  record.count = 1;
+}
+
+// =============================================================================
+// RECORD SOURCES
+// =============================================================================
+
+OutageLogRecordSource::OutageLogRecordSource(size_t skip, size_t maxRecords, OutageRecordPeek peek)
+  : _peek(peek), _skip(skip), _maxRecords(maxRecords), _position(0), _ended(false), _chunkStart(0), _chunkCount(0) {}
+
+bool OutageLogRecordSource::Rewind() {
+  _position = 0;
+  _ended = false;
+  return true;
+}
+
+bool OutageLogRecordSource::Next(RecoveryRecord& record) {
+  if (_position >= _maxRecords) {
+    _ended = true;
+    return false;
+  }
+
+  // The chunk is kept across Rewind(), so every pass over a short message reads the log once
+  if (_position < _chunkStart || _position >= _chunkStart + _chunkCount) {
+    size_t want = _maxRecords - _position;
+    if (want > RECOVERY_SOURCE_CHUNK_RECORDS) want = RECOVERY_SOURCE_CHUNK_RECORDS;
+    _chunkStart = _position;
+    _chunkCount = _peek(_chunk, want, _skip + _position);
+    if (_chunkCount == 0) {
+      _ended = true;
+      return false;
+    }
+  }
+
+  const OutageRecord& stored = _chunk[_position - _chunkStart];
+  record.timestamp = stored.timestamp;
+  record.sequence = (int32_t)stored.sequence;
+  record.value = stored.rawTemp;
+  record.scale = 128;
+  if (stored.count > 1) {
+    record.min = stored.rawMin;
+    record.max = stored.rawMax;
+    record.last = stored.rawLast;
+    record.count = stored.count;
+  } else {
+    SetSingleReading(record);
+  }
+  _position++;
+  return true;
+}
+
+RecoveryPosition OutageLogRecordSource::Position() const {
+  RecoveryPosition position = {0, (uint32_t)(_ended || _position == 0 ? _position : _position - 1)};
+  return position;
+}
+
+CsvBatchRecordSource::CsvBatchRecordSource()
+  : _open(false), _offset(0), _maxRecords(0), _returned(0), _position(0), _scanned(0), _rejected(0) {}
+
+CsvBatchRecordSource::CsvBatchRecordSource(const char* path, uint32_t offset, size_t maxRecords)
+  : CsvBatchRecordSource() {
+  Open(path, offset, maxRecords);
+}
+
+CsvBatchRecordSource::~CsvBatchRecordSource() {
+  Close();
+}
+
+/**
+ * @brief Opens a batch file and positions it at a byte offset.
+ *
+ * @param path Batch file
+ * @param offset Byte offset of the first line to read
+ * @param maxRecords Records returned at most before Next() reports the end
+ * @return true if the file was opened
+ */
+bool CsvBatchRecordSource::Open(const char* path, uint32_t offset, size_t maxRecords) {
+  Close();
+  _offset = offset;
+  _maxRecords = maxRecords;
+  _scanned = offset;
+  _rejected = 0;
+  _file = sd.open(path, FILE_READ);
+  _open = (bool)_file;
+  return _open && Rewind();
+}
+
+void CsvBatchRecordSource::Close() {
+  if (_open) _file.close();
+  _open = false;
+}
+
+bool CsvBatchRecordSource::Rewind() {
+  if (!_open) return false;
+  _returned = 0;
+  _position = _offset;
+  return _file.seekSet(_offset);
+}
+
+bool CsvBatchRecordSource::Next(RecoveryRecord& record) {
+  if (!_open) return false;
+  // At the limit the message ends right after the last record returned
+  if (_returned >= _maxRecords) {
+    _position = _file.curPosition();
+    return false;
+  }
+
+  char line[RECOVERY_CSV_LINE_BYTES];
+  while (_file.available()) {
+    const uint32_t lineStart = _file.curPosition();
+    size_t len = _file.fgets(line, sizeof(line));
+    if (len == 0) continue;
+
+    const uint32_t lineEnd = _file.curPosition();
+    CsvRecord parsed;
+    CsvParseResult result = ParseCsvRecord(line, len, parsed);
+    if (result != CSV_OK) {
+      // Blank lines are not worth a report; everything else is counted once
+      if (lineEnd > _scanned && result != CSV_ERR_EMPTY) _rejected++;
+      if (lineEnd > _scanned) _scanned = lineEnd;
+      continue;
+    }
+    if (lineEnd > _scanned) _scanned = lineEnd;
+
+    record.timestamp = parsed.timestamp;
+    record.sequence = parsed.sequence;
+    record.value = parsed.milliCelsius;
+    record.scale = (uint16_t)CSV_TEMP_SCALE;
+    SetSingleReading(record);
+    _position = lineStart;
+    _returned++;
+    return true;
+  }
+  _position = _file.curPosition();
+  return false;
+}
+
+RecoveryPosition CsvBatchRecordSource::Position() const {
+  RecoveryPosition position = {0, _position};
+  return position;
+}
+
+CsvManifestRecordSource::CsvManifestRecordSource(RecoveryPosition start, uint32_t oldestTimestamp, size_t maxRecords)
+  : _start(start), _oldestTimestamp(oldestTimestamp), _maxRecords(maxRecords), _returned(0),
+    _batch(start.batch), _position(start) {}
+
+bool CsvManifestRecordSource::Rewind() {
+  // A message within one batch keeps its file open between the passes
+  if (_reader.IsOpen() && _batch == _start.batch) {
+    _reader.Rewind();
+  } else {
+    _reader.Close();
+    _batch = _start.batch;
+  }
+  _returned = 0;
+  _position = _start;
+  return true;
+}
+
+/// Opens the first pending batch from _batch on, false where the source ends
+bool CsvManifestRecordSource::OpenCurrentBatch() {
+  const uint16_t batchCount = BatchManifestCount();
+  for (; _batch < batchCount; _batch++) {
+    BatchEntry batch;
+    if (!BatchManifestRead(_batch, batch)) return false;
+    if (batch.state != BATCH_PENDING) continue;
+    if (batch.firstTimestamp < _oldestTimestamp) return false;
+
+    const uint32_t offset = _batch == _start.batch ? _start.offset : 0;
+    return _reader.Open(batch.path, offset, _maxRecords - _returned);
+  }
+  return false;
+}
+
+bool CsvManifestRecordSource::Next(RecoveryRecord& record) {
+  while (true) {
+    if (!_reader.IsOpen() && !OpenCurrentBatch()) {
+      // Every batch before this one is covered by the message
+      _position.batch = _batch;
+      _position.offset = 0;
+      return false;
+    }
+
+    if (_reader.Next(record)) {
+      _position.batch = _batch;
+      _position.offset = _reader.Position().offset;
+      _returned++;
+      return true;
+    }
+
+    if (_returned >= _maxRecords) {
+      _position.batch = _batch;
+      _position.offset = _reader.Position().offset;
+      return false;
+    }
+    _reader.Close();
+    _batch++;
+  }
+}
+
+// =============================================================================
+// MESSAGE ENCODER
+// =============================================================================
+
+/**
+ * @brief Works out how many records of a source fit into one recovery message.
+ *
+ * Reads the source once from its start. The message ends before the first
+ * record that would push the payload past maxBytes, or at the end of the source;
+ * info.end is where the next message picks up. The statistics columns are
+ * sized along the way and count from the first aggregate on.
+ *
+ * @param source Records of the message, rewound before use
+ * @param timestamp Top-level "timestamp" of the message
+ * @param maxBytes Largest payload allowed
+ * @param[out] info Record count, exact length and where the next message starts
+ * @return true if at least one record fits
+ */
+bool RecoveryMeasure(RecoveryRecordSource& source, uint32_t timestamp, size_t maxBytes, RecoveryMessageInfo& info) {
+  char number[NUMBER_BUFFER_SIZE];
+  memset(&info, 0, sizeof(info));
+  if (!source.Rewind()) return false;
+
+  const bool reportLast = AggregateReportsLast();
+  size_t bytes = PAYLOAD_FIXED_BYTES + FormatUnsigned(number, timestamp);
+  size_t statsBytes = PAYLOAD_STATS_FIXED_BYTES + (reportLast ? sizeof(PAYLOAD_LAST) - 1 : 0);
+
+  RecoveryRecord record;
+  while (true) {
+    if (!source.Next(record)) {
+      info.complete = true;
+      break;
+    }
+
+    size_t recordBytes = FormatColumn(number, record, COLUMN_TIMESTAMP) +
+                         FormatColumn(number, record, COLUMN_VALUE) +
+                         FormatColumn(number, record, COLUMN_SEQUENCE);
+    size_t recordStatsBytes = FormatColumn(number, record, COLUMN_MIN) +
+                              FormatColumn(number, record, COLUMN_MAX) +
+                              FormatColumn(number, record, COLUMN_COUNT) +
+                              (reportLast ? FormatColumn(number, record, COLUMN_LAST) : 0);
+    if (info.records > 0) {
+      recordBytes += 3;  // Separators in all three arrays
+      recordStatsBytes += reportLast ? 4 : 3;
+    }
+    const bool aggregated = info.aggregated || record.count > 1;
+    if (bytes + recordBytes + (aggregated ? statsBytes + recordStatsBytes : 0) > maxBytes) break;
+
+    if (info.records == 0) info.firstTimestamp = record.timestamp;
+    bytes += recordBytes;
+    statsBytes += recordStatsBytes;
+    info.aggregated = aggregated;
+    info.records++;
+  }
+
+  info.bytes = bytes + (info.aggregated ? statsBytes : 0);
+  info.end = source.Position();
+  return info.records > 0;
+}
+
+/// Collects small pieces of the payload and prints them in chunks
+struct PayloadWriter {
+  MqttClient& client;
+  char chunk[PRINT_CHUNK_BYTES + 1];
+  size_t used;
+  size_t total;
+
+  explicit PayloadWriter(MqttClient& target) : client(target), used(0), total(0) {}
+
+  void Put(const char* text, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      if (used == PRINT_CHUNK_BYTES) Flush();
+      chunk[used++] = text[i];
+    }
+  }
+
+  void Put(const char* text) { Put(text, strlen(text)); }
+
+  void Flush() {
+    if (used == 0) return;
+    chunk[used] = '\0';
+    client.print(chunk);
+    total += used;
+    used = 0;
+  }
+};
+
+static bool StreamColumn(PayloadWriter& writer, RecoveryRecordSource& source, size_t records, RecoveryColumn column) {
+  char number[NUMBER_BUFFER_SIZE];
+  RecoveryRecord record;
+
+  if (!source.Rewind()) return false;
+  for (size_t i = 0; i < records; i++) {
+    if (!source.Next(record)) return false;
+    if (i > 0) writer.Put(",", 1);
+    writer.Put(number, FormatColumn(number, record, column));
+  }
+  return true;
+}
+
+/**
+ * @brief Prints a recovery message measured by RecoveryMeasure() into an open MQTT message.
+ *
+ * The source is read once per array, so the card is read three times (six
+ * or seven with statistics) in exchange for never holding the message in RAM.
+ *
+ * @param client MQTT client after beginMessage() with info.bytes as length
+ * @param source The source passed to RecoveryMeasure()
+ * @param timestamp Top-level "timestamp" passed to RecoveryMeasure()
+ * @param info Result of RecoveryMeasure()
+ * @return true if exactly info.bytes were printed; false if the source changed in between
+ */
+bool RecoveryStreamMessage(MqttClient& client, RecoveryRecordSource& source, uint32_t timestamp,
+                           const RecoveryMessageInfo& info) {
+  char number[NUMBER_BUFFER_SIZE];
+  PayloadWriter writer(client);
+
+  writer.Put(PAYLOAD_HEAD);
+  writer.Put(number, FormatUnsigned(number, timestamp));
+  writer.Put(PAYLOAD_META);
+  bool ok = StreamColumn(writer, source, info.records, COLUMN_TIMESTAMP);
+  writer.Put(PAYLOAD_VALUES);
+  ok = ok && StreamColumn(writer, source, info.records, COLUMN_VALUE);
+  writer.Put(PAYLOAD_SEQUENCES);
+  ok = ok && StreamColumn(writer, source, info.records, COLUMN_SEQUENCE);
+  if (info.aggregated) {
+    writer.Put(PAYLOAD_MINIMA);
+    ok = ok && StreamColumn(writer, source, info.records, COLUMN_MIN);
+    writer.Put(PAYLOAD_MAXIMA);
+    ok = ok && StreamColumn(writer, source, info.records, COLUMN_MAX);
+    writer.Put(PAYLOAD_COUNTS);
+    ok = ok && StreamColumn(writer, source, info.records, COLUMN_COUNT);
+    if (AggregateReportsLast()) {
+      writer.Put(PAYLOAD_LAST);
+      ok = ok && StreamColumn(writer, source, info.records, COLUMN_LAST);
+    }
+  }
+  writer.Put(PAYLOAD_TAIL);
+  writer.Flush();
+
+  return ok && writer.total == info.bytes;
+}
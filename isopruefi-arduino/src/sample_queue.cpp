@@ -0,0 +1,55 @@
+#include "sample_queue.h"
+
+static_assert((SAMPLE_QUEUE_CAPACITY & (SAMPLE_QUEUE_CAPACITY - 1)) == 0,
+              "SAMPLE_QUEUE_CAPACITY must be a power of two");
+
+SampleQueue::SampleQueue() : _head(0), _tail(0), _dropped(0) {
+}
+
+/**
+ * @brief Appends a record; producer side only.
+ *
+ * @return false if the queue was full and the record was dropped
+ */
+bool SampleQueue::Push(const SampleRecord& record) {
+  const uint32_t head = _head.load(std::memory_order_relaxed);
+  if (head - _tail.load(std::memory_order_acquire) >= SAMPLE_QUEUE_CAPACITY) {
+    // No read-modify-write: the producer is the only writer
+    _dropped.store(_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return false;
+  }
+  _records[head % SAMPLE_QUEUE_CAPACITY] = record;
+  _head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief Takes the oldest record; consumer side only.
+ *
+ * @param[out] record Untouched if the queue is empty
+ * @return false if the queue is empty
+ */
+bool SampleQueue::Pop(SampleRecord& record) {
+  const uint32_t tail = _tail.load(std::memory_order_relaxed);
+  if (_head.load(std::memory_order_acquire) == tail) return false;
+  record = _records[tail % SAMPLE_QUEUE_CAPACITY];
+  _tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief Empties the queue and clears the drop counter; only while neither side runs.
+ */
+void SampleQueue::Reset() {
+  _head.store(0, std::memory_order_relaxed);
+  _tail.store(0, std::memory_order_relaxed);
+  _dropped.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the records waiting; exact on either side, a snapshot elsewhere.
+ */
+uint32_t SampleQueue::Count() const {
+  const uint32_t tail = _tail.load(std::memory_order_acquire);
+  return _head.load(std::memory_order_acquire) - tail;
+}
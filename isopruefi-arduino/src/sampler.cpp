@@ -0,0 +1,119 @@
+#include "sampler.h"
+#include "sensor.h"
+
+static const uint32_t SECONDS_PER_MINUTE = 60;
+
+static SampleQueue s_queue;
+
+// Written by the loop, read by the interrupt
+static std::atomic<bool> s_running(false);
+static std::atomic<uint8_t> s_periodSeconds(SECONDS_PER_MINUTE);
+static uint8_t s_phaseSeconds = 0;   // only written while stopped
+
+// Owned by the interrupt while running
+static uint32_t s_time = 0;          // RTC second that began at the last edge
+static bool s_converting = false;
+static SampleRecord s_pending = {0, 0, 0};
+
+/**
+ * @brief Starts sampling at the next SQW edge.
+ *
+ * Read unixtime right before the call: an edge in between would shift
+ * every sample by a second.
+ *
+ * @param unixtime RTC second running now; the next edge begins the one after
+ * @param phaseSeconds This device's reporting point of the minute (0..59)
+ * @param periodSeconds Sample period (see SamplerSetPeriod())
+ */
+void SamplerBegin(uint32_t unixtime, uint8_t phaseSeconds, uint8_t periodSeconds) {
+  s_running.store(false, std::memory_order_relaxed);
+  s_time = unixtime;
+  s_converting = false;
+  s_phaseSeconds = phaseSeconds % SECONDS_PER_MINUTE;
+  SamplerSetPeriod(periodSeconds);
+  s_running.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Stops sampling; records still queued can be taken afterwards.
+ *
+ * A conversion the interrupt started is left to finish on its own.
+ */
+void SamplerStop() {
+  s_running.store(false, std::memory_order_release);
+}
+
+bool SamplerRunning() {
+  return s_running.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Sets the time between two samples, from the next edge on.
+ *
+ * @param seconds Sample period, clamped to 1..60
+ */
+void SamplerSetPeriod(uint8_t seconds) {
+  if (seconds < 1) seconds = 1;
+  if (seconds > SECONDS_PER_MINUTE) seconds = SECONDS_PER_MINUTE;
+  s_periodSeconds.store(seconds, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Interrupt handler for the falling edge of the DS3231's 1 Hz SQW output.
+ *
+ * Queues the result of the conversion started at an earlier edge, then
+ * starts the next one if this second is a point of the sample grid. A
+ * sensor that does not answer is queued as a failed sample.
+ */
+void SamplerOnSecond() {
+  if (!s_running.load(std::memory_order_acquire)) return;
+  s_time++;
+
+  if (s_converting) {
+    s_converting = false;
+    if (!ReadTemperatureRaw(s_pending.raw)) s_pending.flags |= SAMPLE_FLAG_FAILED;
+    s_queue.Push(s_pending);
+  }
+
+  const uint32_t offset = (s_time % SECONDS_PER_MINUTE + SECONDS_PER_MINUTE - s_phaseSeconds) % SECONDS_PER_MINUTE;
+  if (offset % s_periodSeconds.load(std::memory_order_relaxed) != 0) return;
+
+  s_pending.time = s_time;
+  s_pending.raw = 0;
+  s_pending.flags = offset == 0 ? SAMPLE_FLAG_REPORT : 0;
+  if (SensorTriggerOneShot()) {
+    s_converting = true;
+  } else {
+    s_pending.flags |= SAMPLE_FLAG_FAILED;
+    s_queue.Push(s_pending);
+  }
+}
+
+/**
+ * @brief Takes the oldest queued sample; loop side only.
+ *
+ * @return false if there is none
+ */
+bool SamplerTake(SampleRecord& record) {
+  return s_queue.Pop(record);
+}
+
+/**
+ * @brief Returns the sample queue with its counters, for diagnostics.
+ */
+const SampleQueue& SamplerQueue() {
+  return s_queue;
+}
+
+/**
+ * @brief Stops sampling and empties the queue; only while the interrupt cannot fire.
+ */
+void SamplerReset() {
+  s_running.store(false, std::memory_order_relaxed);
+  s_periodSeconds.store(SECONDS_PER_MINUTE, std::memory_order_relaxed);
+  s_phaseSeconds = 0;
+  s_time = 0;
+  s_converting = false;
+  s_pending = SampleRecord{0, 0, 0};
+  s_queue.Reset();
+}
@@ -0,0 +1,131 @@
+#include "scheduler.h"
+
+/// true once nowMs has reached deadlineMs, also across the millis() wrap
+static bool IsDue(unsigned long nowMs, unsigned long deadlineMs) {
+  return (long)(nowMs - deadlineMs) >= 0;
+}
+
+Scheduler::Scheduler() : _count(0) {}
+
+/**
+ * @brief Adds a periodic task.
+ *
+ * @param name Task name for diagnostics
+ * @param callback Task body
+ * @param periodMs Time between two runs, 0 for every pass
+ * @param budgetMs Longest run that does not count as an overrun
+ * @param firstRunMs millis() value of the first run
+ * @return Task handle, SCHEDULER_NO_TASK if all slots are taken
+ */
+uint8_t Scheduler::AddTask(const char* name, SchedulerCallback callback, unsigned long periodMs,
+                           unsigned long budgetMs, unsigned long firstRunMs) {
+  if (_count >= SCHEDULER_MAX_TASKS || !callback) return SCHEDULER_NO_TASK;
+
+  SchedulerTask& task = _tasks[_count];
+  task.name = name;
+  task.callback = callback;
+  task.periodMs = periodMs;
+  task.budgetMs = budgetMs;
+  task.nextRunMs = firstRunMs;
+  task.lastRunMs = 0;
+  task.runs = 0;
+  task.overruns = 0;
+  task.enabled = true;
+  return _count++;
+}
+
+void Scheduler::SetEnabled(uint8_t task, bool enabled) {
+  if (task < _count) _tasks[task].enabled = enabled;
+}
+
+void Scheduler::SetPeriod(uint8_t task, unsigned long periodMs) {
+  if (task < _count) _tasks[task].periodMs = periodMs;
+}
+
+/**
+ * @brief Moves the next deadline of a task, e.g. to align it with the RTC.
+ *
+ * Called from inside the task itself, this replaces the periodic deadline.
+ */
+void Scheduler::RunAt(uint8_t task, unsigned long atMs) {
+  if (task < _count) _tasks[task].nextRunMs = atMs;
+}
+
+/**
+ * @brief Runs every enabled task whose deadline has passed, once.
+ *
+ * @return Number of tasks that ran
+ */
+uint8_t Scheduler::Run() {
+  uint8_t ran = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    SchedulerTask& task = _tasks[i];
+    const unsigned long startMs = millis();
+    if (!task.enabled || !IsDue(startMs, task.nextRunMs)) continue;
+
+    // Advance first, so a task may set its own next deadline with RunAt(); runs
+    // missed by a late pass are skipped, the phase is kept
+    if (task.periodMs > 0) {
+      const unsigned long missed = (startMs - task.nextRunMs) / task.periodMs;
+      task.nextRunMs += (missed + 1) * task.periodMs;
+    }
+
+    task.callback(startMs);
+
+    task.lastRunMs = millis() - startMs;
+    task.runs++;
+    if (task.lastRunMs > task.budgetMs) task.overruns++;
+    ran++;
+  }
+  return ran;
+}
+
+/**
+ * @brief Returns how long the caller may idle before the next task is due.
+ *
+ * @param nowMs Current millis() value
+ * @return 0 if a task is due, otherwise the time until the earliest deadline
+ */
+unsigned long Scheduler::MsUntilNextRun(unsigned long nowMs) const {
+  unsigned long shortest = (unsigned long)-1;
+  for (uint8_t i = 0; i < _count; i++) {
+    const SchedulerTask& task = _tasks[i];
+    if (!task.enabled) continue;
+    if (IsDue(nowMs, task.nextRunMs)) return 0;
+    unsigned long wait = task.nextRunMs - nowMs;
+    if (wait < shortest) shortest = wait;
+  }
+  return shortest;
+}
+
+/**
+ * @brief Returns a task's settings and run statistics, nullptr for an unknown handle.
+ */
+const SchedulerTask* Scheduler::Task(uint8_t task) const {
+  return task < _count ? &_tasks[task] : nullptr;
+}
+
+/**
+ * @brief Maps a device identifier to a fixed slot of a shared period.
+ *
+ * @param deviceId Identifier unique within the fleet, e.g. the sensor ID
+ * @param slots Number of slots, e.g. seconds of a minute
+ * @return Slot in [0, slots), 0 if slots is 0
+ */
+uint16_t SchedulerPhaseFromId(const char* deviceId, uint16_t slots) {
+  if (slots == 0) return 0;
+
+  // FNV-1a spreads similar names ("Sensor_One", "Sensor_Two") apart
+  uint32_t hash = 2166136261UL;
+  for (const char* c = deviceId; c && *c; c++) {
+    hash ^= (uint8_t)*c;
+    hash *= 16777619UL;
+  }
+  // FNV-1a alone leaves the low bits of sequential names correlated
+  hash ^= hash >> 16;
+  hash *= 0x85EBCA6BUL;
+  hash ^= hash >> 13;
+  hash *= 0xC2B2AE35UL;
+  hash ^= hash >> 16;
+  return hash % slots;
+}
@@ -1,15 +1,205 @@
 #include "sensor.h"
+#include "logger.h"
 
+// ADT7410 registers and bits (datasheet, "Register Map")
+static const uint8_t REG_TEMP_MSB = 0x00;
+static const uint8_t REG_STATUS = 0x02;
+static const uint8_t REG_CONFIG = 0x03;
+static const uint8_t STATUS_NOT_READY = 0x80;   // /RDY: low once a conversion result is ready
+static const uint8_t CONFIG_16BIT = 0x80;
+static const uint8_t CONFIG_MODE_ONE_SHOT = 0x20;
+static const uint8_t CONFIG_MODE_SHUTDOWN = 0x60;
+
+static SensorStatus s_status = SENSOR_IDLE;
+static uint8_t s_oversampling = 1;
+static uint8_t s_conversionsDone = 0;
+static int32_t s_sum = 0;
+static unsigned long s_conversionStartMs = 0;
+
+// Register access of the driver; the library only reads the temperature as float.
+// The native build puts a register model of the ADT7410 behind the same device.
+static Adafruit_I2CDevice s_device(ADT7410_I2CADDR_DEFAULT);
+
+static bool WriteRegister(uint8_t reg, uint8_t value) {
+  const uint8_t data[2] = {reg, value};
+  return s_device.write(data, sizeof(data));
+}
+
+/// Reads len registers from reg on, with a repeated start after the address write
+static bool ReadRegisters(uint8_t reg, uint8_t* data, size_t len) {
+  return s_device.write_then_read(&reg, 1, data, len);
+}
+
+/**
+ * @brief Checks the sensor and leaves it in 16-bit resolution and shutdown.
+ *
+ * No conversion runs until the first SensorStartConversion(), so nothing
+ * has to be waited for here.
+ */
 bool InitSensor(Adafruit_ADT7410& sensor) {
   if (!sensor.begin()) {
-    Serial.println("ADT7410 not found!");
+    LOG_ERROR("ADT7410 not found!");
+    return false;
+  }
+  if (!s_device.begin(false) || !WriteRegister(REG_CONFIG, CONFIG_16BIT | CONFIG_MODE_SHUTDOWN)) {
+    LOG_ERROR("ADT7410 config failed!");
+    return false;
+  }
+  SensorReset();
+  return true;
+}
+
+/**
+ * @brief Starts a single one-shot conversion and nothing else: one short I2C write.
+ *
+ * For the sampling interrupt (see sampler.h), which reads the result itself
+ * with ReadTemperatureRaw() a second later. The driver calls it too.
+ *
+ * @return false if the sensor did not answer
+ */
+bool SensorTriggerOneShot() {
+  return WriteRegister(REG_CONFIG, CONFIG_16BIT | CONFIG_MODE_ONE_SHOT);
+}
+
+static bool StartOneShot(unsigned long nowMs) {
+  if (!SensorTriggerOneShot()) return false;
+  s_conversionStartMs = nowMs;
+  return true;
+}
+
+/**
+ * @brief Starts a reading: one conversion, or as many as set by SensorSetOversampling().
+ *
+ * @param nowMs Current millis() value
+ * @return false if a reading is already running or the sensor did not answer
+ */
+bool SensorStartConversion(unsigned long nowMs) {
+  if (s_status == SENSOR_CONVERTING) return false;
+  s_conversionsDone = 0;
+  s_sum = 0;
+  if (!StartOneShot(nowMs)) {
+    s_status = SENSOR_FAILED;
     return false;
   }
-  delay(250);
-  sensor.setResolution(ADT7410_16BIT);
+  s_status = SENSOR_CONVERTING;
+  return true;
+}
+
+/**
+ * @brief Advances a running reading and returns where it stands.
+ *
+ * Reads the status register only once the conversion time has passed, and
+ * the temperature only once the ready bit says so. A finished conversion
+ * starts the next one until the oversampling count is reached.
+ *
+ * @param nowMs Current millis() value
+ */
+SensorStatus SensorPoll(unsigned long nowMs) {
+  if (s_status != SENSOR_CONVERTING) return s_status;
+
+  const unsigned long elapsed = nowMs - s_conversionStartMs;
+  if (elapsed < SENSOR_CONVERSION_MS) return s_status;
+
+  uint8_t status;
+  if (!ReadRegisters(REG_STATUS, &status, 1)) {
+    s_status = SENSOR_FAILED;
+    return s_status;
+  }
+  if (status & STATUS_NOT_READY) {
+    if (elapsed >= SENSOR_CONVERSION_TIMEOUT_MS) s_status = SENSOR_FAILED;
+    return s_status;
+  }
+
+  int16_t raw;
+  if (!ReadTemperatureRaw(raw)) {
+    s_status = SENSOR_FAILED;
+    return s_status;
+  }
+  s_sum += raw;
+  s_conversionsDone++;
+
+  if (s_conversionsDone >= s_oversampling) {
+    s_status = SENSOR_READY;
+  } else if (!StartOneShot(nowMs)) {
+    s_status = SENSOR_FAILED;
+  }
+  return s_status;
+}
+
+/**
+ * @brief Hands out a finished reading; the driver is idle again afterwards.
+ *
+ * @param[out] raw Mean of the conversions in ADT7410 counts, rounded to nearest
+ * @return false if no reading is ready (still converting, failed or never started)
+ */
+bool SensorFetch(int16_t& raw) {
+  if (s_status == SENSOR_CONVERTING) return false;
+  const bool ready = s_status == SENSOR_READY;
+  if (ready) {
+    const int32_t half = s_conversionsDone / 2;
+    raw = (int16_t)(s_sum >= 0 ? (s_sum + half) / s_conversionsDone : (s_sum - half) / s_conversionsDone);
+  }
+  s_status = SENSOR_IDLE;
+  return ready;
+}
+
+/**
+ * @brief Returns how long to wait before the next SensorPoll() is worth it.
+ */
+unsigned long SensorMsUntilReady(unsigned long nowMs) {
+  if (s_status != SENSOR_CONVERTING) return 0;
+  const unsigned long elapsed = nowMs - s_conversionStartMs;
+  return elapsed < SENSOR_CONVERSION_MS ? SENSOR_CONVERSION_MS - elapsed : SENSOR_POLL_INTERVAL_MS;
+}
+
+/**
+ * @brief Sets the number of conversions averaged into one reading.
+ *
+ * @param conversions Clamped to 1..SENSOR_MAX_OVERSAMPLING; 1 turns oversampling off.
+ *                    A reading takes about conversions * SENSOR_CONVERSION_MS.
+ */
+void SensorSetOversampling(uint8_t conversions) {
+  if (conversions < 1) conversions = 1;
+  if (conversions > SENSOR_MAX_OVERSAMPLING) conversions = SENSOR_MAX_OVERSAMPLING;
+  s_oversampling = conversions;
+}
+
+uint8_t SensorOversampling() {
+  return s_oversampling;
+}
+
+/**
+ * @brief Abandons a running reading and turns oversampling off.
+ */
+void SensorReset() {
+  s_status = SENSOR_IDLE;
+  s_oversampling = 1;
+  s_conversionsDone = 0;
+  s_sum = 0;
+  s_conversionStartMs = 0;
+}
+
+/**
+ * @brief Reads the temperature register as it is, in ADT7410 counts (1/128 °C).
+ *
+ * This is the path every reading takes into aggregates, records and payloads;
+ * no float is involved. The register is read directly because the library
+ * only hands out the converted float. SensorPoll() calls it once a
+ * conversion is ready.
+ *
+ * @param[out] raw Temperature in counts, untouched on failure
+ * @return false if the sensor did not answer
+ */
+bool ReadTemperatureRaw(int16_t& raw) {
+  uint8_t data[2];
+  if (!ReadRegisters(REG_TEMP_MSB, data, sizeof(data))) return false;
+  raw = (int16_t)(((uint16_t)data[0] << 8) | data[1]);
   return true;
 }
 
+/**
+ * @brief Reads the temperature in degrees Celsius, for diagnostics only.
+ */
 float ReadTemperatureInCelsius() {
-  return tempsensor.readTempC();  
+  return tempsensor.readTempC();
 }
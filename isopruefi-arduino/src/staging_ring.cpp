@@ -0,0 +1,152 @@
+#include "staging_ring.h"
+
+// =============================================================================
+// RING STATE
+// =============================================================================
+
+static OutageRecord s_records[STAGING_RING_CAPACITY];
+/// millis() at which each reading was pushed
+static unsigned long s_pushedAtMs[STAGING_RING_CAPACITY];
+/// Slot of the oldest reading
+static uint8_t s_head = 0;
+static uint8_t s_count = 0;
+/// Oldest readings that are part of an in-flight recovery message
+static uint8_t s_held = 0;
+static uint32_t s_spilled = 0;
+
+static uint8_t SlotAt(size_t index) {
+  return (uint8_t)((s_head + index) % STAGING_RING_CAPACITY);
+}
+
+/**
+ * @brief Moves the oldest reading to the outage log.
+ *
+ * The reading leaves the ring even if the log cannot take it, so a card
+ * failure never blocks new readings; the log counts what it loses.
+ */
+static bool SpillOldest() {
+  bool stored = OutageLogAppend(s_records[s_head]);
+  s_head = SlotAt(1);
+  s_count--;
+  s_spilled++;
+  return stored;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+/**
+ * @brief Forgets all staged readings.
+ */
+void StagingRingReset() {
+  s_head = 0;
+  s_count = 0;
+  s_held = 0;
+  s_spilled = 0;
+}
+
+/**
+ * @brief Stages one reading for recovery.
+ *
+ * Above STAGING_RING_HIGH_WATER the oldest readings that are not held move to
+ * the outage log first. If the ring is full of held readings, the new one is
+ * appended to the outage log instead.
+ *
+ * @param record Reading to stage
+ * @param nowMs Current millis(), start of the reading's age
+ * @return true if the reading was staged or stored in the outage log
+ */
+bool StagingRingPush(const OutageRecord& record, unsigned long nowMs) {
+  while (s_count >= STAGING_RING_HIGH_WATER && s_held == 0) SpillOldest();
+  if (s_count >= STAGING_RING_CAPACITY) {
+    s_spilled++;
+    return OutageLogAppend(record);
+  }
+
+  uint8_t slot = SlotAt(s_count);
+  s_records[slot] = record;
+  s_pushedAtMs[slot] = nowMs;
+  s_count++;
+  return true;
+}
+
+/**
+ * @brief Spills readings that waited longer than maxAgeMs to the outage log.
+ *
+ * Bounds how many readings a power cut can take with it. Held readings wait
+ * for their ack instead; the ones behind them are spilled once they settle.
+ *
+ * @param nowMs Current millis() value
+ * @param maxAgeMs Longest time a reading may stay in RAM only
+ */
+void StagingRingTick(unsigned long nowMs, unsigned long maxAgeMs) {
+  while (s_count > 0 && s_held == 0 && nowMs - s_pushedAtMs[s_head] >= maxAgeMs) SpillOldest();
+}
+
+/**
+ * @brief Moves every staged reading to the outage log, held ones included.
+ *
+ * For a planned shutdown; follow with OutageLogFlush() to reach the card.
+ *
+ * @return true if the outage log took all readings
+ */
+bool StagingRingFlush() {
+  bool stored = true;
+  s_held = 0;
+  while (s_count > 0) stored = SpillOldest() && stored;
+  return stored;
+}
+
+/**
+ * @brief Copies the oldest staged readings without consuming them.
+ *
+ * Same contract as OutageLogPeek(), so recovery reads both the same way.
+ *
+ * @param[out] records Destination array
+ * @param[in] maxRecords Capacity of the destination array
+ * @param[in] skip Number of oldest readings to pass over first
+ * @return Number of readings copied, oldest first
+ */
+size_t StagingRingPeek(OutageRecord* records, size_t maxRecords, size_t skip) {
+  size_t copied = 0;
+  for (size_t index = skip; index < s_count && copied < maxRecords; index++) {
+    records[copied++] = s_records[SlotAt(index)];
+  }
+  return copied;
+}
+
+/**
+ * @brief Removes the oldest readings once their recovery message was acknowledged.
+ *
+ * @param count Number of readings to consume (as returned by StagingRingPeek())
+ */
+void StagingRingConsume(size_t count) {
+  if (count > s_count) count = s_count;
+  s_head = SlotAt(count);
+  s_count -= (uint8_t)count;
+  s_held = count < s_held ? (uint8_t)(s_held - count) : 0;
+}
+
+/**
+ * @brief Protects the oldest readings from spilling while they are in flight.
+ *
+ * @param count Readings covered by unsettled recovery messages
+ */
+void StagingRingHold(size_t count) {
+  s_held = (uint8_t)(count < s_count ? count : s_count);
+}
+
+/**
+ * @brief Returns the number of staged readings.
+ */
+size_t StagingRingCount() {
+  return s_count;
+}
+
+/**
+ * @brief Returns the number of readings that went to the outage log instead of staying in RAM.
+ */
+uint32_t StagingRingSpilledCount() {
+  return s_spilled;
+}
@@ -1,83 +1,112 @@
 #include "storage.h"
+#include "sensor.h"
+#include "fixed_point.h"
+#include "logger.h"
 
 // =============================================================================
-// CSV PROCESSING CONSTANTS
+// OUTAGE STORAGE FUNCTIONS
 // =============================================================================
 
-/// Buffer size for folder names (e.g., "2025")
-static const size_t FOLDER_NAME_BUFFER_SIZE = 8;
-/// Buffer size for storing the current active CSV filename
-static const size_t CURRENT_FILENAME_BUFFER_SIZE = 32;
-/// Buffer size for reading individual CSV lines
-static const size_t CSV_LINE_BUFFER_SIZE = 64;
-/// Maximum number of sensor readings per CSV batch file
-static const int MAX_LINES_PER_CSV_FILE = 5;
-static char currentFilename[CURRENT_FILENAME_BUFFER_SIZE] = "";
-/// Static variable to track the number of lines in the current CSV file
-static int linesInFile = 0;
+static OutageRecord MakeOutageRecord(const DateTime& now, float celsius, int sequence) {
+  OutageRecord record = {};
+  record.timestamp = now.unixtime();
+  record.sequence = (uint32_t)sequence;
+  record.rawTemp = CelsiusToRawTemp(celsius);
+  return record;
+}
 
-// =============================================================================
-// CSV BATCH STORAGE FUNCTIONS
-// =============================================================================
+/**
+ * @brief Turns the aggregate of a reporting interval into one record.
+ *
+ * The record carries the mean as its temperature, so every consumer that
+ * only knows single readings still sees a sensible value.
+ *
+ * @param[in] now       Timestamp of the interval
+ * @param[in] aggregate Samples of the interval
+ * @param[in] sequence  Sequence number of the interval
+ * @return Record ready for the staging ring, the outage log or the publish window
+ */
+OutageRecord MakeAggregateRecord(const DateTime& now, const SampleAggregate& aggregate, int sequence) {
+  OutageRecord record = {};
+  record.timestamp = now.unixtime();
+  record.sequence = (uint32_t)sequence;
+  record.rawTemp = AggregateMean(aggregate);
+  record.rawMin = aggregate.min;
+  record.rawMax = aggregate.max;
+  record.count = aggregate.count;
+  record.rawLast = aggregate.last;
+  return record;
+}
 
 /**
- * @brief Saves sensor data to CSV files in batch mode during network outages
- * 
- * This function implements intelligent batch CSV storage that creates new files
- * when needed and manages file rotation. It's designed as a fallback mechanism
- * when MQTT transmission is unavailable due to network connectivity issues.
+ * @brief Saves sensor data to the outage log during network outages
  * 
- * **Batch Management:**
- * - Maintains a static filename for the current active CSV file
- * - Creates new files when the current file reaches maximum line limit
- * - Uses timestamp-based filenames for uniqueness and organization
+ * This function is the fallback mechanism when MQTT transmission is unavailable
+ * due to network connectivity issues. Each reading becomes one fixed-size binary
+ * record in the segment-based outage log (see outage_log.h), which replaces the
+ * former one-CSV-file-per-five-readings layout.
  * 
- * **File Organization:**
- * - Creates date-based folders automatically (e.g., "2025/")
- * - Stores files with minute-precision timestamps in filename
- * - Format: "YYYY/MMDDHHMM.csv" (e.g., "2025/08051430.csv")
+ * **Per-Reading Cost:**
+ * - No directory lookup, folder check or file creation
+ * - A 32-byte copy into the log's sector buffer; the card sees one 512-byte
+ *   write per 16 readings (or earlier via OutageLogTick()/OutageLogFlush())
  * 
  * **Data Format:**
- * - CSV format: timestamp,temperature,sequence
- * - Temperature precision: 5 decimal places
  * - Unix timestamp for absolute time reference
+ * - Temperature as raw ADT7410 counts (1/128 °C, lossless for the sensor)
+ * - Sequence number of the measurement
  * 
- * @param[in] now      Current timestamp for folder creation and data logging
- * @param[in] celsius  Temperature reading in Celsius (stored with 5 decimal precision)
+ * @param[in] now      Current timestamp of the measurement
+ * @param[in] celsius  Temperature reading in Celsius
  * @param[in] sequence Sequence number for the measurement
+ * @return true if the record was stored
  * 
- * @note This function uses static variables to maintain state across calls
- * @note Files are automatically rotated after MAX_LINES_PER_CSV_FILE entries
- * @see createFolderName() for folder naming convention
- * @see createFilename() for CSV filename generation
+ * @see OutageLogAppend() for the on-card record format
+ * @see SendPendingDataToMqtt() in mqtt.cpp for recovery
  */
-void SaveTempToBatchCsv(const DateTime& now, float celsius, int sequence) {
-  char folder[FOLDER_NAME_BUFFER_SIZE];
-  strncpy(folder, CreateFolderName(now), sizeof(folder));
-
-  if (!sd.exists(folder)) {
-    sd.mkdir(folder);
+bool SaveTempToOutageLog(const DateTime& now, float celsius, int sequence) {
+  if (!OutageLogAppend(MakeOutageRecord(now, celsius, sequence))) {
+    LOG_ERROR("Failed to write outage log.");
+    return false;
   }
+  LOG_DEBUG("Saved reading to outage log.");
+  return true;
+}
 
-  // Create new file if needed
-  if (strlen(currentFilename) == 0 || linesInFile >= MAX_LINES_PER_CSV_FILE) {
-    CreateCsvFilename(currentFilename, sizeof(currentFilename), now);
-    linesInFile = 0;
-  }
+/**
+ * @brief Keeps a reading that could not be published for recovery, in RAM first.
+ *
+ * The reading goes into the staging ring (see staging_ring.h), which recovery
+ * drains straight after the reconnect. Only readings of longer outages reach
+ * the outage log, when the ring passes its high-water mark or StagingRingTick()
+ * finds them too old.
+ *
+ * @param[in] now      Current timestamp of the measurement
+ * @param[in] celsius  Temperature reading in Celsius
+ * @param[in] sequence Sequence number for the measurement
+ * @return true if the reading was staged or stored
+ *
+ * @see SaveTempToOutageLog() for the on-card fallback
+ */
+bool StageTempReading(const DateTime& now, float celsius, int sequence) {
+  return StageRecord(MakeOutageRecord(now, celsius, sequence));
+}
 
-  // Write the sensor data to the current CSV file
-  File file = sd.open(currentFilename, FILE_WRITE);
-  if (file) {
-    char line[CSV_LINE_BUFFER_SIZE];
-    snprintf(line, sizeof(line), "%lu,%.5f,%d\n", now.unixtime(), celsius, sequence);
-    file.print(line);
-    file.close();
-    linesInFile++;
-    Serial.print("Saved CSV fallback: ");
-    Serial.println(currentFilename);
-  } else {
-    Serial.println("Failed to write CSV fallback.");
+/**
+ * @brief Keeps a reading or interval aggregate that could not be published for recovery.
+ *
+ * @param[in] record Record as built by MakeAggregateRecord() or from a live reading
+ * @return true if the record was staged or stored
+ *
+ * @see StageTempReading()
+ */
+bool StageRecord(const OutageRecord& record) {
+  if (!StagingRingPush(record, millis())) {
+    LOG_ERROR("Failed to write outage log.");
+    return false;
   }
+  LOG_DEBUG("Staged reading for recovery.");
+  return true;
 }
 
 // =============================================================================
@@ -95,14 +124,14 @@ void SaveTempToBatchCsv(const DateTime& now, float celsius, int sequence) {
  * ```json
  * {
  *   "timestamp": 1737024000,
- *   "value": [25.12345],
+ *   "value": [25.125],
  *   "sequence": 42,
  *   "meta": {}
  * }
  * ```
  * 
  * **Data Precision:**
- * - Temperature: 5 decimal places for high precision monitoring
+ * - Temperature: exact decimal of the sensor reading (1/128 °C steps)
  * - Timestamp: Unix timestamp (seconds since epoch)
  * - Sequence: Integer measurement counter
  * - Value array: Supports multiple sensor readings
@@ -113,134 +142,92 @@ void SaveTempToBatchCsv(const DateTime& now, float celsius, int sequence) {
  * - Optimized for embedded systems with limited memory
  * 
  * @param[out] doc     JsonDocument reference to populate (cleared before use)
- * @param[in]  celsius Temperature reading in Celsius (stored with 5 decimal precision)
+ * @param[in]  celsius Temperature reading in Celsius (sent at sensor resolution, 1/128 °C)
  * @param[in]  now     Current timestamp for the measurement
  * @param[in]  sequence Sequence number for the measurement
  * 
  * @note The function clears the document before populating new data
- * @see buildRecoveredJsonFromCsv() for batch recovery JSON format
- * @see saveToCsvBatch() for CSV fallback storage format
+ * @see RecoveryStreamMessage() for the recovery JSON format
+ * @see SaveTempToOutageLog() for fallback storage
  */
 void BuildJson(JsonDocument& doc, float celsius, const DateTime& now, int sequence) {
+  BuildJson(doc, MakeOutageRecord(now, celsius, sequence));
+}
+
+/**
+ * @brief Adds a temperature in ADT7410 counts to a value array as a decimal number.
+ *
+ * The text comes from FormatRawTemp(), so no float is involved; the array
+ * keeps a copy, the buffer may go out of scope.
+ */
+static void AddRawTemp(JsonArray& val, int16_t raw) {
+  char text[FIXED_POINT_BUFFER_SIZE];
+  const size_t length = FormatRawTemp(text, raw);
+  val.add(serialized(text, length));
+}
+
+/**
+ * @brief Sets a member of an object to a temperature in ADT7410 counts, like AddRawTemp().
+ */
+static void SetRawTemp(JsonObject& object, const char* key, int16_t raw) {
+  char text[FIXED_POINT_BUFFER_SIZE];
+  const size_t length = FormatRawTemp(text, raw);
+  object[key] = serialized(text, length);
+}
+
+/**
+ * @brief Builds the live JSON document of a record, which may be an interval aggregate.
+ *
+ * A single reading gives the same document as BuildJson() above. An aggregate
+ * of several samples keeps its mean as the one value, so the receiver stores
+ * it like any reading; min, max and count go into meta as "mn", "mx" and "n",
+ * plus the last sample as "l" when AggregateReportsLast(). These are the keys
+ * recovery messages use for their aggregate arrays:
+ *
+ * ```json
+ * {"timestamp":1737024000,"value":[25.5],"sequence":42,"meta":{"mn":25.25,"mx":25.75,"n":12}}
+ * ```
+ *
+ * @param[out] doc    JsonDocument reference to populate (cleared before use)
+ * @param[in]  record Reading or aggregate, see MakeAggregateRecord()
+ */
+void BuildJson(JsonDocument& doc, const OutageRecord& record) {
   doc.clear();
-  doc["timestamp"] = now.unixtime();
+  doc["timestamp"] = record.timestamp;
   JsonArray val = doc["value"].to<JsonArray>();
-  val.add(celsius);
-  doc["sequence"] = sequence;
+  AddRawTemp(val, record.rawTemp);
+  doc["sequence"] = (int32_t)record.sequence;
   JsonObject meta = doc["meta"].to<JsonObject>();
+  if (record.count > 1) {
+    SetRawTemp(meta, "mn", record.rawMin);
+    SetRawTemp(meta, "mx", record.rawMax);
+    meta["n"] = record.count;
+    if (AggregateReportsLast()) SetRawTemp(meta, "l", record.rawLast);
+  }
 }
 
 /**
- * @brief Builds a JSON document from CSV batch data for recovery transmission
- * 
- * This function processes stored CSV data files and converts them into
- * JSON format for batch transmission when network connectivity is restored.
- * It handles multiple measurements in a metadata array structure for efficient
- * network utilization during recovery operations.
- * 
- * **Recovery JSON Structure:**
+ * @brief Builds the live JSON document of a burst: all samples in one value array.
+ *
+ * The samples are spaced meta.burst seconds apart, starting at the timestamp.
+ * A burst has no sequence number: it may be dropped, and a gap in the
+ * sequence of the live readings would claim lost data that the interval
+ * aggregate still holds.
+ *
  * ```json
- * {
- *   "timestamp": 1737024000,
- *   "sequence": null,
- *   "value": [null],
- *   "meta": 
- *     {
- *        "t": [1737024000, 1737024060, ..], 
- *        "v": [25.12345, 25.12567, ...], 
- *        "s": [42, 43, ...]
- *      }
- * }
+ * {"timestamp":1737024005,"value":[25.5,25.25,24.75,24.5],"meta":{"burst":5}}
  * ```
- * 
- * **Processing Logic:**
- * - Reads each line from the specified CSV file using secure fgets()
- * - Parses CSV format: timestamp,temperature,sequence using strtok()
- * - Creates individual JSON objects for each measurement in meta array
- * - Uses null placeholders for top-level value and sequence fields
- * 
- * **Error Handling:**
- * - Returns early if file cannot be opened
- * - Skips malformed lines during CSV parsing
- * - Continues processing even if some lines fail
- * - Reports total number of successfully recovered entries
- * 
- * @param[out] doc      JsonDocument reference to populate (cleared before use)
- * @param[in]  filepath Path to the CSV file containing batch sensor data
- * @param[in]  now      Current timestamp for the recovery operation
- * 
- * @note Uses strtok() for safe CSV parsing with buffer protection
- * @note Clears the document before populating new batch data
- * @see saveToCsvBatch() for CSV storage format details
- * @see sendPendingData() in mqtt.cpp for recovery transmission
+ *
+ * @param[out] doc   JsonDocument reference to populate (cleared before use)
+ * @param[in]  burst Samples of the burst, see BurstSampler
  */
-void BuildRecoveryJsonFromBatchCsv(JsonDocument& doc, const char* filepath, const DateTime& now) {
-  File file = sd.open(filepath, FILE_READ);
-  if (!file) {
-    Serial.print("CSV not found: ");
-    Serial.println(filepath);
-    return;
-  }
-
+void BuildJson(JsonDocument& doc, const BurstMessage& burst) {
   doc.clear();
-  doc["timestamp"] = now.unixtime();
-  doc["sequence"] = nullptr;
+  doc["timestamp"] = burst.timestamp;
   JsonArray val = doc["value"].to<JsonArray>();
-  val.add(nullptr);  // Dummy value for compatibility
-
+  for (uint8_t i = 0; i < burst.count; i++) AddRawTemp(val, burst.raw[i]);
   JsonObject meta = doc["meta"].to<JsonObject>();
-  JsonArray tArr = meta["t"].to<JsonArray>();  // timestamp
-  JsonArray vArr = meta["v"].to<JsonArray>();  // value
-  JsonArray sArr = meta["s"].to<JsonArray>();  // sequence
-
-  char line[CSV_LINE_BUFFER_SIZE];
-  int added = 0;
-
-  // Process each line of the CSV file safely
-  while (file.available()) {
-    size_t len = file.fgets(line, sizeof(line));
-    if (len == 0) continue;
-
-     // Parse CSV format: timestamp,temperature,sequence
-     char* p = strtok(line, ",");
-     if (!p) {
-       Serial.print("Malformed CSV line (no timestamp): ");
-       Serial.println(line);
-       continue;
-     }
-     uint32_t ts = atol(p);
-
-     p = strtok(nullptr, ",");
-     if (!p) {
-       Serial.print("Malformed CSV line (no temperature): ");
-       Serial.println(line);
-       continue;
-     }
-     float temp = atof(p);
-
-     p = strtok(nullptr, ",");
-     if (!p) {
-       Serial.print("Malformed CSV line (no sequence): ");
-       Serial.println(line);
-       continue;
-     }
-     int seq = atoi(p);
-
-     tArr.add(ts);
-     vArr.add(temp);
-     sArr.add(seq);
-
-     added++;
-   }
-
-   file.close();
-
-  // Report recovery statistics
-   Serial.print("Recovered entries added from CSV: ");
-   Serial.print(String(added));
-   Serial.print(" (");
-   Serial.print(filepath);
-   Serial.println(")");
+  meta["burst"] = burst.periodSeconds;
 }
 
 // =============================================================================
@@ -251,11 +238,12 @@ void BuildRecoveryJsonFromBatchCsv(JsonDocument& doc, const char* filepath, cons
  * @brief Deletes a CSV file from the SD card storage system
  * 
  * This function provides safe file deletion with error handling and logging. 
- * It's primarily used during the data recovery process to clean up CSV files 
- * after they have been successfully transmitted via MQTT.
+ * It's primarily used during the data recovery process to clean up legacy CSV
+ * files after they have been successfully transmitted via MQTT.
  * 
  * **Safety Features:**
  * - Checks file existence before attempting deletion
+ * - Marks the batch as sent in the batch manifest, so recovery never revisits it
  * - Provides detailed success/failure logging
  * - Handles SD card filesystem errors gracefully
  * 
@@ -272,23 +260,17 @@ void BuildRecoveryJsonFromBatchCsv(JsonDocument& doc, const char* filepath, cons
  * @param[in] filepath Complete path to the CSV file to be deleted
  * 
  * @note Function silently ignores attempts to delete non-existent files
- * @note All operations are logged to Serial for debugging and monitoring
+ * @note All operations are logged (see logger.h) for debugging and monitoring
  * @see buildRecoveredJsonFromCsv() for file processing before deletion
  * @see sendPendingData() in mqtt.cpp for recovery workflow integration
  */
 void DeleteCsvFile(const char* filepath) {
   if (sd.exists(filepath)) {
     if (sd.remove(filepath)) {
-      Serial.print("Deleted CSV file: ");
-      Serial.println(filepath);
-      if (strcmp(filepath, currentFilename) == 0) {
-        currentFilename[0] = '\0';
-        linesInFile = 0;
-        Serial.println("Reset currentFilename after deletion.");
-      }
+      BatchManifestMarkSent(filepath);
+      LOG_DEBUG("Deleted CSV file: %s", filepath);
     } else {
-      Serial.print("Failed to delete CSV file: ");
-      Serial.println(filepath);
+      LOG_ERROR("Failed to delete CSV file: %s", filepath);
     }
   }
 }
\ No newline at end of file
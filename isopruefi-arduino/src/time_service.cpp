@@ -0,0 +1,146 @@
+#include "time_service.h"
+
+static uint32_t s_baseUnix = 0;          // RTC seconds at s_baseMs
+static unsigned long s_baseMs = 0;       // millis() at which s_baseUnix began
+static unsigned long s_lastSyncMs = 0;   // millis() of the last RTC read
+static unsigned long s_intervalMs = TIME_DEFAULT_RESYNC_INTERVAL_MS;
+static bool s_synced = false;
+static bool s_resyncRequested = false;
+static uint32_t s_rtcReads = 0;
+
+// Written by the SQW interrupt
+static volatile bool s_edgePending = false;
+static volatile unsigned long s_edgeMs = 0;
+
+/// true if laterMs is not before earlierMs, also across the millis() wrap
+static bool NotBefore(unsigned long laterMs, unsigned long earlierMs) {
+  return (long)(laterMs - earlierMs) >= 0;
+}
+
+/**
+ * @brief Reads the RTC over I2C and takes its second as the new base.
+ *
+ * @param secondStartMs millis() at which the second the RTC shows began
+ * @param nowMs Current millis() value
+ */
+static void ReadRtc(unsigned long secondStartMs, unsigned long nowMs) {
+  s_baseUnix = rtc.now().unixtime();
+  s_baseMs = secondStartMs;
+  s_lastSyncMs = nowMs;
+  s_synced = true;
+  s_resyncRequested = false;
+  s_rtcReads++;
+}
+
+/**
+ * @brief Forgets the cached time and the counters; the next request reads the RTC.
+ */
+void TimeServiceReset() {
+  s_baseUnix = 0;
+  s_baseMs = 0;
+  s_lastSyncMs = 0;
+  s_intervalMs = TIME_DEFAULT_RESYNC_INTERVAL_MS;
+  s_synced = false;
+  s_resyncRequested = false;
+  s_rtcReads = 0;
+  s_edgePending = false;
+  s_edgeMs = 0;
+}
+
+/**
+ * @brief Sets the time between two RTC reads.
+ *
+ * @param intervalMs Resync interval, 0 to read the RTC only when requested
+ *                   (the SQW edges keep the phase without it)
+ */
+void TimeServiceSetResyncInterval(unsigned long intervalMs) {
+  s_intervalMs = intervalMs;
+}
+
+/**
+ * @brief Makes the next request read the RTC, e.g. after the RTC was set.
+ */
+void TimeServiceRequestResync() {
+  s_resyncRequested = true;
+}
+
+/**
+ * @brief Interrupt handler for the falling edge of the DS3231's 1 Hz SQW output.
+ *
+ * Only notes the edge; the next request applies it.
+ */
+void TimeServiceOnSqwEdge() {
+  s_edgeMs = millis();
+  s_edgePending = true;
+}
+
+/**
+ * @brief Takes a time known to be exact as the new base, without reading the RTC.
+ *
+ * For events that happen at the start of an RTC second, such as a DS3231
+ * alarm waking the MCU from standby (see power.h). It counts as a resync.
+ *
+ * @param unixtime RTC time of the second that began
+ * @param secondStartMs millis() at which it began
+ */
+void TimeServiceAnchor(uint32_t unixtime, unsigned long secondStartMs) {
+  s_baseUnix = unixtime;
+  s_baseMs = secondStartMs;
+  s_lastSyncMs = secondStartMs;
+  s_synced = true;
+  s_resyncRequested = false;
+  s_edgePending = false;
+}
+
+/**
+ * @brief Returns the current time with milliseconds, reading the RTC only when a resync is due.
+ *
+ * A pending SQW edge is applied first. The flag and the edge time are read
+ * without locking: an edge that slips in between is a second boundary all
+ * the same, and the next one follows a second later.
+ *
+ * @param nowMs Current millis() value
+ */
+PreciseTime TimeNowPrecise(unsigned long nowMs) {
+  const bool due = !s_synced || s_resyncRequested ||
+                   (s_intervalMs > 0 && nowMs - s_lastSyncMs >= s_intervalMs);
+
+  const bool edge = s_edgePending;
+  const unsigned long edgeMs = s_edgeMs;
+  s_edgePending = false;
+
+  if (edge && NotBefore(nowMs, edgeMs) && (!s_synced || NotBefore(edgeMs, s_baseMs))) {
+    // The latest second boundary at or before now
+    const unsigned long secondStartMs = edgeMs + (nowMs - edgeMs) / TIME_MS_PER_SECOND * TIME_MS_PER_SECOND;
+    if (due) {
+      ReadRtc(secondStartMs, nowMs);
+    } else {
+      // Whole seconds since the base, rounded: the drift of millis() is dropped
+      s_baseUnix += (secondStartMs - s_baseMs + TIME_MS_PER_SECOND / 2) / TIME_MS_PER_SECOND;
+      s_baseMs = secondStartMs;
+    }
+  } else if (due) {
+    ReadRtc(nowMs, nowMs);
+  }
+
+  const unsigned long elapsed = NotBefore(nowMs, s_baseMs) ? nowMs - s_baseMs : 0;
+  PreciseTime time;
+  time.unixtime = s_baseUnix + (uint32_t)(elapsed / TIME_MS_PER_SECOND);
+  time.millis = (uint16_t)(elapsed % TIME_MS_PER_SECOND);
+  return time;
+}
+
+DateTime TimeNow(unsigned long nowMs) {
+  return DateTime(TimeNowPrecise(nowMs).unixtime);
+}
+
+DateTime TimeNow() {
+  return TimeNow(millis());
+}
+
+/**
+ * @brief Returns how often the RTC was read since the last reset.
+ */
+uint32_t TimeServiceRtcReads() {
+  return s_rtcReads;
+}
@@ -0,0 +1,101 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "aggregator.h"
+
+using namespace fakeit;
+
+static SampleAggregate s_aggregate;
+
+void setUp(void) {
+    ArduinoFakeReset();
+    AggregateReset(s_aggregate);
+    AggregateSetReportLast(false);
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+// Test folding samples into an aggregate
+void Test_Aggregate_starts_empty(void) {
+    TEST_ASSERT_EQUAL(0, s_aggregate.count);
+    TEST_ASSERT_EQUAL(0, AggregateMean(s_aggregate));
+}
+
+void Test_Aggregate_tracks_min_max_last_and_count(void) {
+    AggregateAdd(s_aggregate, 3264);
+    AggregateAdd(s_aggregate, 3200);
+    AggregateAdd(s_aggregate, 3300);
+    AggregateAdd(s_aggregate, 3232);
+
+    TEST_ASSERT_EQUAL(4, s_aggregate.count);
+    TEST_ASSERT_EQUAL(3200, s_aggregate.min);
+    TEST_ASSERT_EQUAL(3300, s_aggregate.max);
+    TEST_ASSERT_EQUAL(3232, s_aggregate.last);
+    TEST_ASSERT_EQUAL(3249, AggregateMean(s_aggregate));
+}
+
+void Test_Aggregate_first_sample_sets_min_and_max(void) {
+    // Negative temperatures must not be hidden by the zeroed reset state
+    AggregateAdd(s_aggregate, -640);
+    TEST_ASSERT_EQUAL(-640, s_aggregate.min);
+    TEST_ASSERT_EQUAL(-640, s_aggregate.max);
+    TEST_ASSERT_EQUAL(-640, AggregateMean(s_aggregate));
+}
+
+void Test_Aggregate_mean_rounds_half_away_from_zero(void) {
+    AggregateAdd(s_aggregate, 1);
+    AggregateAdd(s_aggregate, 2);
+    TEST_ASSERT_EQUAL(2, AggregateMean(s_aggregate));
+
+    AggregateReset(s_aggregate);
+    AggregateAdd(s_aggregate, -1);
+    AggregateAdd(s_aggregate, -2);
+    TEST_ASSERT_EQUAL(-2, AggregateMean(s_aggregate));
+}
+
+void Test_Aggregate_covers_extreme_samples_of_a_minute(void) {
+    // Sixty samples at the sensor's limits cannot overflow the sum
+    for (int i = 0; i < 60; i++) AggregateAdd(s_aggregate, i % 2 ? 32767 : -32768);
+    TEST_ASSERT_EQUAL(60, s_aggregate.count);
+    TEST_ASSERT_EQUAL(-32768, s_aggregate.min);
+    TEST_ASSERT_EQUAL(32767, s_aggregate.max);
+    // The sum is -30, the mean -0.5 rounds away from zero
+    TEST_ASSERT_EQUAL(-1, AggregateMean(s_aggregate));
+}
+
+void Test_Aggregate_reset_starts_a_new_interval(void) {
+    AggregateAdd(s_aggregate, 100);
+    AggregateReset(s_aggregate);
+    AggregateAdd(s_aggregate, 200);
+
+    TEST_ASSERT_EQUAL(1, s_aggregate.count);
+    TEST_ASSERT_EQUAL(200, s_aggregate.min);
+    TEST_ASSERT_EQUAL(200, AggregateMean(s_aggregate));
+}
+
+void Test_Aggregate_report_last_is_off_by_default(void) {
+    TEST_ASSERT_FALSE(AggregateReportsLast());
+    AggregateSetReportLast(true);
+    TEST_ASSERT_TRUE(AggregateReportsLast());
+}
+
+// Bundle for central test_main.cpp
+void Run_aggregator_tests() {
+    RUN_TEST(Test_Aggregate_starts_empty);
+    RUN_TEST(Test_Aggregate_tracks_min_max_last_and_count);
+    RUN_TEST(Test_Aggregate_first_sample_sets_min_and_max);
+    RUN_TEST(Test_Aggregate_mean_rounds_half_away_from_zero);
+    RUN_TEST(Test_Aggregate_covers_extreme_samples_of_a_minute);
+    RUN_TEST(Test_Aggregate_reset_starts_a_new_interval);
+    RUN_TEST(Test_Aggregate_report_last_is_off_by_default);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_aggregator_tests();
+    return UNITY_END();
+}
+#endif
@@ -0,0 +1,115 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "batch_manifest.h"
+
+using namespace fakeit;
+
+void setUp(void) {
+    ArduinoFakeReset();
+    BatchManifestEnd();
+    sd.clearTestFiles();
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char[]))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char[]))).AlwaysReturn(1);
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+static void AddLegacyBatches() {
+    sd.addTestFile("2025/01010005.csv", "1735689900,22.0,3\n");
+    sd.addTestFile("2024/12312350.csv", "1735689000,21.0,1\n1735689060,21.5,2\n");
+    sd.addTestFile("2024/notes.txt", "not a batch\n");
+}
+
+// Test manifest construction
+void Test_BatchManifest_empty_card(void) {
+    TEST_ASSERT_TRUE(BatchManifestBegin());
+    TEST_ASSERT_EQUAL(0, BatchManifestCount());
+    TEST_ASSERT_TRUE(sd.exists(BATCH_MANIFEST_PATH));
+}
+
+void Test_BatchManifest_indexes_every_year_folder_oldest_first(void) {
+    AddLegacyBatches();
+
+    TEST_ASSERT_TRUE(BatchManifestBegin());
+    TEST_ASSERT_EQUAL(2, BatchManifestCount());
+
+    BatchEntry entry;
+    TEST_ASSERT_TRUE(BatchManifestRead(0, entry));
+    TEST_ASSERT_EQUAL_STRING("2024/12312350.csv", entry.path);
+    TEST_ASSERT_EQUAL(1735689000, entry.firstTimestamp);
+    TEST_ASSERT_EQUAL(1735689060, entry.lastTimestamp);
+    TEST_ASSERT_EQUAL(2, entry.records);
+    TEST_ASSERT_EQUAL(BATCH_PENDING, entry.state);
+
+    TEST_ASSERT_TRUE(BatchManifestRead(1, entry));
+    TEST_ASSERT_EQUAL_STRING("2025/01010005.csv", entry.path);
+    TEST_ASSERT_EQUAL(1, entry.records);
+}
+
+void Test_BatchManifest_empty_batch_is_skipped(void) {
+    sd.addTestFile("2025/07261400.csv", "");
+
+    TEST_ASSERT_TRUE(BatchManifestBegin());
+    TEST_ASSERT_EQUAL(1, BatchManifestCount());
+    TEST_ASSERT_EQUAL(1, BatchManifestFirstPending());
+}
+
+// Test persistence (no rescans after the first build)
+void Test_BatchManifest_reload_does_not_rescan_folders(void) {
+    AddLegacyBatches();
+    TEST_ASSERT_TRUE(BatchManifestBegin());
+    BatchManifestEnd();
+
+    // A file that appears later is not picked up: the manifest is authoritative
+    sd.addTestFile("2025/01010010.csv", "1735690200,22.5,4\n");
+    sd.resetStats();
+    TEST_ASSERT_TRUE(BatchManifestBegin());
+    TEST_ASSERT_EQUAL(2, BatchManifestCount());
+    TEST_ASSERT_EQUAL(0, sd.getStats().writes);
+}
+
+void Test_BatchManifest_mark_sent_advances_first_pending(void) {
+    AddLegacyBatches();
+    TEST_ASSERT_TRUE(BatchManifestBegin());
+
+    TEST_ASSERT_FALSE(BatchManifestMarkSent("2025/unknown.csv"));
+    TEST_ASSERT_TRUE(BatchManifestMarkSent("2024/12312350.csv"));
+    TEST_ASSERT_EQUAL(1, BatchManifestFirstPending());
+
+    // State survives a remount
+    BatchManifestEnd();
+    TEST_ASSERT_TRUE(BatchManifestBegin());
+    TEST_ASSERT_EQUAL(1, BatchManifestFirstPending());
+    BatchEntry entry;
+    TEST_ASSERT_TRUE(BatchManifestRead(0, entry));
+    TEST_ASSERT_EQUAL(BATCH_SENT, entry.state);
+}
+
+void Test_BatchManifest_corrupt_manifest_is_rebuilt(void) {
+    AddLegacyBatches();
+    sd.addTestFile(BATCH_MANIFEST_PATH, "garbage that is not a manifest");
+
+    TEST_ASSERT_TRUE(BatchManifestBegin());
+    TEST_ASSERT_EQUAL(2, BatchManifestCount());
+}
+
+// Bundle for central test_main.cpp
+void Run_batch_manifest_tests() {
+    RUN_TEST(Test_BatchManifest_empty_card);
+    RUN_TEST(Test_BatchManifest_indexes_every_year_folder_oldest_first);
+    RUN_TEST(Test_BatchManifest_empty_batch_is_skipped);
+    RUN_TEST(Test_BatchManifest_reload_does_not_rescan_folders);
+    RUN_TEST(Test_BatchManifest_mark_sent_advances_first_pending);
+    RUN_TEST(Test_BatchManifest_corrupt_manifest_is_rebuilt);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_batch_manifest_tests();
+    return UNITY_END();
+}
+#endif
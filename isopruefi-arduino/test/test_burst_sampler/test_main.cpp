@@ -0,0 +1,191 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "burst_sampler.h"
+
+using namespace fakeit;
+
+static const uint32_t T0 = 1753778400;
+static const uint8_t BASE_PERIOD = 60;
+
+/// One synthetic trace: temperature in counts at a given second
+typedef int16_t (*Trace)(uint32_t second);
+
+struct TraceResult {
+    uint32_t samples;
+    uint32_t burstSamples;     ///< Samples that ended up in burst messages
+    uint32_t messages;
+    uint32_t firstBurstSecond; ///< 0 if no burst started
+    uint32_t burstEndSecond;   ///< First second back at the base period
+    uint8_t shortestPeriod;
+};
+
+void setUp(void) {
+    ArduinoFakeReset();
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+static BurstSampler MakeSampler() {
+    BurstSampler sampler;
+    BurstConfig config = {BURST_DEFAULT_RATE_THRESHOLD, BURST_DEFAULT_PERIOD_SECONDS, BURST_DEFAULT_HOLD_SECONDS};
+    sampler.Configure(true, config);
+    return sampler;
+}
+
+/// Samples a trace for the given time the way CoreSampleTask() does, at the period the sampler asks for
+static TraceResult RunTrace(BurstSampler& sampler, Trace trace, uint32_t seconds) {
+    TraceResult result = {0, 0, 0, 0, 0, BASE_PERIOD};
+    uint32_t t = 0;
+    while (t < seconds) {
+        sampler.Add(T0 + t, trace(t), BASE_PERIOD);
+        result.samples++;
+
+        BurstMessage message;
+        if (sampler.TakeMessage(message)) {
+            TEST_ASSERT_TRUE(message.count >= 2);
+            TEST_ASSERT_TRUE(message.count <= BURST_MAX_SAMPLES);
+            // Every message is evenly spaced and starts where its first sample was taken
+            TEST_ASSERT_EQUAL(trace(message.timestamp - T0), message.raw[0]);
+            TEST_ASSERT_EQUAL(trace(message.timestamp - T0 + message.periodSeconds * (message.count - 1)),
+                              message.raw[message.count - 1]);
+            result.messages++;
+            result.burstSamples += message.count;
+        }
+
+        const uint8_t period = sampler.PeriodSeconds(BASE_PERIOD);
+        if (period < result.shortestPeriod) result.shortestPeriod = period;
+        if (sampler.Active() && result.firstBurstSecond == 0) result.firstBurstSecond = t;
+        if (!sampler.Active() && result.firstBurstSecond != 0 && result.burstEndSecond == 0) result.burstEndSecond = t;
+
+        // Next point of a grid that starts at second 0 of every minute
+        uint32_t next = (t / period + 1) * period;
+        if (next / 60 != t / 60) next = (t / 60 + 1) * 60;
+        t = next;
+    }
+    return result;
+}
+
+static int16_t FlatTrace(uint32_t second) {
+    (void)second;
+    return 2560;   // 20 °C
+}
+
+static int16_t SlowDriftTrace(uint32_t second) {
+    // 0.25 °C per minute
+    return 2560 + (int16_t)(second * 32 / 60);
+}
+
+static int16_t NoisyFlatTrace(uint32_t second) {
+    // ±2 counts of deterministic noise
+    return 2560 + (int16_t)((second * 7919) % 5) - 2;
+}
+
+static int16_t DoorOpenedTrace(uint32_t second) {
+    // 20 °C, then the door opens at 10:00 and it drops 3 °C within the next minute
+    if (second < 600) return 2560;
+    if (second < 660) return 2560 - (int16_t)((second - 600) * 384 / 60);
+    return 2176;
+}
+
+// Test the change detector on synthetic traces
+void Test_Burst_flat_trace_never_bursts(void) {
+    BurstSampler sampler = MakeSampler();
+    TraceResult result = RunTrace(sampler, FlatTrace, 3600);
+    TEST_ASSERT_EQUAL(60, result.samples);
+    TEST_ASSERT_EQUAL(0, sampler.Bursts());
+    TEST_ASSERT_EQUAL(0, result.messages);
+}
+
+void Test_Burst_slow_drift_and_noise_never_burst(void) {
+    BurstSampler sampler = MakeSampler();
+    RunTrace(sampler, SlowDriftTrace, 3600);
+    TEST_ASSERT_EQUAL(0, sampler.Bursts());
+
+    BurstSampler noisy = MakeSampler();
+    RunTrace(noisy, NoisyFlatTrace, 3600);
+    TEST_ASSERT_EQUAL(0, noisy.Bursts());
+}
+
+void Test_Burst_step_raises_rate_and_decays_back(void) {
+    BurstSampler sampler = MakeSampler();
+    TraceResult result = RunTrace(sampler, DoorOpenedTrace, 3600);
+
+    TEST_ASSERT_EQUAL(1, sampler.Bursts());
+    TEST_ASSERT_EQUAL(BURST_DEFAULT_PERIOD_SECONDS, result.shortestPeriod);
+    // Detected at the first sample after the door opened, back at the base rate well within the hour
+    TEST_ASSERT_EQUAL(660, result.firstBurstSecond);
+    TEST_ASSERT_TRUE(result.burstEndSecond > result.firstBurstSecond + BURST_DEFAULT_HOLD_SECONDS);
+    TEST_ASSERT_TRUE(result.burstEndSecond < 1800);
+    TEST_ASSERT_FALSE(sampler.Active());
+    // Far more samples than the 60 of the base rate, shipped in a few messages
+    TEST_ASSERT_TRUE(result.samples > 70);
+    TEST_ASSERT_TRUE(result.messages >= 2);
+    TEST_ASSERT_TRUE(result.messages * 2 <= result.burstSamples);
+}
+
+void Test_Burst_is_deterministic(void) {
+    BurstSampler first = MakeSampler();
+    BurstSampler second = MakeSampler();
+    TraceResult a = RunTrace(first, DoorOpenedTrace, 3600);
+    TraceResult b = RunTrace(second, DoorOpenedTrace, 3600);
+
+    TEST_ASSERT_EQUAL(a.samples, b.samples);
+    TEST_ASSERT_EQUAL(a.messages, b.messages);
+    TEST_ASSERT_EQUAL(a.burstSamples, b.burstSamples);
+    TEST_ASSERT_EQUAL(a.burstEndSecond, b.burstEndSecond);
+}
+
+void Test_Burst_messages_hold_consecutive_samples(void) {
+    BurstSampler sampler = MakeSampler();
+    // A change at the first burst sample, then 5 s samples
+    sampler.Add(T0, 2560, BASE_PERIOD);
+    sampler.Add(T0 + 60, 2700, BASE_PERIOD);
+    TEST_ASSERT_TRUE(sampler.Active());
+    TEST_ASSERT_EQUAL(5, sampler.PeriodSeconds(BASE_PERIOD));
+    for (int i = 1; i < BURST_MAX_SAMPLES; i++) sampler.Add(T0 + 60 + 5 * i, 2700 + i, BASE_PERIOD);
+
+    BurstMessage message;
+    TEST_ASSERT_TRUE(sampler.TakeMessage(message));
+    TEST_ASSERT_FALSE(sampler.TakeMessage(message));
+    TEST_ASSERT_EQUAL(T0 + 60, message.timestamp);
+    TEST_ASSERT_EQUAL(5, message.periodSeconds);
+    TEST_ASSERT_EQUAL(BURST_MAX_SAMPLES, message.count);
+    TEST_ASSERT_EQUAL(2700, message.raw[0]);
+    TEST_ASSERT_EQUAL(2700 + BURST_MAX_SAMPLES - 1, message.raw[BURST_MAX_SAMPLES - 1]);
+}
+
+void Test_Burst_disabled_or_slow_burst_period_keeps_base_rate(void) {
+    BurstSampler disabled;
+    disabled.Add(T0, 2560, BASE_PERIOD);
+    disabled.Add(T0 + 60, 2900, BASE_PERIOD);
+    TEST_ASSERT_FALSE(disabled.Active());
+    TEST_ASSERT_EQUAL(BASE_PERIOD, disabled.PeriodSeconds(BASE_PERIOD));
+
+    // A base period already at the burst period leaves nothing to raise
+    BurstSampler sampler = MakeSampler();
+    sampler.Add(T0, 2560, 5);
+    sampler.Add(T0 + 5, 2900, 5);
+    TEST_ASSERT_FALSE(sampler.Active());
+    TEST_ASSERT_EQUAL(0, sampler.Bursts());
+}
+
+// Bundle for central test_main.cpp
+void Run_burst_sampler_tests() {
+    RUN_TEST(Test_Burst_flat_trace_never_bursts);
+    RUN_TEST(Test_Burst_slow_drift_and_noise_never_burst);
+    RUN_TEST(Test_Burst_step_raises_rate_and_decays_back);
+    RUN_TEST(Test_Burst_is_deterministic);
+    RUN_TEST(Test_Burst_messages_hold_consecutive_samples);
+    RUN_TEST(Test_Burst_disabled_or_slow_burst_period_keeps_base_rate);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_burst_sampler_tests();
+    return UNITY_END();
+}
+#endif
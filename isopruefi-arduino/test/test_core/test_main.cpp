@@ -2,9 +2,18 @@
 #include <unity.h>
 #include "platform.h"
 #include "core.h"
+#include "staging_ring.h"
+#include "sensor.h"
+#include "time_service.h"
+#include "sampler.h"
+#include "mqtt.h"
+#include "publish_window.h"
 
 using namespace fakeit;
 
+/// MCU pin the tests wire to the DS3231 SQW output
+static const int RTC_SQW_TEST_PIN = 6;
+
 void setUp(void) {
     ArduinoFakeReset();
     
@@ -13,13 +22,18 @@ void setUp(void) {
     When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char[]))).AlwaysReturn(1);
     When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const String&))).AlwaysReturn(1);
     When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const String&))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(unsigned long, int))).AlwaysReturn(1);
     
     // Mock delay and timing functions
     When(Method(ArduinoFake(), delay)).AlwaysReturn();
     When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
+    When(Method(ArduinoFake(), pinMode)).AlwaysReturn();
+    CoreSetRtcSqwPin(RTC_SQW_TEST_PIN);
     
     // Reset mock WiFi state
     WiFi.disconnect(); // Sets status to WL_DISCONNECTED
+    rtc.resetTestState();
+    TimeServiceReset();
 }
 
 void tearDown(void) {
@@ -184,6 +198,278 @@ void Test_IsMqttConnected_with_different_states(void) {
     TEST_ASSERT_TRUE(IsMqttConnected());
 }
 
+// Test scheduled tasks individually
+
+/// Runs the sample task, and again once a conversion it started is done
+static void RunSampleTask(unsigned long nowMs) {
+    CoreSampleTask(nowMs);
+    CoreSampleTask(nowMs + SENSOR_CONVERSION_MS);
+}
+
+void Test_CoreSampleTask_stages_one_reading_per_minute_while_offline(void) {
+    StagingRingReset();
+    mqttClient.stop();
+
+    // The mock RTC stays at this device's phase, so a second run finds the minute sampled
+    rtc.setNow(DateTime(2025, 7, 26, 14, 55, CorePublishPhaseSeconds()));
+    RunSampleTask(1000);
+    RunSampleTask(1500);
+
+    TEST_ASSERT_EQUAL(1, StagingRingCount());
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(1, StagingRingPeek(&record, 1));
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 26, 14, 55, 0).unixtime(), record.timestamp);
+    TEST_ASSERT_EQUAL(3264, record.rawTemp);
+}
+
+void Test_CoreSampleTask_publishes_at_device_phase_with_minute_timestamp(void) {
+    StagingRingReset();
+    mqttClient.stop();
+    const uint8_t phase = CorePublishPhaseSeconds();
+    TEST_ASSERT_TRUE(phase < 50);
+    TEST_ASSERT_TRUE(phase > 0);   // Sensor_One is not at second :00
+
+    // Before the phase the new minute is not sampled yet
+    rtc.setNow(DateTime(2025, 7, 26, 14, 56, phase - 1));
+    RunSampleTask(1000);
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+
+    // At the phase it is, stamped with the start of the minute
+    rtc.setNow(DateTime(2025, 7, 26, 14, 56, phase));
+    RunSampleTask(2000);
+    TEST_ASSERT_EQUAL(1, StagingRingCount());
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(1, StagingRingPeek(&record, 1));
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 26, 14, 56, 0).unixtime(), record.timestamp);
+}
+
+void Test_CoreSampleTask_aggregates_sub_minute_samples(void) {
+    StagingRingReset();
+    mqttClient.stop();
+    CoreSetSamplePeriod(10);
+    const uint8_t phase = CorePublishPhaseSeconds();
+
+    // Close the previous interval at 14:57, then sample through one minute
+    rtc.setNow(DateTime(2025, 7, 26, 14, 57, phase));
+    RunSampleTask(0);
+    StagingRingReset();
+
+    const float temps[] = {25.0f, 26.0f, 24.5f, 25.5f, 25.0f, 27.0f};
+    for (int i = 0; i < 6; i++) {
+        tempsensor.setTempC(temps[i]);
+        // Every second of the interval runs the task; only the 10 s grid samples
+        for (int s = 1; s <= 10; s++) {
+            const int t = phase + i * 10 + s;
+            rtc.setNow(DateTime(2025, 7, 26, 14 + (57 + t / 60) / 60, (57 + t / 60) % 60, t % 60));
+            RunSampleTask(1000 * t);
+        }
+    }
+    tempsensor.setTempC(25.5f);
+    CoreSetSamplePeriod(60);
+
+    // One message for the minute, stamped with its start
+    TEST_ASSERT_EQUAL(1, StagingRingCount());
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(1, StagingRingPeek(&record, 1));
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 26, 14, 58, 0).unixtime(), record.timestamp);
+    TEST_ASSERT_EQUAL(6, record.count);
+    TEST_ASSERT_EQUAL(CelsiusToRawTemp(24.5f), record.rawMin);
+    TEST_ASSERT_EQUAL(CelsiusToRawTemp(27.0f), record.rawMax);
+    TEST_ASSERT_EQUAL(CelsiusToRawTemp(27.0f), record.rawLast);
+    TEST_ASSERT_EQUAL(CelsiusToRawTemp(25.5f), record.rawTemp);
+}
+
+void Test_CoreSampleTask_deadband_skips_unchanged_minutes(void) {
+    StagingRingReset();
+    mqttClient.stop();
+    CoreSetDeadband(true, 13, 600);
+    const uint8_t phase = CorePublishPhaseSeconds();
+
+    // Twelve steady minutes, then a change of 0.2 °C
+    for (int m = 0; m < 13; m++) {
+        tempsensor.setTempC(m < 12 ? 25.5f : 25.7f);
+        rtc.setNow(DateTime(2025, 7, 26, 15, m, phase));
+        RunSampleTask(60000UL * m);
+    }
+    tempsensor.setTempC(25.5f);
+    const uint32_t skipped = CoreDeadband().Skipped();
+    CoreSetDeadband(false, DEADBAND_DEFAULT_THRESHOLD_RAW, DEADBAND_DEFAULT_HEARTBEAT_SECONDS);
+
+    // 15:00 (first), 15:10 (heartbeat) and 15:12 (change) reach the staging ring
+    TEST_ASSERT_EQUAL(3, StagingRingCount());
+    TEST_ASSERT_EQUAL(10, skipped);
+    OutageRecord records[3];
+    TEST_ASSERT_EQUAL(3, StagingRingPeek(records, 3));
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 26, 15, 0, 0).unixtime(), records[0].timestamp);
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 26, 15, 10, 0).unixtime(), records[1].timestamp);
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 26, 15, 12, 0).unixtime(), records[2].timestamp);
+    // Skipped minutes take no sequence number, so the sequence has no gap
+    TEST_ASSERT_EQUAL(records[0].sequence + 1, records[1].sequence);
+    TEST_ASSERT_EQUAL(records[1].sequence + 1, records[2].sequence);
+}
+
+void Test_CoreSampleTask_burst_samples_faster_after_a_step(void) {
+    StagingRingReset();
+    mqttClient.stop();
+    CoreSetBurstSampling(true);
+    const uint8_t phase = CorePublishPhaseSeconds();
+
+    // 20 °C until 16:01, 23 °C from then on; the task runs every second
+    for (int t = 0; t < 3 * 60; t++) {
+        tempsensor.setTempC(t < 60 ? 20.0f : 23.0f);
+        const int s = phase + t;
+        rtc.setNow(DateTime(2025, 7, 26, 16, s / 60, s % 60));
+        RunSampleTask(1000UL * t);
+    }
+    tempsensor.setTempC(25.5f);
+    const uint32_t bursts = CoreBurstSampler().Bursts();
+    CoreSetBurstSampling(false);
+
+    // The step at 16:01 starts a burst, so 16:02 is covered by 5 s samples
+    TEST_ASSERT_EQUAL(1, bursts);
+    OutageRecord records[3];
+    TEST_ASSERT_EQUAL(3, StagingRingPeek(records, 3));
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 26, 16, 2, 0).unixtime(), records[2].timestamp);
+    TEST_ASSERT_EQUAL(60 / BURST_DEFAULT_PERIOD_SECONDS, records[2].count);
+}
+
+void Test_CoreSampleTask_failed_read_reports_nothing(void) {
+    StagingRingReset();
+    mqttClient.stop();
+    const uint8_t phase = CorePublishPhaseSeconds();
+
+    rtc.setNow(DateTime(2025, 7, 26, 17, 0, phase));
+    RunSampleTask(0);
+    tempsensor.setReadFails(true);
+    rtc.setNow(DateTime(2025, 7, 26, 17, 1, phase));
+    RunSampleTask(60000);
+    tempsensor.setReadFails(false);
+    rtc.setNow(DateTime(2025, 7, 26, 17, 2, phase));
+    RunSampleTask(120000);
+
+    // 17:01 had no reading: no record, and no sequence number taken
+    OutageRecord records[2];
+    TEST_ASSERT_EQUAL(2, StagingRingPeek(records, 2));
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 26, 17, 2, 0).unixtime(), records[1].timestamp);
+    TEST_ASSERT_EQUAL(records[0].sequence + 1, records[1].sequence);
+}
+
+static unsigned long s_coreMillis = 0;
+
+void Test_CoreSampleTask_returns_while_the_sensor_converts(void) {
+    When(Method(ArduinoFake(), millis)).AlwaysDo([]() -> unsigned long { return s_coreMillis; });
+    StagingRingReset();
+    mqttClient.stop();
+    tempsensor.resetTestState();
+    tempsensor.setConversionMs(SENSOR_CONVERSION_MS);
+    const uint8_t phase = CorePublishPhaseSeconds();
+
+    // The grid point starts a one-shot conversion and hands the loop back
+    rtc.setNow(DateTime(2025, 7, 26, 18, 0, phase));
+    s_coreMillis = 5000;
+    CoreSampleTask(5000);
+    TEST_ASSERT_EQUAL(1, tempsensor.getConversions());
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+
+    // A run during the conversion does not touch the bus
+    s_coreMillis = 5100;
+    CoreSampleTask(5100);
+    TEST_ASSERT_EQUAL(0, tempsensor.getStatusReads());
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+
+    // Once converted, the sample counts for its grid point
+    s_coreMillis = 5000 + SENSOR_CONVERSION_MS;
+    CoreSampleTask(s_coreMillis);
+    TEST_ASSERT_EQUAL(1, StagingRingCount());
+    TEST_ASSERT_EQUAL(0, tempsensor.getEarlyReads());
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(1, StagingRingPeek(&record, 1));
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 26, 18, 0, 0).unixtime(), record.timestamp);
+    tempsensor.resetTestState();
+}
+
+void Test_CoreSampleTask_takes_interrupt_samples_after_a_blocked_loop(void) {
+    StagingRingReset();
+    mqttClient.stop();
+    tempsensor.resetTestState();
+    SamplerReset();
+    CoreSetSamplePeriod(10);
+    const uint8_t phase = CorePublishPhaseSeconds();
+
+    // The next SQW edge starts the reporting point of 19:00
+    rtc.setNow(DateTime(2025, 7, 26, 19, 0, phase - 1));
+    TEST_ASSERT_TRUE(CoreSetInterruptSampling(true));
+    CoreSampleTask(1000);
+
+    // A minute and two seconds without a single loop pass, 20 °C then 22 °C
+    for (int s = 0; s < 62; s++) {
+        tempsensor.setTempC(s < 30 ? 20.0f : 22.0f);
+        CoreOnSqwEdge();
+    }
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+    CoreSampleTask(1000);
+    TEST_ASSERT_TRUE(CoreSetInterruptSampling(false));
+    CoreSetSamplePeriod(60);
+
+    // Every grid point was sampled on time: 19:00, then six samples for 19:01
+    TEST_ASSERT_EQUAL(0, SamplerQueue().Dropped());
+    TEST_ASSERT_EQUAL(2, StagingRingCount());
+    OutageRecord records[2];
+    TEST_ASSERT_EQUAL(2, StagingRingPeek(records, 2));
+    TEST_ASSERT_EQUAL(DateTime(2025, 7, 26, 19, 1, 0).unixtime(), records[1].timestamp);
+    TEST_ASSERT_EQUAL(6, records[1].count);
+    TEST_ASSERT_EQUAL(CelsiusToRawTemp(20.0f), records[1].rawMin);
+    TEST_ASSERT_EQUAL(CelsiusToRawTemp(22.0f), records[1].rawLast);
+    TEST_ASSERT_EQUAL(records[0].sequence + 1, records[1].sequence);
+    tempsensor.resetTestState();
+}
+
+void Test_CoreSetInterruptSampling_excludes_low_power_mode(void) {
+    TEST_ASSERT_TRUE(CoreSetLowPower(true));
+    TEST_ASSERT_FALSE(CoreSetInterruptSampling(true));
+    TEST_ASSERT_TRUE(CoreSetLowPower(false));
+
+    TEST_ASSERT_TRUE(CoreSetInterruptSampling(true));
+    TEST_ASSERT_FALSE(CoreSetLowPower(true));
+    TEST_ASSERT_TRUE(CoreSetInterruptSampling(false));
+    SamplerReset();
+}
+
+void Test_CoreRecoveryTask_waits_for_connection(void) {
+    StagingRingReset();
+    mqttClient.stop();
+    StagingRingPush(OutageRecord{rtc.now().unixtime(), 1, 3264, 0}, 0);
+
+    CoreRecoveryTask(1000);
+
+    // Offline: nothing published, the reading stays staged
+    TEST_ASSERT_EQUAL(1, StagingRingCount());
+}
+
+void Test_CoreRecoveryTask_returns_while_acks_are_outstanding(void) {
+    static unsigned long delayedMs;
+    delayedMs = 0;
+    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long ms) { delayedMs += ms; });
+    StagingRingReset();
+    WiFi.begin("test", "test");
+    mqttClient.connect("broker");
+    mqttClient.setEchoEnabled(false);
+    mqttClient.setPubackEnabled(false);
+    StagingRingPush(OutageRecord{rtc.now().unixtime(), 1, 3264, 0}, 0);
+
+    // The broker never answers and the clock stands still, yet the task returns
+    CoreRecoveryTask(1000);
+
+    TEST_ASSERT_EQUAL(1, PublishWindowRecoveryCount());
+    TEST_ASSERT_EQUAL(1, StagingRingCount());
+    TEST_ASSERT_EQUAL(0, delayedMs);
+
+    ResetRecovery();
+    PublishWindowReset();
+    StagingRingReset();
+    mqttClient.stop();
+}
+
 // Bundle for central test_main.cpp
 void Run_core_tests() {
     RUN_TEST(Test_IsWifiConnected_returns_true_when_connected);
@@ -201,6 +487,17 @@ void Run_core_tests() {
     RUN_TEST(Test_fat_time_macros_work);
     RUN_TEST(Test_IsWifiConnected_with_different_states);
     RUN_TEST(Test_IsMqttConnected_with_different_states);
+    RUN_TEST(Test_CoreSampleTask_stages_one_reading_per_minute_while_offline);
+    RUN_TEST(Test_CoreSampleTask_publishes_at_device_phase_with_minute_timestamp);
+    RUN_TEST(Test_CoreSampleTask_aggregates_sub_minute_samples);
+    RUN_TEST(Test_CoreSampleTask_deadband_skips_unchanged_minutes);
+    RUN_TEST(Test_CoreSampleTask_burst_samples_faster_after_a_step);
+    RUN_TEST(Test_CoreSampleTask_failed_read_reports_nothing);
+    RUN_TEST(Test_CoreSampleTask_returns_while_the_sensor_converts);
+    RUN_TEST(Test_CoreSampleTask_takes_interrupt_samples_after_a_blocked_loop);
+    RUN_TEST(Test_CoreSetInterruptSampling_excludes_low_power_mode);
+    RUN_TEST(Test_CoreRecoveryTask_waits_for_connection);
+    RUN_TEST(Test_CoreRecoveryTask_returns_while_acks_are_outstanding);
 }
 
 // When standalone executable
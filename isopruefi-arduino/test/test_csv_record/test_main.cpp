@@ -0,0 +1,255 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include <chrono>
+#include "csv_record.h"
+
+using namespace fakeit;
+
+void setUp(void) {
+    ArduinoFakeReset();
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+static CsvParseResult Parse(const char* line, CsvRecord& record) {
+    return ParseCsvRecord(line, strlen(line), record);
+}
+
+/// The strtok/atol/atof/atoi path the recovery code used before ParseCsvRecord()
+struct LegacyRecord {
+    uint32_t timestamp;
+    double celsius;
+    int sequence;
+};
+
+static bool LegacyParse(const char* input, LegacyRecord& record) {
+    char line[96];
+    strncpy(line, input, sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\0';
+
+    char* p = strtok(line, ",");
+    if (!p) return false;
+    record.timestamp = (uint32_t)atol(p);
+    p = strtok(nullptr, ",");
+    if (!p) return false;
+    record.celsius = atof(p);
+    p = strtok(nullptr, ",");
+    if (!p) return false;
+    record.sequence = atoi(p);
+    return true;
+}
+
+/// Deterministic generator so corpus failures are reproducible
+static uint32_t s_rng = 12345;
+static uint32_t NextRandom() {
+    s_rng = s_rng * 1103515245u + 12345u;
+    return s_rng >> 8;
+}
+
+static void MakeValidLine(char* buffer, size_t size) {
+    uint32_t timestamp = 1700000000u + NextRandom() % 50000000u;
+    int32_t centi = (int32_t)(NextRandom() % 16500) - 4000;  // -40.00 .. 124.99 °C
+    unsigned sub = NextRandom() % 1000;                         // 3 more decimals
+    uint32_t sequence = NextRandom() % 100000;
+    const char* sign = centi < 0 ? "-" : "";
+    int32_t magnitude = centi < 0 ? -centi : centi;
+    snprintf(buffer, size, "%lu,%s%ld.%02ld%03u,%lu\n", (unsigned long)timestamp, sign,
+             (long)(magnitude / 100), (long)(magnitude % 100), sub, (unsigned long)sequence);
+}
+
+static void Mutate(char* line, size_t size) {
+    static const char ALPHABET[] = "0123456789,.-+ eE\r\nx";
+    size_t len = strlen(line);
+    size_t pos = len > 0 ? NextRandom() % len : 0;
+    switch (NextRandom() % 5) {
+        case 0:  // delete a character
+            if (len > 0) memmove(line + pos, line + pos + 1, len - pos);
+            break;
+        case 1:  // insert a character
+            if (len + 1 < size) {
+                memmove(line + pos + 1, line + pos, len - pos + 1);
+                line[pos] = ALPHABET[NextRandom() % (sizeof(ALPHABET) - 1)];
+            }
+            break;
+        case 2:  // replace a character
+            if (len > 0) line[pos] = ALPHABET[NextRandom() % (sizeof(ALPHABET) - 1)];
+            break;
+        case 3:  // truncate
+            line[pos] = '\0';
+            break;
+        default:  // long digit run (overflow candidates)
+            if (len + 12 < size) {
+                memmove(line + pos + 12, line + pos, len - pos + 1);
+                memset(line + pos, '9', 12);
+            }
+            break;
+    }
+}
+
+// =============================================================================
+// FIELD PARSING
+// =============================================================================
+
+void Test_ParseCsvRecord_valid_line(void) {
+    CsvRecord record;
+    TEST_ASSERT_EQUAL(CSV_OK, Parse("1721995200,23.5,1\n", record));
+    TEST_ASSERT_EQUAL(1721995200, record.timestamp);
+    TEST_ASSERT_EQUAL(23500, record.milliCelsius);
+    TEST_ASSERT_EQUAL(1, record.sequence);
+}
+
+void Test_ParseCsvRecord_fixed_point_rounding(void) {
+    CsvRecord record;
+    TEST_ASSERT_EQUAL(CSV_OK, Parse("1,25.12345,42", record));
+    TEST_ASSERT_EQUAL(25123, record.milliCelsius);
+    TEST_ASSERT_EQUAL(CSV_OK, Parse("1,25.1235,42", record));
+    TEST_ASSERT_EQUAL(25124, record.milliCelsius);
+    TEST_ASSERT_EQUAL(CSV_OK, Parse("1,-0.0625,42", record));
+    TEST_ASSERT_EQUAL(-63, record.milliCelsius);
+    TEST_ASSERT_EQUAL(CSV_OK, Parse("1,.5,42", record));
+    TEST_ASSERT_EQUAL(500, record.milliCelsius);
+    TEST_ASSERT_EQUAL(CSV_OK, Parse("1,-7,42", record));
+    TEST_ASSERT_EQUAL(-7000, record.milliCelsius);
+}
+
+void Test_ParseCsvRecord_accepts_crlf_and_length_limit(void) {
+    CsvRecord record;
+    TEST_ASSERT_EQUAL(CSV_OK, Parse("1721995200,23.5,1\r\n", record));
+    TEST_ASSERT_EQUAL(1, record.sequence);
+
+    // Only the given length is read, no terminator needed
+    const char unterminated[] = {'5', ',', '1', ',', '2', '9', '9'};
+    TEST_ASSERT_EQUAL(CSV_OK, ParseCsvRecord(unterminated, 5, record));
+    TEST_ASSERT_EQUAL(2, record.sequence);
+}
+
+void Test_ParseCsvRecord_reports_failing_field(void) {
+    CsvRecord record;
+    TEST_ASSERT_EQUAL(CSV_ERR_EMPTY, Parse("\r\n", record));
+    TEST_ASSERT_EQUAL(CSV_ERR_TIMESTAMP, Parse("abc,23.5,1", record));
+    TEST_ASSERT_EQUAL(CSV_ERR_TIMESTAMP, Parse("4294967296,23.5,1", record));
+    TEST_ASSERT_EQUAL(CSV_ERR_TIMESTAMP, Parse("1721995200", record));
+    TEST_ASSERT_EQUAL(CSV_ERR_TEMPERATURE, Parse("1721995200,,1", record));
+    TEST_ASSERT_EQUAL(CSV_ERR_TEMPERATURE, Parse("1721995200,-.,1", record));
+    TEST_ASSERT_EQUAL(CSV_ERR_TEMPERATURE, Parse("1721995200,23.5", record));
+    TEST_ASSERT_EQUAL(CSV_ERR_SEQUENCE, Parse("1721995200,23.5,", record));
+    TEST_ASSERT_EQUAL(CSV_ERR_SEQUENCE, Parse("1721995200,23.5,99999999999", record));
+    TEST_ASSERT_EQUAL(CSV_ERR_TRAILING, Parse("1721995200,23.5,1,7", record));
+}
+
+void Test_ParseCsvRecord_does_not_modify_input(void) {
+    char line[] = "1721995200,23.5,1\n";
+    CsvRecord record;
+    TEST_ASSERT_EQUAL(CSV_OK, Parse(line, record));
+    TEST_ASSERT_EQUAL_STRING("1721995200,23.5,1\n", line);
+}
+
+// =============================================================================
+// CORPUS COMPARISON AND BENCHMARK
+// =============================================================================
+
+void Test_ParseCsvRecord_corpus_matches_legacy_parser(void) {
+    s_rng = 12345;
+    int validAccepted = 0;
+    int mutatedAccepted = 0;
+    int legacyOnly = 0;
+    const int CORPUS_SIZE = 20000;
+
+    for (int i = 0; i < CORPUS_SIZE; i++) {
+        char line[96];
+        MakeValidLine(line, sizeof(line));
+        bool mutated = i % 2 == 1;
+        if (mutated) {
+            int mutations = 1 + NextRandom() % 3;
+            for (int m = 0; m < mutations; m++) Mutate(line, sizeof(line));
+        }
+
+        CsvRecord record;
+        CsvParseResult result = Parse(line, record);
+        TEST_ASSERT_TRUE(result >= CSV_OK && result <= CSV_ERR_TRAILING);
+
+        LegacyRecord legacy;
+        bool legacyOk = LegacyParse(line, legacy);
+        if (result == CSV_OK) {
+            // Whatever the new parser accepts, the old path read the same way
+            TEST_ASSERT_TRUE(legacyOk);
+            TEST_ASSERT_EQUAL(legacy.timestamp, record.timestamp);
+            TEST_ASSERT_EQUAL(legacy.sequence, record.sequence);
+            double diff = legacy.celsius * CSV_TEMP_SCALE - record.milliCelsius;
+            TEST_ASSERT_TRUE(diff > -1.0 && diff < 1.0);
+            if (mutated) mutatedAccepted++; else validAccepted++;
+        } else if (legacyOk) {
+            // Lines the old path silently turned into numbers (e.g. "12x" -> 12)
+            legacyOnly++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(CORPUS_SIZE / 2, validAccepted);
+    char msg[128];
+    snprintf(msg, sizeof(msg), "corpus: %d mutated lines accepted, %d rejected lines the strtok path accepted",
+             mutatedAccepted, legacyOnly);
+    TEST_MESSAGE(msg);
+}
+
+void Test_ParseCsvRecord_benchmark_against_strtok(void) {
+    s_rng = 777;
+    const int LINES = 256;
+    const int ROUNDS = 200;
+    static char lines[LINES][64];
+    for (int i = 0; i < LINES; i++) MakeValidLine(lines[i], sizeof(lines[i]));
+
+    typedef std::chrono::steady_clock Clock;
+    volatile uint32_t sink = 0;
+
+    Clock::time_point start = Clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < LINES; i++) {
+            CsvRecord record;
+            if (Parse(lines[i], record) == CSV_OK) sink += record.timestamp + record.milliCelsius;
+        }
+    }
+    double parserSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < LINES; i++) {
+            LegacyRecord record;
+            if (LegacyParse(lines[i], record)) sink += record.timestamp + (uint32_t)record.celsius;
+        }
+    }
+    double legacySeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const double records = (double)LINES * ROUNDS;
+    char msg[128];
+    snprintf(msg, sizeof(msg), "ParseCsvRecord: %.0f records/s, strtok path: %.0f records/s",
+             records / (parserSeconds > 0 ? parserSeconds : 1e-9),
+             records / (legacySeconds > 0 ? legacySeconds : 1e-9));
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(sink != 0);
+}
+
+// Bundle for central test_main.cpp
+void Run_csv_record_tests() {
+    RUN_TEST(Test_ParseCsvRecord_valid_line);
+    RUN_TEST(Test_ParseCsvRecord_fixed_point_rounding);
+    RUN_TEST(Test_ParseCsvRecord_accepts_crlf_and_length_limit);
+    RUN_TEST(Test_ParseCsvRecord_reports_failing_field);
+    RUN_TEST(Test_ParseCsvRecord_does_not_modify_input);
+    RUN_TEST(Test_ParseCsvRecord_corpus_matches_legacy_parser);
+    RUN_TEST(Test_ParseCsvRecord_benchmark_against_strtok);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_csv_record_tests();
+    return UNITY_END();
+}
+#endif
@@ -0,0 +1,117 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "deadband.h"
+
+using namespace fakeit;
+
+static const uint32_t T0 = 1753778400;
+
+void setUp(void) {
+    ArduinoFakeReset();
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+/// A single reading at minute m
+static OutageRecord Reading(int m, int16_t raw) {
+    OutageRecord record = {};
+    record.timestamp = T0 + 60 * m;
+    record.rawTemp = raw;
+    record.count = 1;
+    return record;
+}
+
+// Test the report decision
+void Test_Deadband_disabled_reports_everything(void) {
+    DeadbandFilter filter;
+    for (int m = 0; m < 5; m++) TEST_ASSERT_TRUE(filter.Offer(Reading(m, 3264)));
+    TEST_ASSERT_EQUAL(5, filter.Reported());
+    TEST_ASSERT_EQUAL(0, filter.Skipped());
+}
+
+void Test_Deadband_reports_first_reading_and_changes_beyond_threshold(void) {
+    DeadbandFilter filter;
+    filter.Configure(true, 13, 900);
+
+    TEST_ASSERT_TRUE(filter.Offer(Reading(0, 3264)));
+    TEST_ASSERT_FALSE(filter.Offer(Reading(1, 3277)));   // +13 stays in the band
+    TEST_ASSERT_FALSE(filter.Offer(Reading(2, 3251)));   // -13 as well
+    TEST_ASSERT_TRUE(filter.Offer(Reading(3, 3278)));    // +14 leaves it
+    TEST_ASSERT_TRUE(filter.Offer(Reading(4, 3264)));    // Compared with the new value
+    TEST_ASSERT_EQUAL(3, filter.Reported());
+    TEST_ASSERT_EQUAL(2, filter.Skipped());
+}
+
+void Test_Deadband_drift_is_measured_from_last_report(void) {
+    // Steps of 5 counts never leave the band one by one, but their sum does
+    DeadbandFilter filter;
+    filter.Configure(true, 13, 900);
+    TEST_ASSERT_TRUE(filter.Offer(Reading(0, 3264)));
+    TEST_ASSERT_FALSE(filter.Offer(Reading(1, 3269)));
+    TEST_ASSERT_FALSE(filter.Offer(Reading(2, 3274)));
+    TEST_ASSERT_TRUE(filter.Offer(Reading(3, 3279)));
+}
+
+void Test_Deadband_heartbeat_reports_steady_readings(void) {
+    DeadbandFilter filter;
+    filter.Configure(true, 13, 600);
+
+    int reports = 0;
+    for (int m = 0; m < 60; m++) {
+        if (filter.Offer(Reading(m, 3264))) reports++;
+    }
+    // Minutes 0, 10, 20, 30, 40 and 50
+    TEST_ASSERT_EQUAL(6, reports);
+    TEST_ASSERT_EQUAL(54, filter.Skipped());
+}
+
+void Test_Deadband_spike_inside_aggregate_is_reported(void) {
+    DeadbandFilter filter;
+    filter.Configure(true, 13, 900);
+    TEST_ASSERT_TRUE(filter.Offer(Reading(0, 3264)));
+
+    // The mean stays in the band, the maximum does not
+    OutageRecord aggregate = Reading(1, 3266);
+    aggregate.count = 6;
+    aggregate.rawMin = 3260;
+    aggregate.rawMax = 3290;
+    TEST_ASSERT_TRUE(filter.Offer(aggregate));
+
+    aggregate = Reading(2, 3266);
+    aggregate.count = 6;
+    aggregate.rawMin = 3260;
+    aggregate.rawMax = 3270;
+    TEST_ASSERT_FALSE(filter.Offer(aggregate));
+}
+
+void Test_Deadband_configure_starts_over(void) {
+    DeadbandFilter filter;
+    filter.Configure(true, 13, 900);
+    TEST_ASSERT_TRUE(filter.Offer(Reading(0, 3264)));
+    TEST_ASSERT_FALSE(filter.Offer(Reading(1, 3264)));
+
+    filter.Configure(true, 13, 900);
+    TEST_ASSERT_EQUAL(0, filter.Skipped());
+    TEST_ASSERT_TRUE(filter.Offer(Reading(2, 3264)));
+}
+
+// Bundle for central test_main.cpp
+void Run_deadband_tests() {
+    RUN_TEST(Test_Deadband_disabled_reports_everything);
+    RUN_TEST(Test_Deadband_reports_first_reading_and_changes_beyond_threshold);
+    RUN_TEST(Test_Deadband_drift_is_measured_from_last_report);
+    RUN_TEST(Test_Deadband_heartbeat_reports_steady_readings);
+    RUN_TEST(Test_Deadband_spike_inside_aggregate_is_reported);
+    RUN_TEST(Test_Deadband_configure_starts_over);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_deadband_tests();
+    return UNITY_END();
+}
+#endif
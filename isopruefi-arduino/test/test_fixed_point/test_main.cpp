@@ -0,0 +1,166 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "fixed_point.h"
+#include "csv_record.h"
+#include "sensor.h"
+
+using namespace fakeit;
+
+/// Readings per benchmark run, one every 1/128 °C from -40 °C to +85 °C
+static const int BENCH_RAW_FIRST = -40 * TEMP_RAW_COUNTS_PER_DEGREE;
+static const int BENCH_RAW_LAST = 85 * TEMP_RAW_COUNTS_PER_DEGREE;
+static const int BENCH_ROUNDS = 20;
+
+void setUp(void) {
+    ArduinoFakeReset();
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+// Test the integer-only formatters
+void Test_FormatRawTemp_prints_exact_decimals(void) {
+    char text[FIXED_POINT_BUFFER_SIZE];
+
+    TEST_ASSERT_EQUAL(4, FormatRawTemp(text, 3264));
+    TEST_ASSERT_EQUAL_STRING("25.5", text);
+    FormatRawTemp(text, 0);
+    TEST_ASSERT_EQUAL_STRING("0", text);
+    FormatRawTemp(text, 1);
+    TEST_ASSERT_EQUAL_STRING("0.0078125", text);
+    FormatRawTemp(text, -1);
+    TEST_ASSERT_EQUAL_STRING("-0.0078125", text);
+    FormatRawTemp(text, -1312);
+    TEST_ASSERT_EQUAL_STRING("-10.25", text);
+}
+
+void Test_FormatRawTemp_covers_the_register_range(void) {
+    char text[FIXED_POINT_BUFFER_SIZE];
+
+    FormatRawTemp(text, 32767);
+    TEST_ASSERT_EQUAL_STRING("255.9921875", text);
+    FormatRawTemp(text, -32768);
+    TEST_ASSERT_EQUAL_STRING("-256", text);
+}
+
+void Test_FormatRawTemp_reads_back_exactly(void) {
+    // Every count is a binary fraction, so the text is exact and parses back to it
+    char text[FIXED_POINT_BUFFER_SIZE];
+    for (int32_t raw = -32768; raw <= 32767; raw++) {
+        FormatRawTemp(text, (int16_t)raw);
+        double parsed = strtod(text, NULL) * TEMP_RAW_COUNTS_PER_DEGREE;
+        if (parsed != (double)raw) {
+            TEST_FAIL_MESSAGE(text);
+        }
+    }
+}
+
+void Test_FormatSigned_handles_int32_limits(void) {
+    char text[FIXED_POINT_BUFFER_SIZE];
+
+    TEST_ASSERT_EQUAL(11, FormatSigned(text, (int32_t)0x80000000));
+    TEST_ASSERT_EQUAL_STRING("-2147483648", text);
+    FormatUnsigned(text, 4294967295UL);
+    TEST_ASSERT_EQUAL_STRING("4294967295", text);
+}
+
+void Test_FormatFixedPoint_other_scale(void) {
+    char text[FIXED_POINT_BUFFER_SIZE];
+
+    FormatFixedPoint(text, -25125, CSV_TEMP_SCALE);
+    TEST_ASSERT_EQUAL_STRING("-25.125", text);
+}
+
+// Host benchmarks against the float path the firmware used to take. They
+// report timings only; host numbers do not carry over to the SAMD21, where
+// the gap is larger because float arithmetic is done in software.
+static void ReportTiming(const char* what, double fixedNs, double floatNs) {
+    char message[128];
+    snprintf(message, sizeof(message), "%s: fixed-point %.1f ns, float %.1f ns per reading",
+             what, fixedNs, floatNs);
+    TEST_MESSAGE(message);
+}
+
+template <typename Body>
+static double NanosecondsPerReading(Body body) {
+    const int readings = (BENCH_RAW_LAST - BENCH_RAW_FIRST + 1) * BENCH_ROUNDS;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int raw = BENCH_RAW_FIRST; raw <= BENCH_RAW_LAST; raw++) body((int16_t)raw);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / readings;
+}
+
+void Test_Benchmark_encode(void) {
+    char text[FIXED_POINT_BUFFER_SIZE];
+    volatile size_t sink = 0;
+
+    double fixedNs = NanosecondsPerReading([&](int16_t raw) {
+        sink += FormatRawTemp(text, raw);
+    });
+    double floatNs = NanosecondsPerReading([&](int16_t raw) {
+        sink += (size_t)snprintf(text, sizeof(text), "%.5f", RawTempToCelsius(raw));
+    });
+
+    ReportTiming("Encode", fixedNs, floatNs);
+    TEST_ASSERT_GREATER_THAN(0, (int)sink);
+}
+
+void Test_Benchmark_decode(void) {
+    // One CSV line per reading, as the recovery path reads them back
+    char line[64];
+    volatile int32_t sink = 0;
+
+    double fixedNs = NanosecondsPerReading([&](int16_t raw) {
+        size_t n = 0;
+        n += FormatUnsigned(line, 1737024000UL);
+        line[n++] = ',';
+        n += FormatRawTemp(line + n, raw);
+        line[n++] = ',';
+        n += FormatUnsigned(line + n, 42);
+        CsvRecord record;
+        if (ParseCsvRecord(line, n, record) == CSV_OK) sink += record.milliCelsius;
+    });
+    double floatNs = NanosecondsPerReading([&](int16_t raw) {
+        size_t n = 0;
+        n += FormatUnsigned(line, 1737024000UL);
+        line[n++] = ',';
+        n += FormatRawTemp(line + n, raw);
+        line[n++] = ',';
+        n += FormatUnsigned(line + n, 42);
+        unsigned long timestamp;
+        float celsius;
+        int sequence;
+        if (sscanf(line, "%lu,%f,%d", &timestamp, &celsius, &sequence) == 3) {
+            sink += (int32_t)(celsius * CSV_TEMP_SCALE);
+        }
+    });
+
+    ReportTiming("Decode", fixedNs, floatNs);
+    TEST_ASSERT_NOT_EQUAL(0, (int32_t)sink);
+}
+
+// Bundle for central test_main.cpp
+void Run_fixed_point_tests() {
+    RUN_TEST(Test_FormatRawTemp_prints_exact_decimals);
+    RUN_TEST(Test_FormatRawTemp_covers_the_register_range);
+    RUN_TEST(Test_FormatRawTemp_reads_back_exactly);
+    RUN_TEST(Test_FormatSigned_handles_int32_limits);
+    RUN_TEST(Test_FormatFixedPoint_other_scale);
+    RUN_TEST(Test_Benchmark_encode);
+    RUN_TEST(Test_Benchmark_decode);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_fixed_point_tests();
+    return UNITY_END();
+}
+#endif
@@ -0,0 +1,148 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include <cstdlib>
+#include <new>
+#include "core.h"
+#include "mqtt.h"
+#include "staging_ring.h"
+
+using namespace fakeit;
+
+// =============================================================================
+// HEAP COUNTING HOOK
+// =============================================================================
+// malloc() and friends are replaced for this executable and count while
+// s_counting is set. Arduino String and ArduinoJson's default allocator
+// both use them, so they catch every heap allocation of the firmware.
+// operator new is routed past the counted functions: the test doubles
+// (ArduinoFake, the std::string based mocks) allocate through it, and
+// their allocations are not the firmware's.
+
+#if defined(__GLIBC__)
+#define HEAP_HOOK_AVAILABLE 1
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pointer, size_t size);
+extern "C" void __libc_free(void* pointer);
+
+static bool s_counting = false;
+static unsigned long s_mallocCalls = 0;
+static unsigned long s_freeCalls = 0;
+
+extern "C" void* malloc(size_t size) {
+    if (s_counting) s_mallocCalls++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    if (s_counting) s_mallocCalls++;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* pointer, size_t size) {
+    if (s_counting) s_mallocCalls++;
+    return __libc_realloc(pointer, size);
+}
+
+extern "C" void free(void* pointer) {
+    if (s_counting && pointer) s_freeCalls++;
+    __libc_free(pointer);
+}
+
+void* operator new(size_t size) {
+    void* pointer = __libc_malloc(size ? size : 1);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+    __libc_free(pointer);
+}
+#else
+#define HEAP_HOOK_AVAILABLE 0
+#endif
+
+// =============================================================================
+// SIMULATED DAY
+// =============================================================================
+
+static unsigned long s_fakeMillis = 0;
+
+static DateTime TimeOfDay(unsigned long second) {
+    return DateTime(2025, 7, 27, (int)(second / 3600), (int)(second / 60 % 60), (int)(second % 60));
+}
+
+void setUp(void) {
+    ArduinoFakeReset();
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char[]))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char[]))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const String&))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const String&))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(unsigned long, int))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(int, int))).AlwaysReturn(1);
+    When(Method(ArduinoFake(), millis)).AlwaysDo([]() -> unsigned long { return s_fakeMillis; });
+    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long ms) { s_fakeMillis += ms; });
+
+    WiFi.resetTestState();
+    mqttClient.stop();
+    mqttClient.setRefuseConnect(false);
+    mqttClient.setPubackEnabled(true);
+    sd.clearTestFiles();
+    rtc.setNow(TimeOfDay(0));
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+/**
+ * Runs CoreLoop() once per second for a day: sampling and publishing, a
+ * broker outage from 06:00 to 07:00 that stages readings, and the recovery
+ * of that hour after the reconnect.
+ */
+void Test_CoreLoop_simulated_day_leaves_heap_untouched(void) {
+#if HEAP_HOOK_AVAILABLE
+    CoreSetup();
+
+    s_mallocCalls = 0;
+    s_freeCalls = 0;
+    s_counting = true;
+    for (unsigned long second = 0; second < 24UL * 3600; second++) {
+        if (second == 6 * 3600) {
+            mqttClient.stop();
+            mqttClient.setRefuseConnect(true);
+        } else if (second == 7 * 3600) {
+            mqttClient.setRefuseConnect(false);
+        }
+        s_fakeMillis = second * 1000;
+        rtc.setNow(TimeOfDay(second));
+        CoreLoop();
+    }
+    s_counting = false;
+
+    // The day really ran: the outage hour was recovered, the end of the day published
+    TEST_ASSERT_TRUE(mqttClient.connected());
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+    TEST_ASSERT_GREATER_THAN(24 * 60 - 60, mqttClient.getPublishCount());
+
+    TEST_ASSERT_EQUAL_MESSAGE(0, s_mallocCalls, "malloc/calloc/realloc calls after CoreSetup");
+    TEST_ASSERT_EQUAL_MESSAGE(0, s_freeCalls, "free calls after CoreSetup");
+#else
+    TEST_IGNORE_MESSAGE("Heap counting hook needs glibc");
+#endif
+}
+
+// Bundle for central test_main.cpp
+void Run_heap_tests() {
+    RUN_TEST(Test_CoreLoop_simulated_day_leaves_heap_untouched);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_heap_tests();
+    return UNITY_END();
+}
+#endif
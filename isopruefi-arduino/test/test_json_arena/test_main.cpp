@@ -0,0 +1,128 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "json_arena.h"
+#include "storage.h"
+
+using namespace fakeit;
+
+static JsonArena* s_arena = nullptr;
+
+void setUp(void) {
+    ArduinoFakeReset();
+    s_arena = new JsonArena();
+}
+
+void tearDown(void) {
+    delete s_arena;
+    s_arena = nullptr;
+    ArduinoFakeReset();
+}
+
+// Test the bump allocation and reclaiming of blocks
+void Test_JsonArena_blocks_are_aligned_and_counted(void) {
+    void* a = s_arena->allocate(3);
+    void* b = s_arena->allocate(5);
+
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)b % sizeof(void*));
+    TEST_ASSERT_TRUE((uint8_t*)b >= (uint8_t*)a + 3);
+    TEST_ASSERT_EQUAL(2, s_arena->Blocks());
+}
+
+void Test_JsonArena_is_empty_once_every_block_is_free(void) {
+    void* a = s_arena->allocate(100);
+    void* b = s_arena->allocate(100);
+    s_arena->deallocate(a);
+    TEST_ASSERT_GREATER_THAN(0, (int)s_arena->Used());
+
+    s_arena->deallocate(b);
+    TEST_ASSERT_EQUAL(0, s_arena->Used());
+    TEST_ASSERT_EQUAL(0, s_arena->Blocks());
+    TEST_ASSERT_GREATER_THAN(199, (int)s_arena->HighWater());
+}
+
+void Test_JsonArena_reclaims_the_last_block(void) {
+    void* a = s_arena->allocate(16);
+    const size_t used = s_arena->Used();
+    void* b = s_arena->allocate(64);
+    s_arena->deallocate(b);
+
+    TEST_ASSERT_EQUAL(used, s_arena->Used());
+    TEST_ASSERT_EQUAL_PTR(b, s_arena->allocate(32));
+    s_arena->deallocate(a);
+}
+
+void Test_JsonArena_reallocate_grows_last_block_in_place(void) {
+    uint8_t* a = (uint8_t*)s_arena->allocate(8);
+    memset(a, 0x5A, 8);
+
+    uint8_t* grown = (uint8_t*)s_arena->reallocate(a, 200);
+    TEST_ASSERT_EQUAL_PTR(a, grown);
+    TEST_ASSERT_EQUAL(0x5A, grown[7]);
+    TEST_ASSERT_EQUAL(1, s_arena->Blocks());
+}
+
+void Test_JsonArena_reallocate_moves_earlier_block(void) {
+    uint8_t* a = (uint8_t*)s_arena->allocate(8);
+    for (int i = 0; i < 8; i++) a[i] = (uint8_t)i;
+    s_arena->allocate(8);
+
+    uint8_t* moved = (uint8_t*)s_arena->reallocate(a, 16);
+    TEST_ASSERT_NOT_NULL(moved);
+    TEST_ASSERT_TRUE(moved != a);
+    TEST_ASSERT_EQUAL(7, moved[7]);
+    TEST_ASSERT_EQUAL(2, s_arena->Blocks());
+}
+
+void Test_JsonArena_fails_instead_of_using_the_heap(void) {
+    void* a = s_arena->allocate(JSON_ARENA_SIZE / 2);
+    TEST_ASSERT_NOT_NULL(a);
+
+    TEST_ASSERT_NULL(s_arena->allocate(JSON_ARENA_SIZE));
+    TEST_ASSERT_NULL(s_arena->reallocate(a, JSON_ARENA_SIZE));
+    TEST_ASSERT_EQUAL(2, s_arena->Failures());
+    TEST_ASSERT_EQUAL(1, s_arena->Blocks());
+}
+
+// Test the arena behind a real document
+void Test_JsonArena_holds_a_full_burst_document(void) {
+    BurstMessage burst = {};
+    burst.timestamp = 1753541705;
+    burst.periodSeconds = 5;
+    burst.count = BURST_MAX_SAMPLES;
+    for (uint8_t i = 0; i < burst.count; i++) burst.raw[i] = (int16_t)(-1 - 37 * i);
+
+    char payload[256];
+    {
+        JsonDocument doc(s_arena);
+        BuildJson(doc, burst);
+        TEST_ASSERT_FALSE(doc.overflowed());
+        serializeJson(doc, payload, sizeof(payload));
+    }
+
+    TEST_ASSERT_NOT_NULL(strstr(payload, "\"value\":[-0.0078125,-0.296875,"));
+    TEST_ASSERT_EQUAL(0, s_arena->Failures());
+    TEST_ASSERT_EQUAL(0, s_arena->Used());
+    TEST_ASSERT_TRUE(s_arena->HighWater() <= JSON_ARENA_SIZE);
+}
+
+// Bundle for central test_main.cpp
+void Run_json_arena_tests() {
+    RUN_TEST(Test_JsonArena_blocks_are_aligned_and_counted);
+    RUN_TEST(Test_JsonArena_is_empty_once_every_block_is_free);
+    RUN_TEST(Test_JsonArena_reclaims_the_last_block);
+    RUN_TEST(Test_JsonArena_reallocate_grows_last_block_in_place);
+    RUN_TEST(Test_JsonArena_reallocate_moves_earlier_block);
+    RUN_TEST(Test_JsonArena_fails_instead_of_using_the_heap);
+    RUN_TEST(Test_JsonArena_holds_a_full_burst_document);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_json_arena_tests();
+    return UNITY_END();
+}
+#endif
@@ -0,0 +1,112 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "live_batch.h"
+#include "staging_ring.h"
+
+using namespace fakeit;
+
+void setUp(void) {
+    ArduinoFakeReset();
+    LiveBatchReset();
+    StagingRingReset();
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+static OutageRecord Reading(uint32_t sequence) {
+    OutageRecord record = {};
+    record.timestamp = 1753778400 + 60 * sequence;
+    record.sequence = sequence;
+    record.rawTemp = 3264;
+    record.count = 1;
+    return record;
+}
+
+// Test queueing and the flush conditions
+void Test_LiveBatch_is_off_by_default(void) {
+    TEST_ASSERT_EQUAL(1, LiveBatchSize());
+    LiveBatchConfigure(0, 1000);
+    TEST_ASSERT_EQUAL(1, LiveBatchSize());
+    LiveBatchConfigure(200, 1000);
+    TEST_ASSERT_EQUAL(LIVE_BATCH_MAX_RECORDS, LiveBatchSize());
+}
+
+void Test_LiveBatch_due_when_full_or_old(void) {
+    LiveBatchConfigure(3, 10000);
+    TEST_ASSERT_FALSE(LiveBatchDue(0));
+
+    TEST_ASSERT_TRUE(LiveBatchAdd(Reading(1), 1000));
+    TEST_ASSERT_TRUE(LiveBatchAdd(Reading(2), 2000));
+    TEST_ASSERT_FALSE(LiveBatchDue(2000));
+    // The age counts from the oldest reading
+    TEST_ASSERT_TRUE(LiveBatchDue(11000));
+
+    TEST_ASSERT_TRUE(LiveBatchAdd(Reading(3), 3000));
+    TEST_ASSERT_TRUE(LiveBatchDue(3000));
+}
+
+void Test_LiveBatch_queues_behind_the_batch_in_flight(void) {
+    LiveBatchConfigure(2, 10000);
+    LiveBatchAdd(Reading(1), 0);
+    LiveBatchAdd(Reading(2), 0);
+    TEST_ASSERT_EQUAL(2, LiveBatchStart());
+    TEST_ASSERT_EQUAL(0, LiveBatchQueuedCount());
+
+    // The next batch fills up but waits, and a third reading does not fit
+    TEST_ASSERT_TRUE(LiveBatchAdd(Reading(3), 0));
+    TEST_ASSERT_TRUE(LiveBatchAdd(Reading(4), 0));
+    TEST_ASSERT_FALSE(LiveBatchAdd(Reading(5), 0));
+    TEST_ASSERT_FALSE(LiveBatchDue(20000));
+    TEST_ASSERT_EQUAL(0, LiveBatchStart());
+
+    LiveBatchSettle();
+    TEST_ASSERT_TRUE(LiveBatchDue(0));
+    TEST_ASSERT_EQUAL(2, LiveBatchStart());
+    OutageRecord records[2];
+    TEST_ASSERT_EQUAL(2, LiveBatchPeekInFlight(records, 2));
+    TEST_ASSERT_EQUAL(3, records[0].sequence);
+    TEST_ASSERT_EQUAL(4, records[1].sequence);
+}
+
+void Test_LiveBatch_spill_moves_whole_batch_in_order(void) {
+    LiveBatchConfigure(4, 10000);
+    for (uint32_t i = 1; i <= 4; i++) LiveBatchAdd(Reading(i), 0);
+    LiveBatchStart();
+
+    TEST_ASSERT_EQUAL(4, LiveBatchSpill(0));
+    TEST_ASSERT_EQUAL(0, LiveBatchInFlightCount());
+    OutageRecord records[4];
+    TEST_ASSERT_EQUAL(4, StagingRingPeek(records, 4));
+    for (uint32_t i = 0; i < 4; i++) TEST_ASSERT_EQUAL(i + 1, records[i].sequence);
+}
+
+void Test_LiveBatch_peek_skips_records(void) {
+    LiveBatchConfigure(3, 10000);
+    for (uint32_t i = 1; i <= 3; i++) LiveBatchAdd(Reading(i), 0);
+    LiveBatchStart();
+
+    OutageRecord records[3];
+    TEST_ASSERT_EQUAL(2, LiveBatchPeekInFlight(records, 3, 1));
+    TEST_ASSERT_EQUAL(2, records[0].sequence);
+    TEST_ASSERT_EQUAL(0, LiveBatchPeekInFlight(records, 3, 3));
+}
+
+// Bundle for central test_main.cpp
+void Run_live_batch_tests() {
+    RUN_TEST(Test_LiveBatch_is_off_by_default);
+    RUN_TEST(Test_LiveBatch_due_when_full_or_old);
+    RUN_TEST(Test_LiveBatch_queues_behind_the_batch_in_flight);
+    RUN_TEST(Test_LiveBatch_spill_moves_whole_batch_in_order);
+    RUN_TEST(Test_LiveBatch_peek_skips_records);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_live_batch_tests();
+    return UNITY_END();
+}
+#endif
@@ -0,0 +1,161 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include <string>
+#include <cstring>
+#include "logger.h"
+
+using namespace fakeit;
+
+/// Test sink: takes up to s_sinkLimit bytes per call, like a nearly full UART buffer
+static std::string s_output;
+static size_t s_sinkLimit = SIZE_MAX;
+static uint32_t s_sinkCalls = 0;
+
+static size_t CaptureSink(const char* data, size_t len) {
+    s_sinkCalls++;
+    if (len > s_sinkLimit) len = s_sinkLimit;
+    s_output.append(data, len);
+    return len;
+}
+
+void setUp(void) {
+    ArduinoFakeReset();
+    When(Method(ArduinoFake(), millis)).AlwaysReturn(0);
+    LogReset();
+    s_output.clear();
+    s_sinkLimit = SIZE_MAX;
+    s_sinkCalls = 0;
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+// Test buffering and draining
+void Test_LogWrite_waits_in_the_ring_until_drained(void) {
+    LogBegin(CaptureSink);
+    LOG_ERROR("SD card failed.");
+    LOG_WARN("Retrying in ms: %lu", 4000UL);
+    LOG_INFO("Published to %s", "dhbw/temp/Sensor_One");
+    TEST_ASSERT_EQUAL(0, s_sinkCalls);
+
+    const char* expected = "E SD card failed.\nW Retrying in ms: 4000\nI Published to dhbw/temp/Sensor_One\n";
+    TEST_ASSERT_EQUAL(strlen(expected), LogDrain());
+    TEST_ASSERT_EQUAL_STRING(expected, s_output.c_str());
+    TEST_ASSERT_EQUAL(0, LogPendingBytes());
+    TEST_ASSERT_EQUAL(3, LogGetStats().written);
+}
+
+void Test_LogDrain_holds_messages_without_a_sink(void) {
+    LOG_INFO("Setup complete.");
+    TEST_ASSERT_EQUAL(0, LogDrain());
+    TEST_ASSERT_EQUAL(strlen("I Setup complete.\n"), LogPendingBytes());
+
+    LogBegin(CaptureSink);
+    LogDrain();
+    TEST_ASSERT_EQUAL_STRING("I Setup complete.\n", s_output.c_str());
+}
+
+void Test_LogDrain_takes_only_what_the_sink_takes(void) {
+    LogBegin(CaptureSink);
+    s_sinkLimit = 5;
+    LOG_INFO("Connecting to MQTT...");
+
+    TEST_ASSERT_EQUAL(5, LogDrain());
+    TEST_ASSERT_EQUAL_STRING("I Con", s_output.c_str());
+
+    s_sinkLimit = SIZE_MAX;
+    LogDrain();
+    TEST_ASSERT_EQUAL_STRING("I Connecting to MQTT...\n", s_output.c_str());
+}
+
+void Test_LogDrain_keeps_text_intact_across_the_ring_wrap(void) {
+    LogBegin(CaptureSink);
+    // Lines of 50 bytes do not divide the ring, so they wrap at varying points
+    for (int i = 0; i < 100; i++) {
+        LOG_INFO("%047d", i);
+        if (i % 3 == 2) LogDrain();
+    }
+    LogDrain();
+
+    TEST_ASSERT_EQUAL(100 * 50, s_output.size());
+    char expected[64];
+    snprintf(expected, sizeof(expected), "I %047d\n", 99);
+    TEST_ASSERT_EQUAL_STRING(expected, s_output.c_str() + 99 * 50);
+    TEST_ASSERT_EQUAL(0, LogGetStats().dropped);
+}
+
+// Test limits
+void Test_LogWrite_drops_whole_messages_and_notes_the_count(void) {
+    LogBegin(CaptureSink);
+    // 50 bytes each: ten fit into the ring, the rest are dropped
+    for (int i = 0; i < 13; i++) LOG_WARN("%047d", i);
+    TEST_ASSERT_EQUAL(10, LogGetStats().written);
+    TEST_ASSERT_EQUAL(3, LogGetStats().dropped);
+
+    LogDrain();
+    TEST_ASSERT_EQUAL(10 * 50, s_output.size());
+    LogDrain();
+    TEST_ASSERT_EQUAL_STRING("W 3 log messages dropped\n", s_output.c_str() + 10 * 50);
+
+    // The note is written once
+    LogDrain();
+    TEST_ASSERT_EQUAL(10 * 50 + strlen("W 3 log messages dropped\n"), s_output.size());
+}
+
+void Test_LogWrite_cuts_long_messages(void) {
+    LogBegin(CaptureSink);
+    std::string payload(2048, 'x');
+    LOG_INFO("%s", payload.c_str());
+    LogDrain();
+
+    TEST_ASSERT_EQUAL(LOG_LINE_MAX, s_output.size());
+    TEST_ASSERT_EQUAL('\n', s_output[LOG_LINE_MAX - 1]);
+}
+
+void Test_LogFlush_empties_the_ring(void) {
+    LogBegin(CaptureSink);
+    s_sinkLimit = 7;
+    for (int i = 0; i < 20; i++) LOG_ERROR("%047d", i);
+    LogFlush();
+
+    TEST_ASSERT_EQUAL(0, LogPendingBytes());
+    TEST_ASSERT_EQUAL(10 * 50 + strlen("W 10 log messages dropped\n"), s_output.size());
+}
+
+#if LOG_LEVEL < LOG_LEVEL_DEBUG
+void Test_LOG_DEBUG_is_compiled_out(void) {
+    LogBegin(CaptureSink);
+    int evaluated = 0;
+    LOG_DEBUG("%d", ++evaluated);
+    LogDrain();
+
+    // Not even the arguments are evaluated
+    TEST_ASSERT_EQUAL(0, evaluated);
+    TEST_ASSERT_EQUAL(0, s_output.size());
+    TEST_ASSERT_EQUAL(0, LogGetStats().written);
+}
+#endif
+
+// Bundle for central test_main.cpp
+void Run_logger_tests() {
+    RUN_TEST(Test_LogWrite_waits_in_the_ring_until_drained);
+    RUN_TEST(Test_LogDrain_holds_messages_without_a_sink);
+    RUN_TEST(Test_LogDrain_takes_only_what_the_sink_takes);
+    RUN_TEST(Test_LogDrain_keeps_text_intact_across_the_ring_wrap);
+    RUN_TEST(Test_LogWrite_drops_whole_messages_and_notes_the_count);
+    RUN_TEST(Test_LogWrite_cuts_long_messages);
+    RUN_TEST(Test_LogFlush_empties_the_ring);
+#if LOG_LEVEL < LOG_LEVEL_DEBUG
+    RUN_TEST(Test_LOG_DEBUG_is_compiled_out);
+#endif
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_logger_tests();
+    return UNITY_END();
+}
+#endif
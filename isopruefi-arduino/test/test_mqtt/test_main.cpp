@@ -2,12 +2,26 @@
 #include <unity.h>
 #include "mqtt.h"
 #include "storage.h"
+#include "publish_window.h"
+#include "recovery_stream.h"
+#include "live_batch.h"
 
 using namespace fakeit;
 
 void setUp(void) {
     ArduinoFakeReset();
+    OutageLogEnd();
+    BatchManifestEnd();
     sd.clearTestFiles();
+    StagingRingReset();
+    ResetRecovery();
+    PublishWindowReset();
+    LiveBatchReset();
+    SetMqttAckMode(MQTT_ACK_PUBACK);
+    SetRecoveryMessageLimit(RECOVERY_DEFAULT_MESSAGE_BYTES);
+    mqttClient.setEchoEnabled(false);
+    mqttClient.setPubackEnabled(false);
+    mqttClient.connect("broker");
 
     // Basic Arduino function stubs
     When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char[]))).AlwaysReturn(1);
@@ -17,6 +31,7 @@ void setUp(void) {
     When(Method(ArduinoFake(), millis)).Return(8000, 0);
 
     When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const String&))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(unsigned long, int))).AlwaysReturn(1);
     When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const String&))).AlwaysReturn(1);
 }
 
@@ -24,6 +39,89 @@ void tearDown(void) {
     ArduinoFakeReset();
 }
 
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+static unsigned long s_fakeMillis = 0;
+
+/// Stack recovery may use on the host (64-bit frames, mocks included); the former
+/// document-and-buffer recovery needed about 3.5 KB here
+static const size_t RECOVERY_STACK_BUDGET_BYTES = 2048;
+
+/// Lets millis() advance by stepMs per call and makes delay() a no-op
+static void UseFakeClock(unsigned long stepMs) {
+    static unsigned long step;
+    step = stepMs;
+    s_fakeMillis = 0;
+    When(Method(ArduinoFake(), millis)).AlwaysDo([]() { return s_fakeMillis += step; });
+    When(Method(ArduinoFake(), delay)).AlwaysReturn();
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(int, int))).AlwaysReturn(1);
+}
+
+/// millis() only advances through delay(), like a device sleeping between polls
+static void UseSimulatedClock() {
+    s_fakeMillis = 0;
+    When(Method(ArduinoFake(), millis)).AlwaysDo([]() { return s_fakeMillis; });
+    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long ms) { s_fakeMillis += ms; });
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(int, int))).AlwaysReturn(1);
+}
+
+/// Limits recovery messages to the size of the first n outage log records
+static void LimitRecoveryMessagesTo(size_t n, const DateTime& now) {
+    OutageLogRecordSource source(0, n);
+    RecoveryMessageInfo info;
+    TEST_ASSERT_TRUE(RecoveryMeasure(source, now.unixtime(), RECOVERY_MAX_MESSAGE_BYTES, info));
+    SetRecoveryMessageLimit(info.bytes);
+}
+
+/// Drains 40 outage records over a link with the given round trip, returns the simulated time
+static unsigned long MeasureRecoveryTime(uint8_t windowSize, unsigned long roundTripMs) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    OutageLogEnd();
+    sd.clearTestFiles();
+    for (int i = 0; i < 40; i++) SaveTempToOutageLog(now, 20.0, 10 + i);
+    LimitRecoveryMessagesTo(5, now);
+
+    UseSimulatedClock();
+    mqttClient.setPubackEnabled(true);
+    mqttClient.setAckDelay(roundTripMs);
+    PublishWindowSetSize(windowSize);
+
+    // One tick per CoreLoop pass, with the loop delay in between
+    for (int tick = 0; tick < 200; tick++) {
+        if (SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now)) break;
+        delay(1000);
+    }
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+    return s_fakeMillis;
+}
+
+/// Connected client whose broker echoes every message on a subscribed topic (echo fallback mode)
+static void UseEchoingBroker() {
+    SetMqttAckMode(MQTT_ACK_ECHO);
+    mqttClient.connect("broker");
+    mqttClient.setEchoEnabled(true);
+}
+
+/// Connected client whose broker answers every QoS 1 publish with a PUBACK
+static void UseAckingBroker() {
+    mqttClient.connect("broker");
+    mqttClient.setPubackEnabled(true);
+}
+
+/// Period of the recovery task in CoreLoop()
+static const unsigned long RECOVERY_TASK_PERIOD_MS = 250;
+
+/// Calls the recovery tick like CoreLoop() does until it reports completion
+static bool RunRecoveryToCompletion(const DateTime& now, int maxTicks = 50) {
+    for (int tick = 0; tick < maxTicks; tick++) {
+        if (SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now)) return true;
+        delay(RECOVERY_TASK_PERIOD_MS);
+    }
+    return false;
+}
+
 // Test createFullTopic function
 void Test_CreateFullTopic_with_suffix(void) {
     char buffer[128];
@@ -84,10 +182,9 @@ void Test_SendTempToMqtt_handles_mqtt_connection_failure(void) {
     
     bool result = SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 25.5, now, 42);
     
-    // Should fallback to CSV when MQTT fails
+    // Should fall back to the staging ring when MQTT fails
     TEST_ASSERT_FALSE(result);
-    TEST_ASSERT_TRUE(sd.exists("2025"));
-    TEST_ASSERT_TRUE(sd.exists("2025/07261455.csv"));
+    TEST_ASSERT_EQUAL(1, StagingRingCount());
 }
 
 void Test_SendTempToMqtt_handles_negative_temperatures(void) {
@@ -183,6 +280,539 @@ void Test_SendPendingData_handles_large_payloads(void) {
     TEST_ASSERT_TRUE(result);
 }
 
+void Test_SendPendingData_drains_outage_log(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseFakeClock(1);
+    UseEchoingBroker();
+
+    // Setup: three readings stored during an outage
+    SaveTempToOutageLog(now, 21.0, 7);
+    SaveTempToOutageLog(now, 21.5, 8);
+    SaveTempToOutageLog(now, 22.0, 9);
+
+    bool result = RunRecoveryToCompletion(now);
+
+    // All records published in one message and consumed
+    TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+    std::string lastMessage = mqttClient.getLastMessage();
+    TEST_ASSERT_TRUE(lastMessage.find("\"s\":[7,8,9]") != std::string::npos);
+    TEST_ASSERT_TRUE(lastMessage.find("21.5") != std::string::npos);
+}
+
+void Test_SendPendingData_drains_staged_readings_from_ram(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseFakeClock(1);
+    UseAckingBroker();
+
+    // Setup: a short outage, staged in RAM only
+    for (int i = 0; i < 3; i++) StageTempReading(now, 21.0 + i, 10 + i);
+
+    TEST_ASSERT_TRUE(RunRecoveryToCompletion(now));
+
+    // Published straight from the ring, nothing ever written to the card
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+    TEST_ASSERT_EQUAL(0, StagingRingSpilledCount());
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+    TEST_ASSERT_EQUAL(0, OutageLogBufferedBytes());
+    TEST_ASSERT_TRUE(mqttClient.getLastMessage().find("\"s\":[10,11,12]") != std::string::npos);
+}
+
+void Test_SendPendingData_keeps_staged_readings_in_flight_until_acked(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    UseAckingBroker();
+    mqttClient.setAckDelay(500);
+    for (int i = 0; i < 3; i++) StageTempReading(now, 21.0, 10 + i);
+
+    // In flight: the ring may neither spill nor drop them
+    SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now);
+    StagingRingTick(s_fakeMillis + 600000, 1000);
+    TEST_ASSERT_EQUAL(3, StagingRingCount());
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+
+    delay(1000);
+    TEST_ASSERT_TRUE(RunRecoveryToCompletion(now));
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+}
+
+void Test_SendPendingData_discards_stale_outage_records(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    When(Method(ArduinoFake(), millis)).AlwaysReturn(0);
+
+    // Setup: a record older than 24 hours
+    OutageRecord stale = {now.unixtime() - 90000, 1, 2560, 0};
+    OutageLogAppend(stale);
+
+    bool result = SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now);
+
+    TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+}
+
+void Test_SendPendingData_recovers_batches_across_year_folders(void) {
+    DateTime now(2025, 1, 1, 0, 30, 0);
+    UseFakeClock(1);
+    UseEchoingBroker();
+
+    // Setup: a backlog that started before New Year
+    char older[64];
+    char newer[32];
+    snprintf(older, sizeof(older), "%lu,21.0,1\n%lu,21.5,2\n",
+             (unsigned long)now.unixtime() - 2400, (unsigned long)now.unixtime() - 2340);
+    snprintf(newer, sizeof(newer), "%lu,22.0,3\n", (unsigned long)now.unixtime() - 1500);
+    sd.addTestFile("2024/12312350.csv", older);
+    sd.addTestFile("2025/01010005.csv", newer);
+
+    bool result = RunRecoveryToCompletion(now);
+
+    // Both batches published in one message and deleted, the manifest has nothing pending
+    TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_FALSE(sd.exists("2024/12312350.csv"));
+    TEST_ASSERT_FALSE(sd.exists("2025/01010005.csv"));
+    TEST_ASSERT_EQUAL(BatchManifestCount(), BatchManifestFirstPending());
+    std::string lastMessage = mqttClient.getLastMessage();
+    TEST_ASSERT_TRUE(lastMessage.find("\"s\":[1,2,3]") != std::string::npos);
+}
+
+void Test_SendPendingData_tick_publishes_limited_messages(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseFakeClock(1);
+    UseEchoingBroker();
+
+    // Setup: 20 records, i.e. four recovery messages
+    for (int i = 0; i < 20; i++) SaveTempToOutageLog(now, 20.0 + i, 10 + i);
+    LimitRecoveryMessagesTo(5, now);
+
+    // The first tick sends three messages and leaves the rest for the next loop
+    mqttClient.resetPublishCount();
+    bool result = SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now);
+    TEST_ASSERT_FALSE(result);
+    TEST_ASSERT_EQUAL(3, mqttClient.getPublishCount());
+    TEST_ASSERT_EQUAL(20, OutageLogPendingCount());
+
+    // Their echoes are settled by the next tick, which sends the fourth
+    TEST_ASSERT_FALSE(SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now));
+    TEST_ASSERT_EQUAL(4, mqttClient.getPublishCount());
+    TEST_ASSERT_EQUAL(5, OutageLogPendingCount());
+
+    TEST_ASSERT_TRUE(RunRecoveryToCompletion(now));
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+}
+
+void Test_SendPendingData_tick_never_waits_for_acks(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    mqttClient.connect("broker");
+
+    // Setup: a record whose ack never arrives
+    SaveTempToOutageLog(now, 21.0, 1);
+
+    // Every tick returns at once; the time passes between them
+    for (int tick = 0; tick < 20; tick++) {
+        unsigned long before = s_fakeMillis;
+        TEST_ASSERT_FALSE(SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now));
+        TEST_ASSERT_EQUAL(before, s_fakeMillis);
+        delay(RECOVERY_TASK_PERIOD_MS);
+    }
+    TEST_ASSERT_EQUAL(1, OutageLogPendingCount());
+}
+
+void Test_SendPendingData_tick_stops_when_budget_is_used_up(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseFakeClock(100);
+    UseAckingBroker();
+
+    // Setup: four recovery messages on a card so slow that one publish takes the budget
+    for (int i = 0; i < 20; i++) SaveTempToOutageLog(now, 20.0 + i, 10 + i);
+    LimitRecoveryMessagesTo(5, now);
+    mqttClient.resetPublishCount();
+
+    TEST_ASSERT_FALSE(SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now));
+    TEST_ASSERT_EQUAL(1, mqttClient.getPublishCount());
+
+    TEST_ASSERT_TRUE(RunRecoveryToCompletion(now));
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+}
+
+void Test_SendPendingData_keeps_unacknowledged_data_and_retries(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    mqttClient.connect("broker");
+
+    SaveTempToOutageLog(now, 21.0, 1);
+    SaveTempToOutageLog(now, 21.5, 2);
+
+    // No ack: the batch times out and stays in the log
+    TEST_ASSERT_FALSE(RunRecoveryToCompletion(now, 200));
+    TEST_ASSERT_EQUAL(2, OutageLogPendingCount());
+
+    // Once the broker answers, the retry delivers and consumes it
+    mqttClient.setPubackEnabled(true);
+    TEST_ASSERT_TRUE(RunRecoveryToCompletion(now, 200));
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+    TEST_ASSERT_TRUE(mqttClient.getLastMessage().find("\"s\":[1,2]") != std::string::npos);
+}
+
+// Test pipelined publishing with delayed acks
+void Test_SendTempToMqtt_returns_before_ack(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    UseAckingBroker();
+    mqttClient.setAckDelay(800);
+
+    // Published without waiting, the reading stays in flight
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 25.5, now, 42));
+    TEST_ASSERT_EQUAL(0, s_fakeMillis);
+    TEST_ASSERT_EQUAL(1, PublishWindowCount(PUBLISH_LIVE));
+
+    // The late ack settles it without staging it for recovery
+    delay(1000);
+    ServicePublishWindow(mqttClient, now);
+    TEST_ASSERT_EQUAL(0, PublishWindowCount(PUBLISH_LIVE));
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+}
+
+void Test_ServicePublishWindow_spills_only_timed_out_readings(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+
+    // Reading 1 is lost on the way, reading 2 is acknowledged late
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 21.0, now, 1));
+    UseAckingBroker();
+    mqttClient.setAckDelay(3000);
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 22.0, now, 2));
+
+    delay(6000);
+    ServicePublishWindow(mqttClient, now);
+
+    TEST_ASSERT_EQUAL(0, PublishWindowCount(PUBLISH_LIVE));
+    OutageRecord records[2];
+    TEST_ASSERT_EQUAL(1, StagingRingPeek(records, 2));
+    TEST_ASSERT_EQUAL(1, records[0].sequence);
+}
+
+void Test_SendBurstToMqtt_publishes_one_message_and_drops_it_on_timeout(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    BurstMessage burst = {};
+    burst.timestamp = now.unixtime() + 5;
+    burst.periodSeconds = 5;
+    burst.count = BURST_MAX_SAMPLES;
+    for (int i = 0; i < BURST_MAX_SAMPLES; i++) burst.raw[i] = -1280 - 37 * i;
+
+    // A full burst of negative temperatures fits in one message
+    TEST_ASSERT_TRUE(SendBurstToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", burst));
+    std::string lastMessage = mqttClient.getLastMessage();
+    TEST_ASSERT_TRUE(lastMessage.find("\"sequence\"") == std::string::npos);
+    TEST_ASSERT_TRUE(lastMessage.find("\"burst\":5") != std::string::npos);
+    TEST_ASSERT_EQUAL(1, PublishWindowCount(PUBLISH_BURST));
+
+    // Only one burst at a time
+    TEST_ASSERT_FALSE(SendBurstToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", burst));
+
+    // Not acknowledged: dropped, not staged
+    delay(6000);
+    ServicePublishWindow(mqttClient, now);
+    TEST_ASSERT_EQUAL(0, PublishWindowCount(PUBLISH_BURST));
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+}
+
+void Test_SendBurstToMqtt_echo_is_matched_by_timestamp(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    UseEchoingBroker();
+    BurstMessage burst = {};
+    burst.timestamp = now.unixtime() + 5;
+    burst.periodSeconds = 5;
+    burst.count = 2;
+
+    // A live reading in flight next to the burst
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 22.0, now, 3));
+    TEST_ASSERT_TRUE(SendBurstToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", burst));
+    PublishEntry* entry = PublishWindowOldest(PUBLISH_BURST);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL(burst.timestamp, entry->key);
+    TEST_ASSERT_EQUAL(0, entry->record.sequence);
+
+    // Both echoes settle their own message
+    ServicePublishWindow(mqttClient, now);
+    TEST_ASSERT_EQUAL(0, PublishWindowCount(PUBLISH_BURST));
+    TEST_ASSERT_EQUAL(0, PublishWindowCount(PUBLISH_LIVE));
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+}
+
+void Test_LiveBatching_sends_k_readings_in_one_message(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    UseAckingBroker();
+    SetLiveBatching(3, 60000);
+    mqttClient.resetPublishCount();
+
+    // The first two readings only queue up, the third sends all of them
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 21.0, now, 1));
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 21.5, DateTime(2025, 7, 26, 14, 56, 0), 2));
+    TEST_ASSERT_EQUAL(0, mqttClient.getPublishCount());
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 22.0, DateTime(2025, 7, 26, 14, 57, 0), 3));
+    TEST_ASSERT_EQUAL(1, mqttClient.getPublishCount());
+
+    std::string topic = mqttClient.getLastTopic();
+    TEST_ASSERT_EQUAL_STRING("dhbw/ai/si2023/2/temp/Sensor_One/recovered", topic.c_str());
+    std::string lastMessage = mqttClient.getLastMessage();
+    TEST_ASSERT_TRUE(lastMessage.find("\"s\":[1,2,3]") != std::string::npos);
+    TEST_ASSERT_TRUE(lastMessage.find("\"v\":[21,21.5,22]") != std::string::npos);
+
+    // One ack settles the whole batch
+    ServicePublishWindow(mqttClient, now);
+    TEST_ASSERT_EQUAL(0, PublishWindowCount(PUBLISH_LIVE_BATCH));
+    TEST_ASSERT_EQUAL(0, LiveBatchInFlightCount());
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+}
+
+void Test_LiveBatching_flushes_after_max_latency(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    UseAckingBroker();
+    SetLiveBatching(8, 30000);
+    mqttClient.resetPublishCount();
+
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 21.0, now, 1));
+    delay(29000);
+    ServicePublishWindow(mqttClient, now);
+    TEST_ASSERT_EQUAL(0, mqttClient.getPublishCount());
+
+    // The lone reading does not wait for seven more
+    delay(1000);
+    ServicePublishWindow(mqttClient, now);
+    TEST_ASSERT_EQUAL(1, mqttClient.getPublishCount());
+    TEST_ASSERT_EQUAL(1, PublishWindowCount(PUBLISH_LIVE_BATCH));
+}
+
+void Test_LiveBatching_spills_whole_batch_without_ack(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    SetLiveBatching(3, 60000);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 21.0 + i,
+                                        DateTime(2025, 7, 26, 14, 55 + i, 0), 10 + i));
+    }
+    // A reading taken meanwhile queues behind the batch in flight
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 24.0,
+                                    DateTime(2025, 7, 26, 14, 58, 0), 13));
+    TEST_ASSERT_EQUAL(1, LiveBatchQueuedCount());
+
+    delay(6000);
+    ServicePublishWindow(mqttClient, now);
+
+    // All three readings are staged, in order; the queued one stays for the next batch
+    OutageRecord records[4];
+    TEST_ASSERT_EQUAL(3, StagingRingPeek(records, 4));
+    TEST_ASSERT_EQUAL(10, records[0].sequence);
+    TEST_ASSERT_EQUAL(11, records[1].sequence);
+    TEST_ASSERT_EQUAL(12, records[2].sequence);
+    TEST_ASSERT_EQUAL(0, LiveBatchInFlightCount());
+    TEST_ASSERT_EQUAL(0, PublishWindowCount(PUBLISH_LIVE_BATCH));
+}
+
+void Test_LiveBatching_stages_queue_when_disconnected(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    SetLiveBatching(4, 30000);
+
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 21.0, now, 1));
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 21.5, now, 2));
+    mqttClient.stop();
+    delay(30000);
+    ServicePublishWindow(mqttClient, now);
+
+    TEST_ASSERT_EQUAL(0, LiveBatchQueuedCount());
+    TEST_ASSERT_EQUAL(2, StagingRingCount());
+}
+
+void Test_SendPendingData_retries_only_unacknowledged_batches(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    mqttClient.connect("broker");
+
+    // Two messages in flight; the broker only answers after the first was sent
+    for (uint32_t i = 0; i < 10; i++) {
+        OutageRecord record = {now.unixtime() - 600 + i * 60, 10 + i, 2560, 0};
+        OutageLogAppend(record);
+    }
+    LimitRecoveryMessagesTo(5, now);
+    PublishWindowSetSize(1);
+    SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now);
+    mqttClient.setPubackEnabled(true);
+    PublishWindowSetSize(2);
+    mqttClient.resetPublishCount();
+    SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now);
+
+    // The second batch is acknowledged but waits for the first, which is the only one sent again
+    TEST_ASSERT_EQUAL(1, mqttClient.getPublishCount());
+    TEST_ASSERT_EQUAL(10, OutageLogPendingCount());
+    TEST_ASSERT_TRUE(RunRecoveryToCompletion(now, 200));
+    TEST_ASSERT_EQUAL(2, mqttClient.getPublishCount());
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+}
+
+void Test_SendPendingData_throughput_scales_with_window(void) {
+    const unsigned long ROUND_TRIP_MS = 1500;
+    unsigned long stopAndWait = MeasureRecoveryTime(1, ROUND_TRIP_MS);
+    unsigned long pipelined = MeasureRecoveryTime(4, ROUND_TRIP_MS);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "8 recovery messages, %lu ms RTT: window 1 %lu ms, window 4 %lu ms",
+             ROUND_TRIP_MS, stopAndWait, pipelined);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(pipelined * 2 < stopAndWait);
+}
+
+// Test streamed recovery messages
+void Test_SendPendingData_splits_oversized_batch(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseFakeClock(1);
+    UseAckingBroker();
+
+    // Setup: a batch far larger than one recovery message
+    std::string content;
+    for (int i = 0; i < 150; i++) {
+        char line[40];
+        snprintf(line, sizeof(line), "%lu,21.25,%d\n", (unsigned long)now.unixtime() - 9000 + 60UL * i, i);
+        content += line;
+    }
+    sd.addTestFile("2025/07261200.csv", content);
+    mqttClient.resetPublishCount();
+
+    bool result = RunRecoveryToCompletion(now);
+
+    // Sent in bounded parts instead of skipped, deleted once all parts are acknowledged
+    TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_TRUE(mqttClient.getPublishCount() > 1);
+    TEST_ASSERT_TRUE(mqttClient.getLastMessage().size() <= RECOVERY_DEFAULT_MESSAGE_BYTES);
+    TEST_ASSERT_TRUE(mqttClient.getLastMessage().find(",149]}}") != std::string::npos);
+    TEST_ASSERT_FALSE(sd.exists("2025/07261200.csv"));
+}
+
+void Test_SendPendingData_packs_small_batches_into_one_message(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseFakeClock(1);
+    UseAckingBroker();
+
+    // Setup: three batches of two readings each
+    for (int b = 0; b < 3; b++) {
+        char path[32];
+        char content[64];
+        uint32_t first = now.unixtime() - 3600 + 600 * b;
+        snprintf(path, sizeof(path), "2025/072614%d0.csv", b);
+        snprintf(content, sizeof(content), "%lu,21.0,%d\n%lu,21.5,%d\n",
+                 (unsigned long)first, 2 * b + 1, (unsigned long)first + 60, 2 * b + 2);
+        sd.addTestFile(path, content);
+    }
+    mqttClient.resetPublishCount();
+
+    TEST_ASSERT_TRUE(RunRecoveryToCompletion(now));
+
+    // One round trip for all of them, every batch deleted after the ack
+    TEST_ASSERT_EQUAL(1, mqttClient.getPublishCount());
+    TEST_ASSERT_TRUE(mqttClient.getLastMessage().find("\"s\":[1,2,3,4,5,6]") != std::string::npos);
+    TEST_ASSERT_FALSE(sd.exists("2025/07261400.csv"));
+    TEST_ASSERT_FALSE(sd.exists("2025/07261410.csv"));
+    TEST_ASSERT_FALSE(sd.exists("2025/07261420.csv"));
+    TEST_ASSERT_EQUAL(BatchManifestCount(), BatchManifestFirstPending());
+}
+
+void Test_SendPendingData_deletes_only_fully_covered_batches(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    UseAckingBroker();
+    mqttClient.setAckDelay(500);
+    PublishWindowSetSize(1);
+    SetRecoveryMessageLimit(384);
+
+    // Setup: two batches of ten readings, the limit fits about one and a half
+    for (int b = 0; b < 2; b++) {
+        std::string content;
+        for (int i = 0; i < 10; i++) {
+            char line[40];
+            snprintf(line, sizeof(line), "%lu,21.25,%d\n",
+                     (unsigned long)now.unixtime() - 3600 + 600 * b + 60UL * i, 10 + 10 * b + i);
+            content += line;
+        }
+        sd.addTestFile(b == 0 ? "2025/07261400.csv" : "2025/07261410.csv", content);
+    }
+    mqttClient.resetPublishCount();
+
+    SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now);
+    delay(1000);
+    SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now);
+
+    // The first message covered the first batch and part of the second, which stays on the card
+    TEST_ASSERT_FALSE(sd.exists("2025/07261400.csv"));
+    TEST_ASSERT_TRUE(sd.exists("2025/07261410.csv"));
+
+    // The rest of the second batch follows without repeating what was acknowledged
+    for (int tick = 0; tick < 20; tick++) {
+        if (SendPendingDataToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", now)) break;
+        delay(1000);
+    }
+    TEST_ASSERT_FALSE(sd.exists("2025/07261410.csv"));
+    TEST_ASSERT_EQUAL(2, mqttClient.getPublishCount());
+    TEST_ASSERT_TRUE(mqttClient.getLastMessage().find(",29]}}") != std::string::npos);
+    TEST_ASSERT_TRUE(mqttClient.getLastMessage().find("\"s\":[20,") == std::string::npos);
+}
+
+void Test_SendPendingData_stack_high_water_mark(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseFakeClock(1);
+    UseAckingBroker();
+    for (int i = 0; i < 20; i++) SaveTempToOutageLog(now, 20.5, i);
+    sd.addTestFile("2025/07261400.csv", "1753541700,21.0,1\n1753541760,21.5,2\n");
+
+    // Deepest point below this frame that recovery reaches in the card and client mocks
+    volatile char reference = 0;
+    MockStackReset();
+    TEST_ASSERT_TRUE(RunRecoveryToCompletion(now));
+    size_t used = reinterpret_cast<uintptr_t>(&reference) - mockStackLowWater;
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "Recovery stack high-water mark: %lu bytes", (unsigned long)used);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(used < RECOVERY_STACK_BUDGET_BYTES);
+}
+
+// Test packet-ID acknowledgment
+void Test_PubackMode_confirms_without_echo_subscription(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    UseAckingBroker();
+
+    SaveTempToOutageLog(now, 21.0, 7);
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 25.5, now, 8));
+    TEST_ASSERT_TRUE(RunRecoveryToCompletion(now));
+
+    // Both messages settled by PUBACK, nothing is sent back down
+    TEST_ASSERT_FALSE(mqttClient.isSubscribed("dhbw/ai/si2023/2/temp/Sensor_One"));
+    TEST_ASSERT_FALSE(mqttClient.isSubscribed("dhbw/ai/si2023/2/temp/Sensor_One/recovered"));
+    TEST_ASSERT_EQUAL(0, PublishWindowCount(PUBLISH_LIVE));
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+}
+
+void Test_EchoMode_subscribes_and_ignores_pubacks(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    UseSimulatedClock();
+    SetMqttAckMode(MQTT_ACK_ECHO);
+    mqttClient.setPubackEnabled(true);
+
+    // A broker that acks but does not echo leaves the reading unconfirmed
+    TEST_ASSERT_TRUE(SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 25.5, now, 9));
+    TEST_ASSERT_TRUE(mqttClient.isSubscribed("dhbw/ai/si2023/2/temp/Sensor_One"));
+    delay(6000);
+    ServicePublishWindow(mqttClient, now);
+    TEST_ASSERT_EQUAL(1, StagingRingCount());
+}
+
 // Test edge cases and error conditions
 void Test_SendTempToMqtt_null_parameters(void) {
     DateTime now(2025, 7, 26, 14, 55, 0);
@@ -217,12 +847,16 @@ void Test_CreateFullTopic_null_parameters(void) {
 void Test_SendTempToMqtt_extreme_values(void) {
     DateTime now(2025, 7, 26, 14, 55, 0);
     
-    // Test with extreme temperature values
-    SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 999.99, now, 999999);
+    // Test with the limits of the sensor; readings travel at its resolution
+    SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", 150.0, now, 999999);
     
     std::string lastMessage = mqttClient.getLastMessage();
     TEST_ASSERT_TRUE(lastMessage.find("\"sequence\":999999") != std::string::npos);
-    TEST_ASSERT_TRUE(lastMessage.find("999.99") != std::string::npos);
+    TEST_ASSERT_TRUE(lastMessage.find("\"value\":[150]") != std::string::npos);
+
+    SendTempToMqtt(mqttClient, "dhbw/ai/si2023/2/", "temp", "Sensor_One", -55.0078125, now, 1);
+    lastMessage = mqttClient.getLastMessage();
+    TEST_ASSERT_TRUE(lastMessage.find("\"value\":[-55.0078125]") != std::string::npos);
 }
 
 void Test_SendTempToMqtt_zero_sequence(void) {
@@ -250,6 +884,31 @@ void Run_mqtt_tests() {
     RUN_TEST(Test_SendPendingData_processes_csv_files);
     RUN_TEST(Test_SendPendingData_creates_recovered_topic);
     RUN_TEST(Test_SendPendingData_handles_large_payloads);
+    RUN_TEST(Test_SendPendingData_drains_outage_log);
+    RUN_TEST(Test_SendPendingData_drains_staged_readings_from_ram);
+    RUN_TEST(Test_SendPendingData_keeps_staged_readings_in_flight_until_acked);
+    RUN_TEST(Test_SendPendingData_discards_stale_outage_records);
+    RUN_TEST(Test_SendPendingData_recovers_batches_across_year_folders);
+    RUN_TEST(Test_SendPendingData_tick_publishes_limited_messages);
+    RUN_TEST(Test_SendPendingData_tick_never_waits_for_acks);
+    RUN_TEST(Test_SendPendingData_tick_stops_when_budget_is_used_up);
+    RUN_TEST(Test_SendPendingData_keeps_unacknowledged_data_and_retries);
+    RUN_TEST(Test_SendTempToMqtt_returns_before_ack);
+    RUN_TEST(Test_ServicePublishWindow_spills_only_timed_out_readings);
+    RUN_TEST(Test_SendBurstToMqtt_publishes_one_message_and_drops_it_on_timeout);
+    RUN_TEST(Test_SendBurstToMqtt_echo_is_matched_by_timestamp);
+    RUN_TEST(Test_LiveBatching_sends_k_readings_in_one_message);
+    RUN_TEST(Test_LiveBatching_flushes_after_max_latency);
+    RUN_TEST(Test_LiveBatching_spills_whole_batch_without_ack);
+    RUN_TEST(Test_LiveBatching_stages_queue_when_disconnected);
+    RUN_TEST(Test_SendPendingData_retries_only_unacknowledged_batches);
+    RUN_TEST(Test_SendPendingData_throughput_scales_with_window);
+    RUN_TEST(Test_SendPendingData_splits_oversized_batch);
+    RUN_TEST(Test_SendPendingData_packs_small_batches_into_one_message);
+    RUN_TEST(Test_SendPendingData_deletes_only_fully_covered_batches);
+    RUN_TEST(Test_SendPendingData_stack_high_water_mark);
+    RUN_TEST(Test_PubackMode_confirms_without_echo_subscription);
+    RUN_TEST(Test_EchoMode_subscribes_and_ignores_pubacks);
     RUN_TEST(Test_SendTempToMqtt_null_parameters);
     RUN_TEST(Test_SendTempToMqtt_empty_strings);
     RUN_TEST(Test_CreateFullTopic_null_parameters);
@@ -0,0 +1,148 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include <vector>
+#include "mqtt_transport.h"
+
+using namespace fakeit;
+
+static std::vector<uint16_t> s_pubacks;
+static std::vector<uint8_t> s_packetTypes;
+
+static void RecordPuback(uint16_t packetId) {
+    s_pubacks.push_back(packetId);
+}
+
+static void RecordPacket(uint8_t packetType, uint8_t header, uint16_t packetId) {
+    (void)header;
+    (void)packetId;
+    s_packetTypes.push_back(packetType);
+}
+
+void setUp(void) {
+    ArduinoFakeReset();
+    MqttTransportReset();
+    MqttTransportSetPubackHandler(RecordPuback);
+    s_pubacks.clear();
+    s_packetTypes.clear();
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+    MqttTransportSetPubackHandler(nullptr);
+}
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+/// Encodes a PUBLISH packet the way ArduinoMqttClient writes it
+static std::vector<uint8_t> EncodePublish(const char* topic, uint16_t packetId, int qos, size_t payloadBytes) {
+    size_t topicLength = strlen(topic);
+    size_t remaining = 2 + topicLength + (qos > 0 ? 2 : 0) + payloadBytes;
+    std::vector<uint8_t> packet;
+    packet.push_back(0x30 | (uint8_t)(qos << 1));
+    do {
+        uint8_t digit = remaining % 128;
+        remaining /= 128;
+        packet.push_back(remaining > 0 ? (digit | 0x80) : digit);
+    } while (remaining > 0);
+    packet.push_back((uint8_t)(topicLength >> 8));
+    packet.push_back((uint8_t)topicLength);
+    packet.insert(packet.end(), topic, topic + topicLength);
+    if (qos > 0) {
+        packet.push_back((uint8_t)(packetId >> 8));
+        packet.push_back((uint8_t)packetId);
+    }
+    packet.insert(packet.end(), payloadBytes, '7');
+    return packet;
+}
+
+static void ObserveInbound(std::initializer_list<uint8_t> bytes) {
+    std::vector<uint8_t> data(bytes);
+    MqttTransportObserveInbound(data.data(), data.size());
+}
+
+// =============================================================================
+// OUTBOUND PUBLISH IDENTIFIERS
+// =============================================================================
+
+void Test_Transport_reads_publish_packet_id(void) {
+    std::vector<uint8_t> packet = EncodePublish("dhbw/ai/si2023/2/temp/Sensor_One", 0x1234, 1, 60);
+    MqttTransportObserveOutbound(packet.data(), packet.size());
+    TEST_ASSERT_EQUAL(0x1234, MqttTransportLastPublishId());
+}
+
+void Test_Transport_handles_packets_split_at_every_byte(void) {
+    // A recovery payload needs a two-byte remaining length
+    std::vector<uint8_t> packet = EncodePublish("dhbw/ai/si2023/2/temp/Sensor_One/recovered", 513, 1, 1500);
+    for (size_t i = 0; i < packet.size(); i++) MqttTransportObserveOutbound(&packet[i], 1);
+    TEST_ASSERT_EQUAL(513, MqttTransportLastPublishId());
+}
+
+void Test_Transport_ignores_qos0_publish(void) {
+    std::vector<uint8_t> first = EncodePublish("a/b", 77, 1, 10);
+    std::vector<uint8_t> qos0 = EncodePublish("a/b", 0, 0, 10);
+    MqttTransportObserveOutbound(first.data(), first.size());
+    MqttTransportObserveOutbound(qos0.data(), qos0.size());
+    TEST_ASSERT_EQUAL(77, MqttTransportLastPublishId());
+}
+
+// =============================================================================
+// INBOUND PUBACKS
+// =============================================================================
+
+void Test_Transport_reports_pubacks_between_other_packets(void) {
+    std::vector<uint8_t> echo = EncodePublish("a/b", 9, 1, 40);
+    MqttTransportObserveInbound(echo.data(), echo.size());
+    ObserveInbound({0x40, 0x02, 0x00, 0x05});  // PUBACK 5
+    ObserveInbound({0xD0, 0x00});              // PINGRESP
+    ObserveInbound({0x90, 0x03, 0x00, 0x01, 0x01});  // SUBACK 1
+    ObserveInbound({0x40, 0x02, 0x01, 0x00});  // PUBACK 256
+
+    TEST_ASSERT_EQUAL(2, s_pubacks.size());
+    TEST_ASSERT_EQUAL(5, s_pubacks[0]);
+    TEST_ASSERT_EQUAL(256, s_pubacks[1]);
+}
+
+void Test_Transport_scanner_reports_packet_boundaries(void) {
+    MqttPacketScanner scanner;
+    MqttScannerReset(scanner);
+    const uint8_t stream[] = {0x20, 0x02, 0x00, 0x00,   // CONNACK
+                              0xD0, 0x00,               // PINGRESP
+                              0x40, 0x02, 0x00, 0x07};  // PUBACK
+    MqttScannerFeed(scanner, stream, sizeof(stream), RecordPacket);
+
+    TEST_ASSERT_EQUAL(3, s_packetTypes.size());
+    TEST_ASSERT_EQUAL(2, s_packetTypes[0]);
+    TEST_ASSERT_EQUAL(13, s_packetTypes[1]);
+    TEST_ASSERT_EQUAL(MQTT_PACKET_PUBACK, s_packetTypes[2]);
+}
+
+void Test_Transport_reset_starts_at_packet_boundary(void) {
+    // A connection dropped in the middle of a packet
+    ObserveInbound({0x40, 0x02, 0x00});
+    MqttTransportReset();
+    ObserveInbound({0x40, 0x02, 0x00, 0x09});
+
+    TEST_ASSERT_EQUAL(1, s_pubacks.size());
+    TEST_ASSERT_EQUAL(9, s_pubacks[0]);
+}
+
+// Bundle for central test_main.cpp
+void Run_mqtt_transport_tests() {
+    RUN_TEST(Test_Transport_reads_publish_packet_id);
+    RUN_TEST(Test_Transport_handles_packets_split_at_every_byte);
+    RUN_TEST(Test_Transport_ignores_qos0_publish);
+    RUN_TEST(Test_Transport_reports_pubacks_between_other_packets);
+    RUN_TEST(Test_Transport_scanner_reports_packet_boundaries);
+    RUN_TEST(Test_Transport_reset_starts_at_packet_boundary);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_mqtt_transport_tests();
+    return UNITY_END();
+}
+#endif
@@ -9,12 +9,32 @@ void setUp(void) {
     When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char[]))).AlwaysReturn(1);
     When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char[]))).AlwaysReturn(1);
     When(Method(ArduinoFake(), delay)).Return();
+    WiFi.resetTestState();
+    mqttClient.stop();
+    mqttClient.setRefuseConnect(false);
+    mqttClient.resetConnectCalls();
+    ConnectionSetStateHandler(nullptr);
 }
 
 void tearDown(void) {
     ArduinoFakeReset();
 }
 
+static ConnectionState s_transitions[16];
+static int s_transitionCount = 0;
+
+static void RecordTransition(ConnectionState from, ConnectionState to) {
+    if (s_transitionCount < 16) s_transitions[s_transitionCount++] = to;
+}
+
+/// Starts the manager at millis() 0 with a handler that records every new state
+static void BeginRecording() {
+    s_transitionCount = 0;
+    When(Method(ArduinoFake(), millis)).AlwaysReturn(0);
+    ConnectionSetStateHandler(RecordTransition);
+    ConnectionBegin(mqttClient);
+}
+
 void Test_ConnectToWiFi_success(void) {
     // Set up WiFi mock to succeed
     WiFi.begin("test", "test"); // Initialize mock WiFi
@@ -103,6 +123,116 @@ void Test_IsConnectedToServer_both_disconnected(void) {
     TEST_ASSERT_FALSE(result);
 }
 
+// Test the non-blocking connection manager
+void Test_Connection_walks_through_states_to_connected(void) {
+    BeginRecording();
+    TEST_ASSERT_EQUAL(CONNECTION_IDLE, ConnectionGetState());
+
+    ConnectionTick(0);
+    ConnectionTick(100);
+    ConnectionTick(200);
+
+    TEST_ASSERT_EQUAL(CONNECTION_CONNECTED, ConnectionGetState());
+    TEST_ASSERT_EQUAL(3, s_transitionCount);
+    TEST_ASSERT_EQUAL(CONNECTION_ASSOCIATING, s_transitions[0]);
+    TEST_ASSERT_EQUAL(CONNECTION_CONNECTING_BROKER, s_transitions[1]);
+    TEST_ASSERT_EQUAL(CONNECTION_CONNECTED, s_transitions[2]);
+    TEST_ASSERT_TRUE(IsConnectedToServer(mqttClient));
+}
+
+void Test_Connection_association_is_polled_not_awaited(void) {
+    WiFi.setBeginStatus(WL_IDLE_STATUS);
+    BeginRecording();
+
+    // Every tick returns at once while the access point is out of reach
+    for (unsigned long t = 0; t < 10000; t += 100) ConnectionTick(t);
+    TEST_ASSERT_EQUAL(CONNECTION_ASSOCIATING, ConnectionGetState());
+    TEST_ASSERT_EQUAL(1, WiFi.getBeginCalls());
+
+    WiFi.setStatus(WL_CONNECTED);
+    ConnectionTick(10100);
+    ConnectionTick(10200);
+    TEST_ASSERT_EQUAL(CONNECTION_CONNECTED, ConnectionGetState());
+}
+
+void Test_Connection_backs_off_after_association_timeout(void) {
+    WiFi.setBeginStatus(WL_IDLE_STATUS);
+    BeginRecording();
+
+    ConnectionTick(0);
+    ConnectionTick(WIFI_ASSOCIATE_TIMEOUT_MS);
+    TEST_ASSERT_EQUAL(CONNECTION_BACKOFF, ConnectionGetState());
+
+    // The next attempt starts only after the retry delay
+    ConnectionTick(WIFI_ASSOCIATE_TIMEOUT_MS + CONNECTION_RETRY_DELAY_MS - 1);
+    TEST_ASSERT_EQUAL(CONNECTION_BACKOFF, ConnectionGetState());
+    ConnectionTick(WIFI_ASSOCIATE_TIMEOUT_MS + CONNECTION_RETRY_DELAY_MS);
+    TEST_ASSERT_EQUAL(CONNECTION_IDLE, ConnectionGetState());
+    ConnectionTick(WIFI_ASSOCIATE_TIMEOUT_MS + CONNECTION_RETRY_DELAY_MS + 100);
+    TEST_ASSERT_EQUAL(2, WiFi.getBeginCalls());
+}
+
+void Test_Connection_broker_outage_tries_once_per_retry_delay(void) {
+    mqttClient.setRefuseConnect(true);
+    BeginRecording();
+
+    // One minute of ticks every 100 ms while the broker refuses
+    for (unsigned long t = 0; t < 60000; t += 100) ConnectionTick(t);
+
+    TEST_ASSERT_TRUE(mqttClient.getConnectCalls() <= (int)(60000 / CONNECTION_RETRY_DELAY_MS) + 1);
+    TEST_ASSERT_TRUE(mqttClient.getConnectCalls() >= 10);
+    TEST_ASSERT_FALSE(ConnectionGetState() == CONNECTION_CONNECTED);
+
+    mqttClient.setRefuseConnect(false);
+    for (unsigned long t = 60000; t < 60000 + 2 * CONNECTION_RETRY_DELAY_MS; t += 100) ConnectionTick(t);
+    TEST_ASSERT_EQUAL(CONNECTION_CONNECTED, ConnectionGetState());
+}
+
+void Test_Connection_reports_lost_link(void) {
+    BeginRecording();
+    for (unsigned long t = 0; t < 300; t += 100) ConnectionTick(t);
+    TEST_ASSERT_EQUAL(CONNECTION_CONNECTED, ConnectionGetState());
+
+    WiFi.disconnect();
+    ConnectionTick(300);
+
+    TEST_ASSERT_EQUAL(CONNECTION_BACKOFF, ConnectionGetState());
+    TEST_ASSERT_EQUAL(CONNECTION_BACKOFF, s_transitions[s_transitionCount - 1]);
+    TEST_ASSERT_FALSE(mqttClient.connected());
+}
+
+void Test_Connection_waits_as_long_as_the_policy_draws(void) {
+    ReconnectPolicy policy;
+    policy.Seed("IsoPruefi_Sensor_One");
+    mqttClient.setRefuseConnect(true);
+    When(Method(ArduinoFake(), millis)).AlwaysReturn(0);
+    ConnectionBegin(mqttClient, &policy);
+
+    ConnectionTick(0);
+    ConnectionTick(10);
+    ConnectionTick(20);
+    TEST_ASSERT_EQUAL(CONNECTION_BACKOFF, ConnectionGetState());
+    TEST_ASSERT_EQUAL(1, policy.ConsecutiveFailures());
+    TEST_ASSERT_EQUAL(policy.LastDelayMs(), ConnectionRetryDelayMs());
+    TEST_ASSERT_TRUE(ConnectionRetryDelayMs() <= RECONNECT_FIRST_RETRY_MS);
+
+    // Still waiting one millisecond before the drawn delay ends
+    if (ConnectionRetryDelayMs() > 0) {
+        ConnectionTick(20 + ConnectionRetryDelayMs() - 1);
+        TEST_ASSERT_EQUAL(CONNECTION_BACKOFF, ConnectionGetState());
+    }
+    ConnectionTick(20 + ConnectionRetryDelayMs());
+    TEST_ASSERT_EQUAL(CONNECTION_IDLE, ConnectionGetState());
+
+    // A session that comes up resets the sequence to the fast first retry
+    mqttClient.setRefuseConnect(false);
+    ConnectionTick(5000);
+    ConnectionTick(5010);
+    TEST_ASSERT_EQUAL(CONNECTION_CONNECTED, ConnectionGetState());
+    TEST_ASSERT_EQUAL(0, policy.ConsecutiveFailures());
+    TEST_ASSERT_EQUAL(1, policy.Successes());
+}
+
 // Bundle for central test_main.cpp
 void Run_network_tests() {
     RUN_TEST(Test_ConnectToWiFi_success);
@@ -111,6 +241,12 @@ void Run_network_tests() {
     RUN_TEST(Test_IsConnectedToServer_wifi_disconnected);
     RUN_TEST(Test_IsConnectedToServer_mqtt_disconnected);
     RUN_TEST(Test_IsConnectedToServer_both_disconnected);
+    RUN_TEST(Test_Connection_walks_through_states_to_connected);
+    RUN_TEST(Test_Connection_association_is_polled_not_awaited);
+    RUN_TEST(Test_Connection_backs_off_after_association_timeout);
+    RUN_TEST(Test_Connection_broker_outage_tries_once_per_retry_delay);
+    RUN_TEST(Test_Connection_reports_lost_link);
+    RUN_TEST(Test_Connection_waits_as_long_as_the_policy_draws);
 }
 
 // When standalone executable
@@ -0,0 +1,252 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "outage_log.h"
+
+using namespace fakeit;
+
+void setUp(void) {
+    ArduinoFakeReset();
+    OutageLogEnd();
+    sd.clearTestFiles();
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char[]))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char[]))).AlwaysReturn(1);
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+static OutageRecord MakeRecord(uint32_t sequence) {
+    OutageRecord record = {1753541700 + sequence * 60, sequence, (int16_t)(2000 + sequence), 0};
+    return record;
+}
+
+static void AppendRecords(uint32_t first, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE(OutageLogAppend(MakeRecord(first + i)));
+    }
+}
+
+// Test basic append/peek/consume cursors
+void Test_OutageLog_starts_empty(void) {
+    TEST_ASSERT_TRUE(OutageLogBegin());
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(0, OutageLogPeek(&record, 1));
+}
+
+void Test_OutageLog_peek_returns_records_in_order(void) {
+    AppendRecords(0, 3);
+
+    OutageRecord records[5];
+    TEST_ASSERT_EQUAL(3, OutageLogPeek(records, 5));
+    for (uint32_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(i, records[i].sequence);
+        TEST_ASSERT_EQUAL(1753541700 + i * 60, records[i].timestamp);
+        TEST_ASSERT_EQUAL(2000 + i, records[i].rawTemp);
+    }
+
+    // Peeking does not consume
+    TEST_ASSERT_EQUAL(3, OutageLogPendingCount());
+}
+
+void Test_OutageLog_keeps_aggregates_across_remount(void) {
+    OutageRecord aggregate = {1753541700, 9, 3250, 0, -128, 6528, 12, 3264};
+    TEST_ASSERT_TRUE(OutageLogAppend(aggregate));
+    TEST_ASSERT_TRUE(OutageLogFlush());
+    OutageLogEnd();
+    TEST_ASSERT_TRUE(OutageLogBegin());
+
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(1, OutageLogPeek(&record, 1));
+    TEST_ASSERT_EQUAL(3250, record.rawTemp);
+    TEST_ASSERT_EQUAL(-128, record.rawMin);
+    TEST_ASSERT_EQUAL(6528, record.rawMax);
+    TEST_ASSERT_EQUAL(12, record.count);
+    TEST_ASSERT_EQUAL(3264, record.rawLast);
+}
+
+void Test_OutageLog_consume_advances_cursor(void) {
+    AppendRecords(0, 4);
+
+    OutageLogConsume(3);
+
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(1, OutageLogPendingCount());
+    TEST_ASSERT_EQUAL(1, OutageLogPeek(&record, 1));
+    TEST_ASSERT_EQUAL(3, record.sequence);
+}
+
+void Test_OutageLog_peek_skips_records_in_flight(void) {
+    AppendRecords(0, OUTAGE_LOG_RECORDS_PER_SEGMENT + 10);
+    OutageLogConsume(5);
+
+    // The offset counts from the cursor and crosses segment boundaries
+    OutageRecord records[3];
+    TEST_ASSERT_EQUAL(3, OutageLogPeek(records, 3, 10));
+    TEST_ASSERT_EQUAL(15, records[0].sequence);
+    TEST_ASSERT_EQUAL(3, OutageLogPeek(records, 3, OUTAGE_LOG_RECORDS_PER_SEGMENT));
+    TEST_ASSERT_EQUAL(OUTAGE_LOG_RECORDS_PER_SEGMENT + 5, records[0].sequence);
+
+    // Skipping past the end finds nothing
+    TEST_ASSERT_EQUAL(0, OutageLogPeek(records, 3, OUTAGE_LOG_RECORDS_PER_SEGMENT + 5));
+    TEST_ASSERT_EQUAL(OUTAGE_LOG_RECORDS_PER_SEGMENT + 5, OutageLogPendingCount());
+}
+
+void Test_OutageLog_negative_temperatures_roundtrip(void) {
+    OutageRecord record = {1753541700, 1, -7040, 0};
+    OutageLogAppend(record);
+
+    OutageRecord read;
+    TEST_ASSERT_EQUAL(1, OutageLogPeek(&read, 1));
+    TEST_ASSERT_EQUAL(-7040, read.rawTemp);
+}
+
+// Test persistence across remounts (power loss)
+void Test_OutageLog_remount_restores_head_and_cursor(void) {
+    AppendRecords(0, 5);
+    OutageLogConsume(2);
+
+    OutageLogEnd();
+    TEST_ASSERT_TRUE(OutageLogBegin());
+
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(3, OutageLogPendingCount());
+    TEST_ASSERT_EQUAL(1, OutageLogPeek(&record, 1));
+    TEST_ASSERT_EQUAL(2, record.sequence);
+
+    // Appends continue behind the restored head
+    AppendRecords(5, 1);
+    TEST_ASSERT_EQUAL(4, OutageLogPendingCount());
+}
+
+void Test_OutageLog_torn_record_ends_log(void) {
+    AppendRecords(0, 3);
+    OutageLogEnd();
+
+    // Corrupt the last record as if power failed mid-write
+    std::string segment = sd.getTestFileContent("LOG/SEG0.BIN");
+    segment[3 * OUTAGE_LOG_RECORD_BYTES + 2] ^= 0x55;
+    sd.addTestFile("LOG/SEG0.BIN", segment);
+
+    TEST_ASSERT_TRUE(OutageLogBegin());
+    TEST_ASSERT_EQUAL(2, OutageLogPendingCount());
+}
+
+void Test_OutageLog_remount_mid_sector_keeps_flushed_records(void) {
+    AppendRecords(0, 40);
+    OutageLogEnd();
+
+    // Continue inside the partially written second sector
+    TEST_ASSERT_TRUE(OutageLogBegin());
+    AppendRecords(40, 30);
+    OutageLogEnd();
+
+    TEST_ASSERT_TRUE(OutageLogBegin());
+    TEST_ASSERT_EQUAL(70, OutageLogPendingCount());
+    OutageRecord records[70];
+    TEST_ASSERT_EQUAL(70, OutageLogPeek(records, 70));
+    for (uint32_t i = 0; i < 70; i++) {
+        TEST_ASSERT_EQUAL(i, records[i].sequence);
+    }
+}
+
+// Test the write-behind sector buffer
+void Test_OutageLog_buffered_records_are_peeked_from_ram(void) {
+    TEST_ASSERT_TRUE(OutageLogBegin());
+    sd.resetStats();
+    // The header and a sector's worth of records minus one fill the first sector
+    const uint32_t appended = OUTAGE_LOG_RECORDS_PER_SECTOR - 1 + 4;
+    AppendRecords(0, appended);
+
+    OutageRecord records[OUTAGE_LOG_RECORDS_PER_SECTOR + 3];
+    TEST_ASSERT_EQUAL(appended, OutageLogPeek(records, appended));
+    TEST_ASSERT_EQUAL(0, records[0].sequence);
+    TEST_ASSERT_EQUAL(appended - 1, records[appended - 1].sequence);
+    // Only the full first sector reached the card
+    TEST_ASSERT_EQUAL(1, sd.getStats().writes);
+    TEST_ASSERT_EQUAL(4 * OUTAGE_LOG_RECORD_BYTES, OutageLogBufferedBytes());
+}
+
+void Test_OutageLog_tick_flushes_after_max_age(void) {
+    AppendRecords(0, 2);
+    sd.resetStats();
+
+    OutageLogTick(1000, 5000);
+    OutageLogTick(5999, 5000);
+    TEST_ASSERT_EQUAL(0, sd.getStats().writes);
+
+    OutageLogTick(6000, 5000);
+    TEST_ASSERT_EQUAL(1, sd.getStats().writes);
+    TEST_ASSERT_EQUAL(0, OutageLogBufferedBytes());
+
+    // Nothing buffered: ticks stay off the card
+    OutageLogTick(20000, 5000);
+    TEST_ASSERT_EQUAL(1, sd.getStats().writes);
+}
+
+// Test segment rotation and bounded directory growth
+void Test_OutageLog_segments_are_preallocated(void) {
+    AppendRecords(0, 1);
+    TEST_ASSERT_EQUAL(OUTAGE_LOG_SEGMENT_BYTES, sd.getTestFileContent("LOG/SEG0.BIN").size());
+}
+
+void Test_OutageLog_rotates_into_next_segment(void) {
+    AppendRecords(0, OUTAGE_LOG_RECORDS_PER_SEGMENT + 10);
+
+    TEST_ASSERT_TRUE(sd.exists("LOG/SEG1.BIN"));
+    TEST_ASSERT_FALSE(sd.exists("LOG/SEG2.BIN"));
+    TEST_ASSERT_EQUAL(OUTAGE_LOG_RECORDS_PER_SEGMENT + 10, OutageLogPendingCount());
+
+    // Peek across the segment boundary stays in order
+    OutageLogConsume(OUTAGE_LOG_RECORDS_PER_SEGMENT - 2);
+    OutageRecord records[4];
+    TEST_ASSERT_EQUAL(4, OutageLogPeek(records, 4));
+    TEST_ASSERT_EQUAL(OUTAGE_LOG_RECORDS_PER_SEGMENT - 2, records[0].sequence);
+    TEST_ASSERT_EQUAL(OUTAGE_LOG_RECORDS_PER_SEGMENT + 1, records[3].sequence);
+}
+
+void Test_OutageLog_full_ring_drops_oldest_segment(void) {
+    const uint32_t capacity = OUTAGE_LOG_SEGMENT_COUNT * OUTAGE_LOG_RECORDS_PER_SEGMENT;
+    AppendRecords(0, capacity + 5);
+
+    TEST_ASSERT_EQUAL(OUTAGE_LOG_RECORDS_PER_SEGMENT, OutageLogDroppedCount());
+    TEST_ASSERT_EQUAL(capacity - OUTAGE_LOG_RECORDS_PER_SEGMENT + 5, OutageLogPendingCount());
+
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(1, OutageLogPeek(&record, 1));
+    TEST_ASSERT_EQUAL(OUTAGE_LOG_RECORDS_PER_SEGMENT, record.sequence);
+
+    // Stale records of the reused segment must not validate after a remount
+    OutageLogEnd();
+    TEST_ASSERT_TRUE(OutageLogBegin());
+    TEST_ASSERT_EQUAL(capacity - OUTAGE_LOG_RECORDS_PER_SEGMENT + 5, OutageLogPendingCount());
+}
+
+// Bundle for central test_main.cpp
+void Run_outage_log_tests() {
+    RUN_TEST(Test_OutageLog_starts_empty);
+    RUN_TEST(Test_OutageLog_peek_returns_records_in_order);
+    RUN_TEST(Test_OutageLog_keeps_aggregates_across_remount);
+    RUN_TEST(Test_OutageLog_consume_advances_cursor);
+    RUN_TEST(Test_OutageLog_peek_skips_records_in_flight);
+    RUN_TEST(Test_OutageLog_negative_temperatures_roundtrip);
+    RUN_TEST(Test_OutageLog_remount_restores_head_and_cursor);
+    RUN_TEST(Test_OutageLog_torn_record_ends_log);
+    RUN_TEST(Test_OutageLog_remount_mid_sector_keeps_flushed_records);
+    RUN_TEST(Test_OutageLog_buffered_records_are_peeked_from_ram);
+    RUN_TEST(Test_OutageLog_tick_flushes_after_max_age);
+    RUN_TEST(Test_OutageLog_segments_are_preallocated);
+    RUN_TEST(Test_OutageLog_rotates_into_next_segment);
+    RUN_TEST(Test_OutageLog_full_ring_drops_oldest_segment);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_outage_log_tests();
+    return UNITY_END();
+}
+#endif
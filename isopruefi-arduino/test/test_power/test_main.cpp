@@ -0,0 +1,232 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "power.h"
+#include "time_service.h"
+#include "core.h"
+#include "staging_ring.h"
+
+using namespace fakeit;
+
+static const uint32_t T0 = 1753541700;   // 2025-07-26 14:55:00
+/// MCU pin the tests wire to the DS3231 INT/SQW output
+static const int WAKE_PIN = 6;
+
+// The MCU clock stops in standby, the RTC keeps going
+static unsigned long s_fakeMillis = 0;
+static unsigned long s_realMs = 0;
+static bool s_lowPowerWhileAsleep = false;
+/// Time the firmware spent in delay()
+static unsigned long s_delayedMs = 0;
+
+static void Advance(unsigned long ms) {
+    s_fakeMillis += ms;
+    s_realMs += ms;
+    rtc.setNow(DateTime(T0 + s_realMs / 1000));
+}
+
+/// Standby until the alarm: only the RTC moves on
+static void SleepUntilAlarm() {
+    s_lowPowerWhileAsleep = WiFi.isLowPowerMode();
+    s_realMs = (rtc.getAlarm1() - T0) * 1000UL;
+    rtc.setNow(DateTime(rtc.getAlarm1()));
+}
+
+/// Standby ended by something else than the alarm, three seconds in
+static void WakeEarly() {
+    s_realMs += 3000;
+    rtc.setNow(DateTime(T0 + s_realMs / 1000));
+}
+
+void setUp(void) {
+    ArduinoFakeReset();
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char[]))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char[]))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const String&))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const String&))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(unsigned long, int))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(int, int))).AlwaysReturn(1);
+    When(Method(ArduinoFake(), millis)).AlwaysDo([]() -> unsigned long { return s_fakeMillis; });
+    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long ms) { s_delayedMs += ms; Advance(ms); });
+    When(Method(ArduinoFake(), pinMode)).AlwaysReturn();
+
+    s_fakeMillis = 0;
+    s_realMs = 0;
+    s_lowPowerWhileAsleep = false;
+    s_delayedMs = 0;
+    rtc.resetTestState();
+    rtc.setNow(DateTime(T0));
+    LowPower.resetTestState();
+    LowPower.setSleepHandler(SleepUntilAlarm);
+    WiFi.resetTestState();
+    TimeServiceReset();
+    PowerReset();
+    CoreSetRtcSqwPin(WAKE_PIN);
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+// Test a single sleep
+void Test_PowerBegin_turns_sqw_into_alarm_output(void) {
+    TEST_ASSERT_TRUE(PowerBegin(WAKE_PIN));
+    TEST_ASSERT_EQUAL(DS3231_OFF, rtc.getSqwPinMode());
+}
+
+void Test_PowerBegin_needs_a_wired_pin(void) {
+    TEST_ASSERT_FALSE(PowerBegin(-1));
+    TEST_ASSERT_EQUAL(DS3231_SquareWave1Hz, rtc.getSqwPinMode());
+}
+
+void Test_PowerSleepUntil_needs_enabling_and_a_distant_alarm(void) {
+    PowerBegin(WAKE_PIN);
+    TEST_ASSERT_FALSE(PowerSleepUntil(T0 + 10, 0, false));
+
+    PowerSetEnabled(true, 0);
+    TEST_ASSERT_FALSE(PowerSleepUntil(T0 + 1, 0, false));
+    TEST_ASSERT_EQUAL(0, LowPower.getSleepCalls());
+}
+
+void Test_PowerSleepUntil_wakes_at_the_alarm_second(void) {
+    PowerBegin(WAKE_PIN);
+    PowerSetEnabled(true, 0);
+    WiFi.setStatus(WL_CONNECTED);
+    TimeNow(0);
+    Advance(1250);
+
+    TEST_ASSERT_TRUE(PowerSleepUntil(T0 + 60, s_fakeMillis, false));
+
+    TEST_ASSERT_EQUAL(T0 + 60, rtc.getAlarm1());
+    TEST_ASSERT_TRUE(s_lowPowerWhileAsleep);
+    TEST_ASSERT_FALSE(WiFi.isLowPowerMode());
+    // The alarm marks the second, no RTC read needed
+    PreciseTime now = TimeNowPrecise(s_fakeMillis);
+    TEST_ASSERT_EQUAL(T0 + 60, now.unixtime);
+    TEST_ASSERT_EQUAL(0, now.millis);
+    TEST_ASSERT_EQUAL(1, rtc.getNowCalls());
+    TEST_ASSERT_FALSE(rtc.alarmFired(1));
+
+    const PowerStats& stats = PowerGetStats();
+    TEST_ASSERT_EQUAL(1, stats.sleeps);
+    TEST_ASSERT_EQUAL(1250, stats.awakeMs);
+    TEST_ASSERT_EQUAL(58750, stats.sleptMs);
+    TEST_ASSERT_EQUAL(20, PowerDutyCyclePermille());
+}
+
+void Test_PowerSleepUntil_early_wake_reads_the_rtc(void) {
+    PowerBegin(WAKE_PIN);
+    PowerSetEnabled(true, 0);
+    LowPower.setSleepHandler(WakeEarly);
+
+    TEST_ASSERT_TRUE(PowerSleepUntil(T0 + 60, 0, false));
+
+    TEST_ASSERT_EQUAL(T0 + 3, TimeNow(s_fakeMillis).unixtime());
+    TEST_ASSERT_EQUAL(2, rtc.getNowCalls());
+    TEST_ASSERT_EQUAL(3000, PowerGetStats().sleptMs);
+}
+
+void Test_PowerSleepUntil_counts_forced_sleeps(void) {
+    PowerBegin(WAKE_PIN);
+    PowerSetEnabled(true, 0);
+    Advance(POWER_AWAKE_WINDOW_MS);
+
+    TEST_ASSERT_TRUE(PowerWindowExpired(s_fakeMillis));
+    TEST_ASSERT_TRUE(PowerSleepUntil(T0 + 30, s_fakeMillis, true));
+    TEST_ASSERT_FALSE(PowerWindowExpired(s_fakeMillis));
+    TEST_ASSERT_EQUAL(1, PowerGetStats().windowOverruns);
+    TEST_ASSERT_EQUAL(POWER_AWAKE_WINDOW_MS, PowerGetStats().longestAwakeMs);
+}
+
+void Test_CoreSetLowPower_needs_a_wired_pin(void) {
+    CoreSetRtcSqwPin(-1);
+    TEST_ASSERT_FALSE(CoreSetLowPower(true));
+    TEST_ASSERT_FALSE(PowerEnabled());
+
+    CoreSetRtcSqwPin(WAKE_PIN);
+    TEST_ASSERT_TRUE(CoreSetLowPower(true));
+    TEST_ASSERT_TRUE(PowerEnabled());
+    TEST_ASSERT_TRUE(CoreSetLowPower(false));
+}
+
+// Test the duty cycle of the running firmware
+static void RunFor(unsigned long realMs) {
+    const unsigned long endMs = s_realMs + realMs;
+    while (s_realMs < endMs) {
+        Advance(10);
+        CoreLoop();
+    }
+}
+
+void Test_CoreLoop_simulated_hour_in_low_power_mode(void) {
+    mqttClient.stop();
+    mqttClient.setRefuseConnect(false);
+    mqttClient.setPubackEnabled(true);
+    CoreSetup();
+    TEST_ASSERT_TRUE(CoreSetLowPower(true));
+    RunFor(60000);
+    const int publishedBefore = mqttClient.getPublishCount();
+    const uint32_t sleepsBefore = PowerGetStats().sleeps;
+
+    RunFor(3600000UL);
+
+    const PowerStats& stats = PowerGetStats();
+    char message[128];
+    snprintf(message, sizeof(message), "Duty cycle: %u permille, awake %lu ms, asleep %lu ms, longest awake %lu ms",
+             PowerDutyCyclePermille(), stats.awakeMs, stats.sleptMs, stats.longestAwakeMs);
+    TEST_MESSAGE(message);
+    // One wake-up and one message per minute, each done well within the window
+    TEST_ASSERT_EQUAL(60, stats.sleeps - sleepsBefore);
+    TEST_ASSERT_EQUAL(60, mqttClient.getPublishCount() - publishedBefore);
+    TEST_ASSERT_EQUAL(0, stats.windowOverruns);
+    TEST_ASSERT_TRUE(stats.longestAwakeMs <= POWER_AWAKE_WINDOW_MS);
+    TEST_ASSERT_TRUE(PowerDutyCyclePermille() < 10);
+    TEST_ASSERT_TRUE(s_lowPowerWhileAsleep);
+
+    // Ten minutes without broker: readings are staged, one retry per wake-up
+    const uint32_t sleepsOnline = stats.sleeps;
+    mqttClient.stop();
+    mqttClient.setRefuseConnect(true);
+    RunFor(600000UL);
+    TEST_ASSERT_GREATER_OR_EQUAL(9, StagingRingCount());
+    TEST_ASSERT_EQUAL(10, stats.sleeps - sleepsOnline);
+
+    // Back online over a slow link: the backlog is recovered and the device sleeps again
+    const unsigned long ACK_DELAY_MS = 800;
+    mqttClient.setRefuseConnect(false);
+    mqttClient.setAckDelay(ACK_DELAY_MS);
+    const unsigned long awakeOffline = stats.awakeMs;
+    s_delayedMs = 0;
+    RunFor(120000UL);
+    TEST_ASSERT_TRUE(mqttClient.connected());
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+
+    snprintf(message, sizeof(message), "Recovery with %lu ms acks: awake %lu ms in two minutes, longest awake %lu ms",
+             ACK_DELAY_MS, stats.awakeMs - awakeOffline, stats.longestAwakeMs);
+    TEST_MESSAGE(message);
+    // Waiting for the acks costs one round trip and a few task periods, never a delay()
+    TEST_ASSERT_EQUAL(0, s_delayedMs);
+    TEST_ASSERT_EQUAL(0, stats.windowOverruns);
+    TEST_ASSERT_TRUE(stats.longestAwakeMs <= ACK_DELAY_MS + 1000);
+    TEST_ASSERT_TRUE(stats.awakeMs - awakeOffline <= 2 * (ACK_DELAY_MS + 1000));
+}
+
+// Bundle for central test_main.cpp
+void Run_power_tests() {
+    RUN_TEST(Test_PowerBegin_turns_sqw_into_alarm_output);
+    RUN_TEST(Test_PowerBegin_needs_a_wired_pin);
+    RUN_TEST(Test_PowerSleepUntil_needs_enabling_and_a_distant_alarm);
+    RUN_TEST(Test_PowerSleepUntil_wakes_at_the_alarm_second);
+    RUN_TEST(Test_PowerSleepUntil_early_wake_reads_the_rtc);
+    RUN_TEST(Test_PowerSleepUntil_counts_forced_sleeps);
+    RUN_TEST(Test_CoreSetLowPower_needs_a_wired_pin);
+    RUN_TEST(Test_CoreLoop_simulated_hour_in_low_power_mode);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_power_tests();
+    return UNITY_END();
+}
+#endif
@@ -0,0 +1,132 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "publish_window.h"
+
+using namespace fakeit;
+
+void setUp(void) {
+    ArduinoFakeReset();
+    PublishWindowReset();
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+static PublishEntry* AddLogBatch(uint32_t firstTs, uint16_t records) {
+    PublishEntry* entry = PublishWindowAdd(PUBLISH_RECOVERY_LOG, firstTs, 0);
+    TEST_ASSERT_NOT_NULL(entry);
+    entry->records = records;
+    return entry;
+}
+
+// Test window limits
+void Test_PublishWindow_limits_recovery_to_window_size(void) {
+    PublishWindowSetSize(2);
+    AddLogBatch(100, 5);
+    AddLogBatch(400, 5);
+
+    TEST_ASSERT_FALSE(PublishWindowHasRoom(PUBLISH_RECOVERY_LOG));
+    TEST_ASSERT_NULL(PublishWindowAdd(PUBLISH_RECOVERY_CSV, 700, 0));
+
+    // Live readings still get a slot
+    TEST_ASSERT_NOT_NULL(PublishWindowAdd(PUBLISH_LIVE, 1, 0));
+    TEST_ASSERT_EQUAL(2, PublishWindowRecoveryCount());
+}
+
+void Test_PublishWindow_size_is_clamped(void) {
+    PublishWindowSetSize(0);
+    TEST_ASSERT_EQUAL(1, PublishWindowSize());
+    PublishWindowSetSize(200);
+    TEST_ASSERT_EQUAL(PUBLISH_WINDOW_MAX_SIZE, PublishWindowSize());
+}
+
+void Test_PublishWindow_full_capacity_rejects_live(void) {
+    PublishWindowSetSize(PUBLISH_WINDOW_MAX_SIZE);
+    for (uint8_t i = 0; i < PUBLISH_WINDOW_MAX_SIZE; i++) AddLogBatch(i * 300, 5);
+    for (uint8_t i = 0; i < PUBLISH_WINDOW_LIVE_RESERVE; i++) {
+        TEST_ASSERT_NOT_NULL(PublishWindowAdd(PUBLISH_LIVE, i, 0));
+    }
+    TEST_ASSERT_NULL(PublishWindowAdd(PUBLISH_LIVE, 99, 0));
+}
+
+// Test ack matching and settling
+void Test_PublishWindow_ack_matches_topic_and_key(void) {
+    PublishWindowAdd(PUBLISH_LIVE, 42, 0);
+    AddLogBatch(42, 5);
+
+    TEST_ASSERT_FALSE(PublishWindowAck(false, 7));
+    TEST_ASSERT_TRUE(PublishWindowAck(true, 42));
+    TEST_ASSERT_NULL(PublishWindowNextSettled(PUBLISH_LIVE));
+    TEST_ASSERT_NOT_NULL(PublishWindowNextSettled(PUBLISH_RECOVERY_LOG));
+
+    // A second ack for the same key finds nothing left in flight
+    TEST_ASSERT_FALSE(PublishWindowAck(true, 42));
+}
+
+void Test_PublishWindow_log_batches_settle_in_order(void) {
+    PublishEntry* first = AddLogBatch(100, 5);
+    PublishEntry* second = AddLogBatch(400, 3);
+
+    // An ack for the newer batch waits until the older one is settled
+    PublishWindowAck(true, 400);
+    TEST_ASSERT_NULL(PublishWindowNextSettled(PUBLISH_RECOVERY_LOG));
+
+    PublishWindowAck(true, 100);
+    TEST_ASSERT_EQUAL_PTR(first, PublishWindowNextSettled(PUBLISH_RECOVERY_LOG));
+    PublishWindowRelease(first);
+    TEST_ASSERT_EQUAL_PTR(second, PublishWindowNextSettled(PUBLISH_RECOVERY_LOG));
+}
+
+void Test_PublishWindow_records_before_gives_log_offset(void) {
+    PublishEntry* first = AddLogBatch(100, 5);
+    PublishEntry* second = AddLogBatch(400, 3);
+    PublishWindowAdd(PUBLISH_RECOVERY_CSV, 900, 0);
+
+    TEST_ASSERT_EQUAL(0, PublishWindowRecordsBefore(first));
+    TEST_ASSERT_EQUAL(5, PublishWindowRecordsBefore(second));
+    TEST_ASSERT_EQUAL(8, PublishWindowRecordsBefore(nullptr));
+}
+
+void Test_PublishWindow_reports_only_expired_entries(void) {
+    PublishWindowAdd(PUBLISH_LIVE, 1, 1000);
+    PublishEntry* late = PublishWindowAdd(PUBLISH_LIVE, 2, 4000);
+
+    PublishEntry* expired = PublishWindowNextExpired(PUBLISH_LIVE, 6500, 5000);
+    TEST_ASSERT_NOT_NULL(expired);
+    TEST_ASSERT_EQUAL(1, expired->key);
+    PublishWindowRelease(expired);
+    TEST_ASSERT_NULL(PublishWindowNextExpired(PUBLISH_LIVE, 6500, 5000));
+    TEST_ASSERT_EQUAL_PTR(late, PublishWindowNextExpired(PUBLISH_LIVE, 9000, 5000));
+}
+
+void Test_PublishWindow_release_recovery_keeps_live(void) {
+    AddLogBatch(100, 5);
+    PublishWindowAdd(PUBLISH_RECOVERY_CSV, 900, 0);
+    PublishWindowAdd(PUBLISH_LIVE, 1, 0);
+
+    PublishWindowReleaseRecovery();
+    TEST_ASSERT_EQUAL(0, PublishWindowRecoveryCount());
+    TEST_ASSERT_EQUAL(1, PublishWindowCount(PUBLISH_LIVE));
+}
+
+// Bundle for central test_main.cpp
+void Run_publish_window_tests() {
+    RUN_TEST(Test_PublishWindow_limits_recovery_to_window_size);
+    RUN_TEST(Test_PublishWindow_size_is_clamped);
+    RUN_TEST(Test_PublishWindow_full_capacity_rejects_live);
+    RUN_TEST(Test_PublishWindow_ack_matches_topic_and_key);
+    RUN_TEST(Test_PublishWindow_log_batches_settle_in_order);
+    RUN_TEST(Test_PublishWindow_records_before_gives_log_offset);
+    RUN_TEST(Test_PublishWindow_reports_only_expired_entries);
+    RUN_TEST(Test_PublishWindow_release_recovery_keeps_live);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_publish_window_tests();
+    return UNITY_END();
+}
+#endif
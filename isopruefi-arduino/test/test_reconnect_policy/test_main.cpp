@@ -0,0 +1,170 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "reconnect_policy.h"
+
+using namespace fakeit;
+
+static const int FLEET_SIZE = 50;
+static const unsigned long SLOT_MS = 1000;
+
+void setUp(void) {
+    ArduinoFakeReset();
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+/// Seeds a policy with the client ID CoreSetup() would build for device n
+static void SeedAsDevice(ReconnectPolicy& policy, int n) {
+    char clientId[32];
+    snprintf(clientId, sizeof(clientId), "IsoPruefi_Sensor_%d", n);
+    policy.Seed(clientId);
+}
+
+// Test the backoff ceilings
+void Test_ReconnectPolicy_first_retry_takes_fast_path(void) {
+    ReconnectPolicy policy;
+    policy.Seed("IsoPruefi_Sensor_One");
+
+    TEST_ASSERT_EQUAL(RECONNECT_FIRST_RETRY_MS, policy.CeilingMs());
+    TEST_ASSERT_TRUE(policy.NextDelayMs() <= RECONNECT_FIRST_RETRY_MS);
+    TEST_ASSERT_EQUAL(RECONNECT_BASE_DELAY_MS, policy.CeilingMs());
+}
+
+void Test_ReconnectPolicy_ceiling_doubles_up_to_cap(void) {
+    ReconnectPolicy policy;
+    ReconnectPolicyConfig config = {100, 1000, 5000};
+    policy.Configure(config);
+
+    const unsigned long expected[] = {100, 1000, 2000, 4000, 5000, 5000};
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        TEST_ASSERT_EQUAL(expected[i], policy.CeilingMs());
+        TEST_ASSERT_TRUE(policy.NextDelayMs() <= expected[i]);
+    }
+
+    // Far beyond the cap the ceiling neither overflows nor grows
+    for (int i = 0; i < 100; i++) policy.NextDelayMs();
+    TEST_ASSERT_EQUAL(5000, policy.CeilingMs());
+}
+
+void Test_ReconnectPolicy_success_resets_sequence(void) {
+    ReconnectPolicy policy;
+    for (int i = 0; i < 4; i++) policy.NextDelayMs();
+    TEST_ASSERT_EQUAL(4, policy.ConsecutiveFailures());
+
+    policy.RecordSuccess();
+    TEST_ASSERT_EQUAL(0, policy.ConsecutiveFailures());
+    TEST_ASSERT_EQUAL(RECONNECT_FIRST_RETRY_MS, policy.CeilingMs());
+
+    policy.NextDelayMs();
+    TEST_ASSERT_EQUAL(5, policy.TotalFailures());
+    TEST_ASSERT_EQUAL(1, policy.Successes());
+}
+
+// Test the jitter
+void Test_ReconnectPolicy_same_seed_repeats_sequence(void) {
+    ReconnectPolicy a;
+    ReconnectPolicy b;
+    a.Seed("IsoPruefi_Sensor_One");
+    b.Seed("IsoPruefi_Sensor_One");
+
+    for (int i = 0; i < 20; i++) TEST_ASSERT_EQUAL(a.NextDelayMs(), b.NextDelayMs());
+}
+
+void Test_ReconnectPolicy_devices_draw_different_delays(void) {
+    ReconnectPolicy a;
+    ReconnectPolicy b;
+    a.Seed("IsoPruefi_Sensor_One");
+    b.Seed("IsoPruefi_Sensor_Two");
+
+    int equal = 0;
+    for (int i = 0; i < 20; i++) {
+        if (a.NextDelayMs() == b.NextDelayMs()) equal++;
+    }
+    TEST_ASSERT_TRUE(equal < 3);
+}
+
+void Test_ReconnectPolicy_spreads_fleet_after_broker_restart(void) {
+    // The broker is down for 10 minutes; every device lost its session at t = 0
+    // and retries until the broker is back. Count the attempts per second.
+    const unsigned long outageMs = 600000;
+    static int attemptsPerSlot[600];
+    memset(attemptsPerSlot, 0, sizeof(attemptsPerSlot));
+
+    int totalAttempts = 0;
+    for (int n = 0; n < FLEET_SIZE; n++) {
+        ReconnectPolicy policy;
+        SeedAsDevice(policy, n);
+
+        unsigned long t = policy.NextDelayMs();
+        while (t < outageMs) {
+            attemptsPerSlot[t / SLOT_MS]++;
+            totalAttempts++;
+            t += policy.NextDelayMs();
+        }
+    }
+
+    // The first retries bunch up in the first seconds by design; after that
+    // the attempts spread out and thin as the ceilings grow
+    int crowdedSlots = 0;
+    int busiestAfterTenSeconds = 0;
+    int busiestAfterFirstMinute = 0;
+    for (int slot = 0; slot < 600; slot++) {
+        if (attemptsPerSlot[slot] > FLEET_SIZE / 2) crowdedSlots++;
+        if (slot >= 10 && attemptsPerSlot[slot] > busiestAfterTenSeconds) {
+            busiestAfterTenSeconds = attemptsPerSlot[slot];
+        }
+        if (slot >= 60 && attemptsPerSlot[slot] > busiestAfterFirstMinute) {
+            busiestAfterFirstMinute = attemptsPerSlot[slot];
+        }
+    }
+
+    // A fixed 2 s interval puts all FLEET_SIZE devices into the same second 300 times
+    TEST_ASSERT_TRUE(totalAttempts < FLEET_SIZE * 40);
+    TEST_ASSERT_TRUE(crowdedSlots <= 3);
+    TEST_ASSERT_TRUE(busiestAfterTenSeconds <= FLEET_SIZE / 5);
+    TEST_ASSERT_TRUE(busiestAfterFirstMinute <= FLEET_SIZE / 10);
+}
+
+void Test_ReconnectPolicy_spreads_fleet_reconnect_after_recovery(void) {
+    // Time of each device's first attempt after a 5 minute outage ends
+    const unsigned long outageMs = 300000;
+    unsigned long firstAfter[FLEET_SIZE];
+    for (int n = 0; n < FLEET_SIZE; n++) {
+        ReconnectPolicy policy;
+        SeedAsDevice(policy, n);
+        unsigned long t = policy.NextDelayMs();
+        while (t < outageMs) t += policy.NextDelayMs();
+        firstAfter[n] = t - outageMs;
+    }
+
+    // Devices come back over a window instead of all in the same second
+    int sameSecond = 0;
+    for (int n = 1; n < FLEET_SIZE; n++) {
+        if (firstAfter[n] / SLOT_MS == firstAfter[0] / SLOT_MS) sameSecond++;
+    }
+    TEST_ASSERT_TRUE(sameSecond < FLEET_SIZE / 5);
+}
+
+// Bundle for central test_main.cpp
+void Run_reconnect_policy_tests() {
+    RUN_TEST(Test_ReconnectPolicy_first_retry_takes_fast_path);
+    RUN_TEST(Test_ReconnectPolicy_ceiling_doubles_up_to_cap);
+    RUN_TEST(Test_ReconnectPolicy_success_resets_sequence);
+    RUN_TEST(Test_ReconnectPolicy_same_seed_repeats_sequence);
+    RUN_TEST(Test_ReconnectPolicy_devices_draw_different_delays);
+    RUN_TEST(Test_ReconnectPolicy_spreads_fleet_after_broker_restart);
+    RUN_TEST(Test_ReconnectPolicy_spreads_fleet_reconnect_after_recovery);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_reconnect_policy_tests();
+    return UNITY_END();
+}
+#endif
@@ -0,0 +1,271 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "recovery_stream.h"
+#include "storage.h"
+
+using namespace fakeit;
+
+static const char* TOPIC = "dhbw/ai/si2023/2/temp/Sensor_One/recovered";
+
+void setUp(void) {
+    ArduinoFakeReset();
+    OutageLogEnd();
+    sd.clearTestFiles();
+    mqttClient.connect("broker");
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char[]))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char[]))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const String&))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const String&))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(unsigned long, int))).AlwaysReturn(1);
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+/// Measures and streams one message like the recovery does, returns the payload
+static std::string StreamMessage(RecoveryRecordSource& source, uint32_t timestamp,
+                                 size_t maxBytes, RecoveryMessageInfo& info) {
+    TEST_ASSERT_TRUE(RecoveryMeasure(source, timestamp, maxBytes, info));
+    mqttClient.beginMessage(TOPIC, (unsigned long)info.bytes, false, 1);
+    TEST_ASSERT_TRUE(RecoveryStreamMessage(mqttClient, source, timestamp, info));
+    // The mock rejects a message whose length differs from the announced one
+    TEST_ASSERT_EQUAL(1, mqttClient.endMessage());
+    return mqttClient.getLastMessage();
+}
+
+static std::string FormatFixed(int32_t value, uint16_t scale) {
+    char buffer[24];
+    FormatFixedPoint(buffer, value, scale);
+    return std::string(buffer);
+}
+
+// =============================================================================
+// PAYLOAD STRUCTURE
+// =============================================================================
+
+void Test_RecoveryStream_outage_records_structure(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    OutageLogAppend(OutageRecord{1721995200, 1, 3008, 0});
+    OutageLogAppend(OutageRecord{1721995260, 2, -704, 0});
+
+    OutageLogRecordSource source(0, 5);
+    RecoveryMessageInfo info;
+    std::string payload = StreamMessage(source, now.unixtime(), RECOVERY_MAX_MESSAGE_BYTES, info);
+
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, payload));
+    TEST_ASSERT_EQUAL(now.unixtime(), doc["timestamp"].as<unsigned long>());
+    TEST_ASSERT_TRUE(doc["sequence"].isNull());
+
+    JsonArray valueArr = doc["value"];
+    TEST_ASSERT_EQUAL(1, (int)valueArr.size());
+    TEST_ASSERT_TRUE(valueArr[0].isNull());
+
+    JsonObject meta = doc["meta"];
+    JsonArray t = meta["t"];
+    JsonArray v = meta["v"];
+    JsonArray s = meta["s"];
+    TEST_ASSERT_EQUAL(2, (int)t.size());
+    TEST_ASSERT_EQUAL(1721995260, t[1].as<unsigned long>());
+    TEST_ASSERT_EQUAL_FLOAT(23.5, v[0].as<float>());
+    TEST_ASSERT_EQUAL_FLOAT(-5.5, v[1].as<float>());
+    TEST_ASSERT_EQUAL(2, s[1].as<int>());
+    TEST_ASSERT_EQUAL(1721995200, info.firstTimestamp);
+    TEST_ASSERT_TRUE(info.complete);
+}
+
+void Test_RecoveryStream_matches_document_serialization(void) {
+    OutageLogAppend(OutageRecord{1721995200, 41, 3264, 0});
+    OutageLogAppend(OutageRecord{1721995260, 42, -64, 0});
+
+    OutageLogRecordSource source(0, 5);
+    RecoveryMessageInfo info;
+    std::string payload = StreamMessage(source, 1721995300, RECOVERY_MAX_MESSAGE_BYTES, info);
+
+    // Byte for byte what ArduinoJson produced for the same message
+    TEST_ASSERT_EQUAL_STRING("{\"timestamp\":1721995300,\"sequence\":null,\"value\":[null],"
+                             "\"meta\":{\"t\":[1721995200,1721995260],\"v\":[25.5,-0.5],\"s\":[41,42]}}",
+                             payload.c_str());
+    TEST_ASSERT_EQUAL(payload.size(), info.bytes);
+}
+
+void Test_RecoveryStream_aggregates_add_statistics_columns(void) {
+    OutageLogAppend(OutageRecord{1721995200, 41, 3264, 0});
+    OutageLogAppend(OutageRecord{1721995260, 42, 3250, 0, 3200, 3300, 6, 3232});
+
+    OutageLogRecordSource source(0, 5);
+    RecoveryMessageInfo info;
+    std::string payload = StreamMessage(source, 1721995300, RECOVERY_MAX_MESSAGE_BYTES, info);
+
+    // The single reading stands in the statistics with its own value and a count of 1
+    TEST_ASSERT_TRUE(info.aggregated);
+    TEST_ASSERT_EQUAL_STRING("{\"timestamp\":1721995300,\"sequence\":null,\"value\":[null],"
+                             "\"meta\":{\"t\":[1721995200,1721995260],\"v\":[25.5,25.390625],\"s\":[41,42],"
+                             "\"mn\":[25.5,25],\"mx\":[25.5,25.78125],\"n\":[1,6]}}",
+                             payload.c_str());
+    TEST_ASSERT_EQUAL(payload.size(), info.bytes);
+
+    AggregateSetReportLast(true);
+    payload = StreamMessage(source, 1721995300, RECOVERY_MAX_MESSAGE_BYTES, info);
+    AggregateSetReportLast(false);
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, payload));
+    TEST_ASSERT_EQUAL_FLOAT(25.25, doc["meta"]["l"][1].as<float>());
+}
+
+void Test_RecoveryStream_aggregate_that_does_not_fit_ends_message(void) {
+    // Plain readings fill the limit; the aggregate would need the statistics columns too
+    OutageLogAppend(OutageRecord{1721995200, 1, 3264, 0});
+    OutageLogAppend(OutageRecord{1721995260, 2, 3264, 0, 3200, 3300, 6, 3232});
+
+    OutageLogRecordSource plain(0, 1);
+    RecoveryMessageInfo one;
+    TEST_ASSERT_TRUE(RecoveryMeasure(plain, 1721995300, RECOVERY_MAX_MESSAGE_BYTES, one));
+
+    OutageLogRecordSource source(0, 5);
+    RecoveryMessageInfo info;
+    std::string payload = StreamMessage(source, 1721995300, one.bytes + 20, info);
+
+    TEST_ASSERT_EQUAL(1, info.records);
+    TEST_ASSERT_FALSE(info.aggregated);
+    TEST_ASSERT_EQUAL(1, info.end.offset);
+    TEST_ASSERT_EQUAL(payload.size(), info.bytes);
+}
+
+void Test_RecoveryStream_csv_batch_structure(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    const char* path = "2025/07261455.csv";
+    sd.addTestFile(path, "1721995200,23.5,1\n1721995260,24.0,2\n");
+
+    CsvBatchRecordSource source(path, 0, SIZE_MAX);
+    RecoveryMessageInfo info;
+    std::string payload = StreamMessage(source, now.unixtime(), RECOVERY_MAX_MESSAGE_BYTES, info);
+
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, payload));
+    TEST_ASSERT_EQUAL(now.unixtime(), doc["timestamp"].as<unsigned long>());
+    TEST_ASSERT_TRUE(doc["sequence"].isNull());
+    TEST_ASSERT_TRUE(doc["value"][0].isNull());
+
+    JsonObject meta = doc["meta"];
+    TEST_ASSERT_EQUAL(2, (int)meta["t"].size());
+    TEST_ASSERT_EQUAL(2, (int)meta["v"].size());
+    TEST_ASSERT_EQUAL(2, (int)meta["s"].size());
+}
+
+void Test_RecoveryStream_csv_batch_skips_malformed_lines(void) {
+    const char* path = "2025/07261456.csv";
+    sd.addTestFile(path, "1721995200,23.5,1\ngarbage\n1721995260,24.0\n\n1721995320,-1.25,3\r\n");
+
+    CsvBatchRecordSource source(path, 0, SIZE_MAX);
+    RecoveryMessageInfo info;
+    std::string payload = StreamMessage(source, 1721995400, RECOVERY_MAX_MESSAGE_BYTES, info);
+
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(deserializeJson(doc, payload));
+    JsonObject meta = doc["meta"];
+    JsonArray t = meta["t"];
+    JsonArray v = meta["v"];
+    JsonArray s = meta["s"];
+    TEST_ASSERT_EQUAL(2, (int)t.size());
+    TEST_ASSERT_EQUAL(1721995320, t[1].as<unsigned long>());
+    TEST_ASSERT_EQUAL_FLOAT(-1.25, v[1].as<float>());
+    TEST_ASSERT_EQUAL(3, s[1].as<int>());
+
+    // Counted once, although the encoder read the file four times
+    TEST_ASSERT_EQUAL(2, source.RejectedLines());
+}
+
+// =============================================================================
+// BOUNDED MESSAGES
+// =============================================================================
+
+void Test_RecoveryStream_splits_long_batch_into_bounded_messages(void) {
+    const char* path = "2025/07261457.csv";
+    std::string content;
+    for (int i = 0; i < 100; i++) {
+        char line[40];
+        snprintf(line, sizeof(line), "%lu,21.%d,%d\n", 1721995200UL + 60UL * i, i % 10, i);
+        content += line;
+    }
+    sd.addTestFile(path, content);
+
+    // Follow the batch message by message, each one starting where the last ended
+    uint32_t offset = 0;
+    int messages = 0;
+    int records = 0;
+    bool complete = false;
+    while (!complete && messages < 20) {
+        CsvBatchRecordSource source(path, offset, SIZE_MAX);
+        RecoveryMessageInfo info;
+        std::string payload = StreamMessage(source, 1722000000, 512, info);
+
+        TEST_ASSERT_TRUE(payload.size() <= 512);
+        JsonDocument doc;
+        TEST_ASSERT_FALSE(deserializeJson(doc, payload));
+        TEST_ASSERT_EQUAL(records, doc["meta"]["s"][0].as<int>());
+        TEST_ASSERT_EQUAL((int)info.records, (int)doc["meta"]["t"].size());
+
+        records += (int)info.records;
+        offset = info.end.offset;
+        complete = info.complete;
+        messages++;
+    }
+
+    TEST_ASSERT_TRUE(complete);
+    TEST_ASSERT_EQUAL(100, records);
+    TEST_ASSERT_TRUE(messages > 1);
+}
+
+void Test_RecoveryStream_limits_records_per_message(void) {
+    for (uint32_t i = 0; i < 7; i++) OutageLogAppend(OutageRecord{1721995200 + 60 * i, i, 2560, 0});
+
+    OutageLogRecordSource source(2, 3);
+    RecoveryMessageInfo info;
+    std::string payload = StreamMessage(source, 1722000000, RECOVERY_MAX_MESSAGE_BYTES, info);
+
+    TEST_ASSERT_EQUAL(3, info.records);
+    TEST_ASSERT_TRUE(payload.find("\"s\":[2,3,4]") != std::string::npos);
+}
+
+// =============================================================================
+// NUMBER FORMATTING
+// =============================================================================
+
+void Test_RecoveryStream_formats_fixed_point_exactly(void) {
+    TEST_ASSERT_EQUAL_STRING("25", FormatFixed(3200, 128).c_str());
+    TEST_ASSERT_EQUAL_STRING("25.5", FormatFixed(3264, 128).c_str());
+    TEST_ASSERT_EQUAL_STRING("0.0078125", FormatFixed(1, 128).c_str());
+    TEST_ASSERT_EQUAL_STRING("-0.0078125", FormatFixed(-1, 128).c_str());
+    TEST_ASSERT_EQUAL_STRING("-40", FormatFixed(-5120, 128).c_str());
+    TEST_ASSERT_EQUAL_STRING("25.123", FormatFixed(25123, 1000).c_str());
+    TEST_ASSERT_EQUAL_STRING("-0.05", FormatFixed(-50, 1000).c_str());
+    TEST_ASSERT_EQUAL_STRING("0", FormatFixed(0, 1000).c_str());
+}
+
+// Bundle for central test_main.cpp
+void Run_recovery_stream_tests() {
+    RUN_TEST(Test_RecoveryStream_outage_records_structure);
+    RUN_TEST(Test_RecoveryStream_matches_document_serialization);
+    RUN_TEST(Test_RecoveryStream_aggregates_add_statistics_columns);
+    RUN_TEST(Test_RecoveryStream_aggregate_that_does_not_fit_ends_message);
+    RUN_TEST(Test_RecoveryStream_csv_batch_structure);
+    RUN_TEST(Test_RecoveryStream_csv_batch_skips_malformed_lines);
+    RUN_TEST(Test_RecoveryStream_splits_long_batch_into_bounded_messages);
+    RUN_TEST(Test_RecoveryStream_limits_records_per_message);
+    RUN_TEST(Test_RecoveryStream_formats_fixed_point_exactly);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_recovery_stream_tests();
+    return UNITY_END();
+}
+#endif
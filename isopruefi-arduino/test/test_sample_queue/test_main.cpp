@@ -0,0 +1,163 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include <thread>
+#include "sample_queue.h"
+
+using namespace fakeit;
+
+static SampleQueue s_queue;
+
+/// A record whose fields all derive from its sequence number, so a torn copy shows
+static SampleRecord MakeRecord(uint32_t sequence) {
+    return SampleRecord{sequence, (int16_t)(sequence * 7), (uint8_t)(sequence ^ (sequence >> 8))};
+}
+
+static bool IsIntact(const SampleRecord& record) {
+    return record.raw == (int16_t)(record.time * 7) && record.flags == (uint8_t)(record.time ^ (record.time >> 8));
+}
+
+void setUp(void) {
+    ArduinoFakeReset();
+    s_queue.Reset();
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+// Test a single context
+void Test_SampleQueue_pops_in_push_order(void) {
+    SampleRecord record;
+    TEST_ASSERT_FALSE(s_queue.Pop(record));
+
+    for (uint32_t i = 0; i < 5; i++) TEST_ASSERT_TRUE(s_queue.Push(MakeRecord(i)));
+    TEST_ASSERT_EQUAL(5, s_queue.Count());
+
+    for (uint32_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(s_queue.Pop(record));
+        TEST_ASSERT_EQUAL(i, record.time);
+        TEST_ASSERT_TRUE(IsIntact(record));
+    }
+    TEST_ASSERT_FALSE(s_queue.Pop(record));
+    TEST_ASSERT_EQUAL(0, s_queue.Count());
+}
+
+void Test_SampleQueue_drops_and_counts_when_full(void) {
+    for (uint32_t i = 0; i < SAMPLE_QUEUE_CAPACITY; i++) TEST_ASSERT_TRUE(s_queue.Push(MakeRecord(i)));
+    TEST_ASSERT_FALSE(s_queue.Push(MakeRecord(100)));
+    TEST_ASSERT_FALSE(s_queue.Push(MakeRecord(101)));
+    TEST_ASSERT_EQUAL(2, s_queue.Dropped());
+    TEST_ASSERT_EQUAL(SAMPLE_QUEUE_CAPACITY, s_queue.Count());
+
+    // The queued records are kept, the new ones were dropped
+    SampleRecord record;
+    TEST_ASSERT_TRUE(s_queue.Pop(record));
+    TEST_ASSERT_EQUAL(0, record.time);
+    TEST_ASSERT_TRUE(s_queue.Push(MakeRecord(102)));
+}
+
+void Test_SampleQueue_keeps_order_across_many_wraps(void) {
+    uint32_t pushed = 0;
+    uint32_t popped = 0;
+    SampleRecord record;
+    // Fill levels go up and down, the indices wrap the array many times
+    for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < round % 7 + 1; i++) {
+            if (s_queue.Push(MakeRecord(pushed))) pushed++;
+        }
+        for (int i = 0; i < round % 5 + 1 && s_queue.Pop(record); i++) {
+            TEST_ASSERT_EQUAL(popped, record.time);
+            popped++;
+        }
+    }
+    TEST_ASSERT_EQUAL(pushed - popped, s_queue.Count());
+    TEST_ASSERT_TRUE(pushed > 100 * SAMPLE_QUEUE_CAPACITY);
+}
+
+// Test two threads standing in for the interrupt and the loop
+static const uint32_t STRESS_RECORDS = 2000000;
+
+void Test_SampleQueue_two_threads_lose_nothing_when_the_producer_waits(void) {
+    std::thread producer([]() {
+        for (uint32_t i = 0; i < STRESS_RECORDS; i++) {
+            while (!s_queue.Push(MakeRecord(i))) std::this_thread::yield();
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t torn = 0;
+    uint32_t outOfOrder = 0;
+    SampleRecord record;
+    while (expected < STRESS_RECORDS) {
+        if (!s_queue.Pop(record)) {
+            std::this_thread::yield();   // on a single core the producer needs the CPU
+            continue;
+        }
+        if (!IsIntact(record)) torn++;
+        if (record.time != expected) outOfOrder++;
+        expected = record.time + 1;
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL(0, torn);
+    TEST_ASSERT_EQUAL(0, outOfOrder);
+    // Pushes into the full queue were retried: counted as drops, yet none is missing
+    TEST_ASSERT_FALSE(s_queue.Pop(record));
+}
+
+void Test_SampleQueue_two_threads_account_for_every_record(void) {
+    // Like the interrupt, the producer never waits: a full queue drops
+    std::thread producer([]() {
+        for (uint32_t i = 0; i < STRESS_RECORDS; i++) {
+            s_queue.Push(MakeRecord(i));
+            if (i % 64 == 0) std::this_thread::yield();
+        }
+    });
+
+    uint32_t received = 0;
+    uint32_t torn = 0;
+    uint32_t notAscending = 0;
+    uint32_t next = 0;   // lowest sequence number still possible
+    SampleRecord record;
+    for (;;) {
+        if (s_queue.Pop(record)) {
+            if (!IsIntact(record)) torn++;
+            if (record.time < next) notAscending++;
+            next = record.time + 1;
+            received++;
+            if (record.time == STRESS_RECORDS - 1) break;
+        } else if (received + s_queue.Dropped() == STRESS_RECORDS && s_queue.Count() == 0) {
+            break;   // the last record was dropped
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    while (s_queue.Pop(record)) received++;
+
+    char message[96];
+    snprintf(message, sizeof(message), "Received %lu, dropped %lu",
+             (unsigned long)received, (unsigned long)s_queue.Dropped());
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(0, torn);
+    TEST_ASSERT_EQUAL(0, notAscending);
+    TEST_ASSERT_EQUAL(STRESS_RECORDS, received + s_queue.Dropped());
+}
+
+// Bundle for central test_main.cpp
+void Run_sample_queue_tests() {
+    RUN_TEST(Test_SampleQueue_pops_in_push_order);
+    RUN_TEST(Test_SampleQueue_drops_and_counts_when_full);
+    RUN_TEST(Test_SampleQueue_keeps_order_across_many_wraps);
+    RUN_TEST(Test_SampleQueue_two_threads_lose_nothing_when_the_producer_waits);
+    RUN_TEST(Test_SampleQueue_two_threads_account_for_every_record);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_sample_queue_tests();
+    return UNITY_END();
+}
+#endif
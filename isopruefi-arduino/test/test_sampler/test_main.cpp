@@ -0,0 +1,113 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "sampler.h"
+#include "sensor.h"
+
+using namespace fakeit;
+
+static const uint32_t T0 = 1753541700;   // 2025-07-26 14:55:00
+static const uint8_t PHASE = 20;
+
+void setUp(void) {
+    ArduinoFakeReset();
+    When(Method(ArduinoFake(), millis)).AlwaysReturn(1000);
+    tempsensor.resetTestState();
+    SamplerReset();
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+/// SQW edges for the next seconds
+static void Edges(int count) {
+    for (int i = 0; i < count; i++) SamplerOnSecond();
+}
+
+void Test_SamplerOnSecond_does_nothing_before_begin(void) {
+    Edges(120);
+    TEST_ASSERT_EQUAL(0, tempsensor.getConversions());
+    TEST_ASSERT_EQUAL(0, SamplerQueue().Count());
+}
+
+void Test_SamplerOnSecond_queues_the_reading_of_the_previous_edge(void) {
+    SamplerBegin(T0 + PHASE - 1, PHASE, 60);
+
+    // The edge at the phase starts the conversion, the next one reads it
+    Edges(1);
+    TEST_ASSERT_EQUAL(1, tempsensor.getConversions());
+    TEST_ASSERT_EQUAL(0, SamplerQueue().Count());
+    tempsensor.setTempC(21.0f);
+    Edges(1);
+
+    SampleRecord record;
+    TEST_ASSERT_TRUE(SamplerTake(record));
+    TEST_ASSERT_EQUAL(T0 + PHASE, record.time);
+    TEST_ASSERT_EQUAL(21 * 128, record.raw);
+    TEST_ASSERT_EQUAL(SAMPLE_FLAG_REPORT, record.flags);
+    TEST_ASSERT_FALSE(SamplerTake(record));
+}
+
+void Test_SamplerOnSecond_follows_the_grid_and_the_period(void) {
+    SamplerBegin(T0 + PHASE - 1, PHASE, 15);
+    Edges(61);
+
+    // phase, +15, +30, +45 and the next phase, whose reading is still converting
+    uint32_t expected[] = {T0 + PHASE, T0 + PHASE + 15, T0 + PHASE + 30, T0 + PHASE + 45};
+    SampleRecord record;
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(SamplerTake(record));
+        TEST_ASSERT_EQUAL(expected[i], record.time);
+        TEST_ASSERT_EQUAL(i == 0 ? SAMPLE_FLAG_REPORT : 0, record.flags);
+    }
+    TEST_ASSERT_FALSE(SamplerTake(record));
+    TEST_ASSERT_EQUAL(5, tempsensor.getConversions());
+
+    // A shorter period applies from the next edge on
+    SamplerSetPeriod(5);
+    Edges(10);
+    TEST_ASSERT_EQUAL(7, tempsensor.getConversions());
+    TEST_ASSERT_TRUE(SamplerTake(record));
+    TEST_ASSERT_EQUAL(T0 + PHASE + 60, record.time);
+    TEST_ASSERT_EQUAL(SAMPLE_FLAG_REPORT, record.flags);
+}
+
+void Test_SamplerOnSecond_queues_a_silent_sensor_as_failed(void) {
+    SamplerBegin(T0 + PHASE - 1, PHASE, 60);
+    tempsensor.setReadFails(true);
+    Edges(1);
+
+    SampleRecord record;
+    TEST_ASSERT_TRUE(SamplerTake(record));
+    TEST_ASSERT_EQUAL(T0 + PHASE, record.time);
+    TEST_ASSERT_EQUAL(SAMPLE_FLAG_REPORT | SAMPLE_FLAG_FAILED, record.flags);
+}
+
+void Test_SamplerStop_keeps_queued_samples(void) {
+    SamplerBegin(T0 + PHASE - 1, PHASE, 1);
+    Edges(3);
+    SamplerStop();
+    Edges(10);
+
+    TEST_ASSERT_FALSE(SamplerRunning());
+    TEST_ASSERT_EQUAL(2, SamplerQueue().Count());
+    TEST_ASSERT_EQUAL(3, tempsensor.getConversions());
+}
+
+// Bundle for central test_main.cpp
+void Run_sampler_tests() {
+    RUN_TEST(Test_SamplerOnSecond_does_nothing_before_begin);
+    RUN_TEST(Test_SamplerOnSecond_queues_the_reading_of_the_previous_edge);
+    RUN_TEST(Test_SamplerOnSecond_follows_the_grid_and_the_period);
+    RUN_TEST(Test_SamplerOnSecond_queues_a_silent_sensor_as_failed);
+    RUN_TEST(Test_SamplerStop_keeps_queued_samples);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_sampler_tests();
+    return UNITY_END();
+}
+#endif
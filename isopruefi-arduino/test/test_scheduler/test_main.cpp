@@ -0,0 +1,199 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include <stdio.h>
+#include "scheduler.h"
+
+using namespace fakeit;
+
+static unsigned long s_fakeMillis = 0;
+static int s_runsA = 0;
+static int s_runsB = 0;
+static unsigned long s_lastStartA = 0;
+static char s_order[8];
+static size_t s_orderLength = 0;
+
+void setUp(void) {
+    ArduinoFakeReset();
+    s_fakeMillis = 0;
+    s_runsA = 0;
+    s_runsB = 0;
+    s_lastStartA = 0;
+    s_orderLength = 0;
+    When(Method(ArduinoFake(), millis)).AlwaysDo([]() { return s_fakeMillis; });
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+static void TaskA(unsigned long nowMs) {
+    s_runsA++;
+    s_lastStartA = nowMs;
+    if (s_orderLength < sizeof(s_order)) s_order[s_orderLength++] = 'A';
+}
+
+static void TaskB(unsigned long nowMs) {
+    s_runsB++;
+    if (s_orderLength < sizeof(s_order)) s_order[s_orderLength++] = 'B';
+}
+
+static void SlowTask(unsigned long nowMs) {
+    s_fakeMillis += 30;
+}
+
+/// Runs the scheduler once per millisecond up to endMs, like a loop() without delay
+static void RunUntil(Scheduler& scheduler, unsigned long endMs) {
+    while (s_fakeMillis < endMs) {
+        scheduler.Run();
+        s_fakeMillis++;
+    }
+}
+
+// Test periods and deadlines
+void Test_Scheduler_runs_tasks_at_their_period(void) {
+    Scheduler scheduler;
+    scheduler.AddTask("a", TaskA, 100, 10, 0);
+    scheduler.AddTask("b", TaskB, 250, 10, 0);
+
+    RunUntil(scheduler, 1000);
+
+    TEST_ASSERT_EQUAL(10, s_runsA);
+    TEST_ASSERT_EQUAL(4, s_runsB);
+    TEST_ASSERT_EQUAL(900, s_lastStartA);
+}
+
+void Test_Scheduler_runs_due_tasks_in_registration_order(void) {
+    Scheduler scheduler;
+    scheduler.AddTask("b", TaskB, 100, 10, 0);
+    scheduler.AddTask("a", TaskA, 100, 10, 0);
+
+    TEST_ASSERT_EQUAL(2, scheduler.Run());
+    TEST_ASSERT_EQUAL('B', s_order[0]);
+    TEST_ASSERT_EQUAL('A', s_order[1]);
+
+    // Nothing due: the pass returns without running anything
+    TEST_ASSERT_EQUAL(0, scheduler.Run());
+    TEST_ASSERT_EQUAL(100, scheduler.MsUntilNextRun(s_fakeMillis));
+}
+
+void Test_Scheduler_late_pass_keeps_phase(void) {
+    Scheduler scheduler;
+    scheduler.AddTask("a", TaskA, 100, 10, 0);
+    scheduler.Run();
+
+    // A pass 350 ms late runs the task once and keeps the 100 ms grid
+    s_fakeMillis = 450;
+    scheduler.Run();
+    TEST_ASSERT_EQUAL(2, s_runsA);
+    TEST_ASSERT_EQUAL(500, scheduler.Task(0)->nextRunMs);
+}
+
+void Test_Scheduler_task_sets_own_deadline(void) {
+    Scheduler scheduler;
+    uint8_t task = scheduler.AddTask("a", TaskA, 1000, 10, 0);
+    scheduler.Run();
+
+    scheduler.RunAt(task, 40);
+    RunUntil(scheduler, 41);
+    TEST_ASSERT_EQUAL(2, s_runsA);
+    TEST_ASSERT_EQUAL(40, s_lastStartA);
+}
+
+void Test_Scheduler_counts_budget_overruns(void) {
+    Scheduler scheduler;
+    uint8_t slow = scheduler.AddTask("slow", SlowTask, 100, 20, 0);
+    uint8_t fast = scheduler.AddTask("fast", TaskA, 100, 20, 0);
+
+    scheduler.Run();
+
+    TEST_ASSERT_EQUAL(1, scheduler.Task(slow)->overruns);
+    TEST_ASSERT_EQUAL(30, scheduler.Task(slow)->lastRunMs);
+    TEST_ASSERT_EQUAL(0, scheduler.Task(fast)->overruns);
+    // The task after a slow one still runs in the same pass, with its own start time
+    TEST_ASSERT_EQUAL(30, s_lastStartA);
+}
+
+void Test_Scheduler_disabled_task_does_not_run(void) {
+    Scheduler scheduler;
+    uint8_t task = scheduler.AddTask("a", TaskA, 100, 10, 0);
+    scheduler.SetEnabled(task, false);
+
+    RunUntil(scheduler, 500);
+    TEST_ASSERT_EQUAL(0, s_runsA);
+
+    scheduler.SetEnabled(task, true);
+    scheduler.Run();
+    TEST_ASSERT_EQUAL(1, s_runsA);
+}
+
+void Test_Scheduler_deadlines_survive_millis_wrap(void) {
+    Scheduler scheduler;
+    s_fakeMillis = (unsigned long)-50;
+    scheduler.AddTask("a", TaskA, 100, 10, s_fakeMillis);
+    scheduler.Run();
+
+    s_fakeMillis = 0;
+    TEST_ASSERT_EQUAL(0, scheduler.Run());
+    s_fakeMillis = 50;
+    TEST_ASSERT_EQUAL(1, scheduler.Run());
+}
+
+void Test_Scheduler_rejects_tasks_beyond_capacity(void) {
+    Scheduler scheduler;
+    for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        TEST_ASSERT_EQUAL(i, scheduler.AddTask("a", TaskA, 100, 10, 0));
+    }
+    TEST_ASSERT_EQUAL(SCHEDULER_NO_TASK, scheduler.AddTask("b", TaskB, 100, 10, 0));
+    TEST_ASSERT_NULL(scheduler.Task(SCHEDULER_MAX_TASKS));
+}
+
+// Test phase spreading
+void Test_Scheduler_phase_is_stable_per_device(void) {
+    TEST_ASSERT_EQUAL(SchedulerPhaseFromId("Sensor_One", 50), SchedulerPhaseFromId("Sensor_One", 50));
+    TEST_ASSERT_NOT_EQUAL(SchedulerPhaseFromId("Sensor_One", 50), SchedulerPhaseFromId("Sensor_Two", 50));
+    TEST_ASSERT_EQUAL(0, SchedulerPhaseFromId("Sensor_One", 0));
+}
+
+void Test_Scheduler_phases_spread_a_fleet_over_the_window(void) {
+    // 100 devices over 50 one-second slots: no slot gets a large share
+    int perSlot[50] = {0};
+    char id[24];
+    for (int n = 0; n < 100; n++) {
+        snprintf(id, sizeof(id), "Sensor_%d", n);
+        uint16_t slot = SchedulerPhaseFromId(id, 50);
+        TEST_ASSERT_TRUE(slot < 50);
+        perSlot[slot]++;
+    }
+
+    int busiest = 0;
+    int used = 0;
+    for (int slot = 0; slot < 50; slot++) {
+        if (perSlot[slot] > busiest) busiest = perSlot[slot];
+        if (perSlot[slot] > 0) used++;
+    }
+    TEST_ASSERT_TRUE(busiest <= 8);
+    TEST_ASSERT_TRUE(used >= 35);
+}
+
+// Bundle for central test_main.cpp
+void Run_scheduler_tests() {
+    RUN_TEST(Test_Scheduler_runs_tasks_at_their_period);
+    RUN_TEST(Test_Scheduler_runs_due_tasks_in_registration_order);
+    RUN_TEST(Test_Scheduler_late_pass_keeps_phase);
+    RUN_TEST(Test_Scheduler_task_sets_own_deadline);
+    RUN_TEST(Test_Scheduler_counts_budget_overruns);
+    RUN_TEST(Test_Scheduler_disabled_task_does_not_run);
+    RUN_TEST(Test_Scheduler_deadlines_survive_millis_wrap);
+    RUN_TEST(Test_Scheduler_rejects_tasks_beyond_capacity);
+    RUN_TEST(Test_Scheduler_phase_is_stable_per_device);
+    RUN_TEST(Test_Scheduler_phases_spread_a_fleet_over_the_window);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_scheduler_tests();
+    return UNITY_END();
+}
+#endif
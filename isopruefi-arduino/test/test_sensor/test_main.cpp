@@ -4,12 +4,19 @@
 
 using namespace fakeit;
 
+static unsigned long s_fakeMillis = 0;
+static int s_delayCalls = 0;
+
 void setUp(void) {
     ArduinoFakeReset();
     When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char[]))).AlwaysReturn(1);
     When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char[]))).AlwaysReturn(1);
-    When(Method(ArduinoFake(), delay)).Return();
-    When(Method(ArduinoFake(), millis)).Return(1000);
+    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long ms) { s_delayCalls++; });
+    When(Method(ArduinoFake(), millis)).AlwaysDo([]() -> unsigned long { return s_fakeMillis; });
+    s_fakeMillis = 1000;
+    s_delayCalls = 0;
+    tempsensor.resetTestState();
+    SensorReset();
 }
 
 void tearDown(void) {
@@ -27,26 +34,33 @@ void Test_InitSensor_success(void) {
     TEST_ASSERT_TRUE(result);
 }
 
-// Test that initSensor handles delay properly (mock doesn't fail)
-void Test_InitSensor_with_delay(void) {
+// Test that initSensor leaves the sensor idle without waiting for it
+void Test_InitSensor_does_not_wait(void) {
     MockTempSensor mockSensor;
     
-    // Test that the function completes even with delay call
     bool result = InitSensor(mockSensor);
     
     TEST_ASSERT_TRUE(result);
-    TEST_ASSERT_EQUAL_INT(250, mockSensor.delayCalled());
+    TEST_ASSERT_EQUAL_INT(0, s_delayCalls);
+    TEST_ASSERT_EQUAL(0x60, mockSensor.getConfig() & 0x60);   // shutdown
+    TEST_ASSERT_EQUAL(0, mockSensor.getConversions());
 }
 
 // Test initSensor sets correct resolution
 void Test_InitSensor_sets_resolution(void) {
     MockTempSensor mockSensor;
 
-    // This test verifies the function completes successfully.
     bool result = InitSensor(mockSensor);
     
     TEST_ASSERT_TRUE(result);
-    TEST_ASSERT_TRUE(mockSensor.setResolutionCalled());
+    TEST_ASSERT_EQUAL(0x80, mockSensor.getConfig() & 0x80);   // 16-bit
+}
+
+void Test_InitSensor_fails_without_config_write(void) {
+    MockTempSensor mockSensor;
+    mockSensor.setReadFails(true);
+
+    TEST_ASSERT_FALSE(InitSensor(mockSensor));
 }
 
 // Test readTemperatureCelsius function
@@ -76,14 +90,132 @@ void Test_ReadTemperatureCelsius_precision(void) {
     TEST_ASSERT_FLOAT_WITHIN(0.5, 25.5, temperature);
 }
 
+// Test the raw register read every sample takes
+void Test_ReadTemperatureRaw_returns_counts(void) {
+    int16_t raw = 0;
+    tempsensor.setTempC(-10.25f);
+    bool result = ReadTemperatureRaw(raw);
+    tempsensor.setTempC(25.5f);
+
+    TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_EQUAL(-1312, raw);
+}
+
+void Test_ReadTemperatureRaw_failure_leaves_value(void) {
+    int16_t raw = 1234;
+    tempsensor.setReadFails(true);
+    bool result = ReadTemperatureRaw(raw);
+    tempsensor.setReadFails(false);
+
+    TEST_ASSERT_FALSE(result);
+    TEST_ASSERT_EQUAL(1234, raw);
+}
+
+// Test the asynchronous one-shot conversion
+void Test_Sensor_one_shot_conversion_is_polled_and_fetched(void) {
+    tempsensor.setConversionMs(SENSOR_CONVERSION_MS);
+    tempsensor.setTempC(21.5f);
+    int16_t raw = 0;
+
+    TEST_ASSERT_TRUE(SensorStartConversion(1000));
+    TEST_ASSERT_EQUAL(0x20, tempsensor.getConfig() & 0x60);   // one-shot
+    TEST_ASSERT_EQUAL(SENSOR_CONVERSION_MS, SensorMsUntilReady(1000));
+
+    // No bus traffic before the conversion time, and nothing to fetch
+    s_fakeMillis = 1100;
+    TEST_ASSERT_EQUAL(SENSOR_CONVERTING, SensorPoll(1100));
+    TEST_ASSERT_FALSE(SensorFetch(raw));
+    TEST_ASSERT_EQUAL(0, tempsensor.getStatusReads());
+
+    s_fakeMillis = 1000 + SENSOR_CONVERSION_MS;
+    TEST_ASSERT_EQUAL(SENSOR_READY, SensorPoll(s_fakeMillis));
+    TEST_ASSERT_TRUE(SensorFetch(raw));
+    TEST_ASSERT_EQUAL(CelsiusToRawTemp(21.5f), raw);
+    TEST_ASSERT_EQUAL(SENSOR_IDLE, SensorPoll(s_fakeMillis));
+    TEST_ASSERT_EQUAL(1, tempsensor.getConversions());
+    TEST_ASSERT_EQUAL(0, tempsensor.getEarlyReads());
+}
+
+void Test_Sensor_slow_conversion_waits_for_ready_bit(void) {
+    tempsensor.setConversionMs(300);
+
+    SensorStartConversion(1000);
+    s_fakeMillis = 1000 + SENSOR_CONVERSION_MS;
+    TEST_ASSERT_EQUAL(SENSOR_CONVERTING, SensorPoll(s_fakeMillis));
+    TEST_ASSERT_EQUAL(SENSOR_POLL_INTERVAL_MS, SensorMsUntilReady(s_fakeMillis));
+
+    s_fakeMillis = 1300;
+    TEST_ASSERT_EQUAL(SENSOR_READY, SensorPoll(1300));
+    TEST_ASSERT_EQUAL(2, tempsensor.getStatusReads());
+    TEST_ASSERT_EQUAL(0, tempsensor.getEarlyReads());
+}
+
+void Test_Sensor_conversion_that_never_ends_fails(void) {
+    tempsensor.setConversionMs(10000);
+    int16_t raw = 1234;
+
+    SensorStartConversion(1000);
+    s_fakeMillis = 1000 + SENSOR_CONVERSION_TIMEOUT_MS;
+    TEST_ASSERT_EQUAL(SENSOR_FAILED, SensorPoll(s_fakeMillis));
+    TEST_ASSERT_FALSE(SensorFetch(raw));
+    TEST_ASSERT_EQUAL(1234, raw);
+    // The driver is free for the next sample
+    TEST_ASSERT_TRUE(SensorStartConversion(s_fakeMillis));
+}
+
+void Test_Sensor_start_fails_when_sensor_does_not_answer(void) {
+    int16_t raw;
+    tempsensor.setReadFails(true);
+
+    TEST_ASSERT_FALSE(SensorStartConversion(1000));
+    TEST_ASSERT_EQUAL(SENSOR_FAILED, SensorPoll(2000));
+    TEST_ASSERT_FALSE(SensorFetch(raw));
+}
+
+void Test_Sensor_oversampling_averages_conversions(void) {
+    tempsensor.setConversionMs(SENSOR_CONVERSION_MS);
+    SensorSetOversampling(4);
+    const float temps[] = {20.0f, 20.5f, 21.0f, 20.0078125f};
+    int16_t raw = 0;
+
+    SensorStartConversion(1000);
+    for (int i = 0; i < 4; i++) {
+        tempsensor.setTempC(temps[i]);
+        s_fakeMillis = 1000 + (i + 1) * SENSOR_CONVERSION_MS;
+        TEST_ASSERT_EQUAL(i < 3 ? SENSOR_CONVERTING : SENSOR_READY, SensorPoll(s_fakeMillis));
+    }
+
+    TEST_ASSERT_TRUE(SensorFetch(raw));
+    // (2560 + 2624 + 2688 + 2561) / 4 = 2608.25
+    TEST_ASSERT_EQUAL(2608, raw);
+    TEST_ASSERT_EQUAL(4, tempsensor.getConversions());
+    TEST_ASSERT_EQUAL(0, tempsensor.getEarlyReads());
+}
+
+void Test_Sensor_oversampling_is_clamped(void) {
+    SensorSetOversampling(0);
+    TEST_ASSERT_EQUAL(1, SensorOversampling());
+    SensorSetOversampling(100);
+    TEST_ASSERT_EQUAL(SENSOR_MAX_OVERSAMPLING, SensorOversampling());
+}
+
 // Bundle for central test_main.cpp
 void Run_sensor_tests() {
     RUN_TEST(Test_InitSensor_success);
     RUN_TEST(Test_InitSensor_sets_resolution);
-    RUN_TEST(Test_InitSensor_with_delay);
+    RUN_TEST(Test_InitSensor_does_not_wait);
+    RUN_TEST(Test_InitSensor_fails_without_config_write);
     RUN_TEST(Test_ReadTemperatureCelsius_returns_value);
     RUN_TEST(Test_ReadTemperatureCelsius_various_values);
     RUN_TEST(Test_ReadTemperatureCelsius_precision);
+    RUN_TEST(Test_ReadTemperatureRaw_returns_counts);
+    RUN_TEST(Test_ReadTemperatureRaw_failure_leaves_value);
+    RUN_TEST(Test_Sensor_one_shot_conversion_is_polled_and_fetched);
+    RUN_TEST(Test_Sensor_slow_conversion_waits_for_ready_bit);
+    RUN_TEST(Test_Sensor_conversion_that_never_ends_fails);
+    RUN_TEST(Test_Sensor_start_fails_when_sensor_does_not_answer);
+    RUN_TEST(Test_Sensor_oversampling_averages_conversions);
+    RUN_TEST(Test_Sensor_oversampling_is_clamped);
 }
 
 // When standalone executable
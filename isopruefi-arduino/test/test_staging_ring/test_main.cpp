@@ -0,0 +1,135 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "staging_ring.h"
+
+using namespace fakeit;
+
+void setUp(void) {
+    ArduinoFakeReset();
+    OutageLogEnd();
+    sd.clearTestFiles();
+    StagingRingReset();
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char[]))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char[]))).AlwaysReturn(1);
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+static OutageRecord MakeRecord(uint32_t sequence) {
+    OutageRecord record = {1753541700 + sequence * 60, sequence, (int16_t)(2000 + sequence), 0};
+    return record;
+}
+
+static void PushRecords(uint32_t first, uint32_t count, unsigned long nowMs) {
+    for (uint32_t i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE(StagingRingPush(MakeRecord(first + i), nowMs));
+    }
+}
+
+// Test staging and draining from RAM
+void Test_StagingRing_peek_and_consume_in_order(void) {
+    PushRecords(0, 5, 0);
+
+    OutageRecord records[8];
+    TEST_ASSERT_EQUAL(5, StagingRingPeek(records, 8));
+    TEST_ASSERT_EQUAL(0, records[0].sequence);
+    TEST_ASSERT_EQUAL(4, records[4].sequence);
+    TEST_ASSERT_EQUAL(2004, records[4].rawTemp);
+
+    // Skipped readings are the ones already in flight
+    TEST_ASSERT_EQUAL(2, StagingRingPeek(records, 8, 3));
+    TEST_ASSERT_EQUAL(3, records[0].sequence);
+
+    StagingRingConsume(2);
+    TEST_ASSERT_EQUAL(3, StagingRingCount());
+    TEST_ASSERT_EQUAL(1, StagingRingPeek(records, 1));
+    TEST_ASSERT_EQUAL(2, records[0].sequence);
+}
+
+void Test_StagingRing_short_outage_never_touches_the_card(void) {
+    PushRecords(0, STAGING_RING_HIGH_WATER, 0);
+    StagingRingTick(60000, 180000);
+    StagingRingConsume(STAGING_RING_HIGH_WATER);
+
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+    TEST_ASSERT_EQUAL(0, StagingRingSpilledCount());
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+}
+
+// Test spilling to the outage log
+void Test_StagingRing_spills_oldest_above_high_water(void) {
+    PushRecords(0, STAGING_RING_HIGH_WATER + 3, 0);
+
+    TEST_ASSERT_EQUAL(STAGING_RING_HIGH_WATER, StagingRingCount());
+    TEST_ASSERT_EQUAL(3, StagingRingSpilledCount());
+    TEST_ASSERT_EQUAL(3, OutageLogPendingCount());
+
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(1, OutageLogPeek(&record, 1));
+    TEST_ASSERT_EQUAL(0, record.sequence);
+    TEST_ASSERT_EQUAL(1, StagingRingPeek(&record, 1));
+    TEST_ASSERT_EQUAL(3, record.sequence);
+}
+
+void Test_StagingRing_tick_spills_aged_readings(void) {
+    PushRecords(0, 2, 1000);
+    PushRecords(2, 1, 5000);
+
+    StagingRingTick(4000, 5000);
+    TEST_ASSERT_EQUAL(3, StagingRingCount());
+
+    StagingRingTick(6000, 5000);
+    TEST_ASSERT_EQUAL(1, StagingRingCount());
+    TEST_ASSERT_EQUAL(2, OutageLogPendingCount());
+}
+
+void Test_StagingRing_held_readings_are_not_spilled(void) {
+    PushRecords(0, 4, 0);
+    StagingRingHold(2);
+
+    // In flight: neither age nor fill level moves them
+    StagingRingTick(600000, 1000);
+    PushRecords(4, STAGING_RING_CAPACITY - 4, 0);
+    TEST_ASSERT_EQUAL(STAGING_RING_CAPACITY, StagingRingCount());
+    TEST_ASSERT_EQUAL(0, OutageLogPendingCount());
+
+    // A full ring sends new readings to the outage log directly
+    TEST_ASSERT_TRUE(StagingRingPush(MakeRecord(100), 0));
+    TEST_ASSERT_EQUAL(1, OutageLogPendingCount());
+
+    // Once acknowledged, the readings behind them can age out again
+    StagingRingConsume(2);
+    StagingRingTick(600000, 1000);
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+    TEST_ASSERT_EQUAL(STAGING_RING_CAPACITY - 1, OutageLogPendingCount());
+}
+
+void Test_StagingRing_flush_moves_held_readings_too(void) {
+    PushRecords(0, 3, 0);
+    StagingRingHold(3);
+
+    TEST_ASSERT_TRUE(StagingRingFlush());
+    TEST_ASSERT_EQUAL(0, StagingRingCount());
+    TEST_ASSERT_EQUAL(3, OutageLogPendingCount());
+}
+
+// Bundle for central test_main.cpp
+void Run_staging_ring_tests() {
+    RUN_TEST(Test_StagingRing_peek_and_consume_in_order);
+    RUN_TEST(Test_StagingRing_short_outage_never_touches_the_card);
+    RUN_TEST(Test_StagingRing_spills_oldest_above_high_water);
+    RUN_TEST(Test_StagingRing_tick_spills_aged_readings);
+    RUN_TEST(Test_StagingRing_held_readings_are_not_spilled);
+    RUN_TEST(Test_StagingRing_flush_moves_held_readings_too);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_staging_ring_tests();
+    return UNITY_END();
+}
+#endif
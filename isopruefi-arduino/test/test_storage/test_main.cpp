@@ -6,17 +6,28 @@ using namespace fakeit;
 
 void setUp(void) {
     ArduinoFakeReset();
+    OutageLogEnd();
+    BatchManifestEnd();
     sd.clearTestFiles();
+    StagingRingReset();
     When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char[]))).AlwaysReturn(1);
     When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char[]))).AlwaysReturn(1);
     When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const String&))).AlwaysReturn(1);
     When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const String&))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(unsigned long, int))).AlwaysReturn(1);
 }
 
 void tearDown(void) {
     ArduinoFakeReset();
 }
 
+// Temperatures are added as preformatted text; they read back as numbers once sent
+static void SendAndReceive(JsonDocument& doc) {
+    char text[256];
+    serializeJson(doc, text, sizeof(text));
+    deserializeJson(doc, text);
+}
+
 // Test helper functions
 void Test_CreateFolderName(void) {
     DateTime now(2025, 7, 26, 14, 55, 0);
@@ -25,45 +36,106 @@ void Test_CreateFolderName(void) {
     TEST_ASSERT_EQUAL_STRING("2025", result);
 }
 
-void Test_CreateCsvFilename(void) {
-    DateTime now(2025, 7, 26, 14, 55, 0);
-    char buffer[32];
-    CreateCsvFilename(buffer, sizeof(buffer), now);
-    TEST_ASSERT_EQUAL_STRING("2025/07261455.csv", buffer);
-}
-
-void Test_CreateCsvFilename_filename_end_of_year(void) {
-    DateTime testTime(2023, 12, 31, 23, 59, 0);
-    char buffer[32];
-    CreateCsvFilename(buffer, sizeof(buffer), testTime);
-    TEST_ASSERT_EQUAL_STRING("2023/12312359.csv", buffer);
-}
-
-// Test saveToCsvBatch function with ArduinoFake mocking
-void Test_SaveTempToBatchCsv_creates_folder_when_not_exists(void) {
+// Test SaveTempToOutageLog function
+void Test_SaveTempToOutageLog_creates_log_directory(void) {
     DateTime now(2025, 7, 26, 14, 55, 0);
     
-    // Setup: folder doesn't exist initially
-    TEST_ASSERT_FALSE(sd.exists("2025"));
+    // Setup: log directory doesn't exist initially
+    TEST_ASSERT_FALSE(sd.exists(OUTAGE_LOG_DIR));
         
     // Call the function
-    SaveTempToBatchCsv(now, 25.5, 42);
+    TEST_ASSERT_TRUE(SaveTempToOutageLog(now, 25.5, 42));
     
-    // Verify folder was created
-    TEST_ASSERT_TRUE(sd.exists("2025"));
+    // Verify directory and first segment were created
+    TEST_ASSERT_TRUE(sd.exists(OUTAGE_LOG_DIR));
+    TEST_ASSERT_TRUE(sd.exists("LOG/SEG0.BIN"));
 }
 
-void Test_SaveTempToBatchCsv_writes_csv_data(void) {
+void Test_SaveTempToOutageLog_appends_record(void) {
     DateTime now(2025, 7, 26, 14, 55, 0);
-    
-    // Setup: folder exists
-    sd.addTestFile("2025");
         
     // Call the function
-    SaveTempToBatchCsv(now, 25.12345, 42);
+    SaveTempToOutageLog(now, 25.12345, 42);
     
-    // Verify the CSV file was created
-    TEST_ASSERT_TRUE(sd.exists("2025/07261455.csv"));
+    // Verify the record is pending with raw sensor resolution (1/128 °C)
+    TEST_ASSERT_EQUAL(1, OutageLogPendingCount());
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(1, OutageLogPeek(&record, 1));
+    TEST_ASSERT_EQUAL(now.unixtime(), record.timestamp);
+    TEST_ASSERT_EQUAL(42, record.sequence);
+    TEST_ASSERT_EQUAL(3216, record.rawTemp);
+}
+
+// Test StageTempReading function
+void Test_StageTempReading_keeps_reading_in_ram(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    When(Method(ArduinoFake(), millis)).AlwaysReturn(0);
+
+    TEST_ASSERT_TRUE(StageTempReading(now, 25.5, 42));
+
+    // Staged for recovery without mounting the outage log
+    TEST_ASSERT_EQUAL(1, StagingRingCount());
+    TEST_ASSERT_FALSE(sd.exists(OUTAGE_LOG_DIR));
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(1, StagingRingPeek(&record, 1));
+    TEST_ASSERT_EQUAL(42, record.sequence);
+    TEST_ASSERT_EQUAL(3264, record.rawTemp);
+}
+
+void Test_SaveTempToOutageLog_does_not_create_csv_files(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+
+    for (int i = 0; i < 12; i++) {
+        SaveTempToOutageLog(now, 20.0, i);
+    }
+
+    // No per-reading files and no year folder anymore
+    TEST_ASSERT_FALSE(sd.exists("2025"));
+    TEST_ASSERT_FALSE(sd.exists("2025/07261455.csv"));
+    TEST_ASSERT_EQUAL(12, OutageLogPendingCount());
+}
+
+void Test_SaveTempToOutageLog_batches_sd_writes(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    TEST_ASSERT_TRUE(OutageLogBegin());
+    sd.resetStats();
+
+    // The first sector holds the segment header plus one record less than a sector
+    const int firstSectorRecords = OUTAGE_LOG_RECORDS_PER_SECTOR - 1;
+    for (int i = 0; i < firstSectorRecords; i++) {
+        SaveTempToOutageLog(now, 20.0, i);
+    }
+
+    // One sector write instead of one write and sync per reading
+    TEST_ASSERT_EQUAL(1, sd.getStats().writes);
+    TEST_ASSERT_EQUAL(1, sd.getStats().syncs);
+    TEST_ASSERT_EQUAL(OUTAGE_LOG_SECTOR_BYTES - OUTAGE_LOG_RECORD_BYTES, sd.getStats().bytesWritten);
+    TEST_ASSERT_EQUAL(0, sd.getStats().existsCalls);
+
+    for (int i = firstSectorRecords; i < firstSectorRecords + 9; i++) {
+        SaveTempToOutageLog(now, 20.0, i);
+    }
+    TEST_ASSERT_EQUAL(1, sd.getStats().writes);
+    TEST_ASSERT_EQUAL(firstSectorRecords + 9, OutageLogPendingCount());
+}
+
+void Test_SaveTempToOutageLog_flush_writes_buffered_records(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    TEST_ASSERT_TRUE(OutageLogBegin());
+    sd.resetStats();
+
+    SaveTempToOutageLog(now, 21.5, 1);
+    SaveTempToOutageLog(now, 21.5, 2);
+    TEST_ASSERT_EQUAL(0, sd.getStats().writes);
+    TEST_ASSERT_EQUAL(2 * OUTAGE_LOG_RECORD_BYTES, OutageLogBufferedBytes());
+
+    TEST_ASSERT_TRUE(OutageLogFlush());
+    TEST_ASSERT_EQUAL(1, sd.getStats().writes);
+    TEST_ASSERT_EQUAL(0, OutageLogBufferedBytes());
+
+    // Flushing again has nothing to write
+    TEST_ASSERT_TRUE(OutageLogFlush());
+    TEST_ASSERT_EQUAL(1, sd.getStats().writes);
 }
 
 void Test_BuildJson_creates_correct_structure(void) {
@@ -99,6 +171,94 @@ void Test_BuildJson_clears_previous_data(void) {
     TEST_ASSERT_EQUAL(10, doc["sequence"].as<int>());
 }
 
+void Test_BuildJson_single_reading_record_keeps_plain_value(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    SampleAggregate aggregate;
+    AggregateReset(aggregate);
+    AggregateAdd(aggregate, 3264);
+    JsonDocument doc;
+
+    BuildJson(doc, MakeAggregateRecord(now, aggregate, 7));
+    SendAndReceive(doc);
+
+    TEST_ASSERT_EQUAL(1, (int)doc["value"].size());
+    TEST_ASSERT_EQUAL_FLOAT(25.5, doc["value"][0].as<float>());
+    TEST_ASSERT_EQUAL(7, doc["sequence"].as<int>());
+    TEST_ASSERT_EQUAL(now.unixtime(), doc["timestamp"].as<unsigned long>());
+    TEST_ASSERT_EQUAL(0, (int)doc["meta"].size());
+}
+
+void Test_BuildJson_aggregate_sends_mean_with_stats_in_meta(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    SampleAggregate aggregate;
+    AggregateReset(aggregate);
+    AggregateAdd(aggregate, 3200);   // 25.0
+    AggregateAdd(aggregate, 3328);   // 26.0
+    AggregateAdd(aggregate, 3264);   // 25.5
+    JsonDocument doc;
+
+    BuildJson(doc, MakeAggregateRecord(now, aggregate, 8));
+    SendAndReceive(doc);
+
+    // The receiver stores a one-element value array as a reading
+    TEST_ASSERT_EQUAL(1, (int)doc["value"].size());
+    TEST_ASSERT_EQUAL_FLOAT(25.5, doc["value"][0].as<float>());
+    JsonObject meta = doc["meta"];
+    TEST_ASSERT_EQUAL_FLOAT(25.0, meta["mn"].as<float>());
+    TEST_ASSERT_EQUAL_FLOAT(26.0, meta["mx"].as<float>());
+    TEST_ASSERT_EQUAL(3, meta["n"].as<int>());
+    TEST_ASSERT_TRUE(meta["l"].isNull());
+
+    AggregateSetReportLast(true);
+    BuildJson(doc, MakeAggregateRecord(now, aggregate, 8));
+    AggregateSetReportLast(false);
+    SendAndReceive(doc);
+    TEST_ASSERT_EQUAL(1, (int)doc["value"].size());
+    TEST_ASSERT_EQUAL_FLOAT(25.5, doc["meta"]["l"].as<float>());
+}
+
+void Test_BuildJson_burst_lists_all_samples(void) {
+    BurstMessage burst = {};
+    burst.timestamp = DateTime(2025, 7, 26, 14, 55, 5).unixtime();
+    burst.periodSeconds = 5;
+    burst.count = 3;
+    burst.raw[0] = 3264;   // 25.5
+    burst.raw[1] = 3232;   // 25.25
+    burst.raw[2] = 3168;   // 24.75
+    JsonDocument doc;
+
+    BuildJson(doc, burst);
+    SendAndReceive(doc);
+
+    JsonArray value = doc["value"];
+    TEST_ASSERT_EQUAL(3, (int)value.size());
+    TEST_ASSERT_EQUAL_FLOAT(25.5, value[0].as<float>());
+    TEST_ASSERT_EQUAL_FLOAT(24.75, value[2].as<float>());
+    TEST_ASSERT_EQUAL(burst.timestamp, doc["timestamp"].as<unsigned long>());
+    // Bursts take no sequence number
+    TEST_ASSERT_TRUE(doc["sequence"].isNull());
+    TEST_ASSERT_EQUAL(5, doc["meta"]["burst"].as<int>());
+}
+
+void Test_StageRecord_keeps_the_aggregate(void) {
+    DateTime now(2025, 7, 26, 14, 55, 0);
+    SampleAggregate aggregate;
+    AggregateReset(aggregate);
+    AggregateAdd(aggregate, 3200);
+    AggregateAdd(aggregate, 3300);
+    StagingRingReset();
+    When(Method(ArduinoFake(), millis)).AlwaysReturn(0);
+
+    TEST_ASSERT_TRUE(StageRecord(MakeAggregateRecord(now, aggregate, 3)));
+
+    OutageRecord record;
+    TEST_ASSERT_EQUAL(1, StagingRingPeek(&record, 1));
+    TEST_ASSERT_EQUAL(3250, record.rawTemp);
+    TEST_ASSERT_EQUAL(3200, record.rawMin);
+    TEST_ASSERT_EQUAL(3300, record.rawMax);
+    TEST_ASSERT_EQUAL(2, record.count);
+}
+
 void Test_DeleteCsvFile_success(void) {
     const char* testFile = "2025/test.csv";
     
@@ -126,49 +286,23 @@ void Test_DeleteCsvFile_file_not_exists(void) {
     TEST_ASSERT_FALSE(sd.exists(testFile));
 }
 
-void Test_BuildRecoveryJsonFromBatchCsv_structure(void) {
-    DateTime now(2025, 7, 26, 14, 55, 0);
-    
-    sd.addTestFile("2025");
-
-    const char* path = "2025/07261455.csv";
-
-    sd.addTestFile(path, "1721995200,23.5,1\n1721995260,24.0,2\n");
-
-    JsonDocument doc;
-    BuildRecoveryJsonFromBatchCsv(doc, path, now);
-
-    TEST_ASSERT_EQUAL(now.unixtime(), doc["timestamp"].as<unsigned long>());
-    TEST_ASSERT_TRUE(doc["sequence"].isNull());
-
-    JsonArray valueArr = doc["value"];
-    TEST_ASSERT_EQUAL(1, (int)valueArr.size());
-    TEST_ASSERT_TRUE(valueArr[0].isNull());
-
-    JsonObject meta = doc["meta"];
-    JsonArray t = meta["t"];
-    JsonArray v = meta["v"];
-    JsonArray s = meta["s"];
-    TEST_ASSERT_EQUAL(2, (int)t.size());
-    TEST_ASSERT_EQUAL(2, (int)v.size());
-    TEST_ASSERT_EQUAL(2, (int)s.size());
-}
-
-
-
-
 // Bundle for central test_main.cpp
 void Run_storage_tests() {
     RUN_TEST(Test_CreateFolderName);
-    RUN_TEST(Test_CreateCsvFilename);
-    RUN_TEST(Test_CreateCsvFilename_filename_end_of_year);
-    RUN_TEST(Test_SaveTempToBatchCsv_creates_folder_when_not_exists);
-    RUN_TEST(Test_SaveTempToBatchCsv_writes_csv_data);
+    RUN_TEST(Test_BuildJson_single_reading_record_keeps_plain_value);
+    RUN_TEST(Test_BuildJson_aggregate_sends_mean_with_stats_in_meta);
+    RUN_TEST(Test_BuildJson_burst_lists_all_samples);
+    RUN_TEST(Test_StageRecord_keeps_the_aggregate);
+    RUN_TEST(Test_SaveTempToOutageLog_creates_log_directory);
+    RUN_TEST(Test_SaveTempToOutageLog_appends_record);
+    RUN_TEST(Test_StageTempReading_keeps_reading_in_ram);
+    RUN_TEST(Test_SaveTempToOutageLog_does_not_create_csv_files);
+    RUN_TEST(Test_SaveTempToOutageLog_batches_sd_writes);
+    RUN_TEST(Test_SaveTempToOutageLog_flush_writes_buffered_records);
     RUN_TEST(Test_BuildJson_creates_correct_structure);
     RUN_TEST(Test_BuildJson_clears_previous_data);
     RUN_TEST(Test_DeleteCsvFile_success);
     RUN_TEST(Test_DeleteCsvFile_file_not_exists);
-    RUN_TEST(Test_BuildRecoveryJsonFromBatchCsv_structure);
 }
 
 // When standalone executable
@@ -0,0 +1,184 @@
+#include <ArduinoFake.h>
+#include <unity.h>
+#include "time_service.h"
+#include "core.h"
+
+using namespace fakeit;
+
+static unsigned long s_fakeMillis = 0;
+static const uint32_t T0 = 1753541700;   // 2025-07-26 14:55:00
+
+void setUp(void) {
+    ArduinoFakeReset();
+    When(Method(ArduinoFake(), millis)).AlwaysDo([]() -> unsigned long { return s_fakeMillis; });
+    s_fakeMillis = 0;
+    rtc.resetTestState();
+    TimeServiceReset();
+}
+
+void tearDown(void) {
+    ArduinoFakeReset();
+}
+
+// Test the cached time
+void Test_TimeService_reads_rtc_once_and_counts_on(void) {
+    PreciseTime first = TimeNowPrecise(5000);
+    PreciseTime later = TimeNowPrecise(7250);
+
+    TEST_ASSERT_EQUAL(T0, first.unixtime);
+    TEST_ASSERT_EQUAL(0, first.millis);
+    TEST_ASSERT_EQUAL(T0 + 2, later.unixtime);
+    TEST_ASSERT_EQUAL(250, later.millis);
+    TEST_ASSERT_EQUAL(1, rtc.getNowCalls());
+    TEST_ASSERT_EQUAL(1, TimeServiceRtcReads());
+}
+
+void Test_TimeService_resyncs_after_the_interval(void) {
+    TimeServiceSetResyncInterval(60000);
+    TimeNow(0);
+    // The RTC is a second ahead of millis() by the time of the resync
+    rtc.setNow(DateTime(T0 + 61));
+
+    TEST_ASSERT_EQUAL(T0 + 59, TimeNow(59999).unixtime());
+    TEST_ASSERT_EQUAL(T0 + 61, TimeNow(60000).unixtime());
+    TEST_ASSERT_EQUAL(2, rtc.getNowCalls());
+}
+
+void Test_TimeService_resync_on_request(void) {
+    TimeNow(0);
+    rtc.setNow(DateTime(2025, 7, 26, 15, 0, 0));
+    TimeServiceRequestResync();
+
+    DateTime now = TimeNow(1000);
+    TEST_ASSERT_EQUAL(15, now.hour());
+    TEST_ASSERT_EQUAL(0, now.minute());
+    TEST_ASSERT_EQUAL(2, TimeServiceRtcReads());
+}
+
+void Test_TimeService_sqw_edge_pins_the_second(void) {
+    // Read at an unknown phase: the second is taken to start at 1500 ms
+    TimeNowPrecise(1500);
+
+    // The RTC second actually starts at 2300 ms
+    s_fakeMillis = 2300;
+    TimeServiceOnSqwEdge();
+    PreciseTime atEdge = TimeNowPrecise(2300);
+    PreciseTime later = TimeNowPrecise(2800);
+
+    TEST_ASSERT_EQUAL(T0 + 1, atEdge.unixtime);
+    TEST_ASSERT_EQUAL(0, atEdge.millis);
+    TEST_ASSERT_EQUAL(T0 + 1, later.unixtime);
+    TEST_ASSERT_EQUAL(500, later.millis);
+    TEST_ASSERT_EQUAL(1, rtc.getNowCalls());
+}
+
+void Test_TimeService_sqw_edge_cancels_millis_drift(void) {
+    TimeServiceSetResyncInterval(0);
+    s_fakeMillis = 1000;
+    TimeServiceOnSqwEdge();
+    TimeNow(1000);
+
+    // millis() runs 0.3 % fast: after 100 RTC seconds it shows 100.3 s
+    s_fakeMillis = 101300;
+    TimeServiceOnSqwEdge();
+    PreciseTime time = TimeNowPrecise(101300);
+
+    TEST_ASSERT_EQUAL(T0 + 100, time.unixtime);
+    TEST_ASSERT_EQUAL(0, time.millis);
+    TEST_ASSERT_EQUAL(1, rtc.getNowCalls());
+}
+
+void Test_TimeService_due_resync_waits_for_the_edge_phase(void) {
+    TimeServiceSetResyncInterval(10000);
+    TimeNow(0);
+    rtc.setNow(DateTime(T0 + 20));
+
+    // The edge came at 20200 ms, the request only at 20700 ms
+    s_fakeMillis = 20200;
+    TimeServiceOnSqwEdge();
+    PreciseTime time = TimeNowPrecise(20700);
+
+    TEST_ASSERT_EQUAL(T0 + 20, time.unixtime);
+    TEST_ASSERT_EQUAL(500, time.millis);
+    TEST_ASSERT_EQUAL(2, rtc.getNowCalls());
+}
+
+void Test_TimeService_counts_across_millis_wrap(void) {
+    TimeNow(0UL - 4096);
+    PreciseTime time = TimeNowPrecise(2048);
+
+    // 6144 ms later
+    TEST_ASSERT_EQUAL(T0 + 6, time.unixtime);
+    TEST_ASSERT_EQUAL(144, time.millis);
+    TEST_ASSERT_EQUAL(1, rtc.getNowCalls());
+}
+
+void Test_DateTime_round_trips_unixtime(void) {
+    TEST_ASSERT_EQUAL(T0, DateTime(2025, 7, 26, 14, 55, 0).unixtime());
+    DateTime leap(951782400);   // 2000-02-29 00:00:00
+    TEST_ASSERT_EQUAL(2000, leap.year());
+    TEST_ASSERT_EQUAL(2, leap.month());
+    TEST_ASSERT_EQUAL(29, leap.day());
+}
+
+// Test the RTC traffic of the running firmware
+static uint32_t RtcReadsInOneHour(unsigned long startMs, bool sqw) {
+    const uint32_t before = rtc.getNowCalls();
+    for (unsigned long second = 1; second <= 3600; second++) {
+        s_fakeMillis = startMs + second * 1000;
+        rtc.setNow(DateTime(T0 + second));
+        if (sqw) TimeServiceOnSqwEdge();
+        CoreLoop();
+    }
+    return rtc.getNowCalls() - before;
+}
+
+void Test_CoreLoop_rtc_reads_per_simulated_hour(void) {
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char[]))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char[]))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const String&))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const String&))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(unsigned long, int))).AlwaysReturn(1);
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(int, int))).AlwaysReturn(1);
+    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long ms) { s_fakeMillis += ms; });
+    mqttClient.setPubackEnabled(true);
+    rtc.setNow(DateTime(T0));
+    CoreSetup();
+    TEST_ASSERT_EQUAL(1, rtc.getNowCalls());
+
+    // The sample, publish and recovery tasks all ask for the time; the RTC is read once an hour
+    uint32_t hourly = RtcReadsInOneHour(s_fakeMillis, false);
+    TimeServiceSetResyncInterval(600000);
+    uint32_t tenMinutes = RtcReadsInOneHour(s_fakeMillis, false);
+    uint32_t withSqw = RtcReadsInOneHour(s_fakeMillis, true);
+
+    char message[96];
+    snprintf(message, sizeof(message), "RTC reads per hour: %lu (hourly), %lu (10 min), %lu (10 min, SQW)",
+             (unsigned long)hourly, (unsigned long)tenMinutes, (unsigned long)withSqw);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(1, hourly);
+    TEST_ASSERT_EQUAL(6, tenMinutes);
+    TEST_ASSERT_EQUAL(6, withSqw);
+}
+
+// Bundle for central test_main.cpp
+void Run_time_service_tests() {
+    RUN_TEST(Test_TimeService_reads_rtc_once_and_counts_on);
+    RUN_TEST(Test_TimeService_resyncs_after_the_interval);
+    RUN_TEST(Test_TimeService_resync_on_request);
+    RUN_TEST(Test_TimeService_sqw_edge_pins_the_second);
+    RUN_TEST(Test_TimeService_sqw_edge_cancels_millis_drift);
+    RUN_TEST(Test_TimeService_due_resync_waits_for_the_edge_phase);
+    RUN_TEST(Test_TimeService_counts_across_millis_wrap);
+    RUN_TEST(Test_DateTime_round_trips_unixtime);
+    RUN_TEST(Test_CoreLoop_rtc_reads_per_simulated_hour);
+}
+
+// When standalone executable
+#ifndef COMBINED_TEST_MAIN
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    Run_time_service_tests();
+    return UNITY_END();
+}
+#endif
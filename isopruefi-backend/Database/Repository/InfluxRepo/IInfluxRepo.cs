@@ -17,6 +17,17 @@ public interface IInfluxRepo
     /// <returns>A task that represents asynchronous saving of data.</returns>
     Task WriteSensorData(double measurement, string sensor, long timestamp, int sequence);
 
+    /// <summary>
+    ///     Generates a point in the InfluxDB database with one sample of a sensor burst.
+    ///     Bursts are raw samples taken while the temperature changes quickly. They go to their own
+    ///     measurement, so the per-minute temperature series keeps one reading per minute.
+    /// </summary>
+    /// <param name="measurement">Temperature Value</param>
+    /// <param name="sensor">SensorId</param>
+    /// <param name="timestamp">Unix Timestamp</param>
+    /// <returns>A task that represents asynchronous saving of data.</returns>
+    Task WriteBurstSensorData(double measurement, string sensor, long timestamp);
+
     /// <summary>
     ///     Generates a point in the InfluxDB database with the given outside weather data.
     /// </summary>
@@ -56,6 +56,20 @@ public class InfluxRepo : IInfluxRepo
         await _client.WritePointAsync(point);
     }
 
+    /// <inheritdoc />
+    public async Task WriteBurstSensorData(double measurement, string sensor, long timestamp)
+    {
+        var dateTimeUtc = DateTimeOffset
+            .FromUnixTimeSeconds(timestamp)
+            .UtcDateTime;
+
+        var point = PointData.Measurement("temperature_burst")
+            .SetTag("sensor", sensor)
+            .SetField("value", measurement)
+            .SetTimestamp(dateTimeUtc);
+        await _client.WritePointAsync(point);
+    }
+
     /// <inheritdoc />
     public async Task WriteOutsideWeatherData(string place, string website, double temperature, DateTime timestamp,
         int postalcode)
@@ -58,6 +58,21 @@ public class CachedInfluxRepo : IInfluxRepo
         await WritePointWithCache(point, "sensor");
     }
 
+    /// <inheritdoc />
+    public async Task WriteBurstSensorData(double measurement, string sensor, long timestamp)
+    {
+        var dateTimeUtc = DateTimeOffset
+            .FromUnixTimeSeconds(timestamp)
+            .UtcDateTime;
+
+        var point = PointData.Measurement("temperature_burst")
+            .SetTag("sensor", sensor)
+            .SetField("value", measurement)
+            .SetTimestamp(dateTimeUtc);
+
+        await WritePointWithCache(point, "sensor");
+    }
+
     /// <inheritdoc />
     public async Task WriteOutsideWeatherData(string place, string website, double temperature, DateTime timestamp,
         int postalcode)
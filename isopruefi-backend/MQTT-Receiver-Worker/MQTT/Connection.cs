@@ -270,6 +270,7 @@ public class Connection : IConnection
 
     /// <summary>
     ///     Processes a single temperature sensor reading asynchronously and writes it to the provided InfluxDB repository.
+    ///     A burst (meta.burst set) is written as one reading per value.
     /// </summary>
     /// <param name="tempSensorReading">The temperature sensor reading to process.</param>
     /// <param name="sensorName">The name of the sensor that produced the reading.</param>
@@ -297,12 +298,26 @@ public class Connection : IConnection
                         && (tempSensorReading.Meta is null || (tempSensorReading.Meta.Value is null &&
                                                                tempSensorReading.Meta.Timestamp is null &&
                                                                tempSensorReading.Meta.Sequence is null)):
+                // An interval aggregate arrives as its mean; its min/max/count in meta are not stored
                 await influxRepo.WriteSensorData(
                     tempSensorReading.Value[0] ?? 0,
                     sensorName,
                     tempSensorReading.Timestamp,
                     tempSensorReading.Sequence ?? 0);
                 break;
+            case > 1 when tempSensorReading.Meta is { Burst: > 0 }:
+                // A burst carries no sequence number; its values are spaced meta.burst seconds apart
+                // and kept apart from the per-minute readings
+                for (var i = 0; i < tempSensorReading.Value.Length; i++)
+                {
+                    if (tempSensorReading.Value[i] is not { } value) continue;
+                    await influxRepo.WriteBurstSensorData(
+                        value,
+                        sensorName,
+                        tempSensorReading.Timestamp + (long)i * tempSensorReading.Meta.Burst.Value);
+                }
+
+                break;
             case > 1:
                 _logger.LogInformation(
                     "Received multiple values in sensor reading from {SensorName}. Only the first value will be processed",
@@ -350,7 +365,7 @@ public class Connection : IConnection
             && tempSensorReading.Meta.Sequence.Length == tempSensorReading.Meta.Value!.Length)
         {
             var tempDataMeta = tempSensorReading.Meta;
-            await Parallel.ForEachAsync(Enumerable.Range(0, tempDataMeta.Sequence.Length - 1),
+            await Parallel.ForEachAsync(Enumerable.Range(0, tempDataMeta.Sequence.Length),
                 async (value, cancellationToken) =>
                 {
                     double?[]? values = { tempDataMeta.Value[value] };
@@ -25,4 +25,10 @@ public class TempSensorMeta
     /// </summary>
     [JsonPropertyName("s")]
     public int[]? Sequence { get; set; }
+
+    /// <summary>
+    ///     Gets or sets the spacing in seconds of the values of a burst, which start at the reading's timestamp.
+    /// </summary>
+    [JsonPropertyName("burst")]
+    public int? Burst { get; set; }
 }
\ No newline at end of file
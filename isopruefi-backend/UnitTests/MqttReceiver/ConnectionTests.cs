@@ -227,6 +227,67 @@ public class ConnectionTests
         }
     }
 
+    /// <summary>
+    ///     Tests that an interval aggregate from the firmware is written as its mean. The receiver keeps only
+    ///     the mean; min, max, count and last sample in meta ("mn", "mx", "n", "l") are not modeled and not stored.
+    /// </summary>
+    [Test]
+    public async Task ProcessSensorReading_AggregatePayload_KeepsOnlyMean()
+    {
+        var json = """
+                   {"timestamp":1737024000,"value":[25.5],"sequence":42,"meta":{"mn":25.25,"mx":25.75,"n":12,"l":25.5}}
+                   """;
+        var sensorReading = JsonSerializer.Deserialize<TempSensorReading>(json)!;
+
+        var method = typeof(Connection).GetMethod("ProcessSensorReading",
+            BindingFlags.NonPublic | BindingFlags.Instance);
+
+        if (method != null)
+        {
+            var task = (Task)method.Invoke(_connection,
+                new object[] { sensorReading, "testSensor", _mockInfluxRepo.Object })!;
+            await task;
+
+            _mockInfluxRepo.Verify(r => r.WriteSensorData(25.5, "testSensor", 1737024000, 42), Times.Once);
+            _mockInfluxRepo.Verify(
+                r => r.WriteSensorData(It.IsAny<double>(), It.IsAny<string>(), It.IsAny<long>(), It.IsAny<int>()),
+                Times.Once);
+        }
+    }
+
+    /// <summary>
+    ///     Tests that a burst from the firmware is written as one burst sample per value, spaced meta.burst seconds
+    ///     apart, and never into the per-minute readings.
+    /// </summary>
+    [Test]
+    public async Task ProcessSensorReading_BurstPayload_WritesEachValue()
+    {
+        var json = """
+                   {"timestamp":1737024005,"value":[25.5,25.25,24.75],"meta":{"burst":5}}
+                   """;
+        var sensorReading = JsonSerializer.Deserialize<TempSensorReading>(json)!;
+
+        var method = typeof(Connection).GetMethod("ProcessSensorReading",
+            BindingFlags.NonPublic | BindingFlags.Instance);
+
+        if (method != null)
+        {
+            var task = (Task)method.Invoke(_connection,
+                new object[] { sensorReading, "testSensor", _mockInfluxRepo.Object })!;
+            await task;
+
+            _mockInfluxRepo.Verify(r => r.WriteBurstSensorData(25.5, "testSensor", 1737024005), Times.Once);
+            _mockInfluxRepo.Verify(r => r.WriteBurstSensorData(25.25, "testSensor", 1737024010), Times.Once);
+            _mockInfluxRepo.Verify(r => r.WriteBurstSensorData(24.75, "testSensor", 1737024015), Times.Once);
+            _mockInfluxRepo.Verify(
+                r => r.WriteBurstSensorData(It.IsAny<double>(), It.IsAny<string>(), It.IsAny<long>()),
+                Times.Exactly(3));
+            _mockInfluxRepo.Verify(
+                r => r.WriteSensorData(It.IsAny<double>(), It.IsAny<string>(), It.IsAny<long>(), It.IsAny<int>()),
+                Times.Never);
+        }
+    }
+
     /// <summary>
     ///     Tests processing of sensor reading with null value.
     /// </summary>
@@ -310,10 +371,41 @@ public class ConnectionTests
                 new object[] { batchReading, "testSensor", _mockInfluxRepo.Object })!;
             await task;
 
-            // Should process each meta reading
+            // Should process each meta reading, the last one included
+            _mockInfluxRepo.Verify(r => r.WriteSensorData(25.5, "testSensor", 1234567890, 1), Times.Once);
+            _mockInfluxRepo.Verify(r => r.WriteSensorData(26.0, "testSensor", 1234567891, 0), Times.Once);
             _mockInfluxRepo.Verify(
-                r => r.WriteSensorData(It.IsAny<double>(), "testSensor", It.IsAny<long>(), It.IsAny<int>()),
-                Times.AtLeast(1));
+                r => r.WriteSensorData(It.IsAny<double>(), It.IsAny<string>(), It.IsAny<long>(), It.IsAny<int>()),
+                Times.Exactly(2));
+        }
+    }
+
+    /// <summary>
+    ///     Tests that a batch holding a single reading writes that reading.
+    /// </summary>
+    [Test]
+    public async Task ProcessBatchSensorReading_SingleReading_WritesIt()
+    {
+        var batchReading = new TempSensorReading
+        {
+            Meta = new TempSensorMeta
+            {
+                Timestamp = [1234567890],
+                Value = [25.5],
+                Sequence = [7]
+            }
+        };
+
+        var method = typeof(Connection).GetMethod("ProcessBatchSensorReading",
+            BindingFlags.NonPublic | BindingFlags.Instance);
+
+        if (method != null)
+        {
+            var task = (Task)method.Invoke(_connection,
+                new object[] { batchReading, "testSensor", _mockInfluxRepo.Object })!;
+            await task;
+
+            _mockInfluxRepo.Verify(r => r.WriteSensorData(25.5, "testSensor", 1234567890, 7), Times.Once);
         }
     }
 